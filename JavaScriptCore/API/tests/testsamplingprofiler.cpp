@@ -0,0 +1,91 @@
+/*
+ * Exercises JSC::SamplingProfiler, the profiler behind KdStartScriptProfiler,
+ * KdStopScriptProfiler, KdClearScriptProfile and KdGetScriptProfile.
+ *
+ * The testsamplingprofiler project in build/kdgui.sln builds it against
+ * JavaScriptCore_static and runs it after every build; a failing check fails
+ * the build. It needs the JIT. Run by hand, it takes no arguments, prints
+ * one line per check and exits non-zero if any fails.
+ */
+
+#include "config.h"
+
+#include "APICast.h"
+#include "JSContextRef.h"
+#include "JSGlobalData.h"
+#include "JSStringRef.h"
+#include "SamplingProfiler.h"
+#include "UString.h"
+#include <stdio.h>
+#include <string.h>
+#include <wtf/text/CString.h>
+
+using namespace JSC;
+
+static const char* script =
+    "function hot(n) {\n"
+    "    var s = 0;\n"
+    "    for (var i = 0; i < n; ++i)\n"
+    "        s += i % 7;\n"
+    "    return s;\n"
+    "}\n"
+    "function outer() {\n"
+    "    var t = 0;\n"
+    "    for (var k = 0; k < 300; ++k)\n"
+    "        t += hot(100000);\n"
+    "    return t;\n"
+    "}\n"
+    "outer();\n";
+
+static int failures;
+
+static void check(bool condition, const char* description)
+{
+    printf("%s: %s\n", condition ? "PASS" : "FAIL", description);
+    if (!condition)
+        ++failures;
+}
+
+static void runScript(JSGlobalContextRef context)
+{
+    JSStringRef source = JSStringCreateWithUTF8CString(script);
+    JSStringRef url = JSStringCreateWithUTF8CString("profile.js");
+    JSValueRef exception = 0;
+    JSEvaluateScript(context, source, 0, url, 1, &exception);
+    JSStringRelease(url);
+    JSStringRelease(source);
+    check(!exception, "script ran without an exception");
+}
+
+int main()
+{
+    JSGlobalContextRef context = JSGlobalContextCreate(0);
+    SamplingProfiler& profiler = toJS(context)->globalData().samplingProfiler;
+
+    runScript(context);
+    check(!profiler.isRunning() && !profiler.sampleCount(), "nothing is sampled before start()");
+
+    profiler.start(1);
+    check(profiler.isRunning(), "start() starts the timer");
+    runScript(context);
+    profiler.stop();
+    check(!profiler.isRunning(), "stop() stops the timer");
+
+    unsigned samples = profiler.sampleCount();
+    check(samples > 0, "samples were taken while running");
+
+    CString stacks = profiler.foldedStacks().utf8();
+    check(strstr(stacks.data(), "outer profile.js:") && strstr(stacks.data(), ";hot profile.js:"), "folded stacks put hot() under outer()");
+    check(stacks.length() && stacks.data()[stacks.length() - 1] == '\n', "folded stacks end with a newline");
+
+    runScript(context);
+    check(profiler.sampleCount() == samples, "nothing is sampled after stop()");
+
+    profiler.clear();
+    check(!profiler.sampleCount() && profiler.foldedStacks().isEmpty(), "clear() discards every sample");
+
+    JSGlobalContextRelease(context);
+
+    printf("%s\n", failures ? "FAIL: some checks failed" : "PASS: all checks passed");
+    return failures ? 1 : 0;
+}
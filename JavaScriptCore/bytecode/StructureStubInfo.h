@@ -55,6 +55,9 @@ namespace JSC {
         StructureStubInfo(AccessType accessType)
             : accessType(accessType)
             , seen(false)
+#if ENABLE(MEGAMORPHIC_CACHE)
+            , megamorphicSite(0)
+#endif
         {
         }
 
@@ -130,6 +133,10 @@ namespace JSC {
 
         int accessType : 31;
         int seen : 1;
+#if ENABLE(MEGAMORPHIC_CACHE)
+        // Set by the megamorphic get and put stubs; see MegamorphicCache::site().
+        unsigned megamorphicSite;
+#endif
 
         union {
             struct {
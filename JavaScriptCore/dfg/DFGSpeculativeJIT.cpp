@@ -705,6 +705,11 @@ void SpeculativeJIT::compile(Node& node)
         lengthDoesNotNeedUpdate.link(&m_jit);
         notHoleValue.link(&m_jit);
 
+        // Storing a cell means the collector has to scan the storage.
+        MacroAssembler::Jump notCell = m_jit.branchTestPtr(MacroAssembler::NonZero, valueReg, GPRInfo::tagMaskRegister);
+        m_jit.store32(TrustedImm32(1), MacroAssembler::Address(storageReg, OBJECT_OFFSETOF(ArrayStorage, m_mayHaveCells)));
+        notCell.link(&m_jit);
+
         // Store the value to the array.
         m_jit.storePtr(valueReg, MacroAssembler::BaseIndex(storageReg, propertyReg, MacroAssembler::ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
 
@@ -726,6 +731,10 @@ void SpeculativeJIT::compile(Node& node)
         GPRReg propertyReg = property.gpr();
         GPRReg valueReg = value.gpr();
 
+        MacroAssembler::Jump notCell = m_jit.branchTestPtr(MacroAssembler::NonZero, valueReg, GPRInfo::tagMaskRegister);
+        m_jit.store32(TrustedImm32(1), MacroAssembler::Address(storageReg, OBJECT_OFFSETOF(ArrayStorage, m_mayHaveCells)));
+        notCell.link(&m_jit);
+
         // Store the value to the array.
         m_jit.storePtr(valueReg, MacroAssembler::BaseIndex(storageReg, propertyReg, MacroAssembler::ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
 
@@ -31,6 +31,7 @@
 #include "JSONObject.h"
 #include "Tracing.h"
 #include <algorithm>
+#include <wtf/CurrentTime.h>
 
 #define COLLECT_ON_EVERY_SLOW_ALLOCATION 0
 
@@ -39,6 +40,32 @@ using namespace std;
 namespace JSC {
 
 const size_t minBytesPerCycle = 512 * 1024;
+const size_t maxBytesPerCycle = 8 * 1024 * 1024;
+
+GCPauseHistogram::GCPauseHistogram()
+    : collectionCount(0)
+    , totalPauseTime(0)
+    , totalMarkTime(0)
+    , maxPauseTime(0)
+{
+    memset(buckets, 0, sizeof(buckets));
+}
+
+void GCPauseHistogram::record(double pauseTime, double markTime)
+{
+    size_t bucket = 0;
+    double limit = 0.001;
+    while (bucket < bucketCount - 1 && pauseTime >= limit) {
+        ++bucket;
+        limit *= 2;
+    }
+    ++buckets[bucket];
+
+    ++collectionCount;
+    totalPauseTime += pauseTime;
+    totalMarkTime += markTime;
+    maxPauseTime = max(maxPauseTime, pauseTime);
+}
 
 Heap::Heap(JSGlobalData* globalData)
     : m_operationInProgress(NoOperation)
@@ -47,9 +74,14 @@ Heap::Heap(JSGlobalData* globalData)
     , m_activityCallback(DefaultGCActivityCallback::create(this))
     , m_globalData(globalData)
     , m_machineThreads(this)
+#if ENABLE(PARALLEL_GC)
+    , m_markStackSharedData(globalData->jsArrayVPtr)
+#endif
     , m_markStack(globalData->jsArrayVPtr)
     , m_handleHeap(globalData)
     , m_extraCost(0)
+    , m_bytesPerCycle(minBytesPerCycle)
+    , m_sizeAfterLastCollection(0)
 {
     m_markedSpace.setHighWaterMark(minBytesPerCycle);
     (*m_activityCallback)();
@@ -168,6 +200,17 @@ void Heap::popTempSortVector(Vector<ValueStringPair>* tempVector)
     ASSERT_UNUSED(tempVector, tempVector == m_tempSortingVectors.last());
     m_tempSortingVectors.removeLast();
 }
+
+void Heap::pushTempSortVector(Vector<JSValue>* tempVector)
+{
+    m_tempSortingValueVectors.append(tempVector);
+}
+
+void Heap::popTempSortVector(Vector<JSValue>* tempVector)
+{
+    ASSERT_UNUSED(tempVector, tempVector == m_tempSortingValueVectors.last());
+    m_tempSortingValueVectors.removeLast();
+}
     
 void Heap::markTempSortVectors(HeapRootVisitor& heapRootMarker)
 {
@@ -183,6 +226,12 @@ void Heap::markTempSortVectors(HeapRootVisitor& heapRootMarker)
                 heapRootMarker.mark(&vectorIt->first);
         }
     }
+
+    typedef Vector<Vector<JSValue>* > VectorOfValueVectors;
+
+    VectorOfValueVectors::iterator valueVectorsEnd = m_tempSortingValueVectors.end();
+    for (VectorOfValueVectors::iterator it = m_tempSortingValueVectors.begin(); it != valueVectorsEnd; ++it)
+        heapRootMarker.mark((*it)->data(), (*it)->size());
 }
 
 inline RegisterFile& Heap::registerFile()
@@ -222,34 +271,34 @@ void Heap::markRoots()
     m_markedSpace.clearMarks();
 
     visitor.append(machineThreadRoots);
-    visitor.drain();
+    drainMarkStack();
 
     visitor.append(registerFileRoots);
-    visitor.drain();
+    drainMarkStack();
 
     markProtectedObjects(heapRootMarker);
-    visitor.drain();
+    drainMarkStack();
     
     markTempSortVectors(heapRootMarker);
-    visitor.drain();
+    drainMarkStack();
 
     if (m_markListSet && m_markListSet->size())
         MarkedArgumentBuffer::markLists(heapRootMarker, *m_markListSet);
     if (m_globalData->exception)
         heapRootMarker.mark(&m_globalData->exception);
-    visitor.drain();
+    drainMarkStack();
 
     m_handleHeap.markStrongHandles(heapRootMarker);
-    visitor.drain();
+    drainMarkStack();
 
     m_handleStack.mark(heapRootMarker);
-    visitor.drain();
+    drainMarkStack();
 
     // Mark the small strings cache as late as possible, since it will clear
     // itself if nothing else has marked it.
     // FIXME: Change the small strings cache to use Weak<T>.
     m_globalData->smallStrings.visitChildren(heapRootMarker);
-    visitor.drain();
+    drainMarkStack();
     
     // Weak handles must be marked last, because their owners use the set of
     // opaque roots to determine reachability.
@@ -257,7 +306,7 @@ void Heap::markRoots()
     do {
         lastOpaqueRootCount = visitor.opaqueRootCount();
         m_handleHeap.markWeakHandles(heapRootMarker);
-        visitor.drain();
+        drainMarkStack();
     // If the set of opaque roots has grown, more weak handles may have become reachable.
     } while (lastOpaqueRootCount != visitor.opaqueRootCount());
 
@@ -266,6 +315,67 @@ void Heap::markRoots()
     m_operationInProgress = NoOperation;
 }
 
+// Every collection marks the whole heap, so when scripts churn through
+// short-lived objects the cheapest thing to do is collect less often. If
+// little of what was allocated since the last collection survived this one,
+// double the allocation allowed before the next; once a good share of it
+// survives again, back off towards the minimum.
+void Heap::updateBytesPerCycle(size_t sizeBefore, size_t sizeAfter)
+{
+    size_t allocatedBytes = sizeBefore > m_sizeAfterLastCollection ? sizeBefore - m_sizeAfterLastCollection : 0;
+    size_t survivingBytes = sizeAfter > m_sizeAfterLastCollection ? sizeAfter - m_sizeAfterLastCollection : 0;
+    m_sizeAfterLastCollection = sizeAfter;
+
+    if (allocatedBytes < minBytesPerCycle)
+        return;
+
+    if (survivingBytes < allocatedBytes / 4)
+        m_bytesPerCycle = min(2 * m_bytesPerCycle, maxBytesPerCycle);
+    else if (survivingBytes > allocatedBytes / 2)
+        m_bytesPerCycle = max(m_bytesPerCycle / 2, minBytesPerCycle);
+}
+
+void Heap::drainMarkStack()
+{
+#if ENABLE(PARALLEL_GC)
+    m_markStackSharedData.drainInParallel(m_markStack);
+#else
+    m_markStack.drain();
+#endif
+}
+
+void Heap::setMarkingHelperThreadCount(unsigned count)
+{
+#if ENABLE(PARALLEL_GC)
+    ASSERT(m_operationInProgress == NoOperation);
+    m_markStackSharedData.setHelperThreadCount(count);
+#else
+    UNUSED_PARAM(count);
+#endif
+}
+
+unsigned Heap::markingHelperThreadCount() const
+{
+#if ENABLE(PARALLEL_GC)
+    return m_markStackSharedData.helperThreadCount();
+#else
+    return 0;
+#endif
+}
+
+void Heap::addCollectionObserver(HeapCollectionObserver* observer)
+{
+    if (!m_collectionObservers.contains(observer))
+        m_collectionObservers.append(observer);
+}
+
+void Heap::removeCollectionObserver(HeapCollectionObserver* observer)
+{
+    size_t index = m_collectionObservers.find(observer);
+    if (index != notFound)
+        m_collectionObservers.remove(index);
+}
+
 size_t Heap::objectCount() const
 {
     return m_markedSpace.objectCount();
@@ -394,8 +504,17 @@ void Heap::reset(SweepToggle sweepToggle)
     ASSERT(globalData()->identifierTable == wtfThreadData().currentIdentifierTable());
     JAVASCRIPTCORE_GC_BEGIN();
 
+    double startTime = currentTime();
+    // Allocation sets mark bits, so before marking size() covers everything
+    // allocated since the last collection as well.
+    size_t sizeBefore = m_markedSpace.size();
+
     markRoots();
+    double markTime = currentTime() - startTime;
     m_handleHeap.finalizeWeakHandles();
+#if ENABLE(MEGAMORPHIC_CACHE)
+    m_globalData->megamorphicCache.clear();
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
 
@@ -403,23 +522,45 @@ void Heap::reset(SweepToggle sweepToggle)
     m_extraCost = 0;
 
 #if ENABLE(JSC_ZOMBIES)
-    sweepToggle = DoSweep;
-#endif
-
+    // Zombies are made by the sweep and keep their blocks alive, so sweep
+    // everything before looking for empty blocks.
+    UNUSED_PARAM(sweepToggle);
+    m_markedSpace.sweep();
+    m_markedSpace.shrink();
+#else
     if (sweepToggle == DoSweep) {
-        m_markedSpace.sweep();
+        // A full collection is asked for when the embedder wants memory and
+        // destructors back now, so nothing is left for the allocator. Freeing
+        // a block runs the destructors of all its cells, so the empty blocks
+        // are released first rather than swept and then freed.
         m_markedSpace.shrink();
+        m_markedSpace.sweep();
+    } else {
+        // The allocator destroys dead cells as it reaches them; the rest are
+        // swept a block at a time as allocation moves on.
+        m_markedSpace.scheduleSweep();
     }
+#endif
 
     // To avoid pathological GC churn in large heaps, we set the allocation high
     // water mark to be proportional to the current size of the heap. The exact
     // proportion is a bit arbitrary. A 2X multiplier gives a 1:1 (heap size :
     // new bytes allocated) proportion, and seems to work well in benchmarks.
-    size_t proportionalBytes = 2 * m_markedSpace.size();
-    m_markedSpace.setHighWaterMark(max(proportionalBytes, minBytesPerCycle));
+    size_t sizeAfter = m_markedSpace.size();
+    size_t proportionalBytes = 2 * sizeAfter;
+    updateBytesPerCycle(sizeBefore, sizeAfter);
+    m_markedSpace.setHighWaterMark(max(proportionalBytes, m_bytesPerCycle));
 
     JAVASCRIPTCORE_GC_END();
 
+    double endTime = currentTime();
+    m_pauseHistogram.record(endTime - startTime, markTime);
+    if (!m_collectionObservers.isEmpty()) {
+        size_t collectedBytes = sizeBefore > sizeAfter ? sizeBefore - sizeAfter : 0;
+        for (size_t i = 0; i < m_collectionObservers.size(); ++i)
+            m_collectionObservers[i]->didCollect(startTime, endTime, collectedBytes);
+    }
+
     (*m_activityCallback)();
 }
 
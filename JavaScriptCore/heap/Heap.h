@@ -52,6 +52,28 @@ namespace JSC {
 
     enum OperationInProgress { NoOperation, Allocation, Collection };
 
+    // Collection pause times. Bucket i counts pauses shorter than 2^i ms; the
+    // last bucket takes everything longer.
+    struct GCPauseHistogram {
+        static const size_t bucketCount = 10;
+
+        GCPauseHistogram();
+        void record(double pauseTime, double markTime);
+
+        unsigned buckets[bucketCount];
+        unsigned collectionCount;
+        double totalPauseTime; // Seconds.
+        double totalMarkTime;
+        double maxPauseTime;
+    };
+
+    class HeapCollectionObserver {
+    public:
+        virtual ~HeapCollectionObserver() { }
+        // Times are as returned by WTF::currentTime().
+        virtual void didCollect(double startTime, double endTime, size_t collectedBytes) = 0;
+    };
+
     class Heap {
         WTF_MAKE_NONCOPYABLE(Heap);
     public:
@@ -60,6 +82,9 @@ namespace JSC {
 
         static bool isMarked(const JSCell*);
         static bool testAndSetMarked(const JSCell*);
+#if ENABLE(PARALLEL_GC)
+        static bool testAndSetMarkedConcurrently(const JSCell*);
+#endif
         static void setMarked(JSCell*);
         
         Heap(JSGlobalData*);
@@ -79,6 +104,16 @@ namespace JSC {
 
         void reportExtraMemoryCost(size_t cost);
 
+        // Number of extra threads that help the mutator thread mark. 0, the
+        // default, marks on the mutator thread alone.
+        void setMarkingHelperThreadCount(unsigned);
+        unsigned markingHelperThreadCount() const;
+
+        const GCPauseHistogram& pauseHistogram() const { return m_pauseHistogram; }
+        void resetPauseHistogram() { m_pauseHistogram = GCPauseHistogram(); }
+        void addCollectionObserver(HeapCollectionObserver*);
+        void removeCollectionObserver(HeapCollectionObserver*);
+
         void protect(JSValue);
         bool unprotect(JSValue); // True when the protect count drops to 0.
 
@@ -95,6 +130,8 @@ namespace JSC {
 
         void pushTempSortVector(Vector<ValueStringPair>*);
         void popTempSortVector(Vector<ValueStringPair>*);
+        void pushTempSortVector(Vector<JSValue>*);
+        void popTempSortVector(Vector<JSValue>*);
     
         HashSet<MarkedArgumentBuffer*>& markListSet() { if (!m_markListSet) m_markListSet = new HashSet<MarkedArgumentBuffer*>; return *m_markListSet; }
         
@@ -115,11 +152,13 @@ namespace JSC {
         void reportExtraMemoryCostSlowCase(size_t);
 
         void markRoots();
+        void drainMarkStack();
         void markProtectedObjects(HeapRootVisitor&);
         void markTempSortVectors(HeapRootVisitor&);
 
         enum SweepToggle { DoNotSweep, DoSweep };
         void reset(SweepToggle);
+        void updateBytesPerCycle(size_t sizeBefore, size_t sizeAfter);
 
         RegisterFile& registerFile();
 
@@ -128,6 +167,7 @@ namespace JSC {
 
         ProtectCountSet m_protectedValues;
         Vector<Vector<ValueStringPair>* > m_tempSortingVectors;
+        Vector<Vector<JSValue>* > m_tempSortingValueVectors; // Every element must be non-empty.
 
         HashSet<MarkedArgumentBuffer*>* m_markListSet;
 
@@ -136,11 +176,22 @@ namespace JSC {
         JSGlobalData* m_globalData;
         
         MachineThreads m_machineThreads;
+#if ENABLE(PARALLEL_GC)
+        MarkStackThreadSharedData m_markStackSharedData;
+#endif
         MarkStack m_markStack;
         HandleHeap m_handleHeap;
         HandleStack m_handleStack;
 
         size_t m_extraCost;
+
+        // Allocation allowed between collections on top of the live heap's
+        // own growth; see Heap::reset().
+        size_t m_bytesPerCycle;
+        size_t m_sizeAfterLastCollection;
+
+        GCPauseHistogram m_pauseHistogram;
+        Vector<HeapCollectionObserver*> m_collectionObservers;
     };
 
     inline bool Heap::isMarked(const JSCell* cell)
@@ -153,6 +204,22 @@ namespace JSC {
         return MarkedSpace::testAndSetMarked(cell);
     }
 
+#if ENABLE(PARALLEL_GC)
+    inline bool Heap::testAndSetMarkedConcurrently(const JSCell* cell)
+    {
+        return MarkedSpace::testAndSetMarkedConcurrently(cell);
+    }
+#endif
+
+    ALWAYS_INLINE bool MarkStack::testAndSetMarked(JSCell* cell)
+    {
+#if ENABLE(PARALLEL_GC)
+        if (m_isParallel)
+            return Heap::testAndSetMarkedConcurrently(cell);
+#endif
+        return Heap::testAndSetMarked(cell);
+    }
+
     inline void Heap::setMarked(JSCell* cell)
     {
         MarkedSpace::setMarked(cell);
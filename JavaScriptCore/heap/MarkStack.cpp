@@ -33,6 +33,7 @@
 #include "JSObject.h"
 #include "ScopeChain.h"
 #include "Structure.h"
+#include <algorithm>
 
 namespace JSC {
 
@@ -54,9 +55,29 @@ void MarkStack::append(ConservativeRoots& conservativeRoots)
         internalAppend(roots[i]);
 }
 
+#if ENABLE(PARALLEL_GC)
+// True when the cell's marking is JavaScriptCore code that is safe to run
+// concurrently; see MarkStackThreadSharedData.
+inline bool MarkStack::canVisitOnHelperThread(JSCell* cell)
+{
+    Structure* structure = cell->structure();
+    if (structure->typeInfo().type() < CompoundType)
+        return true;
+    if (!structure->typeInfo().overridesVisitChildren())
+        return true;
+    return cell->vptr() == m_jsArrayVPtr;
+}
+#endif
+
 inline void MarkStack::visitChildren(JSCell* cell)
 {
     ASSERT(Heap::isMarked(cell));
+#if ENABLE(PARALLEL_GC)
+    if (m_isHelperThread && !canVisitOnHelperThread(cell)) {
+        m_mutatorThreadCells.append(cell);
+        return;
+    }
+#endif
     if (cell->structure()->typeInfo().type() < CompoundType) {
         cell->JSCell::visitChildren(*this);
         return;
@@ -102,7 +123,7 @@ void MarkStack::drain()
             current.m_values++;
 
             JSCell* cell;
-            if (!value || !value.isCell() || Heap::testAndSetMarked(cell = value.asCell())) {
+            if (!value || !value.isCell() || testAndSetMarked(cell = value.asCell())) {
                 if (current.m_values == end) {
                     m_markSets.removeLast();
                     continue;
@@ -124,12 +145,248 @@ void MarkStack::drain()
 
             visitChildren(cell);
         }
-        while (!m_values.isEmpty())
+        while (!m_values.isEmpty()) {
             visitChildren(m_values.removeLast());
+#if ENABLE(PARALLEL_GC)
+            if (m_sharedData && m_values.size() > MarkStackThreadSharedData::donationThreshold
+                && !(++m_visitCount % MarkStackThreadSharedData::donationInterval))
+                m_sharedData->donate(*this);
+#endif
+        }
     }
 #if !ASSERT_DISABLED
     m_isDraining = false;
 #endif
 }
 
+#if ENABLE(PARALLEL_GC)
+
+MarkStackThreadSharedData::MarkStackThreadSharedData(void* jsArrayVPtr)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_helperThreadCount(0)
+    , m_wakeHelpers(0)
+    , m_lock(0)
+    , m_activeMarkers(0)
+    , m_helpersInSession(0)
+    , m_helpersWoken(false)
+    , m_sessionDone(true)
+    , m_exiting(false)
+    , m_sharedCellCount(0)
+{
+}
+
+MarkStackThreadSharedData::~MarkStackThreadSharedData()
+{
+    if (!m_wakeHelpers)
+        return;
+
+    lock();
+    m_exiting = true;
+    unlock();
+    signalSemaphore(m_wakeHelpers, m_helperThreads.size());
+    for (size_t i = 0; i < m_helperThreads.size(); ++i)
+        joinHelperThread(m_helperThreads[i]);
+    destroySemaphore(m_wakeHelpers);
+}
+
+void MarkStackThreadSharedData::setHelperThreadCount(unsigned count)
+{
+    ASSERT(m_sessionDone);
+    m_helperThreadCount = std::min(count, maxHelperThreadCount);
+    if (!m_helperThreadCount)
+        return;
+
+    if (!m_wakeHelpers) {
+        m_wakeHelpers = createSemaphore();
+        if (!m_wakeHelpers) {
+            m_helperThreadCount = 0;
+            return;
+        }
+    }
+
+    while (m_helperThreads.size() < m_helperThreadCount) {
+        void* thread = createHelperThread(this);
+        if (!thread)
+            break;
+        m_helperThreads.append(thread);
+    }
+    m_helperThreadCount = m_helperThreads.size();
+}
+
+void MarkStackThreadSharedData::lock()
+{
+    while (!weakCompareAndSwap(&m_lock, 0, 1))
+        yieldProcessor();
+}
+
+void MarkStackThreadSharedData::unlock()
+{
+    // A full barrier, so everything written under the lock is visible first.
+    weakCompareAndSwap(&m_lock, 1, 0);
+}
+
+void MarkStackThreadSharedData::donate(MarkStack& visitor)
+{
+    if (m_sharedCellCount >= maxSharedCells)
+        return;
+
+    // Cells that must be visited on this thread go back on the stack.
+    Vector<JSCell*, 32> keptCells;
+    lock();
+    size_t count = visitor.m_values.size() / 2;
+    for (size_t i = 0; i < count; ++i) {
+        JSCell* cell = visitor.m_values.removeLast();
+        if (visitor.canVisitOnHelperThread(cell))
+            m_sharedCells.append(cell);
+        else
+            keptCells.append(cell);
+    }
+    m_sharedCellCount = m_sharedCells.size();
+
+    bool wakeHelpers = !m_helpersWoken && !m_sharedCells.isEmpty();
+    if (wakeHelpers)
+        m_helpersWoken = true;
+    unlock();
+
+    for (size_t i = keptCells.size(); i; --i)
+        visitor.m_values.append(keptCells[i - 1]);
+
+    if (wakeHelpers)
+        signalSemaphore(m_wakeHelpers, m_helperThreadCount);
+}
+
+// Drains the visitor, then keeps taking work from the shared pool until the
+// whole session has run out of it. Only the owner takes cells that must be
+// visited on its thread.
+void MarkStackThreadSharedData::markInSession(MarkStack& visitor, bool holdsWork)
+{
+    bool isOwner = !visitor.m_isHelperThread;
+    while (true) {
+        if (holdsWork)
+            visitor.drain();
+
+        lock();
+        if (holdsWork) {
+            --m_activeMarkers;
+            if (!isOwner) {
+                m_mutatorThreadCells.append(visitor.m_mutatorThreadCells);
+                visitor.m_mutatorThreadCells.clear();
+            }
+        }
+        holdsWork = false;
+        while (!m_sessionDone) {
+            if (isOwner && !m_mutatorThreadCells.isEmpty()) {
+                for (size_t i = 0; i < m_mutatorThreadCells.size(); ++i)
+                    visitor.m_values.append(m_mutatorThreadCells[i]);
+                m_mutatorThreadCells.clear();
+                ++m_activeMarkers;
+                holdsWork = true;
+                break;
+            }
+            if (!m_sharedCells.isEmpty()) {
+                for (size_t i = 0; i < takeChunkSize && !m_sharedCells.isEmpty(); ++i) {
+                    visitor.m_values.append(m_sharedCells.last());
+                    m_sharedCells.removeLast();
+                }
+                m_sharedCellCount = m_sharedCells.size();
+                ++m_activeMarkers;
+                holdsWork = true;
+                break;
+            }
+            if (!m_activeMarkers && m_mutatorThreadCells.isEmpty()) {
+                m_sessionDone = true;
+                break;
+            }
+            unlock();
+            yieldProcessor();
+            lock();
+        }
+        unlock();
+
+        if (!holdsWork)
+            return;
+    }
+}
+
+void MarkStackThreadSharedData::drainInParallel(MarkStack& visitor)
+{
+    if (!m_helperThreadCount) {
+        visitor.drain();
+        return;
+    }
+
+    lock();
+    ASSERT(m_sharedCells.isEmpty());
+    ASSERT(m_mutatorThreadCells.isEmpty());
+    m_sessionDone = false;
+    m_activeMarkers = 1;
+    m_helpersWoken = false;
+    unlock();
+
+    visitor.m_sharedData = this;
+    visitor.m_isParallel = true;
+    markInSession(visitor, true);
+    visitor.m_sharedData = 0;
+    visitor.m_isParallel = false;
+
+    // Helpers still in the session have no work left, but may not have
+    // handed back their opaque roots yet.
+    lock();
+    while (m_helpersInSession) {
+        unlock();
+        yieldProcessor();
+        lock();
+    }
+    HashSet<void*> opaqueRoots;
+    opaqueRoots.swap(m_opaqueRoots);
+    unlock();
+
+    HashSet<void*>::iterator end = opaqueRoots.end();
+    for (HashSet<void*>::iterator it = opaqueRoots.begin(); it != end; ++it)
+        visitor.addOpaqueRoot(*it);
+}
+
+void MarkStackThreadSharedData::helperThreadMain()
+{
+    MarkStack visitor(m_jsArrayVPtr);
+    visitor.m_sharedData = this;
+    visitor.m_isParallel = true;
+    visitor.m_isHelperThread = true;
+
+    while (true) {
+        waitOnSemaphore(m_wakeHelpers);
+
+        lock();
+        if (m_exiting) {
+            unlock();
+            break;
+        }
+        if (m_sessionDone) {
+            unlock();
+            continue;
+        }
+        ++m_helpersInSession;
+        unlock();
+
+        markInSession(visitor, false);
+
+        lock();
+        HashSet<void*>::iterator end = visitor.m_opaqueRoots.end();
+        for (HashSet<void*>::iterator it = visitor.m_opaqueRoots.begin(); it != end; ++it)
+            m_opaqueRoots.add(*it);
+        --m_helpersInSession;
+        unlock();
+        visitor.m_opaqueRoots.clear();
+    }
+
+    visitor.m_sharedData = 0;
+}
+
+void MarkStackThreadSharedData::helperThreadEntry(MarkStackThreadSharedData* sharedData)
+{
+    sharedData->helperThreadMain();
+}
+
+#endif // ENABLE(PARALLEL_GC)
+
 } // namespace JSC
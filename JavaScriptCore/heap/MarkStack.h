@@ -38,6 +38,7 @@ namespace JSC {
 
     class ConservativeRoots;
     class JSGlobalData;
+    class MarkStackThreadSharedData;
     class Register;
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
@@ -47,6 +48,12 @@ namespace JSC {
     public:
         MarkStack(void* jsArrayVPtr)
             : m_jsArrayVPtr(jsArrayVPtr)
+#if ENABLE(PARALLEL_GC)
+            , m_sharedData(0)
+            , m_isParallel(false)
+            , m_isHelperThread(false)
+            , m_visitCount(0)
+#endif
 #if !ASSERT_DISABLED
             , m_isCheckingForDefaultMarkViolation(false)
             , m_isDraining(false)
@@ -80,6 +87,7 @@ namespace JSC {
 
     private:
         friend class HeapRootVisitor; // Allowed to mark a JSValue* or JSCell** directly.
+        friend class MarkStackThreadSharedData;
         void append(JSValue*);
         void append(JSValue*, size_t count);
         void append(JSCell**);
@@ -87,6 +95,10 @@ namespace JSC {
         void internalAppend(JSCell*);
         void internalAppend(JSValue);
         void visitChildren(JSCell*);
+        bool testAndSetMarked(JSCell*);
+#if ENABLE(PARALLEL_GC)
+        bool canVisitOnHelperThread(JSCell*);
+#endif
 
         struct MarkSet {
             MarkSet(JSValue* values, JSValue* end, MarkSetProperties properties)
@@ -194,6 +206,16 @@ namespace JSC {
         static size_t s_pageSize;
         HashSet<void*> m_opaqueRoots; // Handle-owning data structures not visible to the garbage collector.
 
+#if ENABLE(PARALLEL_GC)
+        // Set while this stack takes part in a parallel drain.
+        MarkStackThreadSharedData* m_sharedData;
+        bool m_isParallel;
+        bool m_isHelperThread;
+        unsigned m_visitCount;
+        // Cells a helper marked but left for the owner to visit.
+        Vector<JSCell*> m_mutatorThreadCells;
+#endif
+
 #if !ASSERT_DISABLED
     public:
         bool m_isCheckingForDefaultMarkViolation;
@@ -203,6 +225,91 @@ namespace JSC {
 
     typedef MarkStack SlotVisitor;
 
+#if ENABLE(PARALLEL_GC)
+    // Lets helper threads drain a MarkStack in parallel with its owner.
+    //
+    // The owner stays in charge: drainInParallel() marks as usual, and once
+    // its stack holds more cells than it can use it donates half of them to
+    // a shared pool and wakes the helpers. Every participant that runs dry
+    // takes a chunk back from the pool; the drain is over when the pool is
+    // empty and nobody holds work. Mark bits are set with a compare-and-swap
+    // for the duration, and opaque roots found by helpers are merged into the
+    // owner's set before drainInParallel() returns.
+    //
+    // Helpers only run marking code that lives in JavaScriptCore: strings,
+    // arrays, and objects that use the default JSObject marking. Any cell
+    // that overrides visitChildren, which includes every WebCore wrapper
+    // with custom marking, is visited on the owner's thread. The owner
+    // never donates such cells, and a helper that marks one hands it back
+    // through a separate queue that only the owner drains. WebCore's
+    // visitChildren implementations walk DOM structures and touch
+    // unsynchronized state such as reference counts, so they must not run
+    // concurrently.
+    //
+    // The helpers are native threads, created on first use and kept for the
+    // life of the heap, because WTF threading may be compiled out.
+    class MarkStackThreadSharedData {
+        WTF_MAKE_NONCOPYABLE(MarkStackThreadSharedData);
+    public:
+        MarkStackThreadSharedData(void* jsArrayVPtr);
+        ~MarkStackThreadSharedData();
+
+        // 0 turns parallel draining off.
+        void setHelperThreadCount(unsigned);
+        unsigned helperThreadCount() const { return m_helperThreadCount; }
+
+        void drainInParallel(MarkStack&);
+
+        static const unsigned maxHelperThreadCount = 8;
+
+        // Entry point for the platform thread functions.
+        static void helperThreadEntry(MarkStackThreadSharedData*);
+
+    private:
+        friend class MarkStack;
+
+        static const size_t donationThreshold = 128;
+        static const unsigned donationInterval = 64;
+        static const size_t maxSharedCells = 4096;
+        static const size_t takeChunkSize = 64;
+
+        void donate(MarkStack&);
+        void markInSession(MarkStack&, bool holdsWork);
+        void helperThreadMain();
+
+        void lock();
+        void unlock();
+
+        // Implemented per platform in MarkStackPosix.cpp and MarkStackWin.cpp.
+        static void* createSemaphore();
+        static void destroySemaphore(void*);
+        static void signalSemaphore(void*, unsigned count);
+        static void waitOnSemaphore(void*);
+        static void* createHelperThread(MarkStackThreadSharedData*);
+        static void joinHelperThread(void*);
+        static void yieldProcessor();
+
+        void* m_jsArrayVPtr;
+        unsigned m_helperThreadCount;
+        Vector<void*> m_helperThreads;
+        void* m_wakeHelpers;
+
+        // Guarded by m_lock.
+        volatile unsigned m_lock;
+        Vector<JSCell*> m_sharedCells;
+        Vector<JSCell*> m_mutatorThreadCells;
+        HashSet<void*> m_opaqueRoots;
+        unsigned m_activeMarkers;
+        unsigned m_helpersInSession;
+        bool m_helpersWoken;
+        bool m_sessionDone;
+        bool m_exiting;
+
+        // Read without the lock, as a hint only.
+        volatile size_t m_sharedCellCount;
+    };
+#endif
+
     inline void MarkStack::append(JSValue* slot, size_t count)
     {
         if (!count)
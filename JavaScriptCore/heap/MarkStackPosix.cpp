@@ -31,6 +31,13 @@
 #include <unistd.h>
 #include <sys/mman.h>
 
+#if ENABLE(PARALLEL_GC)
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#endif
+
 namespace JSC {
 
 void MarkStack::initializePagesize()
@@ -38,6 +45,64 @@ void MarkStack::initializePagesize()
     MarkStack::s_pageSize = getpagesize();
 }
 
+#if ENABLE(PARALLEL_GC)
+
+void* MarkStackThreadSharedData::createSemaphore()
+{
+    sem_t* semaphore = new sem_t;
+    if (sem_init(semaphore, 0, 0)) {
+        delete semaphore;
+        return 0;
+    }
+    return semaphore;
+}
+
+void MarkStackThreadSharedData::destroySemaphore(void* semaphore)
+{
+    sem_destroy(static_cast<sem_t*>(semaphore));
+    delete static_cast<sem_t*>(semaphore);
+}
+
+void MarkStackThreadSharedData::signalSemaphore(void* semaphore, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+        sem_post(static_cast<sem_t*>(semaphore));
+}
+
+void MarkStackThreadSharedData::waitOnSemaphore(void* semaphore)
+{
+    while (sem_wait(static_cast<sem_t*>(semaphore)) && errno == EINTR) { }
+}
+
+static void* markStackHelperThreadEntry(void* sharedData)
+{
+    MarkStackThreadSharedData::helperThreadEntry(static_cast<MarkStackThreadSharedData*>(sharedData));
+    return 0;
+}
+
+void* MarkStackThreadSharedData::createHelperThread(MarkStackThreadSharedData* sharedData)
+{
+    pthread_t* thread = new pthread_t;
+    if (pthread_create(thread, 0, markStackHelperThreadEntry, sharedData)) {
+        delete thread;
+        return 0;
+    }
+    return thread;
+}
+
+void MarkStackThreadSharedData::joinHelperThread(void* thread)
+{
+    pthread_join(*static_cast<pthread_t*>(thread), 0);
+    delete static_cast<pthread_t*>(thread);
+}
+
+void MarkStackThreadSharedData::yieldProcessor()
+{
+    sched_yield();
+}
+
+#endif
+
 }
 
 #endif
@@ -29,6 +29,7 @@
 #if OS(WINDOWS)
 
 #include "windows.h"
+#include <process.h>
 
 namespace JSC {
 
@@ -39,6 +40,53 @@ void MarkStack::initializePagesize()
     MarkStack::s_pageSize = system_info.dwPageSize;
 }
 
+#if ENABLE(PARALLEL_GC)
+
+void* MarkStackThreadSharedData::createSemaphore()
+{
+    return CreateSemaphoreW(0, 0, LONG_MAX, 0);
+}
+
+void MarkStackThreadSharedData::destroySemaphore(void* semaphore)
+{
+    CloseHandle(semaphore);
+}
+
+void MarkStackThreadSharedData::signalSemaphore(void* semaphore, unsigned count)
+{
+    if (count)
+        ReleaseSemaphore(semaphore, count, 0);
+}
+
+void MarkStackThreadSharedData::waitOnSemaphore(void* semaphore)
+{
+    WaitForSingleObject(semaphore, INFINITE);
+}
+
+static unsigned __stdcall markStackHelperThreadEntry(void* sharedData)
+{
+    MarkStackThreadSharedData::helperThreadEntry(static_cast<MarkStackThreadSharedData*>(sharedData));
+    return 0;
+}
+
+void* MarkStackThreadSharedData::createHelperThread(MarkStackThreadSharedData* sharedData)
+{
+    return reinterpret_cast<void*>(_beginthreadex(0, 0, markStackHelperThreadEntry, sharedData, 0, 0));
+}
+
+void MarkStackThreadSharedData::joinHelperThread(void* thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void MarkStackThreadSharedData::yieldProcessor()
+{
+    SwitchToThread();
+}
+
+#endif
+
 }
 
 #endif
@@ -67,7 +67,9 @@ void MarkedBlock::sweep()
 {
     Structure* dummyMarkableCellStructure = m_heap->globalData()->dummyMarkableCellStructure.get();
 
-    for (size_t i = firstAtom(); i < m_endAtom; i += m_atomsPerCell) {
+    // Every cell below m_nextAtom is marked: allocate() either skipped a live
+    // cell or destroyed a dead one and handed it out.
+    for (size_t i = m_nextAtom; i < m_endAtom; i += m_atomsPerCell) {
         if (m_marks.get(i))
             continue;
 
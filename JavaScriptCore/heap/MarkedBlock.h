@@ -72,6 +72,9 @@ namespace JSC {
         size_t atomNumber(const void*);
         bool isMarked(const void*);
         bool testAndSetMarked(const void*);
+#if ENABLE(PARALLEL_GC)
+        bool testAndSetMarkedConcurrently(const void*);
+#endif
         void setMarked(const void*);
         
         template <typename Functor> void forEach(Functor&);
@@ -204,6 +207,13 @@ namespace JSC {
         return m_marks.testAndSet(atomNumber(p));
     }
 
+#if ENABLE(PARALLEL_GC)
+    inline bool MarkedBlock::testAndSetMarkedConcurrently(const void* p)
+    {
+        return m_marks.concurrentTestAndSet(atomNumber(p));
+    }
+#endif
+
     inline void MarkedBlock::setMarked(const void* p)
     {
         m_marks.set(atomNumber(p));
@@ -79,6 +79,7 @@ void* MarkedSpace::allocateFromSizeClass(SizeClass& sizeClass)
             return result;
 
         m_waterMark += block->capacity();
+        sweepNextBlock();
     }
 
     if (m_waterMark < m_highWaterMark)
@@ -103,6 +104,18 @@ void MarkedSpace::shrink()
         }
     }
     
+    if (!empties.isEmpty() && !m_blocksToSweep.isEmpty()) {
+        // Drop the blocks we are about to free from the sweep queue. A block
+        // is empty exactly when it has no marks, so the test matches the one
+        // above.
+        size_t kept = 0;
+        for (size_t i = 0; i < m_blocksToSweep.size(); ++i) {
+            if (!m_blocksToSweep[i]->isEmpty())
+                m_blocksToSweep[kept++] = m_blocksToSweep[i];
+        }
+        m_blocksToSweep.shrink(kept);
+    }
+
     freeBlocks(empties);
     ASSERT(empties.isEmpty());
 }
@@ -116,11 +129,32 @@ void MarkedSpace::clearMarks()
 
 void MarkedSpace::sweep()
 {
+    m_blocksToSweep.clear();
+
     BlockIterator end = m_blocks.end();
     for (BlockIterator it = m_blocks.begin(); it != end; ++it)
         (*it)->sweep();
 }
 
+void MarkedSpace::scheduleSweep()
+{
+    m_blocksToSweep.clear();
+    m_blocksToSweep.reserveCapacity(m_blocks.size());
+
+    BlockIterator end = m_blocks.end();
+    for (BlockIterator it = m_blocks.begin(); it != end; ++it)
+        m_blocksToSweep.append(*it);
+}
+
+void MarkedSpace::sweepNextBlock()
+{
+    if (m_blocksToSweep.isEmpty())
+        return;
+
+    m_blocksToSweep.last()->sweep();
+    m_blocksToSweep.removeLast();
+}
+
 size_t MarkedSpace::objectCount() const
 {
     size_t result = 0;
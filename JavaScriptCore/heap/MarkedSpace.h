@@ -54,6 +54,9 @@ namespace JSC {
 
         static bool isMarked(const JSCell*);
         static bool testAndSetMarked(const JSCell*);
+#if ENABLE(PARALLEL_GC)
+        static bool testAndSetMarkedConcurrently(const JSCell*);
+#endif
         static void setMarked(const JSCell*);
 
         MarkedSpace(JSGlobalData*);
@@ -72,6 +75,12 @@ namespace JSC {
         void sweep();
         void shrink();
 
+        // Queues every block for sweeping. The queue is worked off a block at
+        // a time as allocation moves past full blocks, instead of inside the
+        // collection pause.
+        void scheduleSweep();
+        size_t blocksWaitingForSweep() const { return m_blocksToSweep.size(); }
+
         size_t size() const;
         size_t capacity() const;
         size_t objectCount() const;
@@ -109,10 +118,12 @@ namespace JSC {
         void* allocateFromSizeClass(SizeClass&);
 
         void clearMarks(MarkedBlock*);
+        void sweepNextBlock();
 
         SizeClass m_preciseSizeClasses[preciseCount];
         SizeClass m_impreciseSizeClasses[impreciseCount];
         HashSet<MarkedBlock*> m_blocks;
+        Vector<MarkedBlock*> m_blocksToSweep;
         size_t m_waterMark;
         size_t m_highWaterMark;
         JSGlobalData* m_globalData;
@@ -133,6 +144,13 @@ namespace JSC {
         return MarkedBlock::blockFor(cell)->testAndSetMarked(cell);
     }
 
+#if ENABLE(PARALLEL_GC)
+    inline bool MarkedSpace::testAndSetMarkedConcurrently(const JSCell* cell)
+    {
+        return MarkedBlock::blockFor(cell)->testAndSetMarkedConcurrently(cell);
+    }
+#endif
+
     inline void MarkedSpace::setMarked(const JSCell* cell)
     {
         MarkedBlock::blockFor(cell)->setMarked(cell);
@@ -98,6 +98,19 @@ void JIT::emitTimeoutCheck()
     stubCall.call(timeoutCheckRegister);
     stubCall.getArgument(0, regT1, regT0); // reload last result registers.
     skipTimeout.link(this);
+
+    emitSampleCheck();
+}
+
+void JIT::emitSampleCheck()
+{
+    move(TrustedImmPtr(m_globalData->samplingProfiler.addressOfSampleRequested()), regT2);
+    Jump skipSample = branchTest32(Zero, Address(regT2));
+    JITStubCall stubCall(this, cti_take_sample);
+    stubCall.addArgument(regT1, regT0); // save last result registers.
+    stubCall.call();
+    stubCall.getArgument(0, regT1, regT0); // reload last result registers.
+    skipSample.link(this);
 }
 #else
 void JIT::emitTimeoutCheck()
@@ -106,8 +119,18 @@ void JIT::emitTimeoutCheck()
     JITStubCall(this, cti_timeout_check).call(timeoutCheckRegister);
     skipTimeout.link(this);
 
+    emitSampleCheck();
+
     killLastResultRegister();
 }
+
+void JIT::emitSampleCheck()
+{
+    move(TrustedImmPtr(m_globalData->samplingProfiler.addressOfSampleRequested()), regT2);
+    Jump skipSample = branchTest32(Zero, Address(regT2));
+    JITStubCall(this, cti_take_sample).call();
+    skipSample.link(this);
+}
 #endif
 
 #define NEXT_OPCODE(name) \
@@ -485,10 +508,24 @@ JITCode JIT::privateCompile(CodePtr* functionEntryArityCheck)
 
     Label functionBody = label();
 
+    // A sample that fell due while the caller ran is taken here, so it lands
+    // in the callee rather than at the next loop back-edge.
+    move(TrustedImmPtr(m_globalData->samplingProfiler.addressOfSampleRequested()), regT2);
+    Jump sampleRequested = branchTest32(NonZero, Address(regT2));
+    Label afterSampleCheck = label();
+
     privateCompileMainPass();
     privateCompileLinkPass();
     privateCompileSlowCases();
 
+    sampleRequested.link(this);
+    m_bytecodeOffset = 0;
+    JITStubCall(this, cti_take_sample).call();
+#ifndef NDEBUG
+    m_bytecodeOffset = (unsigned)-1; // Reset this, in order to guard its use with ASSERTs.
+#endif
+    jump(afterSampleCheck);
+
     Label arityCheck;
     if (m_codeBlock->codeType() == FunctionCode) {
         registerFileCheck.link(this);
@@ -211,6 +211,14 @@ namespace JSC {
             JIT jit(globalData, codeBlock);
             jit.privateCompileGetByIdChain(stubInfo, structure, chain, count, ident, slot, cachedOffset, returnAddress, callFrame);
         }
+
+#if ENABLE(MEGAMORPHIC_CACHE)
+        static void compileGetByIdMegamorphic(JSGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, CodeLocationLabel failureTarget, const Identifier& ident, unsigned* accessCount)
+        {
+            JIT jit(globalData, codeBlock);
+            jit.privateCompileGetByIdMegamorphic(stubInfo, failureTarget, ident, accessCount);
+        }
+#endif
         
         static void compilePutByIdTransition(JSGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct)
         {
@@ -218,6 +226,14 @@ namespace JSC {
             jit.privateCompilePutByIdTransition(stubInfo, oldStructure, newStructure, cachedOffset, chain, returnAddress, direct);
         }
 
+#if ENABLE(MEGAMORPHIC_CACHE)
+        static void compilePutByIdMegamorphic(JSGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, const Identifier& ident, unsigned* accessCount, ReturnAddressPtr returnAddress)
+        {
+            JIT jit(globalData, codeBlock);
+            jit.privateCompilePutByIdMegamorphic(stubInfo, ident, accessCount, returnAddress);
+        }
+#endif
+
         static void compileCTIMachineTrampolines(JSGlobalData* globalData, RefPtr<ExecutablePool>* executablePool, TrampolineStructure *trampolines)
         {
             if (!globalData->canUseJIT())
@@ -271,6 +287,10 @@ namespace JSC {
         void privateCompileGetByIdChainList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, StructureChain* chain, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, CallFrame* callFrame);
         void privateCompileGetByIdChain(StructureStubInfo*, Structure*, StructureChain*, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, ReturnAddressPtr returnAddress, CallFrame* callFrame);
         void privateCompilePutByIdTransition(StructureStubInfo*, Structure*, Structure*, size_t cachedOffset, StructureChain*, ReturnAddressPtr returnAddress, bool direct);
+#if ENABLE(MEGAMORPHIC_CACHE)
+        void privateCompileGetByIdMegamorphic(StructureStubInfo*, CodeLocationLabel failureTarget, const Identifier&, unsigned* accessCount);
+        void privateCompilePutByIdMegamorphic(StructureStubInfo*, const Identifier&, unsigned* accessCount, ReturnAddressPtr returnAddress);
+#endif
 
         void privateCompileCTIMachineTrampolines(RefPtr<ExecutablePool>* executablePool, JSGlobalData* data, TrampolineStructure *trampolines);
         Label privateCompileCTINativeCall(JSGlobalData*, bool isConstruct = false);
@@ -296,6 +316,9 @@ namespace JSC {
         void emitLoadInt32ToDouble(unsigned index, FPRegisterID value);
 
         void testPrototype(JSValue, JumpList& failureCases);
+#if ENABLE(MEGAMORPHIC_CACHE)
+        void emitMegamorphicCacheEntry(MegamorphicCache::Entry* table, const Identifier&, RegisterID structure, RegisterID entry);
+#endif
 
 #if USE(JSVALUE32_64)
         bool getOperandConstantImmediateInt(unsigned op1, unsigned op2, unsigned& op, int32_t& constant);
@@ -936,6 +959,7 @@ namespace JSC {
         void emitLoadCharacterString(RegisterID src, RegisterID dst, JumpList& failures);
         
         void emitTimeoutCheck();
+        void emitSampleCheck();
 #ifndef NDEBUG
         void printBytecodeOperandTypes(unsigned src1, unsigned src2);
 #endif
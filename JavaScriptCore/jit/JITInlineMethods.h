@@ -88,8 +88,14 @@ ALWAYS_INLINE void JIT::emitLoadCharacterString(RegisterID src, RegisterID dst,
     failures.append(branchTest32(NonZero, Address(src, OBJECT_OFFSETOF(JSString, m_fiberCount))));
     failures.append(branch32(NotEqual, MacroAssembler::Address(src, ThunkHelpers::jsStringLengthOffset()), TrustedImm32(1)));
     loadPtr(MacroAssembler::Address(src, ThunkHelpers::jsStringValueOffset()), dst);
+    Jump is8Bit = branchTestPtr(Zero, MacroAssembler::Address(dst, ThunkHelpers::stringImplDataOffset()));
     loadPtr(MacroAssembler::Address(dst, ThunkHelpers::stringImplDataOffset()), dst);
     load16(MacroAssembler::Address(dst, 0), dst);
+    Jump loaded = jump();
+    is8Bit.link(this);
+    loadPtr(MacroAssembler::Address(dst, ThunkHelpers::stringImplData8Offset()), dst);
+    load8(MacroAssembler::Address(dst, 0), dst);
+    loaded.link(this);
 }
 
 ALWAYS_INLINE void JIT::emitGetFromCallFrameHeader32(RegisterFile::CallFrameHeaderEntry entry, RegisterID to, RegisterID from)
@@ -274,16 +274,23 @@ JIT::CodePtr JIT::stringGetByValStubGenerator(JSGlobalData* globalData, Executab
     failures.append(jit.branchPtr(NotEqual, Address(regT0), TrustedImmPtr(globalData->jsStringVPtr)));
     failures.append(jit.branchTest32(NonZero, Address(regT0, OBJECT_OFFSETOF(JSString, m_fiberCount))));
     
-    // Load string length to regT1, and start the process of loading the data pointer into regT0
+    // Load string length to regT1, and the StringImpl into regT0
     jit.load32(Address(regT0, ThunkHelpers::jsStringLengthOffset()), regT1);
     jit.loadPtr(Address(regT0, ThunkHelpers::jsStringValueOffset()), regT0);
-    jit.loadPtr(Address(regT0, ThunkHelpers::stringImplDataOffset()), regT0);
     
     // Do an unsigned compare to simultaneously filter negative indices as well as indices that are too large
     failures.append(jit.branch32(AboveOrEqual, regT2, regT1));
     
-    // Load the character
+    // Load the character, from the 8-bit data if the string has not been widened
+    Jump is8Bit = jit.branchTestPtr(Zero, Address(regT0, ThunkHelpers::stringImplDataOffset()));
+    jit.loadPtr(Address(regT0, ThunkHelpers::stringImplDataOffset()), regT0);
     jit.load16(BaseIndex(regT0, regT2, TimesTwo, 0), regT0);
+    Jump loaded = jit.jump();
+    is8Bit.link(&jit);
+    jit.loadPtr(Address(regT0, ThunkHelpers::stringImplData8Offset()), regT0);
+    jit.addPtr(regT2, regT0);
+    jit.load8(Address(regT0), regT0);
+    loaded.link(&jit);
     
     failures.append(jit.branch32(AboveOrEqual, regT0, TrustedImm32(0x100)));
     jit.move(TrustedImmPtr(globalData->smallStrings.singleCharacterStrings()), regT1);
@@ -370,6 +377,9 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     
     Label storeResult(this);
     emitLoad(value, regT1, regT0);
+    Jump notCell = branch32(NotEqual, regT1, TrustedImm32(JSValue::CellTag));
+    store32(TrustedImm32(1), Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_mayHaveCells)));
+    notCell.link(this);
     store32(regT0, BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0]) + OBJECT_OFFSETOF(JSValue, u.asBits.payload))); // payload
     store32(regT1, BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0]) + OBJECT_OFFSETOF(JSValue, u.asBits.tag))); // tag
     Jump end = jump();
@@ -639,6 +649,53 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     repatchBuffer.relinkCallerToTrampoline(returnAddress, entryLabel);
 }
 
+#if ENABLE(MEGAMORPHIC_CACHE)
+void JIT::privateCompilePutByIdMegamorphic(StructureStubInfo* stubInfo, const Identifier& ident, unsigned* accessCount, ReturnAddressPtr returnAddress)
+{
+    MegamorphicCache& cache = m_globalData->megamorphicCache;
+    JumpList failureCases;
+
+    add32(TrustedImm32(1), AbsoluteAddress(accessCount));
+
+    // It is assumed that regT0 contains the basePayload and regT1 contains the baseTag.  The value can be found on the stack.
+    failureCases.append(branch32(NotEqual, regT1, TrustedImm32(JSValue::CellTag)));
+    loadPtr(Address(regT0, JSCell::structureOffset()), regT2);
+    emitMegamorphicCacheEntry(cache.m_putTable.data(), ident, regT2, regT3);
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, structure)), regT2));
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, propertyName)), TrustedImmPtr(ident.impl())));
+
+    loadPtr(Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT3);
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(JSObject, m_propertyStorage)), regT0);
+#if CPU(MIPS) || CPU(SH4)
+    // For MIPS, we don't add sizeof(void*) to the stack offset.
+    load32(Address(stackPointerRegister, OBJECT_OFFSETOF(JITStackFrame, args[2]) + OBJECT_OFFSETOF(JSValue, u.asBits.payload)), regT2);
+    store32(regT2, BaseIndex(regT0, regT3, TimesEight, OBJECT_OFFSETOF(JSValue, u.asBits.payload)));
+    load32(Address(stackPointerRegister, OBJECT_OFFSETOF(JITStackFrame, args[2]) + OBJECT_OFFSETOF(JSValue, u.asBits.tag)), regT2);
+    store32(regT2, BaseIndex(regT0, regT3, TimesEight, OBJECT_OFFSETOF(JSValue, u.asBits.tag)));
+#else
+    load32(Address(stackPointerRegister, OBJECT_OFFSETOF(JITStackFrame, args[2]) + sizeof(void*) + OBJECT_OFFSETOF(JSValue, u.asBits.payload)), regT2);
+    store32(regT2, BaseIndex(regT0, regT3, TimesEight, OBJECT_OFFSETOF(JSValue, u.asBits.payload)));
+    load32(Address(stackPointerRegister, OBJECT_OFFSETOF(JITStackFrame, args[2]) + sizeof(void*) + OBJECT_OFFSETOF(JSValue, u.asBits.tag)), regT2);
+    store32(regT2, BaseIndex(regT0, regT3, TimesEight, OBJECT_OFFSETOF(JSValue, u.asBits.tag)));
+#endif
+
+    ret();
+
+    failureCases.link(this);
+    restoreArgumentReferenceForTrampoline();
+    Call failureCall = tailRecursiveCall();
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
+
+    patchBuffer.link(failureCall, FunctionPtr(cti_op_put_by_id_megamorphic));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+    stubInfo->stubRoutine = entryLabel;
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relinkCallerToTrampoline(returnAddress, entryLabel);
+}
+#endif
+
 void JIT::patchGetByIdSelf(CodeBlock* codeBlock, StructureStubInfo* stubInfo, Structure* structure, size_t cachedOffset, ReturnAddressPtr returnAddress)
 {
     RepatchBuffer repatchBuffer(codeBlock);
@@ -676,9 +733,13 @@ void JIT::patchPutByIdReplace(CodeBlock* codeBlock, StructureStubInfo* stubInfo,
 {
     RepatchBuffer repatchBuffer(codeBlock);
     
-    // We don't want to patch more than once - in future go to cti_op_put_by_id_generic.
+    // We don't want to patch more than once - in future go to cti_op_put_by_id_megamorphic.
     // Should probably go to cti_op_put_by_id_fail, but that doesn't do anything interesting right now.
+#if ENABLE(MEGAMORPHIC_CACHE)
+    repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(direct ? cti_op_put_by_id_direct_generic : cti_op_put_by_id_megamorphic));
+#else
     repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(direct ? cti_op_put_by_id_direct_generic : cti_op_put_by_id_generic));
+#endif
     
     int offset = sizeof(JSValue) * cachedOffset;
 
@@ -1047,6 +1108,58 @@ void JIT::privateCompileGetByIdChain(StructureStubInfo* stubInfo, Structure* str
     repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(cti_op_get_by_id_proto_list));
 }
 
+#if ENABLE(MEGAMORPHIC_CACHE)
+void JIT::privateCompileGetByIdMegamorphic(StructureStubInfo* stubInfo, CodeLocationLabel failureTarget, const Identifier& ident, unsigned* accessCount)
+{
+    MegamorphicCache& cache = m_globalData->megamorphicCache;
+    JumpList failureCases;
+
+    add32(TrustedImm32(1), AbsoluteAddress(accessCount));
+
+    // regT0 holds a JSCell* and regT1 its tag. The list and the slow case
+    // after it expect both, so neither is touched before a hit.
+    loadPtr(Address(regT0, JSCell::structureOffset()), regT2);
+    emitMegamorphicCacheEntry(cache.m_getTable.data(), ident, regT2, regT3);
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, structure)), regT2));
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, propertyName)), TrustedImmPtr(ident.impl())));
+    Jump isPrototypeProperty = branchTestPtr(NonZero, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, prototypeStructure)));
+
+    loadPtr(Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT3);
+    move(regT0, regT2);
+    compileGetDirectOffset(regT2, regT1, regT0, regT3);
+    Jump success = jump();
+
+    // A non-dictionary Structure always has the same prototype, but the
+    // prototype's own Structure still has to be checked. With only regT2 to
+    // spare, the prototype is loaded again once the check has passed.
+    isPrototypeProperty.link(this);
+    load32(Address(regT2, Structure::prototypeOffset() + OBJECT_OFFSETOF(JSValue, u.asBits.payload)), regT2);
+    loadPtr(Address(regT2, JSCell::structureOffset()), regT2);
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, prototypeStructure)), regT2));
+    loadPtr(Address(regT0, JSCell::structureOffset()), regT2);
+    load32(Address(regT2, Structure::prototypeOffset() + OBJECT_OFFSETOF(JSValue, u.asBits.payload)), regT2);
+    loadPtr(Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT3);
+    compileGetDirectOffset(regT2, regT1, regT0, regT3);
+    Jump prototypeSuccess = jump();
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
+
+    // Misses go on to the polymorphic list, and from there to the slow case.
+    patchBuffer.link(failureCases, failureTarget);
+
+    // On success return back to the hot patch code, at a point it will perform the store to dest for us.
+    patchBuffer.link(success, stubInfo->hotPathBegin.labelAtOffset(patchOffsetGetByIdPutResult));
+    patchBuffer.link(prototypeSuccess, stubInfo->hotPathBegin.labelAtOffset(patchOffsetGetByIdPutResult));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+
+    // Finally patch the jump to the list back in the hot path to jump here instead.
+    CodeLocationJump jumpLocation = stubInfo->hotPathBegin.jumpAtOffset(patchOffsetGetByIdBranchToSlowCase);
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relink(jumpLocation, entryLabel);
+}
+#endif // ENABLE(MEGAMORPHIC_CACHE)
+
 /* ------------------------------ END: !ENABLE / ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS) ------------------------------ */
 
 #endif // !ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
@@ -1357,6 +1357,13 @@ DEFINE_STUB_FUNCTION(int, timeout_check)
     return timeoutChecker.ticksUntilNextCheck();
 }
 
+DEFINE_STUB_FUNCTION(void, take_sample)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    stackFrame.globalData->samplingProfiler.takeSample(stackFrame.callFrame, ReturnAddressPtr(STUB_RETURN_ADDRESS));
+}
+
 DEFINE_STUB_FUNCTION(void*, register_file_check)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1480,6 +1487,47 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_fail)
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
+#if ENABLE(MEGAMORPHIC_CACHE)
+static MegamorphicCache::Site& addMegamorphicSite(CallFrame* callFrame, StructureStubInfo* stubInfo, ReturnAddressPtr returnAddress, const Identifier& propertyName, bool isPut)
+{
+    ASSERT(!stubInfo->megamorphicSite);
+    CodeBlock* codeBlock = callFrame->codeBlock();
+    MegamorphicCache& cache = callFrame->globalData().megamorphicCache;
+    int lineNumber = codeBlock->lineNumberForBytecodeOffset(codeBlock->bytecodeOffset(returnAddress));
+    stubInfo->megamorphicSite = cache.addSite(codeBlock->ownerExecutable()->sourceURL(), lineNumber, propertyName.ustring(), isPut);
+    return cache.site(stubInfo->megamorphicSite);
+}
+
+DEFINE_STUB_FUNCTION(void, op_put_by_id_megamorphic)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    CallFrame* callFrame = stackFrame.callFrame;
+    Identifier& ident = stackFrame.args[1].identifier();
+    JSValue baseValue = stackFrame.args[0].jsValue();
+    JSValue value = stackFrame.args[2].jsValue();
+    JSGlobalData& globalData = callFrame->globalData();
+
+    // The first call compiles a trampoline that probes the cache and counts
+    // accesses itself, and only calls here on a miss.
+    CodeBlock* codeBlock = callFrame->codeBlock();
+    StructureStubInfo* stubInfo = &codeBlock->getStubInfo(STUB_RETURN_ADDRESS);
+    if (!stubInfo->megamorphicSite) {
+        MegamorphicCache::Site& site = addMegamorphicSite(callFrame, stubInfo, STUB_RETURN_ADDRESS, ident, true);
+        ++site.accesses;
+        JIT::compilePutByIdMegamorphic(callFrame->scopeChain()->globalData, codeBlock, stubInfo, ident, &site.accesses, STUB_RETURN_ADDRESS);
+    }
+    ++globalData.megamorphicCache.site(stubInfo->megamorphicSite).misses;
+
+    PutPropertySlot slot(codeBlock->isStrictMode());
+    baseValue.put(callFrame, ident, value, slot);
+    CHECK_FOR_EXCEPTION_VOID();
+
+    if (baseValue.isCell())
+        globalData.megamorphicCache.addPut(globalData, baseValue.asCell(), ident.impl(), slot);
+}
+#endif
+
 DEFINE_STUB_FUNCTION(void, op_put_by_id_direct_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1602,6 +1650,17 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id)
     return JSValue::encode(result);
 }
 
+#if ENABLE(MEGAMORPHIC_CACHE)
+// Puts a JIT probe of the MegamorphicCache in front of a full polymorphic
+// list, and sends whatever misses both to cti_op_get_by_id_megamorphic.
+static void makeGetByIdMegamorphic(CallFrame* callFrame, CodeBlock* codeBlock, StructureStubInfo* stubInfo, CodeLocationLabel listHead, const Identifier& propertyName, ReturnAddressPtr returnAddress)
+{
+    MegamorphicCache::Site& site = addMegamorphicSite(callFrame, stubInfo, returnAddress, propertyName, false);
+    JIT::compileGetByIdMegamorphic(callFrame->scopeChain()->globalData, codeBlock, stubInfo, listHead, propertyName, &site.accesses);
+    ctiPatchCallByReturnAddress(codeBlock, returnAddress, FunctionPtr(cti_op_get_by_id_megamorphic));
+}
+#endif
+
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_self_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1641,7 +1700,11 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_self_fail)
             JIT::compileGetByIdSelfList(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList, listIndex, baseValue.asCell()->structure(), ident, slot, slot.cachedOffset());
 
             if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
+#if ENABLE(MEGAMORPHIC_CACHE)
+                makeGetByIdMegamorphic(callFrame, codeBlock, stubInfo, polymorphicStructureList->list[listIndex].stubRoutine, ident, STUB_RETURN_ADDRESS);
+#else
                 ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
+#endif
         }
     } else
         ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
@@ -1753,7 +1816,11 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
             JIT::compileGetByIdProtoList(callFrame->scopeChain()->globalData, callFrame, codeBlock, stubInfo, prototypeStructureList, listIndex, structure, slotBaseObject->structure(), propertyName, slot, offset);
 
             if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
+#if ENABLE(MEGAMORPHIC_CACHE)
+                makeGetByIdMegamorphic(callFrame, codeBlock, stubInfo, prototypeStructureList->list[listIndex].stubRoutine, propertyName, STUB_RETURN_ADDRESS);
+#else
                 ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_list_full));
+#endif
         }
     } else if (size_t count = normalizePrototypeChain(callFrame, baseValue, slot.slotBase(), propertyName, offset)) {
         ASSERT(!baseValue.asCell()->structure()->isDictionary());
@@ -1765,7 +1832,11 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
             JIT::compileGetByIdChainList(callFrame->scopeChain()->globalData, callFrame, codeBlock, stubInfo, prototypeStructureList, listIndex, structure, protoChain, count, propertyName, slot, offset);
 
             if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
+#if ENABLE(MEGAMORPHIC_CACHE)
+                makeGetByIdMegamorphic(callFrame, codeBlock, stubInfo, prototypeStructureList->list[listIndex].stubRoutine, propertyName, STUB_RETURN_ADDRESS);
+#else
                 ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_list_full));
+#endif
         }
     } else
         ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_fail));
@@ -1773,6 +1844,31 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
     return JSValue::encode(result);
 }
 
+#if ENABLE(MEGAMORPHIC_CACHE)
+DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_megamorphic)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    CallFrame* callFrame = stackFrame.callFrame;
+    Identifier& ident = stackFrame.args[1].identifier();
+    JSValue baseValue = stackFrame.args[0].jsValue();
+    MegamorphicCache& cache = callFrame->globalData().megamorphicCache;
+
+    // The JIT probe in front of the polymorphic list has already counted the
+    // access and missed the cache.
+    StructureStubInfo& stubInfo = callFrame->codeBlock()->getStubInfo(STUB_RETURN_ADDRESS);
+    ASSERT(stubInfo.megamorphicSite);
+    ++cache.site(stubInfo.megamorphicSite).misses;
+
+    PropertySlot slot(baseValue);
+    JSValue result = baseValue.get(callFrame, ident, slot);
+    CHECK_FOR_EXCEPTION();
+
+    if (baseValue.isCell())
+        cache.addGet(baseValue.asCell(), ident.impl(), slot);
+    return JSValue::encode(result);
+}
+#else
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list_full)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1784,6 +1880,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list_full)
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
 }
+#endif
 
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_fail)
 {
@@ -0,0 +1,139 @@
+#include "config.h"
+#include "MegamorphicCache.h"
+
+#if ENABLE(MEGAMORPHIC_CACHE)
+
+#include "JSObject.h"
+#include "PropertySlot.h"
+#include "PutPropertySlot.h"
+#include "Structure.h"
+#include "UStringBuilder.h"
+#include "UStringConcatenate.h"
+#include <algorithm>
+#include <string.h>
+
+namespace JSC {
+
+MegamorphicCache::MegamorphicCache()
+    : m_otherSites(0)
+{
+    clear();
+}
+
+void MegamorphicCache::addGet(JSCell* base, StringImpl* propertyName, const PropertySlot& slot)
+{
+    if (!slot.isCacheableValue())
+        return;
+    Structure* structure = base->structure();
+    if (structure->isDictionary())
+        return;
+
+    Structure* prototypeStructure = 0;
+    if (slot.slotBase() != base) {
+        if (slot.slotBase() != structure->storedPrototype())
+            return;
+        prototypeStructure = asObject(slot.slotBase())->structure();
+        if (prototypeStructure->isDictionary())
+            return;
+    }
+
+    Entry& entry = entryFor(m_getTable, structure, propertyName);
+    entry.structure = structure;
+    entry.propertyName = propertyName;
+    entry.prototypeStructure = prototypeStructure;
+    entry.offset = slot.cachedOffset();
+}
+
+void MegamorphicCache::addPut(JSGlobalData& globalData, JSCell* base, StringImpl* propertyName, const PutPropertySlot& slot)
+{
+    if (!slot.isCacheable() || slot.type() != PutPropertySlot::ExistingProperty || slot.base() != base)
+        return;
+    Structure* structure = base->structure();
+    if (structure->isDictionary())
+        return;
+
+    // Storing over a specific function value has to change the Structure,
+    // so only plain writable properties can be stored to directly.
+    unsigned attributes;
+    JSCell* specificValue;
+    if (structure->get(globalData, propertyName, attributes, specificValue) != slot.cachedOffset())
+        return;
+    if (specificValue || (attributes & (ReadOnly | Getter | Setter)))
+        return;
+
+    Entry& entry = entryFor(m_putTable, structure, propertyName);
+    entry.structure = structure;
+    entry.propertyName = propertyName;
+    entry.prototypeStructure = 0;
+    entry.offset = slot.cachedOffset();
+}
+
+void MegamorphicCache::clear()
+{
+    memset(m_getTable.data(), 0, sizeof(Table));
+    memset(m_putTable.data(), 0, sizeof(Table));
+}
+
+static UString siteKey(const UString& sourceURL, int lineNumber, const UString& propertyName, bool isPut)
+{
+    return makeUString(sourceURL, ":", UString::number(lineNumber), isPut ? " put " : " get ", propertyName);
+}
+
+unsigned MegamorphicCache::addSite(const UString& sourceURL, int lineNumber, const UString& propertyName, bool isPut)
+{
+    UString key = siteKey(sourceURL, lineNumber, propertyName, isPut);
+    HashMap<RefPtr<StringImpl>, unsigned>::iterator it = m_siteNumbers.find(key.impl());
+    if (it != m_siteNumbers.end())
+        return it->second;
+
+    if (m_siteNumbers.size() >= maxSites) {
+        if (!m_otherSites) {
+            m_sites.append(Site(UString(), 0, "(other sites)", false));
+            m_otherSites = m_sites.size();
+        }
+        return m_otherSites;
+    }
+
+    m_sites.append(Site(sourceURL, lineNumber, propertyName, isPut));
+    m_siteNumbers.set(key.impl(), m_sites.size());
+    return m_sites.size();
+}
+
+void MegamorphicCache::resetSiteCounts()
+{
+    for (size_t i = 0; i < m_sites.size(); ++i) {
+        m_sites[i].accesses = 0;
+        m_sites[i].misses = 0;
+    }
+}
+
+static bool siteIsBusier(const MegamorphicCache::Site* a, const MegamorphicCache::Site* b)
+{
+    return a->accesses > b->accesses;
+}
+
+UString MegamorphicCache::siteStatistics()
+{
+    Vector<const Site*> sites;
+    sites.reserveCapacity(m_sites.size());
+    for (size_t i = 0; i < m_sites.size(); ++i)
+        sites.append(&m_sites[i]);
+    std::stable_sort(sites.begin(), sites.end(), siteIsBusier);
+
+    const Site* otherSites = m_otherSites ? &site(m_otherSites) : 0;
+    UStringBuilder builder;
+    for (size_t i = 0; i < sites.size(); ++i) {
+        const Site& site = *sites[i];
+        builder.append(&site == otherSites ? site.propertyName : siteKey(site.sourceURL, site.lineNumber, site.propertyName, site.isPut));
+        builder.append(' ');
+        builder.append(UString::number(site.accesses));
+        builder.append(' ');
+        builder.append(UString::number(site.misses));
+        builder.append('\n');
+    }
+    return builder.toUString();
+}
+
+} // namespace JSC
+
+#endif // ENABLE(MEGAMORPHIC_CACHE)
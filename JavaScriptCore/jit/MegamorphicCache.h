@@ -0,0 +1,125 @@
+#ifndef MegamorphicCache_h
+#define MegamorphicCache_h
+
+#if ENABLE(MEGAMORPHIC_CACHE)
+
+#include "UString.h"
+#include <wtf/FixedArray.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/SegmentedVector.h>
+#include <wtf/text/StringHash.h>
+
+namespace JSC {
+
+    class JSCell;
+    class JSGlobalData;
+    class PropertySlot;
+    class PutPropertySlot;
+    class Structure;
+
+    // Property offsets for the get_by_id and put_by_id sites whose inline
+    // caches have given up.
+    //
+    // A site that sees more Structures than its polymorphic list holds used to
+    // do a full property lookup on every access. Such sites are usually the
+    // shared accessors and methods of a framework, which meet many Structures
+    // but only a few names, so a direct-mapped table keyed by
+    // (Structure, name) and shared by every site catches most of their
+    // accesses. Gets are entered for data properties of the object itself or
+    // of its direct prototype, which is checked by Structure on every hit the
+    // way get_by_id_proto does; puts only for writable data properties of the
+    // object itself that do not hold a specific function value. Dictionary
+    // Structures change in place, so they are never entered.
+    //
+    // Entries hold raw Structure pointers, so the heap clears the tables on
+    // every collection, before a dead Structure's memory can be reused.
+    //
+    // Only JIT code reads the tables, from a stub ahead of a full get_by_id
+    // list and from a put_by_id trampoline; misses call the stubs, which do a
+    // full lookup and enter its result here.
+    class MegamorphicCache {
+        WTF_MAKE_NONCOPYABLE(MegamorphicCache);
+        friend class JIT;
+    public:
+        // One per megamorphic site, in the order the sites were first used.
+        // Sites of code that has since been recompiled share the entry of the
+        // same source line and name. Sites never move, as JIT code counts
+        // accesses in place, so once maxSites are recorded every later site
+        // shares a single "(other sites)" entry.
+        struct Site {
+            Site(const UString& sourceURL, int lineNumber, const UString& propertyName, bool isPut)
+                : sourceURL(sourceURL)
+                , lineNumber(lineNumber)
+                , propertyName(propertyName)
+                , isPut(isPut)
+                , accesses(0)
+                , misses(0)
+            {
+            }
+
+            UString sourceURL;
+            int lineNumber;
+            UString propertyName;
+            bool isPut;
+            unsigned accesses;
+            unsigned misses; // Accesses that fell through to a full lookup.
+        };
+
+        MegamorphicCache();
+
+        // Enter the result of a full lookup, if it can be reused.
+        void addGet(JSCell* base, StringImpl* propertyName, const PropertySlot&);
+        void addPut(JSGlobalData&, JSCell* base, StringImpl* propertyName, const PutPropertySlot&);
+
+        void clear();
+
+        // Returns the site's number, which is never 0.
+        unsigned addSite(const UString& sourceURL, int lineNumber, const UString& propertyName, bool isPut);
+        Site& site(unsigned number) { return m_sites[number - 1]; }
+
+        void resetSiteCounts();
+
+        // One "url:line get|put name accesses misses" line per site, busiest
+        // first.
+        UString siteStatistics();
+
+    private:
+        static const size_t maxSites = 1000;
+
+        static const unsigned log2TableSize = 11;
+        static const size_t tableSize = 1 << log2TableSize;
+        static const unsigned hashMultiplier = 0x9E3779B9U; // 2^32 divided by the golden ratio.
+
+        struct Entry {
+            Structure* structure;
+            StringImpl* propertyName;
+            Structure* prototypeStructure; // 0 for the object's own properties.
+            size_t offset;
+        };
+        typedef FixedArray<Entry, tableSize> Table;
+
+        static Entry& entryFor(Table& table, Structure* structure, StringImpl* propertyName)
+        {
+            // Structures are cell aligned, so their low bits carry nothing.
+            // Structures made one after another lie at regular distances, and
+            // names can agree in their low bits, so the multiply mixes every
+            // bit into the top ones the index is taken from.
+            // JIT::emitMegamorphicCacheEntry() computes the same hash from
+            // the pointer's low word.
+            unsigned hash = (static_cast<unsigned>(reinterpret_cast<uintptr_t>(structure)) >> 5) ^ propertyName->existingHash();
+            return table[(hash * hashMultiplier) >> (32 - log2TableSize)];
+        }
+
+        Table m_getTable;
+        Table m_putTable;
+        SegmentedVector<Site, 16> m_sites;
+        HashMap<RefPtr<StringImpl>, unsigned> m_siteNumbers; // Keyed by siteKey().
+        unsigned m_otherSites;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(MEGAMORPHIC_CACHE)
+
+#endif // MegamorphicCache_h
@@ -40,10 +40,9 @@ static void stringCharLoad(SpecializedThunkJIT& jit)
     jit.loadJSStringArgument(SpecializedThunkJIT::ThisArgument, SpecializedThunkJIT::regT0);
     // regT0 now contains this, and is a non-rope JSString*
 
-    // Load string length to regT2, and start the process of loading the data pointer into regT0
+    // Load string length to regT2, and the StringImpl into regT0
     jit.load32(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::jsStringLengthOffset()), SpecializedThunkJIT::regT2);
     jit.loadPtr(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::jsStringValueOffset()), SpecializedThunkJIT::regT0);
-    jit.loadPtr(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::stringImplDataOffset()), SpecializedThunkJIT::regT0);
 
     // load index
     jit.loadInt32Argument(0, SpecializedThunkJIT::regT1); // regT1 contains the index
@@ -51,8 +50,16 @@ static void stringCharLoad(SpecializedThunkJIT& jit)
     // Do an unsigned compare to simultaneously filter negative indices as well as indices that are too large
     jit.appendFailure(jit.branch32(MacroAssembler::AboveOrEqual, SpecializedThunkJIT::regT1, SpecializedThunkJIT::regT2));
 
-    // Load the character
+    // Load the character, from the 8-bit data if the string has not been widened
+    MacroAssembler::Jump is8Bit = jit.branchTestPtr(MacroAssembler::Zero, MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::stringImplDataOffset()));
+    jit.loadPtr(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::stringImplDataOffset()), SpecializedThunkJIT::regT0);
     jit.load16(MacroAssembler::BaseIndex(SpecializedThunkJIT::regT0, SpecializedThunkJIT::regT1, MacroAssembler::TimesTwo, 0), SpecializedThunkJIT::regT0);
+    MacroAssembler::Jump loaded = jit.jump();
+    is8Bit.link(&jit);
+    jit.loadPtr(MacroAssembler::Address(SpecializedThunkJIT::regT0, ThunkHelpers::stringImplData8Offset()), SpecializedThunkJIT::regT0);
+    jit.addPtr(SpecializedThunkJIT::regT1, SpecializedThunkJIT::regT0);
+    jit.load8(MacroAssembler::Address(SpecializedThunkJIT::regT0), SpecializedThunkJIT::regT0);
+    loaded.link(&jit);
 }
 
 static void charToString(SpecializedThunkJIT& jit, JSGlobalData* globalData, MacroAssembler::RegisterID src, MacroAssembler::RegisterID dst, MacroAssembler::RegisterID scratch)
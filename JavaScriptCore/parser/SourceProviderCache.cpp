@@ -26,10 +26,72 @@
 #include "config.h"
 #include "SourceProviderCache.h"
 
+#include "Identifier.h"
 #include "SourceProviderCacheItem.h"
+#include <algorithm>
 
 namespace JSC {
 
+static const uint32_t encodedCacheMagic = 0x4350534a; // "JSPC"
+static const uint32_t encodedCacheVersion = 1;
+
+static void appendUInt32(Vector<char>& out, uint32_t value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendIdentifiers(Vector<char>& out, const Vector<RefPtr<StringImpl> >& identifiers)
+{
+    appendUInt32(out, identifiers.size());
+    for (size_t i = 0; i < identifiers.size(); ++i) {
+        StringImpl* identifier = identifiers[i].get();
+        appendUInt32(out, identifier->length());
+        out.append(reinterpret_cast<const char*>(identifier->characters()), identifier->length() * sizeof(UChar));
+    }
+}
+
+class EncodedCacheReader {
+public:
+    EncodedCacheReader(const char* data, size_t length)
+        : m_position(data)
+        , m_end(data + length)
+    {
+    }
+
+    bool atEnd() const { return m_position == m_end; }
+
+    bool read(uint32_t& value)
+    {
+        if (static_cast<size_t>(m_end - m_position) < sizeof(value))
+            return false;
+        memcpy(&value, m_position, sizeof(value));
+        m_position += sizeof(value);
+        return true;
+    }
+
+    bool readIdentifiers(JSGlobalData* globalData, Vector<RefPtr<StringImpl> >& identifiers)
+    {
+        uint32_t count;
+        if (!read(count) || count > static_cast<size_t>(m_end - m_position) / sizeof(uint32_t))
+            return false;
+        identifiers.reserveInitialCapacity(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t length;
+            if (!read(length) || length > static_cast<size_t>(m_end - m_position) / sizeof(UChar))
+                return false;
+            Vector<UChar, 64> characters(length);
+            memcpy(characters.data(), m_position, length * sizeof(UChar));
+            m_position += length * sizeof(UChar);
+            identifiers.uncheckedAppend(Identifier(globalData, characters.data(), length).impl());
+        }
+        return true;
+    }
+
+private:
+    const char* m_position;
+    const char* m_end;
+};
+
 SourceProviderCache::~SourceProviderCache()
 {
     clear();
@@ -53,4 +115,90 @@ void SourceProviderCache::add(int sourcePosition, PassOwnPtr<SourceProviderCache
     m_contentByteSize += size;
 }
 
+void SourceProviderCache::encode(Vector<char>& out) const
+{
+    appendUInt32(out, encodedCacheMagic);
+    appendUInt32(out, encodedCacheVersion);
+    appendUInt32(out, m_map.size());
+
+    HashMap<int, SourceProviderCacheItem*>::const_iterator end = m_map.end();
+    for (HashMap<int, SourceProviderCacheItem*>::const_iterator it = m_map.begin(); it != end; ++it) {
+        const SourceProviderCacheItem* item = it->second;
+        appendUInt32(out, it->first);
+        appendUInt32(out, item->closeBraceLine);
+        appendUInt32(out, item->closeBracePos);
+        appendUInt32(out, item->usesEval);
+        appendIdentifiers(out, item->usedVariables);
+        appendIdentifiers(out, item->writtenVariables);
+    }
+}
+
+// Offsets at which each line of source starts, counting line terminators the
+// way the Lexer does.
+static void computeLineStarts(const UChar* source, unsigned sourceLength, Vector<unsigned>& lineStarts)
+{
+    lineStarts.append(0);
+    for (unsigned i = 0; i < sourceLength; ++i) {
+        UChar c = source[i];
+        if (c == '\r' && i + 1 < sourceLength && source[i + 1] == '\n')
+            ++i;
+        if (c == '\r' || c == '\n' || c == 0x2028 || c == 0x2029)
+            lineStarts.append(i + 1);
+    }
+}
+
+// The parser skips from the '{' at sourcePosition to just past the '}' at
+// closeBracePos and carries on counting lines from closeBraceLine.
+static bool isValidFunctionBody(uint32_t sourcePosition, uint32_t closeBracePos, uint32_t closeBraceLine, const UChar* source, unsigned sourceLength, const Vector<unsigned>& lineStarts)
+{
+    if (closeBracePos >= sourceLength || sourcePosition >= closeBracePos)
+        return false;
+    if (source[sourcePosition] != '{' || source[closeBracePos] != '}')
+        return false;
+    size_t line = std::upper_bound(lineStarts.begin(), lineStarts.end(), closeBracePos) - lineStarts.begin();
+    return closeBraceLine == line;
+}
+
+bool SourceProviderCache::decode(JSGlobalData* globalData, const char* data, size_t length, const UChar* source, unsigned sourceLength)
+{
+    EncodedCacheReader reader(data, length);
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    if (!reader.read(magic) || magic != encodedCacheMagic || !reader.read(version) || version != encodedCacheVersion || !reader.read(count))
+        return false;
+
+    Vector<unsigned> lineStarts;
+    if (count)
+        computeLineStarts(source, sourceLength, lineStarts);
+
+    Vector<std::pair<int, SourceProviderCacheItem*> > items;
+    bool valid = true;
+    for (uint32_t i = 0; valid && i < count; ++i) {
+        uint32_t sourcePosition;
+        uint32_t closeBraceLine;
+        uint32_t closeBracePos;
+        uint32_t usesEval;
+        if (!reader.read(sourcePosition) || !reader.read(closeBraceLine) || !reader.read(closeBracePos) || !reader.read(usesEval)
+            || !isValidFunctionBody(sourcePosition, closeBracePos, closeBraceLine, source, sourceLength, lineStarts)) {
+            valid = false;
+            break;
+        }
+
+        SourceProviderCacheItem* item = new SourceProviderCacheItem(closeBraceLine, closeBracePos);
+        item->usesEval = usesEval;
+        items.append(std::make_pair(static_cast<int>(sourcePosition), item));
+        valid = reader.readIdentifiers(globalData, item->usedVariables) && reader.readIdentifiers(globalData, item->writtenVariables);
+    }
+    valid = valid && reader.atEnd();
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (valid && !m_map.contains(items[i].first))
+            add(items[i].first, adoptPtr(items[i].second), items[i].second->approximateByteSize());
+        else
+            delete items[i].second;
+    }
+    return valid;
+}
+
 }
@@ -25,9 +25,12 @@
 
 #include <wtf/HashMap.h>
 #include <wtf/PassOwnPtr.h>
+#include <wtf/Vector.h>
+#include <wtf/unicode/Unicode.h>
 
 namespace JSC {
 
+class JSGlobalData;
 class SourceProviderCacheItem;
 
 class SourceProviderCache {
@@ -39,6 +42,16 @@ public:
     unsigned byteSize() const;
     void add(int sourcePosition, PassOwnPtr<SourceProviderCacheItem>, unsigned size);
     const SourceProviderCacheItem* get(int sourcePosition) const { return m_map.get(sourcePosition); }
+    bool isEmpty() const { return m_map.isEmpty(); }
+
+    // A flat form of the cache, so an embedder can keep it across runs. It is
+    // only meaningful for the exact source text it was built from, which must
+    // start on line 1. decode() interns the variable names in globalData's
+    // identifier table. It returns false, adding nothing, if the data is not
+    // a cache this version wrote or if any entry does not describe a function
+    // body of source: the parser jumps straight to the positions it reads.
+    void encode(Vector<char>&) const;
+    bool decode(JSGlobalData*, const char* data, size_t length, const UChar* source, unsigned sourceLength);
 
 private:
     HashMap<int, SourceProviderCacheItem*> m_map;
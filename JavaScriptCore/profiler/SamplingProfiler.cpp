@@ -0,0 +1,241 @@
+#include "config.h"
+#include "SamplingProfiler.h"
+
+#include "CallFrame.h"
+#include "CodeBlock.h"
+#include "Executable.h"
+#include "Profiler.h"
+#include "UStringBuilder.h"
+#include "UStringConcatenate.h"
+
+#include <algorithm>
+
+#if OS(WINDOWS)
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace JSC {
+
+// Deeper stacks keep their innermost frames under a single "(truncated)" root,
+// so a runaway recursion cannot make one sample arbitrarily expensive.
+static const size_t maximumStackDepth = 256;
+
+SamplingProfiler::Node* SamplingProfiler::Node::child(const CallIdentifier& callIdentifier)
+{
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[i]->callIdentifier == callIdentifier)
+            return children[i];
+    }
+    children.append(new Node(callIdentifier));
+    return children.last();
+}
+
+SamplingProfiler::SamplingProfiler()
+    : m_root(CallIdentifier())
+    , m_sampleRequested(0)
+    , m_shouldStop(false)
+    , m_intervalInMilliseconds(1)
+    , m_timerThread(0)
+{
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stop();
+}
+
+void SamplingProfiler::start(unsigned intervalInMilliseconds)
+{
+    if (m_timerThread)
+        return;
+
+    m_intervalInMilliseconds = std::max(intervalInMilliseconds, 1u);
+    m_shouldStop = false;
+    m_timerThread = createTimerThread();
+}
+
+void SamplingProfiler::stop()
+{
+    if (!m_timerThread)
+        return;
+
+    m_shouldStop = true;
+    joinTimerThread(m_timerThread);
+    m_timerThread = 0;
+    m_sampleRequested = 0;
+}
+
+void SamplingProfiler::clear()
+{
+    deleteAllValues(m_root.children);
+    m_root.children.clear();
+    m_root.selfSamples = 0;
+    m_root.totalSamples = 0;
+}
+
+void SamplingProfiler::runTimer()
+{
+    while (!m_shouldStop) {
+        sleepForInterval();
+        m_sampleRequested = 1;
+    }
+}
+
+static CallIdentifier callIdentifierForFrame(CallFrame* frame, ReturnAddressPtr returnAddress)
+{
+    CodeBlock* codeBlock = frame->codeBlock();
+    if (!codeBlock)
+        return Profiler::createCallIdentifier(frame, frame->callee(), "", 0);
+
+    ScriptExecutable* executable = codeBlock->ownerExecutable();
+    int lineNumber = executable->lineNo();
+    if (returnAddress.value())
+        lineNumber = codeBlock->lineNumberForBytecodeOffset(codeBlock->bytecodeOffset(returnAddress));
+
+    CallIdentifier callIdentifier = Profiler::createCallIdentifier(frame, frame->callee(), executable->sourceURL(), lineNumber);
+    callIdentifier.m_lineNumber = lineNumber;
+    return callIdentifier;
+}
+
+void SamplingProfiler::takeSample(ExecState* callFrame, ReturnAddressPtr returnAddress)
+{
+    m_sampleRequested = 0;
+    if (!m_timerThread)
+        return;
+
+    // Walk out from the innermost frame. A frame's line comes from the address
+    // its code will resume at: returnAddress for the innermost frame, and the
+    // ReturnPC saved by its callee for the others. A frame whose callee was
+    // entered from native code has no such address.
+    m_stack.shrink(0);
+    for (CallFrame* frame = callFrame; frame; ) {
+        if (m_stack.size() == maximumStackDepth) {
+            m_stack.append(CallIdentifier("(truncated)", "", 0));
+            break;
+        }
+        m_stack.append(callIdentifierForFrame(frame, returnAddress));
+
+        CallFrame* callerFrame = frame->callerFrame();
+        if (callerFrame->hasHostCallFrameFlag()) {
+            returnAddress = ReturnAddressPtr();
+            frame = callerFrame->removeHostCallFrameFlag();
+        } else {
+            returnAddress = frame->returnPC();
+            frame = callerFrame;
+        }
+    }
+
+    Node* node = &m_root;
+    ++node->totalSamples;
+    for (size_t i = m_stack.size(); i--; ) {
+        node = node->child(m_stack[i]);
+        ++node->totalSamples;
+    }
+    ++node->selfSamples;
+}
+
+static void appendFrameLabel(UStringBuilder& builder, const CallIdentifier& callIdentifier)
+{
+    UString label = callIdentifier.m_name;
+    if (!callIdentifier.m_url.isEmpty() || callIdentifier.m_lineNumber)
+        label = makeUString(label, " ", callIdentifier.m_url, ":", UString::number(callIdentifier.m_lineNumber));
+
+    // ';' separates frames and the line ends the stack, so neither may appear
+    // inside a label.
+    const UChar* characters = label.characters();
+    for (unsigned i = 0; i < label.length(); ++i) {
+        UChar c = characters[i];
+        builder.append(c == ';' || c == '\n' ? static_cast<UChar>('_') : c);
+    }
+}
+
+static void appendFoldedStacks(UStringBuilder& builder, Vector<const SamplingProfiler::Node*>& path, const SamplingProfiler::Node& node)
+{
+    path.append(&node);
+
+    if (node.selfSamples) {
+        for (size_t i = 0; i < path.size(); ++i) {
+            if (i)
+                builder.append(';');
+            appendFrameLabel(builder, path[i]->callIdentifier);
+        }
+        builder.append(' ');
+        builder.append(UString::number(node.selfSamples));
+        builder.append('\n');
+    }
+
+    for (size_t i = 0; i < node.children.size(); ++i)
+        appendFoldedStacks(builder, path, *node.children[i]);
+
+    path.removeLast();
+}
+
+UString SamplingProfiler::foldedStacks() const
+{
+    UStringBuilder builder;
+    Vector<const Node*> path;
+    for (size_t i = 0; i < m_root.children.size(); ++i)
+        appendFoldedStacks(builder, path, *m_root.children[i]);
+    return builder.toUString();
+}
+
+#if OS(WINDOWS)
+
+unsigned __stdcall SamplingProfiler::timerThreadEntry(void* profiler)
+{
+    static_cast<SamplingProfiler*>(profiler)->runTimer();
+    return 0;
+}
+
+void* SamplingProfiler::createTimerThread()
+{
+    return reinterpret_cast<void*>(_beginthreadex(0, 0, timerThreadEntry, this, 0, 0));
+}
+
+void SamplingProfiler::joinTimerThread(void* thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void SamplingProfiler::sleepForInterval()
+{
+    Sleep(m_intervalInMilliseconds);
+}
+
+#else
+
+void* SamplingProfiler::timerThreadEntry(void* profiler)
+{
+    static_cast<SamplingProfiler*>(profiler)->runTimer();
+    return 0;
+}
+
+void* SamplingProfiler::createTimerThread()
+{
+    pthread_t* thread = new pthread_t;
+    if (pthread_create(thread, 0, timerThreadEntry, this)) {
+        delete thread;
+        return 0;
+    }
+    return thread;
+}
+
+void SamplingProfiler::joinTimerThread(void* thread)
+{
+    pthread_join(*static_cast<pthread_t*>(thread), 0);
+    delete static_cast<pthread_t*>(thread);
+}
+
+void SamplingProfiler::sleepForInterval()
+{
+    usleep(m_intervalInMilliseconds * 1000);
+}
+
+#endif
+
+} // namespace JSC
@@ -0,0 +1,96 @@
+#ifndef SamplingProfiler_h
+#define SamplingProfiler_h
+
+#include "CallIdentifier.h"
+#include "MacroAssemblerCodeRef.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class ExecState;
+
+    // A statistical profiler cheap enough to leave running in production.
+    //
+    // While it runs, a timer thread raises a flag every interval. JIT code
+    // tests the flag at function entry and on loop back-edges, and the first
+    // test to see it set walks the CallFrame chain and adds one sample to the
+    // call tree. Frames are identified by function and by the line they are
+    // executing, which is found by mapping the JIT return address back
+    // through the CodeBlock. Nothing is recorded per call, so the cost when a
+    // sample is not due is a load and a branch.
+    //
+    // Time spent in native code is charged to the next JS function entry or
+    // loop back-edge, and code running in the interpreter is not sampled.
+    class SamplingProfiler {
+        WTF_MAKE_NONCOPYABLE(SamplingProfiler);
+    public:
+        struct Node {
+            WTF_MAKE_NONCOPYABLE(Node); WTF_MAKE_FAST_ALLOCATED;
+        public:
+            Node(const CallIdentifier& callIdentifier)
+                : callIdentifier(callIdentifier)
+                , selfSamples(0)
+                , totalSamples(0)
+            {
+            }
+
+            ~Node() { deleteAllValues(children); }
+
+            Node* child(const CallIdentifier&);
+
+            CallIdentifier callIdentifier;
+            unsigned selfSamples;
+            unsigned totalSamples;
+            Vector<Node*> children;
+        };
+
+        SamplingProfiler();
+        ~SamplingProfiler();
+
+        void start(unsigned intervalInMilliseconds = 1);
+        void stop();
+        bool isRunning() const { return !!m_timerThread; }
+
+        // Discards every sample taken so far.
+        void clear();
+
+        // The root has an empty CallIdentifier; its children are the
+        // outermost frames seen.
+        const Node& callTree() const { return m_root; }
+        unsigned sampleCount() const { return m_root.totalSamples; }
+
+        // One line per distinct stack, outermost frame first, in the
+        // "frame;frame;frame count" form that flame graph tools read.
+        UString foldedStacks() const;
+
+        // JIT code tests this word; see JIT::emitSampleCheck().
+        int* addressOfSampleRequested() { return &m_sampleRequested; }
+
+        // Called from JIT code once it has seen the flag. returnAddress is
+        // where the check will resume in callFrame's code.
+        void takeSample(ExecState* callFrame, ReturnAddressPtr returnAddress);
+
+    private:
+#if OS(WINDOWS)
+        static unsigned __stdcall timerThreadEntry(void*);
+#else
+        static void* timerThreadEntry(void*);
+#endif
+        void runTimer();
+        void* createTimerThread();
+        void joinTimerThread(void*);
+        void sleepForInterval();
+
+        Node m_root;
+        Vector<CallIdentifier, 32> m_stack;
+
+        int m_sampleRequested;
+        volatile bool m_shouldStop;
+        unsigned m_intervalInMilliseconds;
+        void* m_timerThread;
+    };
+
+} // namespace JSC
+
+#endif // SamplingProfiler_h
@@ -56,9 +56,16 @@ void MarkedArgumentBuffer::slowAppend(JSValue v)
     // our Vector's inline capacity, though, our values move to the 
     // heap, where they do need explicit marking.
     if (!m_markSet) {
-        // FIXME: Even if v is not a JSCell*, if previous values in the buffer
-        // are, then they won't be marked!
-        if (Heap* heap = Heap::heap(v)) {
+        // The values already in the inline buffer are about to move to the
+        // heap as well, so any of them can tell us which heap marks the list.
+        // Later appends only need to look at the new value: had an earlier
+        // one been a cell, the list would be in the mark set by now.
+        Heap* heap = Heap::heap(v);
+        if (m_isUsingInlineBuffer) {
+            for (size_t i = 0; !heap && i < m_size; ++i)
+                heap = Heap::heap(m_buffer[i].jsValue());
+        }
+        if (heap) {
             ListSet& markSet = heap->markListSet();
             markSet.add(this);
             m_markSet = &markSet;
@@ -162,6 +162,151 @@ static unsigned argumentClampedIndexFromStartOrEnd(ExecState* exec, int argument
     return indexDouble > length ? length : static_cast<unsigned>(indexDouble);
 }
 
+// An int32 element is kept as its value and formatted straight into the
+// result; allocating a string for each one costs more than the join itself.
+struct JoinElement {
+    JoinElement(unsigned index, const UString& string)
+        : index(index)
+        , number(0)
+        , string(string)
+    {
+    }
+
+    JoinElement(unsigned index, int number)
+        : index(index)
+        , number(number)
+    {
+    }
+
+    unsigned index;
+    int number;
+    UString string;
+};
+
+typedef Vector<JoinElement, 64> JoinElementVector;
+
+static inline void appendCharacters(LChar*& position, const UString& string)
+{
+    memcpy(position, string.characters8(), string.length());
+    position += string.length();
+}
+
+static inline void appendCharacters(UChar*& position, const UString& string)
+{
+    if (string.is8Bit())
+        StringImpl::copyChars(position, string.characters8(), string.length());
+    else
+        StringImpl::copyChars(position, string.characters(), string.length());
+    position += string.length();
+}
+
+static unsigned decimalLength(int number)
+{
+    unsigned length = number < 0 ? 2 : 1;
+    unsigned magnitude = number < 0 ? -static_cast<unsigned>(number) : number;
+    while (magnitude >= 10) {
+        magnitude /= 10;
+        ++length;
+    }
+    return length;
+}
+
+template<typename CharacterType>
+static inline void appendCharacters(CharacterType*& position, const JoinElement& element)
+{
+    if (!element.string.isNull()) {
+        appendCharacters(position, element.string);
+        return;
+    }
+
+    unsigned length = decimalLength(element.number);
+    unsigned magnitude = element.number < 0 ? -static_cast<unsigned>(element.number) : element.number;
+    CharacterType* digit = position + length;
+    do {
+        *--digit = static_cast<CharacterType>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (element.number < 0)
+        *--digit = '-';
+    position += length;
+}
+
+template<typename CharacterType>
+static void copyJoinedElements(CharacterType* position, unsigned length, const JoinElementVector& elements, const UString& separator)
+{
+    if (!separator.length()) {
+        for (size_t i = 0; i < elements.size(); ++i)
+            appendCharacters(position, elements[i]);
+        return;
+    }
+
+    size_t next = 0;
+    for (unsigned k = 0; k < length; ++k) {
+        if (k)
+            appendCharacters(position, separator);
+        if (next < elements.size() && elements[next].index == k)
+            appendCharacters(position, elements[next++]);
+    }
+}
+
+// Converts every element once, then copies them all into a buffer of the
+// final size, so a join never regrows its result. Holes and empty strings
+// are not stored. The result stays 8-bit when the separator and every
+// element are.
+static JSValue joinElements(ExecState* exec, JSObject* thisObj, unsigned length, const UString& separator)
+{
+    JSArray* array = isJSArray(&exec->globalData(), thisObj) ? asArray(thisObj) : 0;
+
+    JoinElementVector elements;
+    unsigned long long totalLength = length ? static_cast<unsigned long long>(length - 1) * separator.length() : 0;
+    bool is8Bit = !separator.length() || separator.is8Bit();
+    for (unsigned k = 0; k < length; k++) {
+        JSValue element;
+        if (array && array->canGetIndex(k))
+            element = array->getIndex(k);
+        else
+            element = thisObj->get(exec, k);
+        if (element.isUndefinedOrNull())
+            continue;
+
+        if (element.isInt32()) {
+            totalLength += decimalLength(element.asInt32());
+            elements.append(JoinElement(k, element.asInt32()));
+            continue;
+        }
+
+        UString string = element.toString(exec);
+        if (exec->hadException())
+            return jsUndefined();
+        if (!string.length())
+            continue;
+        totalLength += string.length();
+        is8Bit = is8Bit && string.is8Bit();
+        elements.append(JoinElement(k, string));
+    }
+
+    if (!totalLength)
+        return jsEmptyString(exec);
+    if (totalLength > std::numeric_limits<unsigned>::max())
+        return throwOutOfMemoryError(exec);
+
+    if (is8Bit) {
+        LChar* buffer;
+        RefPtr<StringImpl> result = StringImpl::tryCreateUninitialized(static_cast<unsigned>(totalLength), buffer);
+        if (!result)
+            return throwOutOfMemoryError(exec);
+        copyJoinedElements(buffer, length, elements, separator);
+        return jsString(exec, UString(result.release()));
+    }
+
+    UChar* buffer;
+    RefPtr<StringImpl> result = StringImpl::tryCreateUninitialized(static_cast<unsigned>(totalLength), buffer);
+    if (!result)
+        return throwOutOfMemoryError(exec);
+    copyJoinedElements(buffer, length, elements, separator);
+    return jsString(exec, UString(result.release()));
+}
+
 EncodedJSValue JSC_HOST_CALL arrayProtoFuncToString(ExecState* exec)
 {
     JSValue thisValue = exec->hostThisValue();
@@ -179,51 +324,7 @@ EncodedJSValue JSC_HOST_CALL arrayProtoFuncToString(ExecState* exec)
     if (EncodedJSValue earlyReturnValue = checker.earlyReturnValue())
         return earlyReturnValue;
 
-    unsigned totalSize = length ? length - 1 : 0;
-#if OS(SYMBIAN)
-    // Symbian has very limited stack size available.
-    // This function could be called recursively and allocating 1K on stack here cause
-    // stack overflow on Symbian devices.
-    Vector<RefPtr<StringImpl> > strBuffer(length);
-#else
-    Vector<RefPtr<StringImpl>, 256> strBuffer(length);
-#endif    
-    for (unsigned k = 0; k < length; k++) {
-        JSValue element;
-        if (isRealArray && thisObj->canGetIndex(k))
-            element = thisObj->getIndex(k);
-        else
-            element = thisObj->get(exec, k);
-        
-        if (element.isUndefinedOrNull())
-            continue;
-        
-        UString str = element.toString(exec);
-        strBuffer[k] = str.impl();
-        totalSize += str.length();
-        
-        if (!strBuffer.data()) {
-            throwOutOfMemoryError(exec);
-        }
-        
-        if (exec->hadException())
-            break;
-    }
-    if (!totalSize)
-        return JSValue::encode(jsEmptyString(exec));
-    Vector<UChar> buffer;
-    buffer.reserveCapacity(totalSize);
-    if (!buffer.data())
-        return JSValue::encode(throwOutOfMemoryError(exec));
-        
-    for (unsigned i = 0; i < length; i++) {
-        if (i)
-            buffer.append(',');
-        if (RefPtr<StringImpl> rep = strBuffer[i])
-            buffer.append(rep->characters(), rep->length());
-    }
-    ASSERT(buffer.size() == totalSize);
-    return JSValue::encode(jsString(exec, UString::adopt(buffer)));
+    return JSValue::encode(joinElements(exec, thisObj, length, ","));
 }
 
 EncodedJSValue JSC_HOST_CALL arrayProtoFuncToLocaleString(ExecState* exec)
@@ -276,60 +377,15 @@ EncodedJSValue JSC_HOST_CALL arrayProtoFuncJoin(ExecState* exec)
     if (EncodedJSValue earlyReturnValue = checker.earlyReturnValue())
         return earlyReturnValue;
 
-    JSStringBuilder strBuffer;
-
     UString separator;
     if (!exec->argument(0).isUndefined())
         separator = exec->argument(0).toString(exec);
+    else
+        separator = ",";
+    if (exec->hadException())
+        return JSValue::encode(jsUndefined());
 
-    unsigned k = 0;
-    if (isJSArray(&exec->globalData(), thisObj)) {
-        JSArray* array = asArray(thisObj);
-
-        if (length) {
-            if (!array->canGetIndex(k)) 
-                goto skipFirstLoop;
-            JSValue element = array->getIndex(k);
-            if (!element.isUndefinedOrNull())
-                strBuffer.append(element.toString(exec));
-            k++;
-        }
-
-        if (separator.isNull()) {
-            for (; k < length; k++) {
-                if (!array->canGetIndex(k))
-                    break;
-                strBuffer.append(',');
-                JSValue element = array->getIndex(k);
-                if (!element.isUndefinedOrNull())
-                    strBuffer.append(element.toString(exec));
-            }
-        } else {
-            for (; k < length; k++) {
-                if (!array->canGetIndex(k))
-                    break;
-                strBuffer.append(separator);
-                JSValue element = array->getIndex(k);
-                if (!element.isUndefinedOrNull())
-                    strBuffer.append(element.toString(exec));
-            }
-        }
-    }
- skipFirstLoop:
-    for (; k < length; k++) {
-        if (k >= 1) {
-            if (separator.isNull())
-                strBuffer.append(',');
-            else
-                strBuffer.append(separator);
-        }
-
-        JSValue element = thisObj->get(exec, k);
-        if (!element.isUndefinedOrNull())
-            strBuffer.append(element.toString(exec));
-    }
-
-    return JSValue::encode(strBuffer.build(exec));
+    return JSValue::encode(joinElements(exec, thisObj, length, separator));
 }
 
 EncodedJSValue JSC_HOST_CALL arrayProtoFuncConcat(ExecState* exec)
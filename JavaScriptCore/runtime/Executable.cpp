@@ -32,6 +32,7 @@
 #include "Parser.h"
 #include "UStringBuilder.h"
 #include "Vector.h"
+#include <wtf/CurrentTime.h>
 
 #if ENABLE(DFG_JIT)
 #include "DFGByteCodeParser.h"
@@ -40,6 +41,41 @@
 
 namespace JSC {
 
+// Splits the time a compile function takes into its parse, bytecode and
+// machine code phases, each ending at the matching call. Nothing reaches the
+// JSGlobalData until didGenerateMachineCode(), so a compilation that returns
+// early with an exception is not counted.
+class CompilationTimer {
+public:
+    CompilationTimer(JSGlobalData* globalData)
+        : m_globalData(globalData)
+        , m_lastCheckpoint(currentTime())
+    {
+    }
+
+    void didParse() { charge(m_statistics.parseTime); }
+    void didGenerateBytecode() { charge(m_statistics.bytecodeTime); }
+
+    void didGenerateMachineCode()
+    {
+        charge(m_statistics.machineCodeTime);
+        m_statistics.compilations = 1;
+        m_globalData->didCompile(m_statistics);
+    }
+
+private:
+    void charge(double& phaseTime)
+    {
+        double now = currentTime();
+        phaseTime += now - m_lastCheckpoint;
+        m_lastCheckpoint = now;
+    }
+
+    JSGlobalData* m_globalData;
+    CompilationStatistics m_statistics;
+    double m_lastCheckpoint;
+};
+
 const ClassInfo ExecutableBase::s_info = { "Executable", 0, 0, 0 };
 
 const ClassInfo NativeExecutable::s_info = { "NativeExecutable", &ExecutableBase::s_info, 0, 0 };
@@ -102,6 +138,7 @@ JSObject* EvalExecutable::compileInternal(ExecState* exec, ScopeChainNode* scope
     JSObject* exception = 0;
     JSGlobalData* globalData = &exec->globalData();
     JSGlobalObject* lexicalGlobalObject = exec->lexicalGlobalObject();
+    CompilationTimer timer(globalData);
     if (!lexicalGlobalObject->isEvalEnabled())
         return throwError(exec, createEvalError(exec, "Eval is disabled"));
     RefPtr<EvalNode> evalNode = globalData->parser->parse<EvalNode>(lexicalGlobalObject, lexicalGlobalObject->debugger(), exec, m_source, 0, isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
@@ -110,6 +147,7 @@ JSObject* EvalExecutable::compileInternal(ExecState* exec, ScopeChainNode* scope
         return exception;
     }
     recordParse(evalNode->features(), evalNode->hasCapturedVariables(), evalNode->lineNo(), evalNode->lastLine());
+    timer.didParse();
 
     JSGlobalObject* globalObject = scopeChainNode->globalObject.get();
 
@@ -123,6 +161,7 @@ JSObject* EvalExecutable::compileInternal(ExecState* exec, ScopeChainNode* scope
     }
 
     evalNode->destroyData();
+    timer.didGenerateBytecode();
 
 #if ENABLE(JIT)
     if (exec->globalData().canUseJIT()) {
@@ -133,6 +172,7 @@ JSObject* EvalExecutable::compileInternal(ExecState* exec, ScopeChainNode* scope
 #endif
     }
 #endif
+    timer.didGenerateMachineCode();
 
 #if ENABLE(JIT)
     Heap::heap(this)->reportExtraMemoryCost(sizeof(*m_evalCodeBlock) + m_jitCodeForCall.size());
@@ -169,12 +209,14 @@ JSObject* ProgramExecutable::compileInternal(ExecState* exec, ScopeChainNode* sc
     JSObject* exception = 0;
     JSGlobalData* globalData = &exec->globalData();
     JSGlobalObject* lexicalGlobalObject = exec->lexicalGlobalObject();
+    CompilationTimer timer(globalData);
     RefPtr<ProgramNode> programNode = globalData->parser->parse<ProgramNode>(lexicalGlobalObject, lexicalGlobalObject->debugger(), exec, m_source, 0, isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
     if (!programNode) {
         ASSERT(exception);
         return exception;
     }
     recordParse(programNode->features(), programNode->hasCapturedVariables(), programNode->lineNo(), programNode->lastLine());
+    timer.didParse();
 
     JSGlobalObject* globalObject = scopeChainNode->globalObject.get();
     
@@ -187,6 +229,7 @@ JSObject* ProgramExecutable::compileInternal(ExecState* exec, ScopeChainNode* sc
     }
 
     programNode->destroyData();
+    timer.didGenerateBytecode();
 
 #if ENABLE(JIT)
     if (exec->globalData().canUseJIT()) {
@@ -197,6 +240,7 @@ JSObject* ProgramExecutable::compileInternal(ExecState* exec, ScopeChainNode* sc
 #endif
     }
 #endif
+    timer.didGenerateMachineCode();
 
 #if ENABLE(JIT)
     Heap::heap(this)->reportExtraMemoryCost(sizeof(*m_programCodeBlock) + m_jitCodeForCall.size());
@@ -211,6 +255,9 @@ JSObject* ProgramExecutable::compileInternal(ExecState* exec, ScopeChainNode* sc
 static bool tryDFGCompile(JSGlobalData* globalData, CodeBlock* codeBlock, JITCode& jitCode, MacroAssemblerCodePtr& jitCodeWithArityCheck)
 {
 #if ENABLE(DFG_JIT)
+    if (!globalData->canUseDFG())
+        return false;
+
 #if ENABLE(DFG_JIT_RESTRICTIONS)
     // FIXME: No flow control yet supported, don't bother scanning the bytecode if there are any jump targets.
     // FIXME: temporarily disable property accesses until we fix regressions.
@@ -246,6 +293,7 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
 {
     JSObject* exception = 0;
     JSGlobalData* globalData = scopeChainNode->globalData;
+    CompilationTimer timer(globalData);
     RefPtr<FunctionBodyNode> body = globalData->parser->parse<FunctionBodyNode>(exec->lexicalGlobalObject(), 0, 0, m_source, m_parameters.get(), isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
     if (!body) {
         ASSERT(exception);
@@ -255,6 +303,7 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
         body->setUsesArguments();
     body->finishParsing(m_parameters, m_name);
     recordParse(body->features(), body->hasCapturedVariables(), body->lineNo(), body->lastLine());
+    timer.didParse();
 
     JSGlobalObject* globalObject = scopeChainNode->globalObject.get();
 
@@ -273,6 +322,7 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
     m_symbolTable = m_codeBlockForCall->sharedSymbolTable();
 
     body->destroyData();
+    timer.didGenerateBytecode();
 
 #if ENABLE(JIT)
     if (exec->globalData().canUseJIT()) {
@@ -286,6 +336,7 @@ JSObject* FunctionExecutable::compileForCallInternal(ExecState* exec, ScopeChain
 #endif
     }
 #endif
+    timer.didGenerateMachineCode();
 
 #if ENABLE(JIT)
     Heap::heap(this)->reportExtraMemoryCost(sizeof(*m_codeBlockForCall) + m_jitCodeForCall.size());
@@ -300,6 +351,7 @@ JSObject* FunctionExecutable::compileForConstructInternal(ExecState* exec, Scope
 {
     JSObject* exception = 0;
     JSGlobalData* globalData = scopeChainNode->globalData;
+    CompilationTimer timer(globalData);
     RefPtr<FunctionBodyNode> body = globalData->parser->parse<FunctionBodyNode>(exec->lexicalGlobalObject(), 0, 0, m_source, m_parameters.get(), isStrictMode() ? JSParseStrict : JSParseNormal, &exception);
     if (!body) {
         ASSERT(exception);
@@ -309,6 +361,7 @@ JSObject* FunctionExecutable::compileForConstructInternal(ExecState* exec, Scope
         body->setUsesArguments();
     body->finishParsing(m_parameters, m_name);
     recordParse(body->features(), body->hasCapturedVariables(), body->lineNo(), body->lastLine());
+    timer.didParse();
 
     JSGlobalObject* globalObject = scopeChainNode->globalObject.get();
 
@@ -327,6 +380,7 @@ JSObject* FunctionExecutable::compileForConstructInternal(ExecState* exec, Scope
     m_symbolTable = m_codeBlockForConstruct->sharedSymbolTable();
 
     body->destroyData();
+    timer.didGenerateBytecode();
 
 #if ENABLE(JIT)
     if (exec->globalData().canUseJIT()) {
@@ -337,6 +391,7 @@ JSObject* FunctionExecutable::compileForConstructInternal(ExecState* exec, Scope
 #endif
     }
 #endif
+    timer.didGenerateMachineCode();
 
 #if ENABLE(JIT)
     Heap::heap(this)->reportExtraMemoryCost(sizeof(*m_codeBlockForConstruct) + m_jitCodeForConstruct.size());
@@ -28,10 +28,10 @@
 #include "Error.h"
 #include "Executable.h"
 #include "PropertyNameArray.h"
-#include <wtf/AVLTree.h>
 #include <wtf/Assertions.h>
 #include <wtf/OwnPtr.h>
 #include <Operations.h>
+#include <algorithm>
 
 using namespace std;
 using namespace WTF;
@@ -140,6 +140,7 @@ JSArray::JSArray(JSGlobalData& globalData, Structure* structure)
 
     m_storage = static_cast<ArrayStorage*>(fastZeroedMalloc(storageSize(initialCapacity)));
     m_storage->m_allocBase = m_storage;
+    m_storage->m_mayHaveCells = 0;
     m_indexBias = 0;
     m_vectorLength = initialCapacity;
 
@@ -167,6 +168,7 @@ JSArray::JSArray(JSGlobalData& globalData, Structure* structure, unsigned initia
     m_storage->m_sparseValueMap = 0;
     m_storage->subclassData = 0;
     m_storage->reportedMapCapacity = 0;
+    m_storage->m_mayHaveCells = 0;
 
     if (creationMode == CreateCompact) {
 #if CHECK_ARRAY_CONSISTENCY
@@ -214,6 +216,7 @@ JSArray::JSArray(JSGlobalData& globalData, Structure* structure, const ArgList&
     m_storage->m_sparseValueMap = 0;
     m_storage->subclassData = 0;
     m_storage->reportedMapCapacity = 0;
+    m_storage->m_mayHaveCells = 0;
 #if CHECK_ARRAY_CONSISTENCY
     m_storage->m_inCompactInitialization = false;
 #endif
@@ -222,7 +225,7 @@ JSArray::JSArray(JSGlobalData& globalData, Structure* structure, const ArgList&
     WriteBarrier<Unknown>* vector = m_storage->m_vector;
     ArgList::const_iterator end = list.end();
     for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
-        vector[i].set(globalData, this, *it);
+        setVectorValue(globalData, vector[i], *it);
     for (; i < initialStorage; i++)
         vector[i].clear();
 
@@ -355,11 +358,11 @@ void JSArray::put(ExecState* exec, unsigned i, JSValue value)
     if (i < m_vectorLength) {
         WriteBarrier<Unknown>& valueSlot = storage->m_vector[i];
         if (valueSlot) {
-            valueSlot.set(exec->globalData(), this, value);
+            setVectorValue(exec->globalData(), valueSlot, value);
             checkConsistency();
             return;
         }
-        valueSlot.set(exec->globalData(), this, value);
+        setVectorValue(exec->globalData(), valueSlot, value);
         ++storage->m_numValuesInVector;
         checkConsistency();
         return;
@@ -409,7 +412,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
     if (!map || map->isEmpty()) {
         if (increaseVectorLength(i + 1)) {
             storage = m_storage;
-            storage->m_vector[i].set(exec->globalData(), this, value);
+            setVectorValue(exec->globalData(), storage->m_vector[i], value);
             ++storage->m_numValuesInVector;
             checkConsistency();
         } else
@@ -463,7 +466,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
             vector[j].clear();
         JSGlobalData& globalData = exec->globalData();
         for (unsigned j = max(vectorLength, MIN_SPARSE_ARRAY_INDEX); j < newVectorLength; ++j)
-            vector[j].set(globalData, this, map->take(j).get());
+            setVectorValue(globalData, vector[j], map->take(j).get());
     }
 
     ASSERT(i < newVectorLength);
@@ -471,7 +474,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
     m_vectorLength = newVectorLength;
     storage->m_numValuesInVector = newNumValuesInVector;
 
-    storage->m_vector[i].set(exec->globalData(), this, value);
+    setVectorValue(exec->globalData(), storage->m_vector[i], value);
 
     checkConsistency();
 
@@ -743,7 +746,7 @@ void JSArray::push(ExecState* exec, JSValue value)
     }
 
     if (storage->m_length < m_vectorLength) {
-        storage->m_vector[storage->m_length].set(exec->globalData(), this, value);
+        setVectorValue(exec->globalData(), storage->m_vector[storage->m_length], value);
         ++storage->m_numValuesInVector;
         ++storage->m_length;
         checkConsistency();
@@ -755,7 +758,7 @@ void JSArray::push(ExecState* exec, JSValue value)
         if (!map || map->isEmpty()) {
             if (increaseVectorLength(storage->m_length + 1)) {
                 storage = m_storage;
-                storage->m_vector[storage->m_length].set(exec->globalData(), this, value);
+                setVectorValue(exec->globalData(), storage->m_vector[storage->m_length], value);
                 ++storage->m_numValuesInVector;
                 ++storage->m_length;
                 checkConsistency();
@@ -868,12 +871,18 @@ void JSArray::visitChildren(SlotVisitor& visitor)
     visitChildrenDirect(visitor);
 }
 
-static int compareNumbersForQSort(const void* a, const void* b)
-{
-    double da = static_cast<const JSValue*>(a)->uncheckedGetNumber();
-    double db = static_cast<const JSValue*>(b)->uncheckedGetNumber();
-    return (da > db) - (da < db);
-}
+// NaN sorts after every number. A plain < is not a strict weak ordering once
+// NaN is present, and std::sort may then read past the end of the range.
+struct NumericLess {
+    bool operator()(JSValue a, JSValue b) const
+    {
+        double x = a.uncheckedGetNumber();
+        double y = b.uncheckedGetNumber();
+        if (x < y)
+            return true;
+        return isnan(y) && !isnan(x);
+    }
+};
 
 static int compareByStringPairForQSort(const void* a, const void* b)
 {
@@ -884,9 +893,8 @@ static int compareByStringPairForQSort(const void* a, const void* b)
 
 void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
 {
-    ArrayStorage* storage = m_storage;
-
     unsigned lengthNotIncludingUndefined = compactForSorting();
+    ArrayStorage* storage = m_storage;
     if (storage->m_sparseValueMap) {
         throwOutOfMemoryError(exec);
         return;
@@ -896,7 +904,7 @@ void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType cal
         return;
         
     bool allValuesAreNumbers = true;
-    size_t size = storage->m_numValuesInVector;
+    size_t size = lengthNotIncludingUndefined;
     for (size_t i = 0; i < size; ++i) {
         if (!storage->m_vector[i].isNumber()) {
             allValuesAreNumbers = false;
@@ -907,19 +915,21 @@ void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType cal
     if (!allValuesAreNumbers)
         return sort(exec, compareFunction, callType, callData);
 
-    // For numeric comparison, which is fast, qsort is faster than mergesort. We
-    // also don't require mergesort's stability, since there's no user visible
-    // side-effect from swapping the order of equal primitive values.
-    qsort(storage->m_vector, size, sizeof(JSValue), compareNumbersForQSort);
+    // For numeric comparison, which is fast, an unstable sort is faster than
+    // mergesort, and std::sort inlines the comparison where qsort makes an
+    // indirect call for each one. We don't require mergesort's stability, since
+    // there's no user visible side-effect from swapping the order of equal
+    // primitive values.
+    JSValue* values = storage->m_vector[0].slot();
+    std::sort(values, values + size, NumericLess());
 
     checkConsistency(SortConsistencyCheck);
 }
 
 void JSArray::sort(ExecState* exec)
 {
-    ArrayStorage* storage = m_storage;
-
     unsigned lengthNotIncludingUndefined = compactForSorting();
+    ArrayStorage* storage = m_storage;
     if (storage->m_sparseValueMap) {
         throwOutOfMemoryError(exec);
         return;
@@ -978,204 +988,204 @@ void JSArray::sort(ExecState* exec)
 
     JSGlobalData& globalData = exec->globalData();
     for (size_t i = 0; i < lengthNotIncludingUndefined; i++)
-        storage->m_vector[i].set(globalData, this, values[i].first);
+        setVectorValue(globalData, storage->m_vector[i], values[i].first);
 
     Heap::heap(this)->popTempSortVector(&values);
     
     checkConsistency(SortConsistencyCheck);
 }
 
-struct AVLTreeNodeForArrayCompare {
-    JSValue value;
-
-    // Child pointers.  The high bit of gt is robbed and used as the
-    // balance factor sign.  The high bit of lt is robbed and used as
-    // the magnitude of the balance factor.
-    int32_t gt;
-    int32_t lt;
-};
-
-struct AVLTreeAbstractorForArrayCompare {
-    typedef int32_t handle; // Handle is an index into m_nodes vector.
-    typedef JSValue key;
-    typedef int32_t size;
-
-    Vector<AVLTreeNodeForArrayCompare> m_nodes;
-    ExecState* m_exec;
-    JSValue m_compareFunction;
-    CallType m_compareCallType;
-    const CallData* m_compareCallData;
-    JSValue m_globalThisValue;
-    OwnPtr<CachedCall> m_cachedCall;
-
-    handle get_less(handle h) { return m_nodes[h].lt & 0x7FFFFFFF; }
-    void set_less(handle h, handle lh) { m_nodes[h].lt &= 0x80000000; m_nodes[h].lt |= lh; }
-    handle get_greater(handle h) { return m_nodes[h].gt & 0x7FFFFFFF; }
-    void set_greater(handle h, handle gh) { m_nodes[h].gt &= 0x80000000; m_nodes[h].gt |= gh; }
-
-    int get_balance_factor(handle h)
-    {
-        if (m_nodes[h].gt & 0x80000000)
-            return -1;
-        return static_cast<unsigned>(m_nodes[h].lt) >> 31;
-    }
-
-    void set_balance_factor(handle h, int bf)
+// Calls a sort comparator supplied by script. A JS comparator goes through a
+// CachedCall, so its frame is set up once per sort rather than once per
+// comparison.
+class ArrayCompareFunction {
+public:
+    ArrayCompareFunction(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
+        : m_exec(exec)
+        , m_compareFunction(compareFunction)
+        , m_callType(callType)
+        , m_callData(callData)
+        , m_globalThisValue(exec->globalThisValue())
     {
-        if (bf == 0) {
-            m_nodes[h].lt &= 0x7FFFFFFF;
-            m_nodes[h].gt &= 0x7FFFFFFF;
-        } else {
-            m_nodes[h].lt |= 0x80000000;
-            if (bf < 0)
-                m_nodes[h].gt |= 0x80000000;
-            else
-                m_nodes[h].gt &= 0x7FFFFFFF;
-        }
+        if (callType == CallTypeJS)
+            m_cachedCall = adoptPtr(new CachedCall(exec, asFunction(compareFunction), 2));
     }
 
-    int compare_key_key(key va, key vb)
+    // Once the comparator has thrown, every pair is treated as already in
+    // order, so the sort runs to completion without calling it again.
+    bool isGreater(JSValue a, JSValue b)
     {
-        ASSERT(!va.isUndefined());
-        ASSERT(!vb.isUndefined());
+        ASSERT(!a.isUndefined());
+        ASSERT(!b.isUndefined());
 
         if (m_exec->hadException())
-            return 1;
+            return false;
 
         double compareResult;
         if (m_cachedCall) {
             m_cachedCall->setThis(m_globalThisValue);
-            m_cachedCall->setArgument(0, va);
-            m_cachedCall->setArgument(1, vb);
+            m_cachedCall->setArgument(0, a);
+            m_cachedCall->setArgument(1, b);
             compareResult = m_cachedCall->call().toNumber(m_cachedCall->newCallFrame(m_exec));
         } else {
             MarkedArgumentBuffer arguments;
-            arguments.append(va);
-            arguments.append(vb);
-            compareResult = call(m_exec, m_compareFunction, m_compareCallType, *m_compareCallData, m_globalThisValue, arguments).toNumber(m_exec);
+            arguments.append(a);
+            arguments.append(b);
+            compareResult = call(m_exec, m_compareFunction, m_callType, m_callData, m_globalThisValue, arguments).toNumber(m_exec);
         }
-        return (compareResult < 0) ? -1 : 1; // Not passing equality through, because we need to store all values, even if equivalent.
+        return compareResult > 0;
     }
 
-    int compare_key_node(key k, handle h) { return compare_key_key(k, m_nodes[h].value); }
-    int compare_node_node(handle h1, handle h2) { return compare_key_key(m_nodes[h1].value, m_nodes[h2].value); }
-
-    static handle null() { return 0x7FFFFFFF; }
+private:
+    ExecState* m_exec;
+    JSValue m_compareFunction;
+    CallType m_callType;
+    const CallData& m_callData;
+    JSValue m_globalThisValue;
+    OwnPtr<CachedCall> m_cachedCall;
 };
 
-void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
-{
-    checkConsistency();
+// Runs this short are sorted by binary insertion before merging starts.
+static const size_t insertionSortRunLength = 8;
 
-    ArrayStorage* storage = m_storage;
-
-    // FIXME: This ignores exceptions raised in the compare function or in toNumber.
+template<typename Comparator>
+static void insertionSort(JSValue* values, size_t size, Comparator& comparator)
+{
+    for (size_t i = 1; i < size; ++i) {
+        JSValue value = values[i];
+
+        // Find the first element greater than value, which keeps equal
+        // elements in their original order.
+        size_t low = 0;
+        size_t high = i;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (comparator.isGreater(values[middle], value))
+                high = middle;
+            else
+                low = middle + 1;
+        }
 
-    // The maximum tree depth is compiled in - but the caller is clearly up to no good
-    // if a larger array is passed.
-    ASSERT(storage->m_length <= static_cast<unsigned>(std::numeric_limits<int>::max()));
-    if (storage->m_length > static_cast<unsigned>(std::numeric_limits<int>::max()))
-        return;
+        for (size_t j = i; j > low; --j)
+            values[j] = values[j - 1];
+        values[low] = value;
+    }
+}
 
-    unsigned usedVectorLength = min(storage->m_length, m_vectorLength);
-    unsigned nodeCount = usedVectorLength + (storage->m_sparseValueMap ? storage->m_sparseValueMap->size() : 0);
+template<typename Comparator>
+static void merge(const JSValue* left, const JSValue* middle, const JSValue* end, JSValue* out, Comparator& comparator)
+{
+    const JSValue* right = middle;
+
+    // Runs that are already in order, common when re-sorting a mostly sorted
+    // table, cost a single comparison.
+    if (left != middle && right != end && comparator.isGreater(middle[-1], *right)) {
+        while (left != middle && right != end) {
+            if (comparator.isGreater(*left, *right))
+                *out++ = *right++;
+            else
+                *out++ = *left++;
+        }
+    }
 
-    if (!nodeCount)
-        return;
+    while (left != middle)
+        *out++ = *left++;
+    while (right != end)
+        *out++ = *right++;
+}
 
-    AVLTree<AVLTreeAbstractorForArrayCompare, 44> tree; // Depth 44 is enough for 2^31 items
-    tree.abstractor().m_exec = exec;
-    tree.abstractor().m_compareFunction = compareFunction;
-    tree.abstractor().m_compareCallType = callType;
-    tree.abstractor().m_compareCallData = &callData;
-    tree.abstractor().m_globalThisValue = exec->globalThisValue();
-    tree.abstractor().m_nodes.grow(nodeCount);
+// A stable bottom-up merge sort. The scratch buffer must be as large as values
+// and both must be visible to the collector, since comparisons can allocate.
+// Returns whichever of the two buffers holds the sorted result.
+template<typename Comparator>
+static JSValue* mergeSort(JSValue* values, JSValue* scratch, size_t size, Comparator& comparator)
+{
+    for (size_t start = 0; start < size; start += insertionSortRunLength)
+        insertionSort(values + start, min(insertionSortRunLength, size - start), comparator);
+
+    JSValue* from = values;
+    JSValue* to = scratch;
+    for (size_t width = insertionSortRunLength; width < size; width *= 2) {
+        for (size_t start = 0; start < size; start += 2 * width) {
+            size_t middle = min(start + width, size);
+            size_t end = min(start + 2 * width, size);
+            merge(from + start, from + middle, from + end, to + start, comparator);
+        }
+        std::swap(from, to);
+    }
+    return from;
+}
 
-    if (callType == CallTypeJS)
-        tree.abstractor().m_cachedCall = adoptPtr(new CachedCall(exec, asFunction(compareFunction), 2));
+void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
+{
+    checkConsistency();
 
-    if (!tree.abstractor().m_nodes.begin()) {
+    unsigned lengthNotIncludingUndefined = compactForSorting();
+    ArrayStorage* storage = m_storage;
+    if (storage->m_sparseValueMap) {
         throwOutOfMemoryError(exec);
         return;
     }
 
-    // FIXME: If the compare function modifies the array, the vector, map, etc. could be modified
-    // right out from under us while we're building the tree here.
+    if (!lengthNotIncludingUndefined)
+        return;
 
-    unsigned numDefined = 0;
-    unsigned numUndefined = 0;
+    // compactForSorting() moved the undefined values after the defined ones;
+    // they go back there once the sort is done.
+    unsigned newUsedVectorLength = storage->m_numValuesInVector;
 
-    // Iterate over the array, ignoring missing values, counting undefined ones, and inserting all other ones into the tree.
-    for (; numDefined < usedVectorLength; ++numDefined) {
-        JSValue v = storage->m_vector[numDefined].get();
-        if (!v || v.isUndefined())
-            break;
-        tree.abstractor().m_nodes[numDefined].value = v;
-        tree.insert(numDefined);
+    // The comparator can run arbitrary code, including code that empties this
+    // array, so the sort works on a copy that the collector marks. The second
+    // half of the copy is the merge sort's scratch space.
+    size_t size = lengthNotIncludingUndefined;
+    Vector<JSValue> values;
+    if (!values.tryReserveCapacity(2 * size)) {
+        throwOutOfMemoryError(exec);
+        return;
     }
-    for (unsigned i = numDefined; i < usedVectorLength; ++i) {
-        JSValue v = storage->m_vector[i].get();
-        if (v) {
-            if (v.isUndefined())
-                ++numUndefined;
-            else {
-                tree.abstractor().m_nodes[numDefined].value = v;
-                tree.insert(numDefined);
-                ++numDefined;
-            }
-        }
+    for (size_t i = 0; i < size; i++) {
+        JSValue value = storage->m_vector[i].get();
+        ASSERT(value && !value.isUndefined());
+        values.uncheckedAppend(value);
     }
+    values.append(values.data(), size);
 
-    unsigned newUsedVectorLength = numDefined + numUndefined;
-
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
-        newUsedVectorLength += map->size();
-        if (newUsedVectorLength > m_vectorLength) {
-            // Check that it is possible to allocate an array large enough to hold all the entries.
-            if ((newUsedVectorLength > MAX_STORAGE_VECTOR_LENGTH) || !increaseVectorLength(newUsedVectorLength)) {
-                throwOutOfMemoryError(exec);
-                return;
-            }
-        }
-        
-        storage = m_storage;
-
-        SparseArrayValueMap::iterator end = map->end();
-        for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it) {
-            tree.abstractor().m_nodes[numDefined].value = it->second.get();
-            tree.insert(numDefined);
-            ++numDefined;
-        }
+    Heap::heap(this)->pushTempSortVector(&values);
 
-        delete map;
-        storage->m_sparseValueMap = 0;
+    ArrayCompareFunction comparator(exec, compareFunction, callType, callData);
+    if (exec->hadException()) {
+        Heap::heap(this)->popTempSortVector(&values);
+        return;
     }
 
-    ASSERT(tree.abstractor().m_nodes.size() >= numDefined);
+    JSValue* sorted = mergeSort(values.data(), values.data() + size, size, comparator);
 
-    // FIXME: If the compare function changed the length of the array, the following might be
-    // modifying the vector incorrectly.
+    // The compare function may have changed the array in any way. Whatever it
+    // did to the vector is overwritten: the sorted values come first, then
+    // the undefined values, then nothing. If it changed the length of the
+    // array or vector storage, increase the length to hold the original
+    // number of values.
+    if (m_vectorLength < newUsedVectorLength)
+        increaseVectorLength(newUsedVectorLength);
+    storage = m_storage;
+    if (storage->m_length < newUsedVectorLength)
+        storage->m_length = newUsedVectorLength;
 
-    // Copy the values back into m_storage.
-    AVLTree<AVLTreeAbstractorForArrayCompare, 44>::Iterator iter;
-    iter.start_iter_least(tree);
     JSGlobalData& globalData = exec->globalData();
-    for (unsigned i = 0; i < numDefined; ++i) {
-        storage->m_vector[i].set(globalData, this, tree.abstractor().m_nodes[*iter].value);
-        ++iter;
-    }
-
-    // Put undefined values back in.
-    for (unsigned i = numDefined; i < newUsedVectorLength; ++i)
+    for (size_t i = 0; i < size; i++)
+        setVectorValue(globalData, storage->m_vector[i], sorted[i]);
+    for (unsigned i = size; i < newUsedVectorLength; ++i)
         storage->m_vector[i].setUndefined();
-
-    // Ensure that unused values in the vector are zeroed out.
+    unsigned usedVectorLength = min(storage->m_length, m_vectorLength);
     for (unsigned i = newUsedVectorLength; i < usedVectorLength; ++i)
         storage->m_vector[i].clear();
-
     storage->m_numValuesInVector = newUsedVectorLength;
 
-    checkConsistency(SortConsistencyCheck);
+    Heap::heap(this)->popTempSortVector(&values);
+
+    // Only the vector is restored; a compare function that stored far past
+    // the end may have left a sparse map behind.
+    checkConsistency(storage->m_sparseValueMap ? NormalConsistencyCheck : SortConsistencyCheck);
 }
 
 void JSArray::fillArgList(ExecState* exec, MarkedArgumentBuffer& args)
@@ -1254,6 +1264,9 @@ unsigned JSArray::compactForSorting()
             storage = m_storage;
         }
 
+        // The map's values are moved without looking at them; the next
+        // collection works out whether any of them are cells.
+        storage->m_mayHaveCells = 1;
         SparseArrayValueMap::iterator end = map->end();
         for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it)
             storage->m_vector[numDefined++].setWithoutWriteBarrier(it->second.get());
@@ -41,6 +41,7 @@ namespace JSC {
         void* subclassData; // A JSArray subclass can use this to fill the vector lazily.
         void* m_allocBase; // Pointer to base address returned by malloc().  Keeping this pointer does eliminate false positives from the leak detector.
         size_t reportedMapCapacity;
+        unsigned m_mayHaveCells; // Zero only if m_vector holds no cells, so the collector can skip it. See JSArray::setVectorValue().
 #if CHECK_ARRAY_CONSISTENCY
         bool m_inCompactInitialization;
 #endif
@@ -107,7 +108,7 @@ namespace JSC {
                 if (i >= storage->m_length)
                     storage->m_length = i + 1;
             }
-            x.set(globalData, this, v);
+            setVectorValue(globalData, x, v);
         }
         
         void uncheckedSetIndex(JSGlobalData& globalData, unsigned i, JSValue v)
@@ -117,7 +118,7 @@ namespace JSC {
 #if CHECK_ARRAY_CONSISTENCY
             ASSERT(storage->m_inCompactInitialization);
 #endif
-            storage->m_vector[i].set(globalData, this, v);
+            setVectorValue(globalData, storage->m_vector[i], v);
         }
 
         void fillArgList(ExecState*, MarkedArgumentBuffer&);
@@ -155,6 +156,16 @@ namespace JSC {
         bool getOwnPropertySlotSlowCase(ExecState*, unsigned propertyName, PropertySlot&);
         void putSlowCase(ExecState*, unsigned propertyName, JSValue);
 
+        // Every store into m_vector goes through here, or does the same in
+        // generated code (op_put_by_val), so that arrays of numbers are not
+        // scanned by the collector.
+        void setVectorValue(JSGlobalData& globalData, WriteBarrier<Unknown>& slot, JSValue value)
+        {
+            if (value.isCell())
+                m_storage->m_mayHaveCells = 1;
+            slot.set(globalData, this, value);
+        }
+
         unsigned getNewVectorLength(unsigned desiredLength);
         bool increaseVectorLength(unsigned newLength);
         bool increaseVectorPrefixLength(unsigned newLength);
@@ -191,8 +202,19 @@ namespace JSC {
         
         ArrayStorage* storage = m_storage;
 
-        unsigned usedVectorLength = std::min(storage->m_length, m_vectorLength);
-        visitor.appendValues(storage->m_vector, usedVectorLength, MayContainNullValues);
+        // Skip the vector if it cannot hold cells. Otherwise start at the
+        // first cell, and if there is none, remember that for next time.
+        if (storage->m_mayHaveCells) {
+            unsigned usedVectorLength = std::min(storage->m_length, m_vectorLength);
+            WriteBarrier<Unknown>* vector = storage->m_vector;
+            unsigned firstCell = 0;
+            while (firstCell < usedVectorLength && !(vector[firstCell] && vector[firstCell].get().isCell()))
+                ++firstCell;
+            if (firstCell < usedVectorLength)
+                visitor.appendValues(vector + firstCell, usedVectorLength - firstCell, MayContainNullValues);
+            else
+                storage->m_mayHaveCells = 0;
+        }
 
         if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
             SparseArrayValueMap::iterator end = map->end();
@@ -159,6 +159,7 @@ JSGlobalData::JSGlobalData(GlobalDataType globalDataType, ThreadStackType thread
     , identifierTable(globalDataType == Default ? wtfThreadData().currentIdentifierTable() : createIdentifierTable())
     , propertyNames(new CommonIdentifiers(this))
     , emptyList(new MarkedArgumentBuffer)
+    , jsonStringifyCapacityHint(0)
     , lexer(new Lexer(this))
     , parser(new Parser)
     , interpreter(0)
@@ -238,6 +239,19 @@ JSGlobalData::JSGlobalData(GlobalDataType globalDataType, ThreadStackType thread
 #endif
     jitStubs = adoptPtr(new JITThunks(this));
 #endif
+#if ENABLE(DFG_JIT)
+    // The DFG has no tier-up or OSR exit yet, so it is opt-in.
+    char* canUseDFGString = getenv("JavaScriptCoreUseDFG");
+    m_canUseDFG = canUseDFGString && atoi(canUseDFGString);
+#endif
+}
+
+void JSGlobalData::didCompile(const CompilationStatistics& compilation)
+{
+    m_compilationStatistics.compilations += compilation.compilations;
+    m_compilationStatistics.parseTime += compilation.parseTime;
+    m_compilationStatistics.bytecodeTime += compilation.bytecodeTime;
+    m_compilationStatistics.machineCodeTime += compilation.machineCodeTime;
 }
 
 void JSGlobalData::clearBuiltinStructures()
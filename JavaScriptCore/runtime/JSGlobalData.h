@@ -36,7 +36,9 @@
 #include "Strong.h"
 #include "JITStubs.h"
 #include "JSValue.h"
+#include "MegamorphicCache.h"
 #include "NumericStrings.h"
+#include "SamplingProfiler.h"
 #include "SmallStrings.h"
 #include "Terminator.h"
 #include "TimeoutChecker.h"
@@ -102,6 +104,45 @@ namespace JSC {
         ThreadStackTypeSmall
     };
 
+    // Time spent compiling on the thread that runs the script, which is
+    // where first calls of large functions show up as jank. Only compilations
+    // that produce code are counted; one that stops at a syntax error, or
+    // any other exception, leaves the statistics alone.
+    struct CompilationStatistics {
+        CompilationStatistics()
+            : compilations(0)
+            , parseTime(0)
+            , bytecodeTime(0)
+            , machineCodeTime(0)
+        {
+        }
+
+        unsigned compilations;
+        double parseTime; // Seconds.
+        double bytecodeTime;
+        double machineCodeTime;
+    };
+
+    // Kept by RegExpCache. Misses include patterns too large to cache.
+    struct RegExpCacheStatistics {
+        RegExpCacheStatistics()
+            : hits(0)
+            , misses(0)
+            , evictions(0)
+            , compileTime(0)
+            , entries(0)
+            , cachedBytes(0)
+        {
+        }
+
+        unsigned hits;
+        unsigned misses;
+        unsigned evictions;
+        double compileTime; // Seconds spent compiling on misses.
+        unsigned entries;
+        size_t cachedBytes;
+    };
+
     class JSGlobalData : public RefCounted<JSGlobalData> {
     public:
         // WebCore has a one-to-one mapping of threads to JSGlobalDatas;
@@ -183,6 +224,9 @@ namespace JSC {
         SmallStrings smallStrings;
         NumericStrings numericStrings;
         DateInstanceCache dateInstanceCache;
+        RegExpCacheStatistics regExpCacheStatistics;
+        // Length of the last large JSON.stringify result; see Stringifier::stringify().
+        unsigned jsonStringifyCapacityHint;
         
 #if ENABLE(ASSEMBLER)
         ExecutableAllocator executableAllocator;
@@ -197,6 +241,19 @@ namespace JSC {
         bool canUseJIT() { return m_canUseJIT; }
 #endif
 
+#if ENABLE(DFG_JIT)
+        // Functions are compiled with the DFG, where it can handle them, only
+        // while this is set. Takes effect for functions compiled afterwards.
+        // Off unless the JavaScriptCoreUseDFG environment variable is set to
+        // a non-zero value.
+        bool canUseDFG() { return m_canUseDFG; }
+        void setCanUseDFG(bool canUseDFG) { m_canUseDFG = canUseDFG; }
+#endif
+
+        const CompilationStatistics& compilationStatistics() const { return m_compilationStatistics; }
+        void resetCompilationStatistics() { m_compilationStatistics = CompilationStatistics(); }
+        void didCompile(const CompilationStatistics&);
+
         const StackBounds& stack()
         {
             return (globalDataType == Default)
@@ -214,11 +271,15 @@ namespace JSC {
             return jitStubs->ctiStub(this, generator);
         }
         NativeExecutable* getHostFunction(NativeFunction, ThunkGenerator);
+#endif
+#if ENABLE(MEGAMORPHIC_CACHE)
+        MegamorphicCache megamorphicCache;
 #endif
         NativeExecutable* getHostFunction(NativeFunction);
 
         TimeoutChecker timeoutChecker;
         Terminator terminator;
+        SamplingProfiler samplingProfiler;
         Heap heap;
 
         JSValue exception;
@@ -277,6 +338,10 @@ namespace JSC {
 #if ENABLE(JIT) && ENABLE(INTERPRETER)
         bool m_canUseJIT;
 #endif
+#if ENABLE(DFG_JIT)
+        bool m_canUseDFG;
+#endif
+        CompilationStatistics m_compilationStatistics;
         StackBounds m_stack;
     };
 
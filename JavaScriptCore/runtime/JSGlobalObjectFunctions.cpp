@@ -217,10 +217,10 @@ double parseIntOverflow(const UChar* s, int length, int radix)
     return number;
 }
 
-static double parseInt(const UString& s, int radix)
+template<typename CharType>
+static double parseInt(const UString& s, const CharType* data, int radix)
 {
     int length = s.length();
-    const UChar* data = s.characters();
     int p = 0;
 
     while (p < length && isStrWhiteSpace(data[p]))
@@ -275,9 +275,17 @@ static double parseInt(const UString& s, int radix)
     return sign * number;
 }
 
+static double parseInt(const UString& s, int radix)
+{
+    if (s.is8Bit())
+        return parseInt(s, s.characters8(), radix);
+    return parseInt(s, s.characters(), radix);
+}
+
 static const int SizeOfInfinity = 8;
 
-static bool isInfinity(const UChar* data, const UChar* end)
+template<typename CharType>
+static bool isInfinity(const CharType* data, const CharType* end)
 {
     return (end - data) >= SizeOfInfinity
         && data[0] == 'I'
@@ -291,11 +299,12 @@ static bool isInfinity(const UChar* data, const UChar* end)
 }
 
 // See ecma-262 9.3.1
-static double jsHexIntegerLiteral(const UChar*& data, const UChar* end)
+template<typename CharType>
+static double jsHexIntegerLiteral(const CharType*& data, const CharType* end)
 {
     // Hex number.
     data += 2;
-    const UChar* firstDigitPosition = data;
+    const CharType* firstDigitPosition = data;
     double number = 0;
     while (true) {
         number = number * 16 + toASCIIHexValue(*data);
@@ -312,14 +321,15 @@ static double jsHexIntegerLiteral(const UChar*& data, const UChar* end)
 }
 
 // See ecma-262 9.3.1
-static double jsStrDecimalLiteral(const UChar*& data, const UChar* end)
+template<typename CharType>
+static double jsStrDecimalLiteral(const CharType*& data, const CharType* end)
 {
     ASSERT(data < end);
 
     // Copy the sting into a null-terminated byte buffer, and call strtod.
     Vector<char, 32> byteBuffer;
-    for (const UChar* characters = data; characters < end; ++characters) {
-        UChar character = *characters;
+    for (const CharType* characters = data; characters < end; ++characters) {
+        CharType character = *characters;
         byteBuffer.append(isASCII(character) ? character : 0);
     }
     byteBuffer.append(0);
@@ -361,22 +371,10 @@ static double jsStrDecimalLiteral(const UChar*& data, const UChar* end)
     return NaN;
 }
 
-// See ecma-262 9.3.1
-double jsToNumber(const UString& s)
+template<typename CharType>
+static double jsToNumber(const CharType* data, unsigned size)
 {
-    unsigned size = s.length();
-
-    if (size == 1) {
-        UChar c = s.characters()[0];
-        if (isASCIIDigit(c))
-            return c - '0';
-        if (isStrWhiteSpace(c))
-            return 0;
-        return NaN;
-    }
-
-    const UChar* data = s.characters();
-    const UChar* end = data + size;
+    const CharType* end = data + size;
 
     // Skip leading white space.
     for (; data < end; ++data) {
@@ -405,19 +403,29 @@ double jsToNumber(const UString& s)
     return number;
 }
 
-static double parseFloat(const UString& s)
+// See ecma-262 9.3.1
+double jsToNumber(const UString& s)
 {
     unsigned size = s.length();
 
     if (size == 1) {
-        UChar c = s.characters()[0];
+        UChar c = s[0];
         if (isASCIIDigit(c))
             return c - '0';
+        if (isStrWhiteSpace(c))
+            return 0;
         return NaN;
     }
 
-    const UChar* data = s.characters();
-    const UChar* end = data + size;
+    if (s.is8Bit())
+        return jsToNumber(s.characters8(), size);
+    return jsToNumber(s.characters(), size);
+}
+
+template<typename CharType>
+static double parseFloat(const CharType* data, unsigned size)
+{
+    const CharType* end = data + size;
 
     // Skip leading white space.
     for (; data < end; ++data) {
@@ -432,6 +440,22 @@ static double parseFloat(const UString& s)
     return jsStrDecimalLiteral(data, end);
 }
 
+static double parseFloat(const UString& s)
+{
+    unsigned size = s.length();
+
+    if (size == 1) {
+        UChar c = s[0];
+        if (isASCIIDigit(c))
+            return c - '0';
+        return NaN;
+    }
+
+    if (s.is8Bit())
+        return parseFloat(s.characters8(), size);
+    return parseFloat(s.characters(), size);
+}
+
 EncodedJSValue JSC_HOST_CALL globalFuncEval(ExecState* exec)
 {
     JSObject* thisObject = exec->hostThisValue().toThisObject(exec);
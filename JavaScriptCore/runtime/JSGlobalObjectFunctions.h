@@ -54,6 +54,7 @@ namespace JSC {
     static const double mantissaOverflowLowerBound = 9007199254740992.0;
     double parseIntOverflow(const char*, int length, int radix);
     double parseIntOverflow(const UChar*, int length, int radix);
+    inline double parseIntOverflow(const LChar* s, int length, int radix) { return parseIntOverflow(reinterpret_cast<const char*>(s), length, radix); }
     bool isStrWhiteSpace(UChar);
     double jsToNumber(const UString& s);
 
@@ -36,9 +36,13 @@
 #include "LocalScope.h"
 #include "Lookup.h"
 #include "PropertyNameArray.h"
+#include "Strong.h"
 #include "UStringBuilder.h"
 #include "UStringConcatenate.h"
+#include <algorithm>
+#include <wtf/CPUFeatures.h>
 #include <wtf/MathExtras.h>
+#include <wtf/dtoa.h>
 
 namespace JSC {
 
@@ -107,6 +111,10 @@ private:
     friend class Holder;
 
     static void appendQuotedString(UStringBuilder&, const UString&);
+    template<typename CharType> static void appendQuotedCharacters(UStringBuilder&, const CharType*, unsigned length);
+    static void appendNumber(UStringBuilder&, JSValue, double);
+
+    PassRefPtr<PropertyNameArrayData> ownPropertyNames(JSObject*);
 
     JSValue toJSON(JSValue, const PropertyNameForFunctionCall&);
 
@@ -129,6 +137,16 @@ private:
     Vector<Holder, 16> m_holderStack;
     UString m_repeatedGap;
     UString m_indent;
+
+    // Objects that share a Structure have the same own property names, so
+    // the names are collected once per Structure rather than per object.
+    struct PropertyNamesCacheEntry {
+        Strong<Structure> structure;
+        RefPtr<PropertyNameArrayData> propertyNames;
+    };
+    static const unsigned propertyNamesCacheSize = 8;
+    PropertyNamesCacheEntry m_propertyNamesCache[propertyNamesCacheSize];
+    unsigned m_nextPropertyNamesCacheEntry;
 };
 
 // ------------------------------ helper functions --------------------------------
@@ -210,6 +228,7 @@ Stringifier::Stringifier(ExecState* exec, const Local<Unknown>* replacer, const
     , m_arrayReplacerPropertyNames(exec)
     , m_replacerCallType(CallTypeNone)
     , m_gap(gap(exec, space->get()))
+    , m_nextPropertyNamesCacheEntry(0)
 #else
 Stringifier::Stringifier(ExecState* exec, const Local<Unknown>& replacer, const Local<Unknown>& space)
     : m_exec(exec)
@@ -218,6 +237,7 @@ Stringifier::Stringifier(ExecState* exec, const Local<Unknown>& replacer, const
     , m_arrayReplacerPropertyNames(exec)
     , m_replacerCallType(CallTypeNone)
     , m_gap(gap(exec, space.get()))
+    , m_nextPropertyNamesCacheEntry(0)
 #endif
 {
     if (!m_replacer.isObject())
@@ -276,7 +296,17 @@ Local<Unknown> Stringifier::stringify(Handle<Unknown> value)
     object->putDirect(m_exec->globalData(), m_exec->globalData().propertyNames->emptyIdentifier, value.get());
 #endif
 
+    // Large outputs, such as periodic snapshots of the same model, tend to
+    // come back at a similar size, so start from the last large output's
+    // length instead of doubling up to it again. The hint is that length
+    // alone, capped, so a single huge result over-reserves for the next call
+    // only, and toUString() gives back what that call did not use.
+    static const unsigned minimumCapacityHint = 256 * 1024;
+    static const unsigned maximumCapacityHint = 16 * 1024 * 1024;
+    unsigned& capacityHint = m_exec->globalData().jsonStringifyCapacityHint;
     UStringBuilder result;
+    if (capacityHint)
+        result.reserveCapacity(capacityHint + capacityHint / 8);
 #if COMPILER(WINSCW)
     if (appendStringifiedValue(result, value->get(), object, emptyPropertyName) != StringifySucceeded)
 #else
@@ -286,20 +316,76 @@ Local<Unknown> Stringifier::stringify(Handle<Unknown> value)
     if (m_exec->hadException())
         return Local<Unknown>(m_exec->globalData(), jsNull());
 
+    capacityHint = result.length() < minimumCapacityHint ? 0 : std::min(result.length(), maximumCapacityHint);
     return Local<Unknown>(m_exec->globalData(), jsString(m_exec, result.toUString()));
 }
 
+// Returns the index of the first character at or after start that JSON
+// requires to be escaped, or length if there is none.
+static inline unsigned firstCharacterToEscape(const UChar* data, unsigned start, unsigned length)
+{
+    unsigned i = start;
+#if HAVE(SSE2_INTRINSICS)
+    if (length - start >= 8 && isSSE2Present()) {
+        const __m128i quote = _mm_set1_epi16('"');
+        const __m128i backslash = _mm_set1_epi16('\\');
+        const __m128i lastControlCharacter = _mm_set1_epi16(0x1F);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= length; i += 8) {
+            __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // Saturating subtraction leaves zero exactly for 0x00-0x1F.
+            __m128i isControl = _mm_cmpeq_epi16(_mm_subs_epu16(characters, lastControlCharacter), zero);
+            __m128i isSpecial = _mm_or_si128(_mm_cmpeq_epi16(characters, quote), _mm_cmpeq_epi16(characters, backslash));
+            if (_mm_movemask_epi8(_mm_or_si128(isControl, isSpecial)))
+                break;
+        }
+    }
+#endif
+    while (i < length && data[i] > 0x1F && data[i] != '"' && data[i] != '\\')
+        ++i;
+    return i;
+}
+
+static inline unsigned firstCharacterToEscape(const LChar* data, unsigned start, unsigned length)
+{
+    unsigned i = start;
+#if HAVE(SSE2_INTRINSICS)
+    if (length - start >= 16 && isSSE2Present()) {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i lastControlCharacter = _mm_set1_epi8(0x1F);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16) {
+            __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i isControl = _mm_cmpeq_epi8(_mm_subs_epu8(characters, lastControlCharacter), zero);
+            __m128i isSpecial = _mm_or_si128(_mm_cmpeq_epi8(characters, quote), _mm_cmpeq_epi8(characters, backslash));
+            if (_mm_movemask_epi8(_mm_or_si128(isControl, isSpecial)))
+                break;
+        }
+    }
+#endif
+    while (i < length && data[i] > 0x1F && data[i] != '"' && data[i] != '\\')
+        ++i;
+    return i;
+}
+
 void Stringifier::appendQuotedString(UStringBuilder& builder, const UString& value)
 {
-    int length = value.length();
+    // Reading an 8-bit string as 8-bit keeps it from being upconverted.
+    if (value.is8Bit())
+        appendQuotedCharacters(builder, value.characters8(), value.length());
+    else
+        appendQuotedCharacters(builder, value.characters(), value.length());
+}
 
+template<typename CharType>
+void Stringifier::appendQuotedCharacters(UStringBuilder& builder, const CharType* data, unsigned length)
+{
     builder.append('"');
 
-    const UChar* data = value.characters();
-    for (int i = 0; i < length; ++i) {
-        int start = i;
-        while (i < length && (data[i] > 0x1F && data[i] != '"' && data[i] != '\\'))
-            ++i;
+    for (unsigned i = 0; i < length; ++i) {
+        unsigned start = i;
+        i = firstCharacterToEscape(data, i, length);
         builder.append(data + start, i - start);
         if (i >= length)
             break;
@@ -344,6 +430,61 @@ void Stringifier::appendQuotedString(UStringBuilder& builder, const UString& val
     builder.append('"');
 }
 
+void Stringifier::appendNumber(UStringBuilder& builder, JSValue value, double numericValue)
+{
+    if (value.isInt32()) {
+        // Formats without allocating a string for the number.
+        char buffer[12];
+        char* end = buffer + sizeof(buffer);
+        char* p = end;
+        int integer = value.asInt32();
+        unsigned magnitude = integer < 0 ? -static_cast<unsigned>(integer) : integer;
+        do {
+            *--p = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+        if (integer < 0)
+            *--p = '-';
+        builder.append(p, end - p);
+        return;
+    }
+
+    if (!isfinite(numericValue)) {
+        builder.append("null");
+        return;
+    }
+
+    NumberToStringBuffer buffer;
+    unsigned length = numberToString(numericValue, buffer);
+    builder.append(buffer, length);
+}
+
+PassRefPtr<PropertyNameArrayData> Stringifier::ownPropertyNames(JSObject* object)
+{
+    // Unless its class overrides getOwnPropertyNames(), an object's own
+    // property names follow from its Structure, which also fixes its class
+    // and so any static properties. Dictionary Structures change in place.
+    Structure* structure = object->structure();
+    bool cacheable = !structure->typeInfo().overridesGetPropertyNames() && !structure->isDictionary();
+    if (cacheable) {
+        for (unsigned i = 0; i < propertyNamesCacheSize; ++i) {
+            if (m_propertyNamesCache[i].structure.get() == structure)
+                return m_propertyNamesCache[i].propertyNames;
+        }
+    }
+
+    PropertyNameArray objectPropertyNames(m_exec);
+    object->getOwnPropertyNames(m_exec, objectPropertyNames);
+    RefPtr<PropertyNameArrayData> propertyNames = objectPropertyNames.releaseData();
+    if (cacheable) {
+        PropertyNamesCacheEntry& entry = m_propertyNamesCache[m_nextPropertyNamesCacheEntry];
+        m_nextPropertyNamesCacheEntry = (m_nextPropertyNamesCacheEntry + 1) % propertyNamesCacheSize;
+        entry.structure.set(m_exec->globalData(), structure);
+        entry.propertyNames = propertyNames;
+    }
+    return propertyNames.release();
+}
+
 inline JSValue Stringifier::toJSON(JSValue value, const PropertyNameForFunctionCall& propertyName)
 {
     ASSERT(!m_exec->hadException());
@@ -410,10 +551,7 @@ Stringifier::StringifyResult Stringifier::appendStringifiedValue(UStringBuilder&
 
     double numericValue;
     if (value.getNumber(numericValue)) {
-        if (!isfinite(numericValue))
-            builder.append("null");
-        else
-            builder.append(UString::number(numericValue));
+        appendNumber(builder, value, numericValue);
         return StringifySucceeded;
     }
 
@@ -515,11 +653,8 @@ bool Stringifier::Holder::appendNextProperty(Stringifier& stringifier, UStringBu
         } else {
             if (stringifier.m_usingArrayReplacer)
                 m_propertyNames = stringifier.m_arrayReplacerPropertyNames.data();
-            else {
-                PropertyNameArray objectPropertyNames(exec);
-                m_object->getOwnPropertyNames(exec, objectPropertyNames);
-                m_propertyNames = objectPropertyNames.releaseData();
-            }
+            else
+                m_propertyNames = stringifier.ownPropertyNames(m_object.get());
             m_size = m_propertyNames->propertyNameVector().size();
             builder.append('{');
         }
@@ -36,10 +36,54 @@ static const unsigned substringFromRopeCutoff = 4;
 
 const ClassInfo JSString::s_info = { "string", 0, 0, 0 };
 
+static inline void copyCharacters(LChar* destination, StringImpl* string)
+{
+    ASSERT(string->is8Bit());
+    memcpy(destination, string->characters8(), string->length());
+}
+
+static inline void copyCharacters(UChar* destination, StringImpl* string)
+{
+    if (string->is8Bit())
+        StringImpl::copyChars(destination, string->characters8(), string->length());
+    else
+        StringImpl::copyChars(destination, string->characters(), string->length());
+}
+
+// Joining only 8-bit strings keeps the result 8-bit. This visits the rope's
+// nodes, not its characters.
+static bool fibersAre8Bit(RopeImpl::Fiber* fibers, unsigned fiberCount)
+{
+    Vector<RopeImpl::Fiber, 32> workQueue;
+    workQueue.append(fibers, fiberCount);
+    while (!workQueue.isEmpty()) {
+        RopeImpl::Fiber fiber = workQueue.last();
+        workQueue.removeLast();
+        if (RopeImpl::isRope(fiber)) {
+            RopeImpl* rope = static_cast<RopeImpl*>(fiber);
+            workQueue.append(rope->fibers(), rope->fiberCount());
+        } else if (!static_cast<StringImpl*>(fiber)->is8Bit())
+            return false;
+    }
+    return true;
+}
+
 void JSString::resolveRope(ExecState* exec) const
 {
     ASSERT(isRope());
 
+    if (fibersAre8Bit(m_fibers.data(), m_fiberCount)) {
+        LChar* buffer;
+        if (PassRefPtr<StringImpl> newImpl = StringImpl::tryCreateUninitialized(m_length, buffer))
+            m_value = newImpl;
+        else {
+            outOfMemory(exec);
+            return;
+        }
+        resolveRopeSlowCase(exec, buffer);
+        return;
+    }
+
     UChar* buffer;
     if (PassRefPtr<StringImpl> newImpl = StringImpl::tryCreateUninitialized(m_length, buffer))
         m_value = newImpl;
@@ -47,37 +91,7 @@ void JSString::resolveRope(ExecState* exec) const
         outOfMemory(exec);
         return;
     }
-
-    RopeImpl::Fiber currentFiber = m_fibers[0];
-
-    if ((m_fiberCount > 2) || (RopeImpl::isRope(currentFiber)) 
-        || ((m_fiberCount == 2) && (RopeImpl::isRope(m_fibers[1])))) {
-        resolveRopeSlowCase(exec, buffer);
-        return;
-    }
-
-    UChar* position = buffer;
-    StringImpl* string = static_cast<StringImpl*>(currentFiber);
-    unsigned length = string->length();
-    StringImpl::copyChars(position, string->characters(), length);
-
-    if (m_fiberCount > 1) {
-        position += length;
-        currentFiber = m_fibers[1];
-        string = static_cast<StringImpl*>(currentFiber);
-        length = string->length();
-        StringImpl::copyChars(position, string->characters(), length);
-        position += length;
-    }
-
-    ASSERT((buffer + m_length) == position);
-    for (unsigned i = 0; i < m_fiberCount; ++i) {
-        RopeImpl::deref(m_fibers[i]);
-        m_fibers[i] = 0;
-    }
-    m_fiberCount = 0;
-
-    ASSERT(!isRope());
+    resolveRopeSlowCase(exec, buffer);
 }
 
 // Overview: this methods converts a JSString from holding a string in rope form
@@ -90,11 +104,12 @@ void JSString::resolveRope(ExecState* exec) const
 // Vector before performing any concatenation, but by working backwards we likely
 // only fill the queue with the number of substrings at any given level in a
 // rope-of-ropes.)    
-void JSString::resolveRopeSlowCase(ExecState* exec, UChar* buffer) const
+template<typename CharacterType>
+void JSString::resolveRopeSlowCase(ExecState* exec, CharacterType* buffer) const
 {
     UNUSED_PARAM(exec);
 
-    UChar* position = buffer + m_length;
+    CharacterType* position = buffer + m_length;
 
     // Start with the current RopeImpl.
     Vector<RopeImpl::Fiber, 32> workQueue;
@@ -113,9 +128,8 @@ void JSString::resolveRopeSlowCase(ExecState* exec, UChar* buffer) const
             currentFiber = rope->fibers()[fiberCountMinusOne];
         } else {
             StringImpl* string = static_cast<StringImpl*>(currentFiber);
-            unsigned length = string->length();
-            position -= length;
-            StringImpl::copyChars(position, string->characters(), length);
+            position -= string->length();
+            copyCharacters(position, string);
 
             // Was this the last item in the work queue?
             if (workQueue.isEmpty()) {
@@ -194,7 +208,7 @@ JSString* JSString::substringFromRope(ExecState* exec, unsigned substringStart,
 
     if (substringLength == 1) {
         ASSERT(substringFiberCount == 1);
-        UChar c = substringFibers[0].characters()[0];
+        UChar c = substringFibers[0][0];
         if (c <= maxSingleCharacterString)
             return globalData->smallStrings.singleCharacterString(globalData, c);
     }
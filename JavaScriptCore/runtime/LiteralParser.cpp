@@ -29,6 +29,7 @@
 #include "JSArray.h"
 #include "JSString.h"
 #include "Lexer.h"
+#include "Strong.h"
 #include "UStringBuilder.h"
 #include <wtf/ASCIICType.h>
 #include <wtf/dtoa.h>
@@ -141,7 +142,21 @@ template <LiteralParser::ParserMode mode> static inline bool isSafeStringCharact
 template <LiteralParser::ParserMode mode> inline LiteralParser::TokenType LiteralParser::Lexer::lexString(LiteralParserToken& token)
 {
     ++m_ptr;
-    const UChar* runStart;
+    const UChar* runStart = m_ptr;
+
+    // Most strings have nothing to unescape; hand those out in place.
+    while (m_ptr < m_end && isSafeStringCharacter<mode>(*m_ptr))
+        ++m_ptr;
+    if (m_ptr < m_end && *m_ptr == '"') {
+        token.stringCharacters = runStart;
+        token.stringLength = m_ptr - runStart;
+        token.stringToken = UString();
+        token.type = TokString;
+        token.end = ++m_ptr;
+        return TokString;
+    }
+
+    m_ptr = runStart;
     UStringBuilder builder;
     do {
         runStart = m_ptr;
@@ -208,6 +223,8 @@ template <LiteralParser::ParserMode mode> inline LiteralParser::TokenType Litera
         return TokError;
 
     token.stringToken = builder.toUString();
+    token.stringCharacters = token.stringToken.characters();
+    token.stringLength = token.stringToken.length();
     token.type = TokString;
     token.end = ++m_ptr;
     return TokString;
@@ -229,10 +246,14 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
     //
     // -?(0 | [1-9][0-9]*) ('.' [0-9]+)? ([eE][+-]? [0-9]+)?
 
-    if (m_ptr < m_end && *m_ptr == '-') // -?
+    bool negative = false;
+    if (m_ptr < m_end && *m_ptr == '-') { // -?
+        negative = true;
         ++m_ptr;
+    }
     
     // (0 | [1-9][0-9]*)
+    const UChar* digitsStart = m_ptr;
     if (m_ptr < m_end && *m_ptr == '0') // 0
         ++m_ptr;
     else if (m_ptr < m_end && *m_ptr >= '1' && *m_ptr <= '9') { // [1-9]
@@ -243,6 +264,19 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
     } else
         return TokError;
 
+    // Integers that fit in an int are by far the most common numbers in
+    // JSON, and need no trip through strtod.
+    static const int maximumFastIntegerDigits = 9;
+    if (m_ptr - digitsStart <= maximumFastIntegerDigits && (m_ptr >= m_end || (*m_ptr != '.' && *m_ptr != 'e' && *m_ptr != 'E'))) {
+        int result = 0;
+        for (const UChar* digit = digitsStart; digit < m_ptr; ++digit)
+            result = result * 10 + (*digit - '0');
+        token.type = TokNumber;
+        token.end = m_ptr;
+        token.numberToken = negative ? -static_cast<double>(result) : result;
+        return TokNumber;
+    }
+
     // ('.' [0-9]+)?
     if (m_ptr < m_end && *m_ptr == '.') {
         ++m_ptr;
@@ -287,13 +321,113 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
     return TokNumber;
 }
 
+// Remembers the Structure that recent key sequences produced. Records in
+// bulk JSON usually share their keys, so every object after the first is
+// given its final Structure and storage in one step and its values are
+// stored by offset, instead of taking a transition for each key.
+class LiteralParserShapeCache {
+public:
+    LiteralParserShapeCache()
+        : m_nextEntry(0)
+    {
+    }
+
+    JSObject* createObject(ExecState*, const Identifier* keys, const MarkedArgumentBuffer& values, size_t firstValue, size_t count);
+
+private:
+    struct Entry {
+        Vector<StringImpl*, 16> keys;
+        Vector<size_t, 16> offsets;
+        Strong<Structure> structure;
+    };
+
+    static const size_t cacheSize = 8;
+    static const size_t maximumCachedKeyCount = 64;
+
+    Entry m_entries[cacheSize];
+    size_t m_nextEntry;
+};
+
+JSObject* LiteralParserShapeCache::createObject(ExecState* exec, const Identifier* keys, const MarkedArgumentBuffer& values, size_t firstValue, size_t count)
+{
+    JSGlobalData& globalData = exec->globalData();
+    JSObject* object = constructEmptyObject(exec);
+
+    for (size_t i = 0; i < cacheSize; ++i) {
+        Entry& entry = m_entries[i];
+        if (entry.keys.size() != count)
+            continue;
+        size_t matched = 0;
+        while (matched < count && entry.keys[matched] == keys[matched].impl())
+            ++matched;
+        if (matched != count)
+            continue;
+
+        Structure* structure = entry.structure.get();
+        size_t currentCapacity = object->structure()->propertyStorageCapacity();
+        if (currentCapacity != structure->propertyStorageCapacity())
+            object->allocatePropertyStorage(currentCapacity, structure->propertyStorageCapacity());
+        object->setStructure(globalData, structure);
+        for (size_t k = 0; k < count; ++k)
+            object->putDirectOffset(globalData, entry.offsets[k], values.at(firstValue + k));
+        return object;
+    }
+
+    for (size_t k = 0; k < count; ++k)
+        object->putDirect(globalData, keys[k], values.at(firstValue + k));
+
+    // Only cache sequences without repeated keys, which map one key to one
+    // offset.
+    Structure* structure = object->structure();
+    if (!count || count > maximumCachedKeyCount || structure->isDictionary()
+        || structure->propertyStorageSize() - structure->anonymousSlotCount() != count)
+        return object;
+
+    Entry& entry = m_entries[m_nextEntry];
+    m_nextEntry = (m_nextEntry + 1) % cacheSize;
+    entry.keys.resize(count);
+    entry.offsets.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        entry.keys[k] = keys[k].impl();
+        entry.offsets[k] = structure->get(globalData, keys[k]);
+    }
+    entry.structure.set(globalData, structure);
+    return object;
+}
+
+Identifier LiteralParser::makeIdentifier(const Lexer::LiteralParserToken& token)
+{
+    const UChar* characters = token.stringCharacters;
+    unsigned length = token.stringLength;
+    if (!length)
+        return m_exec->globalData().propertyNames->emptyIdentifier;
+
+    Identifier& recent = m_recentIdentifiers[characters[0] & 0x7f];
+    if (!recent.isNull() && Identifier::equal(recent.impl(), characters, length))
+        return recent;
+    recent = Identifier(m_exec, characters, length);
+    return recent;
+}
+
+JSValue LiteralParser::makeString(const Lexer::LiteralParserToken& token)
+{
+    if (token.stringToken.isNull())
+        return jsString(m_exec, UString(StringImpl::create8BitIfPossible(token.stringCharacters, token.stringLength)));
+    return jsString(m_exec, token.stringToken);
+}
+
 JSValue LiteralParser::parse(ParserState initialState)
 {
     ParserState state = initialState;
     MarkedArgumentBuffer objectStack;
     JSValue lastValue;
     Vector<ParserState, 16> stateStack;
+    // Keys and values of the objects being parsed, innermost last. Objects
+    // are only created at their closing brace.
     Vector<Identifier, 16> identifierStack;
+    MarkedArgumentBuffer propertyValueStack;
+    Vector<size_t, 16> objectStartStack;
+    LiteralParserShapeCache shapeCache;
     while (1) {
         switch(state) {
             startParseArray:
@@ -333,9 +467,6 @@ JSValue LiteralParser::parse(ParserState initialState)
             }
             startParseObject:
             case StartParseObject: {
-                JSObject* object = constructEmptyObject(m_exec);
-                objectStack.append(object);
-
                 TokenType type = m_lexer.next();
                 if (type == TokString) {
                     Lexer::LiteralParserToken identifierToken = m_lexer.currentToken();
@@ -345,14 +476,14 @@ JSValue LiteralParser::parse(ParserState initialState)
                         return JSValue();
                     
                     m_lexer.next();
-                    identifierStack.append(Identifier(m_exec, identifierToken.stringToken));
+                    objectStartStack.append(identifierStack.size());
+                    identifierStack.append(makeIdentifier(identifierToken));
                     stateStack.append(DoParseObjectEndExpression);
                     goto startParseExpression;
                 } else if (type != TokRBrace) 
                     return JSValue();
                 m_lexer.next();
-                lastValue = objectStack.last();
-                objectStack.removeLast();
+                lastValue = constructEmptyObject(m_exec);
                 break;
             }
             doParseObjectStartExpression:
@@ -367,21 +498,27 @@ JSValue LiteralParser::parse(ParserState initialState)
                     return JSValue();
 
                 m_lexer.next();
-                identifierStack.append(Identifier(m_exec, identifierToken.stringToken));
+                identifierStack.append(makeIdentifier(identifierToken));
                 stateStack.append(DoParseObjectEndExpression);
                 goto startParseExpression;
             }
             case DoParseObjectEndExpression:
             {
-                asObject(objectStack.last())->putDirect(m_exec->globalData(), identifierStack.last(), lastValue);
-                identifierStack.removeLast();
+                propertyValueStack.append(lastValue);
                 if (m_lexer.currentToken().type == TokComma)
                     goto doParseObjectStartExpression;
                 if (m_lexer.currentToken().type != TokRBrace)
                     return JSValue();
                 m_lexer.next();
-                lastValue = objectStack.last();
-                objectStack.removeLast();
+
+                size_t keyStart = objectStartStack.last();
+                objectStartStack.removeLast();
+                size_t propertyCount = identifierStack.size() - keyStart;
+                size_t valueStart = propertyValueStack.size() - propertyCount;
+                lastValue = shapeCache.createObject(m_exec, identifierStack.data() + keyStart, propertyValueStack, valueStart, propertyCount);
+                identifierStack.shrink(keyStart);
+                while (propertyValueStack.size() > valueStart)
+                    propertyValueStack.removeLast();
                 break;
             }
             startParseExpression:
@@ -394,7 +531,7 @@ JSValue LiteralParser::parse(ParserState initialState)
                     case TokString: {
                         Lexer::LiteralParserToken stringToken = m_lexer.currentToken();
                         m_lexer.next();
-                        lastValue = jsString(m_exec, stringToken.stringToken);
+                        lastValue = makeString(stringToken);
                         break;
                     }
                     case TokNumber: {
@@ -26,6 +26,7 @@
 #ifndef LiteralParser_h
 #define LiteralParser_h
 
+#include "Identifier.h"
 #include "JSGlobalObjectFunctions.h"
 #include "JSValue.h"
 #include "UString.h"
@@ -66,6 +67,10 @@ namespace JSC {
                 TokenType type;
                 const UChar* start;
                 const UChar* end;
+                // The characters of a TokString. When the literal has no
+                // escapes they point into the source and stringToken is null.
+                const UChar* stringCharacters;
+                unsigned stringLength;
                 UString stringToken;
                 double numberToken;
             };
@@ -100,10 +105,15 @@ namespace JSC {
         
         class StackGuard;
         JSValue parse(ParserState);
+        Identifier makeIdentifier(const Lexer::LiteralParserToken&);
+        JSValue makeString(const Lexer::LiteralParserToken&);
 
         ExecState* m_exec;
         LiteralParser::Lexer m_lexer;
         ParserMode m_mode;
+        // Object keys repeat from record to record, so remember the last key
+        // seen for each leading character rather than hashing it again.
+        Identifier m_recentIdentifiers[128];
     };
 }
 
@@ -42,6 +42,12 @@ GlobalMemoryStatistics globalMemoryStatistics()
 #else
     stats.JITBytes = 0;
 #endif
+
+    // Bytes sitting in free lists are committed but not in use; for a
+    // breakdown by size class see WTF::fastMallocSizeClassStatistics().
+    WTF::FastMallocStatistics fastMallocStats = WTF::fastMallocStatistics();
+    stats.fastMallocCommittedBytes = fastMallocStats.committedVMBytes;
+    stats.fastMallocFreeListBytes = fastMallocStats.freeListBytes;
     return stats;
 }
 
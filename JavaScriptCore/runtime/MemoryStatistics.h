@@ -35,6 +35,8 @@ namespace JSC {
 struct GlobalMemoryStatistics {
     size_t stackBytes;
     size_t JITBytes;
+    size_t fastMallocCommittedBytes;
+    size_t fastMallocFreeListBytes;
 };
 
 GlobalMemoryStatistics globalMemoryStatistics();
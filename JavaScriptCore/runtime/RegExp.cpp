@@ -39,7 +39,7 @@ RegExpFlags regExpFlags(const UString& string)
     RegExpFlags flags = NoFlags;
 
     for (unsigned i = 0; i < string.length(); ++i) {
-        switch (string.characters()[i]) {
+        switch (string[i]) {
         case 'g':
             if (flags & FlagGlobal)
                 return InvalidFlags;
@@ -130,6 +130,18 @@ RegExp::RegExpState RegExp::compile(JSGlobalData* globalData)
     return res;
 }
 
+size_t RegExp::compiledSizeInBytes() const
+{
+    size_t size = sizeof(RegExp) + sizeof(RegExpRepresentation);
+#if ENABLE(YARR_JIT)
+    if (m_state == JITCode)
+        size += m_representation->m_regExpJITCode.size();
+#endif
+    if (m_representation->m_regExpBytecode)
+        size += m_representation->m_regExpBytecode->sizeInBytes();
+    return size;
+}
+
 int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
 {
     if (startOffset < 0)
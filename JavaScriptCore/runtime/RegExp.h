@@ -51,6 +51,9 @@ namespace JSC {
 
         int match(const UString&, int startOffset, Vector<int, 32>* ovector = 0);
         unsigned numSubpatterns() const { return m_numSubpatterns; }
+
+        // Memory held by the compiled pattern: JIT code or bytecode.
+        size_t compiledSizeInBytes() const;
         
 #if ENABLE(REGEXP_TRACING)
         void printTraceData();
@@ -29,49 +29,72 @@
 
 #include "RegExpCache.h"
 
+#include "JSGlobalData.h"
+#include <wtf/CurrentTime.h>
+
 namespace JSC {
 
-PassRefPtr<RegExp> RegExpCache::lookupOrCreate(const UString& patternString, RegExpFlags flags)
+RegExpCache::RegExpCache(JSGlobalData* globalData)
+    : m_capacity(defaultCapacity)
+    , m_globalData(globalData)
+    , m_statistics(globalData->regExpCacheStatistics)
 {
-    if (patternString.length() < maxCacheablePatternLength) {
-        pair<RegExpCacheMap::iterator, bool> result = m_cacheMap.add(RegExpKey(flags, patternString), 0);
-        if (!result.second)
-            return result.first->second;
-        else
-            return create(patternString, flags, result.first);
-    }
-    return create(patternString, flags, m_cacheMap.end());
 }
 
-PassRefPtr<RegExp> RegExpCache::create(const UString& patternString, RegExpFlags flags, RegExpCacheMap::iterator iterator) 
+RegExpCache::~RegExpCache()
+{
+    deleteAllValues(m_cacheMap);
+}
+
+PassRefPtr<RegExp> RegExpCache::lookupOrCreate(const UString& patternString, RegExpFlags flags)
 {
+    RegExpKey key(flags, patternString);
+    RegExpCacheMap::iterator iterator = m_cacheMap.find(key);
+    if (iterator != m_cacheMap.end()) {
+        ++m_statistics.hits;
+        Entry* entry = iterator->second;
+        m_entries.remove(entry);
+        m_entries.append(entry);
+        return entry->regExp;
+    }
+
+    ++m_statistics.misses;
+    double compileStart = currentTime();
     RefPtr<RegExp> regExp = RegExp::create(m_globalData, patternString, flags);
+    m_statistics.compileTime += currentTime() - compileStart;
 
-    if (patternString.length() >= maxCacheablePatternLength)
-        return regExp;
+    size_t size = regExp->compiledSizeInBytes() + patternString.length() * sizeof(UChar);
+    if (size > maxCacheableEntryBytes())
+        return regExp.release();
 
-    RegExpKey key = RegExpKey(flags, patternString);
-    iterator->first = key;
-    iterator->second = regExp;
+    while (m_statistics.cachedBytes + size > m_capacity)
+        evictLeastRecentlyUsed();
 
-    ++m_nextKeyToEvict;
-    if (m_nextKeyToEvict == maxCacheableEntries) {
-        m_nextKeyToEvict = 0;
-        m_isFull = true;
-    }
-    if (m_isFull)
-        m_cacheMap.remove(RegExpKey(patternKeyArray[m_nextKeyToEvict].flagsValue, patternKeyArray[m_nextKeyToEvict].pattern));
+    Entry* entry = new Entry(key, regExp, size);
+    m_cacheMap.set(key, entry);
+    m_entries.append(entry);
+    ++m_statistics.entries;
+    m_statistics.cachedBytes += size;
+    return regExp.release();
+}
 
-    patternKeyArray[m_nextKeyToEvict].flagsValue = key.flagsValue;
-    patternKeyArray[m_nextKeyToEvict].pattern = patternString.impl();
-    return regExp;
+void RegExpCache::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+    while (m_statistics.cachedBytes > m_capacity)
+        evictLeastRecentlyUsed();
 }
 
-RegExpCache::RegExpCache(JSGlobalData* globalData)
-    : m_globalData(globalData)
-    , m_nextKeyToEvict(-1)
-    , m_isFull(false)
+void RegExpCache::evictLeastRecentlyUsed()
 {
+    Entry* entry = m_entries.head();
+    ASSERT(entry);
+    m_entries.remove(entry);
+    m_cacheMap.remove(entry->key);
+    ++m_statistics.evictions;
+    --m_statistics.entries;
+    m_statistics.cachedBytes -= entry->size;
+    delete entry;
 }
 
 }
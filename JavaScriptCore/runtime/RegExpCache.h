@@ -28,7 +28,7 @@
 #include "RegExp.h"
 #include "RegExpKey.h"
 #include "UString.h"
-#include <wtf/FixedArray.h>
+#include <wtf/DoublyLinkedList.h>
 #include <wtf/HashMap.h>
 
 #ifndef RegExpCache_h
@@ -36,31 +36,72 @@
 
 namespace JSC {
 
-class RegExpCache {
-
-typedef HashMap<RegExpKey, RefPtr<RegExp> > RegExpCacheMap;
+struct RegExpCacheStatistics;
 
+// Keeps recently used RegExps alive so that pages which build the same
+// pattern over and over compile it once. The cache is bounded by the memory
+// the compiled patterns hold, not by how many there are, and evicts the
+// least recently used entry first. Counters are kept in
+// JSGlobalData::regExpCacheStatistics.
+class RegExpCache {
 public:
-    PassRefPtr<RegExp> lookupOrCreate(const UString& patternString, RegExpFlags);
-    PassRefPtr<RegExp> create(const UString& patternString, RegExpFlags, RegExpCacheMap::iterator);
     RegExpCache(JSGlobalData* globalData);
+    ~RegExpCache();
 
-private:
-    static const unsigned maxCacheablePatternLength = 256;
+    PassRefPtr<RegExp> lookupOrCreate(const UString& patternString, RegExpFlags);
 
 #if PLATFORM(IOS)
     // The RegExpCache can currently hold onto multiple Mb of memory;
     // as a short-term fix some embedded platforms may wish to reduce the cache size.
-    static const int maxCacheableEntries = 32;
+    static const size_t defaultCapacity = 256 * 1024;
 #else
-    static const int maxCacheableEntries = 256;
+    static const size_t defaultCapacity = 2 * 1024 * 1024;
 #endif
 
-    FixedArray<RegExpKey, maxCacheableEntries> patternKeyArray;
+    // The most bytes the cached patterns may hold. Lowering it evicts at once.
+    size_t capacity() const { return m_capacity; }
+    void setCapacity(size_t);
+
+private:
+    class Entry {
+    public:
+        Entry(const RegExpKey& key, PassRefPtr<RegExp> regExp, size_t size)
+            : key(key)
+            , regExp(regExp)
+            , size(size)
+            , m_prev(0)
+            , m_next(0)
+        {
+        }
+
+        Entry* prev() const { return m_prev; }
+        Entry* next() const { return m_next; }
+        void setPrev(Entry* prev) { m_prev = prev; }
+        void setNext(Entry* next) { m_next = next; }
+
+        RegExpKey key;
+        RefPtr<RegExp> regExp;
+        size_t size;
+
+    private:
+        Entry* m_prev;
+        Entry* m_next;
+    };
+
+    typedef HashMap<RegExpKey, Entry*> RegExpCacheMap;
+
+    void evictLeastRecentlyUsed();
+
+    // A single pattern may not take more than this share of the cache, so
+    // one huge expression cannot flush everything else.
+    size_t maxCacheableEntryBytes() const { return m_capacity / 16; }
+
+    size_t m_capacity;
     RegExpCacheMap m_cacheMap;
+    // Least recently used first.
+    DoublyLinkedList<Entry> m_entries;
     JSGlobalData* m_globalData;
-    int m_nextKeyToEvict;
-    bool m_isFull;
+    RegExpCacheStatistics& m_statistics;
 };
 
 } // namespace JSC
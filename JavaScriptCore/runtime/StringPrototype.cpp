@@ -512,7 +512,7 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncCharCodeAt(ExecState* exec)
     if (a0.isUInt32()) {
         uint32_t i = a0.asUInt32();
         if (i < len)
-            return JSValue::encode(jsNumber(s.characters()[i]));
+            return JSValue::encode(jsNumber(s[i]));
         return JSValue::encode(jsNaN());
     }
     double dpos = a0.toInteger(exec);
@@ -675,8 +675,16 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncSlice(ExecState* exec)
     JSValue thisValue = exec->hostThisValue();
     if (thisValue.isUndefinedOrNull()) // CheckObjectCoercible
         return throwVMTypeError(exec);
-    UString s = thisValue.toThisString(exec);
-    int len = s.length();
+    int len;
+    JSString* jsString = 0;
+    UString uString;
+    if (thisValue.isString()) {
+        jsString = static_cast<JSString*>(thisValue.asCell());
+        len = jsString->length();
+    } else {
+        uString = thisValue.toThisObject(exec)->toString(exec);
+        len = uString.length();
+    }
 
     JSValue a0 = exec->argument(0);
     JSValue a1 = exec->argument(1);
@@ -691,7 +699,11 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncSlice(ExecState* exec)
             from = 0;
         if (to > len)
             to = len;
-        return JSValue::encode(jsSubstring(exec, s, static_cast<unsigned>(from), static_cast<unsigned>(to) - static_cast<unsigned>(from)));
+        unsigned substringStart = static_cast<unsigned>(from);
+        unsigned substringLength = static_cast<unsigned>(to) - substringStart;
+        if (jsString)
+            return JSValue::encode(jsSubstring(exec, jsString, substringStart, substringLength));
+        return JSValue::encode(jsSubstring(exec, uString, substringStart, substringLength));
     }
 
     return JSValue::encode(jsEmptyString(exec));
@@ -857,6 +869,14 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncToLowerCase(ExecState* exec)
     if (!sSize)
         return JSValue::encode(sVal);
 
+    // Case-map 8-bit strings without widening them.
+    if (s.is8Bit()) {
+        RefPtr<StringImpl> result = s.impl()->lower();
+        if (result == s.impl())
+            return JSValue::encode(sVal);
+        return JSValue::encode(jsString(exec, UString(result.release())));
+    }
+
     const UChar* sData = s.characters();
     Vector<UChar> buffer(sSize);
 
@@ -897,6 +917,14 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncToUpperCase(ExecState* exec)
     if (!sSize)
         return JSValue::encode(sVal);
 
+    // Case-map 8-bit strings without widening them.
+    if (s.is8Bit()) {
+        RefPtr<StringImpl> result = s.impl()->upper();
+        if (result == s.impl())
+            return JSValue::encode(sVal);
+        return JSValue::encode(jsString(exec, UString(result.release())));
+    }
+
     const UChar* sData = s.characters();
     Vector<UChar> buffer(sSize);
 
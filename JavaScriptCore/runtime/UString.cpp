@@ -89,9 +89,9 @@ UString::UString(const char* characters)
 
 UString UString::number(int i)
 {
-    UChar buf[1 + sizeof(i) * 3];
-    UChar* end = buf + WTF_ARRAY_LENGTH(buf);
-    UChar* p = end;
+    LChar buf[1 + sizeof(i) * 3];
+    LChar* end = buf + WTF_ARRAY_LENGTH(buf);
+    LChar* p = end;
 
     if (i == 0)
         *--p = '0';
@@ -106,21 +106,21 @@ UString UString::number(int i)
             i = -i;
         }
         while (i) {
-            *--p = static_cast<unsigned short>((i % 10) + '0');
+            *--p = static_cast<LChar>((i % 10) + '0');
             i /= 10;
         }
         if (negative)
             *--p = '-';
     }
 
-    return UString(p, static_cast<unsigned>(end - p));
+    return UString(StringImpl::create(p, static_cast<unsigned>(end - p)));
 }
 
 UString UString::number(long long i)
 {
-    UChar buf[1 + sizeof(i) * 3];
-    UChar* end = buf + WTF_ARRAY_LENGTH(buf);
-    UChar* p = end;
+    LChar buf[1 + sizeof(i) * 3];
+    LChar* end = buf + WTF_ARRAY_LENGTH(buf);
+    LChar* p = end;
 
     if (i == 0)
         *--p = '0';
@@ -139,39 +139,39 @@ UString UString::number(long long i)
             i = -i;
         }
         while (i) {
-            *--p = static_cast<unsigned short>((i % 10) + '0');
+            *--p = static_cast<LChar>((i % 10) + '0');
             i /= 10;
         }
         if (negative)
             *--p = '-';
     }
 
-    return UString(p, static_cast<unsigned>(end - p));
+    return UString(StringImpl::create(p, static_cast<unsigned>(end - p)));
 }
 
 UString UString::number(unsigned u)
 {
-    UChar buf[sizeof(u) * 3];
-    UChar* end = buf + WTF_ARRAY_LENGTH(buf);
-    UChar* p = end;
+    LChar buf[sizeof(u) * 3];
+    LChar* end = buf + WTF_ARRAY_LENGTH(buf);
+    LChar* p = end;
 
     if (u == 0)
         *--p = '0';
     else {
         while (u) {
-            *--p = static_cast<unsigned short>((u % 10) + '0');
+            *--p = static_cast<LChar>((u % 10) + '0');
             u /= 10;
         }
     }
 
-    return UString(p, static_cast<unsigned>(end - p));
+    return UString(StringImpl::create(p, static_cast<unsigned>(end - p)));
 }
 
 UString UString::number(long l)
 {
-    UChar buf[1 + sizeof(l) * 3];
-    UChar* end = buf + WTF_ARRAY_LENGTH(buf);
-    UChar* p = end;
+    LChar buf[1 + sizeof(l) * 3];
+    LChar* end = buf + WTF_ARRAY_LENGTH(buf);
+    LChar* p = end;
 
     if (l == 0)
         *--p = '0';
@@ -186,21 +186,21 @@ UString UString::number(long l)
             l = -l;
         }
         while (l) {
-            *--p = static_cast<unsigned short>((l % 10) + '0');
+            *--p = static_cast<LChar>((l % 10) + '0');
             l /= 10;
         }
         if (negative)
             *--p = '-';
     }
 
-    return UString(p, end - p);
+    return UString(StringImpl::create(p, static_cast<unsigned>(end - p)));
 }
 
 UString UString::number(double d)
 {
     NumberToStringBuffer buffer;
     unsigned length = numberToString(d, buffer);
-    return UString(buffer, length);
+    return UString(StringImpl::create8BitIfPossible(buffer, length));
 }
 
 UString UString::substringSharingImpl(unsigned offset, unsigned length) const
@@ -235,40 +235,12 @@ bool operator==(const UString& s1, const char *s2)
 
 bool operator<(const UString& s1, const UString& s2)
 {
-    const unsigned l1 = s1.length();
-    const unsigned l2 = s2.length();
-    const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1.characters();
-    const UChar* c2 = s2.characters();
-    unsigned l = 0;
-    while (l < lmin && *c1 == *c2) {
-        c1++;
-        c2++;
-        l++;
-    }
-    if (l < lmin)
-        return (c1[0] < c2[0]);
-
-    return (l1 < l2);
+    return codePointCompare(s1, s2) < 0;
 }
 
 bool operator>(const UString& s1, const UString& s2)
 {
-    const unsigned l1 = s1.length();
-    const unsigned l2 = s2.length();
-    const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1.characters();
-    const UChar* c2 = s2.characters();
-    unsigned l = 0;
-    while (l < lmin && *c1 == *c2) {
-        c1++;
-        c2++;
-        l++;
-    }
-    if (l < lmin)
-        return (c1[0] > c2[0]);
-
-    return (l1 > l2);
+    return codePointCompare(s1, s2) > 0;
 }
 
 CString UString::ascii() const
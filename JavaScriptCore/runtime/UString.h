@@ -76,6 +76,9 @@ public:
         return m_impl->characters();
     }
 
+    bool is8Bit() const { return m_impl && m_impl->is8Bit(); }
+    const LChar* characters8() const { return m_impl->characters8(); }
+
     CString ascii() const;
     CString latin1() const;
     CString utf8(bool strict = false) const;
@@ -84,7 +87,7 @@ public:
     {
         if (!m_impl || index >= m_impl->length())
             return 0;
-        return m_impl->characters()[index];
+        return (*m_impl)[index];
     }
 
     static UString number(int);
@@ -134,6 +137,9 @@ ALWAYS_INLINE bool operator==(const UString& s1, const UString& s2)
     
     if (!size1)
         return true;
+
+    if (rep1->is8Bit() || rep2->is8Bit())
+        return equalCharacters(rep1, rep2);
     
     // At this point we know 
     //   (a) that the strings are the same length and
@@ -151,7 +157,10 @@ ALWAYS_INLINE bool operator==(const UString& s1, const UString& s2)
     case 2:
         return (d1[0] == d2[0]) & (d1[1] == d2[1]);
     default:
-        return memcmp(d1, d2, size1 * sizeof(UChar)) == 0;
+        // Short compares stay inline; StringHash makes the same cut.
+        if (size1 < 16)
+            return !memcmp(d1, d2, size1 * sizeof(UChar));
+        return WTF::equal(d1, d2, size1);
     }
 }
 
@@ -200,6 +209,9 @@ struct UStringHash {
         if (aLength != bLength)
             return false;
 
+        if (a->is8Bit() || b->is8Bit())
+            return equalCharacters(a, b);
+
         // FIXME: perhaps we should have a more abstract macro that indicates when
         // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS) || CPU(SPARC)
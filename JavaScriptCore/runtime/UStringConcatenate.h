@@ -35,7 +35,7 @@ template<>
 class StringTypeAdapter<JSC::UString> {
 public:
     StringTypeAdapter<JSC::UString>(JSC::UString& string)
-        : m_data(string.characters())
+        : m_string(string)
         , m_length(string.length())
     {
     }
@@ -44,12 +44,19 @@ public:
 
     void writeTo(UChar* destination)
     {
+        if (m_string.is8Bit()) {
+            const LChar* data = m_string.characters8();
+            for (unsigned i = 0; i < m_length; ++i)
+                destination[i] = data[i];
+            return;
+        }
+        const UChar* data = m_string.characters();
         for (unsigned i = 0; i < m_length; ++i)
-            destination[i] = m_data[i];
+            destination[i] = data[i];
     }
 
 private:
-    const UChar* m_data;
+    const JSC::UString& m_string;
     unsigned m_length;
 };
 
@@ -107,8 +107,40 @@ inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_
 
 #endif
 
+#if OS(WINDOWS)
+#define WTF_USE_COMPARE_AND_SWAP 1
+
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue)
+{
+    return InterlockedCompareExchange(reinterpret_cast<long volatile*>(location), static_cast<long>(newValue), static_cast<long>(expected)) == static_cast<long>(expected);
+}
+
+inline bool weakCompareAndSwap(void* volatile* location, void* expected, void* newValue)
+{
+    return InterlockedCompareExchangePointer(location, newValue, expected) == expected;
+}
+
+#elif COMPILER(GCC) && !OS(SYMBIAN) && !OS(ANDROID)
+#define WTF_USE_COMPARE_AND_SWAP 1
+
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue)
+{
+    return __sync_bool_compare_and_swap(location, expected, newValue);
+}
+
+inline bool weakCompareAndSwap(void* volatile* location, void* expected, void* newValue)
+{
+    return __sync_bool_compare_and_swap(location, expected, newValue);
+}
+
+#endif
+
 } // namespace WTF
 
+#if USE(COMPARE_AND_SWAP)
+using WTF::weakCompareAndSwap;
+#endif
+
 #if USE(LOCKFREE_THREADSAFEREFCOUNTED)
 using WTF::atomicDecrement;
 using WTF::atomicIncrement;
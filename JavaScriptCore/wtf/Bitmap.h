@@ -19,6 +19,7 @@
 #ifndef Bitmap_h
 #define Bitmap_h
 
+#include "Atomics.h"
 #include "FixedArray.h"
 #include "StdLibExtras.h"
 #include <stdint.h>
@@ -37,6 +38,11 @@ public:
     bool get(size_t) const;
     void set(size_t);
     bool testAndSet(size_t);
+#if USE(COMPARE_AND_SWAP)
+    // Like testAndSet(), but safe against other threads setting bits in the
+    // same word at the same time.
+    bool concurrentTestAndSet(size_t);
+#endif
     size_t nextPossiblyUnset(size_t) const;
     void clear(size_t);
     void clearAll();
@@ -87,6 +93,22 @@ inline bool Bitmap<size>::testAndSet(size_t n)
     return result;
 }
 
+#if USE(COMPARE_AND_SWAP)
+template<size_t size>
+inline bool Bitmap<size>::concurrentTestAndSet(size_t n)
+{
+    WordType mask = one << (n % wordSize);
+    volatile WordType* word = bits.data() + n / wordSize;
+    WordType oldValue;
+    do {
+        oldValue = *word;
+        if (oldValue & mask)
+            return true;
+    } while (!weakCompareAndSwap(reinterpret_cast<volatile unsigned*>(word), oldValue, oldValue | mask));
+    return false;
+}
+#endif
+
 template<size_t size>
 inline void Bitmap<size>::clear(size_t n)
 {
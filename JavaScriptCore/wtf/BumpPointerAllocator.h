@@ -31,6 +31,7 @@
 namespace WTF {
 
 #define MINIMUM_BUMP_POOL_SIZE 0x1000
+#define MAXIMUM_RETAINED_BUMP_POOL_SIZE 0x40000
 
 class BumpPointerPool {
 public:
@@ -125,6 +126,11 @@ private:
         return 0;
     }
 
+    size_t capacity() const
+    {
+        return static_cast<const char*>(static_cast<const void*>(this)) - static_cast<const char*>(m_start);
+    }
+
     void shrink()
     {
         ASSERT(!m_previous);
@@ -164,6 +170,9 @@ private:
             ASSERT(allocationEnd > current); // check for overflow
             if (allocationEnd <= static_cast<void*>(pool))
                 return pool;
+
+            previousPool = pool;
+            pool = pool->m_next;
         }
     }
 
@@ -211,6 +220,12 @@ private:
 // (In practice we will still hold on to the initial pool to allow allocation
 // to be quickly restared, but aditional pools will be freed).
 //
+// If a run needed more than the initial pool, the pool is replaced on
+// stopAllocator() by one big enough for all that run used (up to
+// MAXIMUM_RETAINED_BUMP_POOL_SIZE), so that later runs of the same kind
+// allocate from a single flat pool. Clients that know how much they will
+// need can also ask for it up front in startAllocator().
+//
 // This allocator is non-renetrant, it is encumbant on the clients to ensure
 // startAllocator() is not called again until stopAllocator() has been called.
 class BumpPointerAllocator {
@@ -226,17 +241,33 @@ public:
             m_head->destroy();
     }
 
-    BumpPointerPool* startAllocator()
+    BumpPointerPool* startAllocator(size_t minimumCapacity = 0)
     {
+        if (m_head && m_head->capacity() < minimumCapacity && minimumCapacity <= MAXIMUM_RETAINED_BUMP_POOL_SIZE) {
+            m_head->destroy();
+            m_head = 0;
+        }
         if (!m_head)
-            m_head = BumpPointerPool::create();
+            m_head = BumpPointerPool::create(minimumCapacity <= MAXIMUM_RETAINED_BUMP_POOL_SIZE ? minimumCapacity : 0);
         return m_head;
     }
 
     void stopAllocator()
     {
-        if (m_head)
-            m_head->shrink();
+        if (!m_head)
+            return;
+
+        size_t usedCapacity = 0;
+        for (BumpPointerPool* pool = m_head; pool; pool = pool->m_next)
+            usedCapacity += pool->capacity();
+        m_head->shrink();
+
+        if (usedCapacity > m_head->capacity() && usedCapacity <= MAXIMUM_RETAINED_BUMP_POOL_SIZE) {
+            if (BumpPointerPool* pool = BumpPointerPool::create(usedCapacity)) {
+                m_head->destroy();
+                m_head = pool;
+            }
+        }
     }
 
 private:
@@ -0,0 +1,41 @@
+#ifndef WTF_CPUFeatures_h
+#define WTF_CPUFeatures_h
+
+#include <wtf/Platform.h>
+
+// SSE2 intrinsics compile with every x86 compiler we build with. On 32-bit
+// x86 code using them must still check isSSE2Present() before running them.
+#if CPU(X86_64) || (CPU(X86) && (COMPILER(MSVC) || defined(__SSE2__)))
+#define HAVE_SSE2_INTRINSICS 1
+#include <emmintrin.h>
+#if COMPILER(MSVC)
+#include <intrin.h>
+#endif
+#endif
+
+namespace WTF {
+
+inline bool isSSE2Present()
+{
+#if CPU(X86_64) || defined(__SSE2__)
+    return true;
+#elif HAVE(SSE2_INTRINSICS) && COMPILER(MSVC)
+    // Races only ever store the same answer.
+    static int sse2State = -1;
+    if (sse2State < 0) {
+        int registers[4];
+        __cpuid(registers, 1);
+        static const int sse2FeatureBit = 1 << 26;
+        sse2State = (registers[3] & sse2FeatureBit) ? 1 : 0;
+    }
+    return sse2State;
+#else
+    return false;
+#endif
+}
+
+} // namespace WTF
+
+using WTF::isSSE2Present;
+
+#endif // WTF_CPUFeatures_h
@@ -97,8 +97,10 @@
 #endif
 
 // weolar
+#if !OS(LINUX)
 #undef  FORCE_SYSTEM_MALLOC
 #define FORCE_SYSTEM_MALLOC 1
+#endif
 
 int g_Weolar = 0;
 
@@ -385,6 +387,10 @@ FastMallocStatistics fastMallocStatistics()
     return statistics;
 }
 
+size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics*, size_t) { return 0; }
+
+void setFastMallocTransferBatchSize(size_t, size_t) { }
+
 size_t fastMallocSize(const void* p)
 {
 #if ENABLE(WTF_MALLOC_VALIDATION)
@@ -425,7 +431,9 @@ extern "C" const int jscore_fastmalloc_introspection = 0;
 #include "TCSystemAlloc.h"
 #include <algorithm>
 #include <limits>
-//#include <pthread.h>
+#if !OS(WINDOWS)
+#include <pthread.h>
+#endif
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -640,7 +648,13 @@ static const size_t kMinSystemAlloc = 1 << (20 - kPageShift);
 // amortize the lock overhead for accessing the central list.  Making
 // it too big may temporarily cause unnecessary memory wastage in the
 // per-thread free list until the scavenger cleans up the list.
-static int num_objects_to_move[kNumClasses];
+//
+// An entry is only written under its central list's lock_, by
+// SetTransferBatchSize().  Thread caches read it without locking, each read
+// once into a local, so a cache may pass the old size to InsertRange() or
+// RemoveRange() after a change.  Both compare it again under lock_ and move
+// objects through the spans instead when it no longer matches.
+static volatile int num_objects_to_move[kNumClasses];
 
 // Maximum length we allow a per-thread free-list to have before we
 // move objects from it into the corresponding central free-list.  We
@@ -649,8 +663,25 @@ static int num_objects_to_move[kNumClasses];
 // scavenging code will shrink it down when its contents are not in use.
 static const int kMaxFreeListLength = 256;
 
-// Lower and upper bounds on the per-thread cache sizes
+// Default bounds on a transfer between a per-thread list and a central
+// list.  setFastMallocTransferBatchSize() can change them at runtime.
+static const size_t kDefaultTransferBatchBytes = 64 * 1024;
+static const int kDefaultTransferBatchObjects = 32;
+static size_t transfer_batch_bytes = kDefaultTransferBatchBytes;
+static int transfer_batch_objects = kDefaultTransferBatchObjects;
+
+// Protects transfer_batch_bytes and transfer_batch_objects above
+static SpinLock transfer_batch_lock = SPINLOCK_INITIALIZER;
+
+// Lower and upper bounds on the per-thread cache sizes.  Linux servers run
+// many allocating worker threads; the larger lower bound there lets the
+// overall budget grow with the thread count instead of dividing it into
+// caches too small to avoid the central lists.
+#if OS(LINUX)
+static const size_t kMinThreadCacheSize = 256 << 10;
+#else
 static const size_t kMinThreadCacheSize = kMaxSize * 2;
+#endif
 static const size_t kMaxThreadCacheSize = 2 << 20;
 
 // Default bound on the total amount of thread caches
@@ -840,8 +871,8 @@ static ALWAYS_INLINE size_t ByteSizeForClass(size_t cl) {
 }
 static int NumMoveSize(size_t size) {
   if (size == 0) return 0;
-  // Use approx 64k transfers between thread and central caches.
-  int num = static_cast<int>(64.0 * 1024.0 / size);
+  // Use approx transfer_batch_bytes transfers between thread and central caches.
+  int num = static_cast<int>(static_cast<double>(transfer_batch_bytes) / size);
   if (num < 2) num = 2;
   // Clamp well below kMaxFreeListLength to avoid ping pong between central
   // and thread caches.
@@ -856,7 +887,7 @@ static int NumMoveSize(size_t size) {
   //
   // TODO: Make thread cache free list sizes dynamic so that we do not
   // have to equally divide a fixed resource amongst lots of threads.
-  if (num > 32) num = 32;
+  if (num > transfer_batch_objects) num = transfer_batch_objects;
 
   return num;
 }
@@ -2343,6 +2374,15 @@ class TCMalloc_Central_FreeList {
     return used_slots_ * num_objects_to_move[size_class_];
   }
 
+  // Changes the number of objects moved per transfer for this size class.
+  // Chains cached at the old size are released to the spans.
+  void SetTransferBatchSize(int N);
+
+  // Returns the bytes of pages held by this size class and the number of
+  // objects handed out of its spans, which includes objects sitting in the
+  // transfer cache (also returned) and in thread caches.
+  void SpanStatistics(size_t* committedBytes, size_t* allocatedObjects, size_t* transferObjects);
+
 #ifdef WTF_CHANGES
   template <class Finder, class Reader>
   void enumerateFreeObjects(Finder& finder, const Reader& reader, TCMalloc_Central_FreeList* remoteCentralFreeList)
@@ -2540,8 +2580,8 @@ static __thread TCMalloc_ThreadCache *threadlocal_heap;
 static bool tsd_inited = false;
 #if USE(PTHREAD_GETSPECIFIC_DIRECT)
 static const pthread_key_t heap_key = __PTK_FRAMEWORK_JAVASCRIPTCORE_KEY0;
-#else
-//static pthread_key_t heap_key;
+#elif !OS(WINDOWS)
+static pthread_key_t heap_key;
 #endif
 #if OS(WINDOWS)
 DWORD tlsIndex = TLS_OUT_OF_INDEXES;
@@ -2558,11 +2598,10 @@ static ALWAYS_INLINE void setThreadHeap(TCMalloc_ThreadCache* heap)
 
     // Still do pthread_setspecific even if there's an alternate form
     // of thread-local storage in use, to benefit from the delete callback.
-//    pthread_setspecific(heap_key, heap);
-    //__asm int 3; // Weolar
-
 #if OS(WINDOWS)
     TlsSetValue(tlsIndex, heap);
+#else
+    pthread_setspecific(heap_key, heap);
 #endif
 }
 
@@ -2736,6 +2775,42 @@ void TCMalloc_Central_FreeList::InsertRange(void *start, void *end, int N) {
   ReleaseListToSpans(start);
 }
 
+// Other threads may be running their caches meanwhile; see
+// num_objects_to_move for why they need not stop.
+void TCMalloc_Central_FreeList::SetTransferBatchSize(int N) {
+  SpinLockHolder h(&lock_);
+  if (N == num_objects_to_move[size_class_]) return;
+
+  // RemoveRange hands out cached chains without counting them, so no chain
+  // of the old size may survive the change.  Detach them all before
+  // ReleaseListToSpans gets a chance to drop the lock.
+  num_objects_to_move[size_class_] = N;
+  TCEntry stale[kNumTransferEntries];
+  const int stale_count = used_slots_;
+  for (int i = 0; i < stale_count; ++i)
+    stale[i] = tc_slots_[i];
+  used_slots_ = 0;
+  for (int i = 0; i < stale_count; ++i)
+    ReleaseListToSpans(stale[i].head);
+}
+
+void TCMalloc_Central_FreeList::SpanStatistics(size_t* committedBytes, size_t* allocatedObjects, size_t* transferObjects) {
+  SpinLockHolder h(&lock_);
+  size_t pages = 0;
+  size_t objects = 0;
+  for (Span* span = empty_.next; span != &empty_; span = span->next) {
+    pages += span->length;
+    objects += span->refcount;
+  }
+  for (Span* span = nonempty_.next; span != &nonempty_; span = span->next) {
+    pages += span->length;
+    objects += span->refcount;
+  }
+  *committedBytes = pages << kPageShift;
+  *allocatedObjects = objects;
+  *transferObjects = used_slots_ * num_objects_to_move[size_class_];
+}
+
 void TCMalloc_Central_FreeList::RemoveRange(void **start, void **end, int *N) {
   int num = *N;
   ASSERT(num > 0);
@@ -3103,9 +3178,8 @@ void TCMalloc_ThreadCache::InitTSD() {
   ASSERT(!tsd_inited);
 #if USE(PTHREAD_GETSPECIFIC_DIRECT)
   pthread_key_init_np(heap_key, DestroyThreadCache);
-#else
-//  pthread_key_create(&heap_key, DestroyThreadCache);
-// __asm int 3; // Weolar
+#elif !OS(WINDOWS)
+  pthread_key_create(&heap_key, DestroyThreadCache);
 #endif
 #if OS(WINDOWS)
   tlsIndex = TlsAlloc();
@@ -4314,6 +4388,53 @@ FastMallocStatistics fastMallocStatistics()
     return statistics;
 }
 
+size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics* statistics, size_t maximumCount)
+{
+    SpinLockHolder lockHolder(&pageheap_lock);
+    if (!phinited)
+        return 0;
+
+    size_t count = 0;
+    for (size_t cl = 1; cl < kNumClasses && count < maximumCount; ++cl) {
+        const size_t objectSize = ByteSizeForClass(cl);
+        if (!objectSize)
+            continue;
+
+        size_t committedBytes;
+        size_t allocatedObjects;
+        size_t cachedObjects;
+        central_cache[cl].SpanStatistics(&committedBytes, &allocatedObjects, &cachedObjects);
+        for (TCMalloc_ThreadCache* threadCache = thread_heaps; threadCache ; threadCache = threadCache->next_)
+            cachedObjects += threadCache->freelist_length(cl);
+
+        // Thread caches are read without their owners' cooperation, so the
+        // counts can briefly disagree.
+        FastMallocSizeClassStatistics& entry = statistics[count++];
+        entry.objectSize = objectSize;
+        entry.bytesInUse = allocatedObjects > cachedObjects ? (allocatedObjects - cachedObjects) * objectSize : 0;
+        entry.bytesCommitted = committedBytes;
+    }
+    return count;
+}
+
+void setFastMallocTransferBatchSize(size_t maximumBytes, size_t maximumObjects)
+{
+    TCMalloc_ThreadCache::InitModule();
+
+    SpinLockHolder lockHolder(&transfer_batch_lock);
+    if (!maximumBytes)
+        maximumBytes = kDefaultTransferBatchBytes;
+    transfer_batch_bytes = maximumBytes < kMaxFreeListLength * kMaxSize ? maximumBytes : kMaxFreeListLength * kMaxSize;
+    if (!maximumObjects)
+        maximumObjects = kDefaultTransferBatchObjects;
+    transfer_batch_objects = maximumObjects < static_cast<size_t>(kMaxFreeListLength) ? static_cast<int>(maximumObjects) : kMaxFreeListLength;
+
+    for (size_t cl = 1; cl < kNumClasses; ++cl) {
+        if (const size_t objectSize = ByteSizeForClass(cl))
+            central_cache[cl].SetTransferBatchSize(NumMoveSize(objectSize));
+    }
+}
+
 size_t fastMallocSize(const void* ptr)
 {
 #if ENABLE(WTF_MALLOC_VALIDATION)
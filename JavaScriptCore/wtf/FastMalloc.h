@@ -89,6 +89,21 @@ namespace WTF {
     };
     FastMallocStatistics fastMallocStatistics();
 
+    // One entry per small-object size class. Committed bytes are the pages held by the
+    // class's spans, so committed minus in-use is the class's fragmentation.
+    struct FastMallocSizeClassStatistics {
+        size_t objectSize;
+        size_t bytesInUse;
+        size_t bytesCommitted;
+    };
+    // Returns the number of entries written, which is 0 when the system allocator is in use.
+    size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics*, size_t maximumCount);
+
+    // Bounds the batches moved between a thread's cache and the central free lists.
+    // Larger batches take the central locks less often at the cost of more memory parked
+    // in thread caches. Passing 0 for either bound restores its default.
+    void setFastMallocTransferBatchSize(size_t maximumBytes, size_t maximumObjects);
+
     // This defines a type which holds an unsigned integer and is the same
     // size as the minimally aligned memory allocation.
     typedef unsigned long long AllocAlignmentInteger;
@@ -29,10 +29,12 @@
 #include "config.h"
 #include "MainThread.h"
 
+#include "Atomics.h"
 #include "CurrentTime.h"
-#include "Deque.h"
+#include "FastAllocBase.h"
 #include "StdLibExtras.h"
 #include "Threading.h"
+#include <string.h>
 
 #if PLATFORM(CHROMIUM)
 #error Chromium uses a different main thread implementation
@@ -40,34 +42,114 @@
 
 namespace WTF {
 
+static bool queueTimingEnabled;
+
 struct FunctionWithContext {
-    MainThreadFunction* function;
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    MainThreadFunction* function; // Cleared by cancelCallOnMainThread().
     void* context;
     ThreadCondition* syncFlag;
+    MainThreadTaskPriority priority;
+    double postTime; // 0 unless queue timing was enabled.
+    FunctionWithContext* next;
+    unsigned poolSlot; // 1-based index in functionPool, 0 for a node from the heap.
+    unsigned nextFreeSlot;
+};
+
+// Posting takes its node from a fixed pool, and only goes to the heap while
+// every node in the pool is waiting to run. The free nodes form a stack of
+// pool slots that any thread pops from and the main thread pushes back onto.
+// Its head keeps the top slot (0 when empty) in the low 16 bits and a tag in
+// the high 16 that changes on every push and pop, so a pop that raced with
+// others fails its compare-and-swap rather than installing a stale next slot.
+static const unsigned functionPoolSize = 1024;
+static FunctionWithContext functionPool[functionPoolSize];
+static unsigned volatile freeFunctionSlots;
+
+static inline unsigned nextFreeFunctionSlots(unsigned head, unsigned slot)
+{
+    return ((head & 0xffff0000) + 0x10000) | slot;
+}
 
-    FunctionWithContext(MainThreadFunction* function = 0, void* context = 0, ThreadCondition* syncFlag = 0)
-        : function(function)
-        , context(context)
-        , syncFlag(syncFlag)
-    { 
+// Called once, before other threads can post. Until then every node comes
+// from the heap.
+static void initializeFunctionPool()
+{
+    for (unsigned i = 0; i < functionPoolSize; ++i) {
+        functionPool[i].poolSlot = i + 1;
+        functionPool[i].nextFreeSlot = i + 1 < functionPoolSize ? i + 2 : 0;
     }
-    bool operator == (const FunctionWithContext& o)
-    {
-        return function == o.function
-            && context == o.context
-            && syncFlag == o.syncFlag;
+    freeFunctionSlots = 1;
+}
+
+static FunctionWithContext* createFunction(MainThreadFunction* function, void* context, ThreadCondition* syncFlag, MainThreadTaskPriority priority)
+{
+    FunctionWithContext* invocation;
+    while (true) {
+        unsigned head = freeFunctionSlots;
+        unsigned slot = head & 0xffff;
+        if (!slot) {
+            invocation = new FunctionWithContext;
+            invocation->poolSlot = 0;
+            break;
+        }
+        invocation = &functionPool[slot - 1];
+        if (weakCompareAndSwap(&freeFunctionSlots, head, nextFreeFunctionSlots(head, invocation->nextFreeSlot)))
+            break;
     }
-};
 
-class FunctionWithContextFinder {
-public:
-    FunctionWithContextFinder(const FunctionWithContext& m) : m(m) {}
-    bool operator() (FunctionWithContext& o) { return o == m; }
-    FunctionWithContext m;
+    invocation->function = function;
+    invocation->context = context;
+    invocation->syncFlag = syncFlag;
+    invocation->priority = priority;
+    invocation->postTime = queueTimingEnabled ? currentTime() : 0;
+    invocation->next = 0;
+    return invocation;
+}
+
+static void destroyFunction(FunctionWithContext* invocation)
+{
+    if (!invocation->poolSlot) {
+        delete invocation;
+        return;
+    }
+
+    unsigned head;
+    do {
+        head = freeFunctionSlots;
+        invocation->nextFreeSlot = head & 0xffff;
+    } while (!weakCompareAndSwap(&freeFunctionSlots, head, nextFreeFunctionSlots(head, invocation->poolSlot)));
+}
+
+// Posting threads never take a lock: each priority has a stack that they
+// push onto with a compare-and-swap. The main thread takes everything on a
+// stack at once and appends it, oldest first, to the priority's queue. The
+// queues are only touched under mainThreadFunctionQueueMutex(), which is
+// taken by the main thread once per batch of functions it runs, and by
+// cancelCallOnMainThread(); a stack can only be emptied under it too.
+struct FunctionLane {
+    FunctionWithContext* volatile posted; // Newest first.
+    FunctionWithContext* head;
+    FunctionWithContext* tail;
+    unsigned queued;
 };
 
+// Functions a dispatch has taken off the queues. Runs can nest, so each
+// dispatch keeps its own batch on the stack, where cancelCallOnMainThread()
+// and nested dispatches can still find it.
+struct DispatchBatch {
+    static const unsigned capacity = 16;
+
+    FunctionWithContext* functions[capacity];
+    unsigned count;
+    unsigned ran; // Run or running; the rest are still waiting.
+    DispatchBatch* outer;
+};
 
-typedef Deque<FunctionWithContext> FunctionQueue;
+static FunctionLane functionLanes[numberOfMainThreadTaskPriorities];
+static DispatchBatch* activeDispatchBatches;
+static MainThreadQueueStatistics queueStatistics;
 
 static bool callbacksPaused; // This global variable is only accessed from main thread.
 #if !PLATFORM(MAC) && !PLATFORM(QT)
@@ -80,12 +162,6 @@ static Mutex& mainThreadFunctionQueueMutex()
     return staticMutex;
 }
 
-static FunctionQueue& functionQueue()
-{
-    DEFINE_STATIC_LOCAL(FunctionQueue, staticFunctionQueue, ());
-    return staticFunctionQueue;
-}
-
 
 #if !PLATFORM(MAC)
 
@@ -101,6 +177,7 @@ void initializeMainThread()
 #endif
 
     mainThreadFunctionQueueMutex();
+    initializeFunctionPool();
     initializeMainThreadPlatform();
 }
 
@@ -111,6 +188,7 @@ static pthread_once_t initializeMainThreadKeyOnce = PTHREAD_ONCE_INIT;
 static void initializeMainThreadOnce()
 {
     mainThreadFunctionQueueMutex();
+    initializeFunctionPool();
     initializeMainThreadPlatform();
 }
 
@@ -122,6 +200,7 @@ void initializeMainThread()
 static void initializeMainThreadToProcessMainThreadOnce()
 {
     mainThreadFunctionQueueMutex();
+    initializeFunctionPool();
     initializeMainThreadToProcessMainThreadPlatform();
 }
 
@@ -134,6 +213,85 @@ void initializeMainThreadToProcessMainThread()
 // 0.1 sec delays in UI is approximate threshold when they become noticeable. Have a limit that's half of that.
 static const double maxRunLoopSuspensionTime = 0.05;
 
+// Whoever pushes onto an empty stack schedules a dispatch; anything pushed
+// on top of it before that dispatch empties the stack goes along with it.
+static void postFunction(FunctionWithContext* invocation)
+{
+    FunctionLane& lane = functionLanes[invocation->priority];
+    FunctionWithContext* posted;
+    do {
+        posted = lane.posted;
+        invocation->next = posted;
+    } while (!weakCompareAndSwap(reinterpret_cast<void* volatile*>(&lane.posted), posted, invocation));
+
+    if (!posted)
+        scheduleDispatchFunctionsOnMainThread();
+}
+
+// Must hold mainThreadFunctionQueueMutex().
+static void takePostedFunctions(FunctionLane& lane, MainThreadQueueStatistics::Lane& laneStatistics)
+{
+    FunctionWithContext* posted;
+    do {
+        posted = lane.posted;
+        if (!posted)
+            return;
+    } while (!weakCompareAndSwap(reinterpret_cast<void* volatile*>(&lane.posted), posted, 0));
+
+    FunctionWithContext* last = posted;
+    FunctionWithContext* first = 0;
+    while (posted) {
+        FunctionWithContext* next = posted->next;
+        posted->next = first;
+        first = posted;
+        posted = next;
+        ++lane.queued;
+    }
+
+    if (lane.tail)
+        lane.tail->next = first;
+    else
+        lane.head = first;
+    lane.tail = last;
+
+    if (lane.queued > laneStatistics.maximumDepth)
+        laneStatistics.maximumDepth = lane.queued;
+}
+
+// Fills the batch from the highest priority queues that have functions
+// waiting. Must hold mainThreadFunctionQueueMutex().
+static void takeDispatchBatch(DispatchBatch& batch)
+{
+    batch.count = 0;
+    for (unsigned priority = 0; priority < numberOfMainThreadTaskPriorities && batch.count < DispatchBatch::capacity; ++priority) {
+        FunctionLane& lane = functionLanes[priority];
+        takePostedFunctions(lane, queueStatistics.lanes[priority]);
+        while (lane.head && batch.count < DispatchBatch::capacity) {
+            batch.functions[batch.count++] = lane.head;
+            lane.head = lane.head->next;
+            --lane.queued;
+        }
+        if (!lane.head)
+            lane.tail = 0;
+    }
+}
+
+// Puts the functions of the batch from index 'from' on back at the front of
+// their queues. Must hold mainThreadFunctionQueueMutex().
+static void returnDispatchBatch(DispatchBatch& batch, unsigned from)
+{
+    for (unsigned i = batch.count; i > from; --i) {
+        FunctionWithContext* invocation = batch.functions[i - 1];
+        FunctionLane& lane = functionLanes[invocation->priority];
+        invocation->next = lane.head;
+        lane.head = invocation;
+        if (!lane.tail)
+            lane.tail = invocation;
+        ++lane.queued;
+    }
+    batch.count = from;
+}
+
 void dispatchFunctionsFromMainThread()
 {
     ASSERT(isMainThread());
@@ -142,50 +300,88 @@ void dispatchFunctionsFromMainThread()
         return;
 
     double startTime = currentTime();
+    double now = startTime;
 
-    FunctionWithContext invocation;
+    Mutex& functionQueueMutex = mainThreadFunctionQueueMutex();
+    DispatchBatch batch;
     while (true) {
         {
-            MutexLocker locker(mainThreadFunctionQueueMutex());
-            if (!functionQueue().size())
+            MutexLocker locker(functionQueueMutex);
+            // A function an outer dispatch is running has nested this one (a
+            // modal loop, say). Take back what the outer batches have not run
+            // yet so that it runs here, in order, rather than after the outer
+            // function returns, which a callOnMainThreadAndWait() caller
+            // among them would otherwise be blocked on.
+            for (DispatchBatch* outer = activeDispatchBatches; outer; outer = outer->outer)
+                returnDispatchBatch(*outer, outer->ran);
+            takeDispatchBatch(batch);
+            if (!batch.count)
+                break;
+            batch.outer = activeDispatchBatches;
+            activeDispatchBatches = &batch;
+        }
+
+        bool yield = false;
+        batch.ran = 0;
+        while (batch.ran < batch.count) {
+            FunctionWithContext* invocation = batch.functions[batch.ran++];
+            if (MainThreadFunction* function = invocation->function) {
+                MainThreadQueueStatistics::Lane& laneStatistics = queueStatistics.lanes[invocation->priority];
+                ++laneStatistics.dispatched;
+                if (invocation->postTime) {
+                    double timeInQueue = now - invocation->postTime;
+                    ++laneStatistics.timed;
+                    laneStatistics.totalTimeInQueue += timeInQueue;
+                    if (timeInQueue > laneStatistics.maximumTimeInQueue)
+                        laneStatistics.maximumTimeInQueue = timeInQueue;
+                }
+
+                function(invocation->context);
+                if (invocation->syncFlag) {
+                    MutexLocker locker(functionQueueMutex);
+                    invocation->syncFlag->signal();
+                }
+            }
+
+            // If we are running accumulated functions for too long so UI may become unresponsive, we need to
+            // yield so the user input can be processed. Otherwise user may not be able to even close the window.
+            // This code has effect only in case the scheduleDispatchFunctionsOnMainThread() is implemented in a way that
+            // allows input events to be processed before we are back here.
+            now = currentTime();
+            if (now - startTime > maxRunLoopSuspensionTime) {
+                yield = true;
                 break;
-            invocation = functionQueue().takeFirst();
+            }
         }
 
-        invocation.function(invocation.context);
-        if (invocation.syncFlag) {
-            MutexLocker locker(mainThreadFunctionQueueMutex());
-            invocation.syncFlag->signal();
+        {
+            MutexLocker locker(functionQueueMutex);
+            returnDispatchBatch(batch, batch.ran);
+            activeDispatchBatches = batch.outer;
         }
+        for (unsigned i = 0; i < batch.ran; ++i)
+            destroyFunction(batch.functions[i]);
 
-        // If we are running accumulated functions for too long so UI may become unresponsive, we need to
-        // yield so the user input can be processed. Otherwise user may not be able to even close the window.
-        // This code has effect only in case the scheduleDispatchFunctionsOnMainThread() is implemented in a way that
-        // allows input events to be processed before we are back here.
-        if (currentTime() - startTime > maxRunLoopSuspensionTime) {
+        if (yield) {
             scheduleDispatchFunctionsOnMainThread();
-            break;
+            return;
         }
     }
 }
 
 void callOnMainThread(MainThreadFunction* function, void* context)
 {
-    OutputDebugStringW(L"callOnMainThread\n");
+    callOnMainThread(function, context, MainThreadLoadingPriority);
+}
+
+void callOnMainThread(MainThreadFunction* function, void* context, MainThreadTaskPriority priority)
+{
     ASSERT(function);
-    bool needToSchedule = false;
-    {
-        MutexLocker locker(mainThreadFunctionQueueMutex());
-        needToSchedule = functionQueue().size() == 0;
-        functionQueue().append(FunctionWithContext(function, context));
-    }
-    if (needToSchedule)
-        scheduleDispatchFunctionsOnMainThread();
+    postFunction(createFunction(function, context, 0, priority));
 }
 
 void callOnMainThreadAndWait(MainThreadFunction* function, void* context)
 {
-    OutputDebugStringW(L"callOnMainThreadAndWait\n");
     ASSERT(function);
 
     if (isMainThread()) {
@@ -196,29 +392,60 @@ void callOnMainThreadAndWait(MainThreadFunction* function, void* context)
     ThreadCondition syncFlag;
     Mutex& functionQueueMutex = mainThreadFunctionQueueMutex();
     MutexLocker locker(functionQueueMutex);
-    functionQueue().append(FunctionWithContext(function, context, &syncFlag));
-    if (functionQueue().size() == 1)
-        scheduleDispatchFunctionsOnMainThread();
+    postFunction(createFunction(function, context, &syncFlag, MainThreadLoadingPriority));
     syncFlag.wait(functionQueueMutex);
 }
 
 void cancelCallOnMainThread(MainThreadFunction* function, void* context)
 {
-    OutputDebugStringW(L"cancelCallOnMainThread\n");
     ASSERT(function);
 
     MutexLocker locker(mainThreadFunctionQueueMutex());
 
-    FunctionWithContextFinder pred(FunctionWithContext(function, context));
+    for (unsigned priority = 0; priority < numberOfMainThreadTaskPriorities; ++priority) {
+        FunctionLane& lane = functionLanes[priority];
+        takePostedFunctions(lane, queueStatistics.lanes[priority]);
+        for (FunctionWithContext* invocation = lane.head; invocation; invocation = invocation->next) {
+            if (invocation->function == function && invocation->context == context && !invocation->syncFlag)
+                invocation->function = 0;
+        }
+    }
+
+    for (DispatchBatch* batch = activeDispatchBatches; batch; batch = batch->outer) {
+        for (unsigned i = 0; i < batch->count; ++i) {
+            FunctionWithContext* invocation = batch->functions[i];
+            if (invocation->function == function && invocation->context == context && !invocation->syncFlag)
+                invocation->function = 0;
+        }
+    }
+}
+
+MainThreadQueueStatistics mainThreadQueueStatistics()
+{
+    ASSERT(isMainThread());
 
-    while (true) {
-        // We must redefine 'i' each pass, because the itererator's operator= 
-        // requires 'this' to be valid, and remove() invalidates all iterators
-        FunctionQueue::iterator i(functionQueue().findIf(pred));
-        if (i == functionQueue().end())
-            break;
-        functionQueue().remove(i);
+    MutexLocker locker(mainThreadFunctionQueueMutex());
+    unsigned depth = 0;
+    for (unsigned priority = 0; priority < numberOfMainThreadTaskPriorities; ++priority) {
+        takePostedFunctions(functionLanes[priority], queueStatistics.lanes[priority]);
+        depth += functionLanes[priority].queued;
     }
+    MainThreadQueueStatistics statistics = queueStatistics;
+    statistics.depth = depth;
+    return statistics;
+}
+
+void resetMainThreadQueueStatistics()
+{
+    ASSERT(isMainThread());
+
+    MutexLocker locker(mainThreadFunctionQueueMutex());
+    memset(&queueStatistics, 0, sizeof(queueStatistics));
+}
+
+void setMainThreadQueueTimingEnabled(bool enabled)
+{
+    queueTimingEnabled = enabled;
 }
 
 void setMainThreadCallbacksPaused(bool paused)
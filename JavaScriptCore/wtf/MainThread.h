@@ -40,10 +40,43 @@ typedef void MainThreadFunction(void*);
 // Must be called from the main thread.
 void initializeMainThread();
 
+// Functions posted with a higher priority run before any waiting function of
+// a lower one; within a priority they run in the order they were posted.
+enum MainThreadTaskPriority {
+    MainThreadInputPriority,
+    MainThreadPaintPriority,
+    MainThreadLoadingPriority,
+    MainThreadIdlePriority,
+};
+const unsigned numberOfMainThreadTaskPriorities = MainThreadIdlePriority + 1;
+
+// callOnMainThread() without a priority posts at MainThreadLoadingPriority.
 void callOnMainThread(MainThreadFunction*, void* context);
+void callOnMainThread(MainThreadFunction*, void* context, MainThreadTaskPriority);
 void callOnMainThreadAndWait(MainThreadFunction*, void* context);
 void cancelCallOnMainThread(MainThreadFunction*, void* context);
 
+// Counters for the queue of functions waiting to run on the main thread.
+// Times are in seconds, and only kept while timing is enabled, as it costs a
+// clock read on every post.
+struct MainThreadQueueStatistics {
+    struct Lane {
+        unsigned maximumDepth; // Most functions seen waiting at once.
+        unsigned dispatched;
+        unsigned timed; // Dispatched functions that were posted with timing on.
+        double totalTimeInQueue;
+        double maximumTimeInQueue;
+    };
+
+    unsigned depth; // Functions waiting now, over all priorities.
+    Lane lanes[numberOfMainThreadTaskPriorities];
+};
+
+// Must be called from the main thread.
+MainThreadQueueStatistics mainThreadQueueStatistics();
+void resetMainThreadQueueStatistics();
+void setMainThreadQueueTimingEnabled(bool);
+
 void setMainThreadCallbacksPaused(bool paused);
 
 bool isMainThread();
@@ -53,6 +86,14 @@ void initializeMainThreadPlatform();
 void scheduleDispatchFunctionsOnMainThread();
 void dispatchFunctionsFromMainThread();
 
+#if PLATFORM(QT)
+// The kd port has no native event loop to post to. Hosts that own a run loop
+// install a scheduler here so callOnMainThread() wakes them up instead of
+// waiting for the next poll.
+typedef void MainThreadDispatchScheduler();
+void setMainThreadDispatchScheduler(MainThreadDispatchScheduler*);
+#endif
+
 #if PLATFORM(MAC)
 // This version of initializeMainThread sets up the main thread as corresponding
 // to the process's main thread, and not necessarily the thread that calls this
@@ -66,6 +107,12 @@ void initializeMainThreadToProcessMainThreadPlatform();
 using WTF::callOnMainThread;
 using WTF::callOnMainThreadAndWait;
 using WTF::cancelCallOnMainThread;
+using WTF::MainThreadTaskPriority;
+using WTF::MainThreadInputPriority;
+using WTF::MainThreadPaintPriority;
+using WTF::MainThreadLoadingPriority;
+using WTF::MainThreadIdlePriority;
+using WTF::MainThreadQueueStatistics;
 using WTF::setMainThreadCallbacksPaused;
 using WTF::isMainThread;
 #endif // MainThread_h
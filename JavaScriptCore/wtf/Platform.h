@@ -865,6 +865,9 @@
 #define HAVE_STRINGS_H 1
 #define HAVE_SYS_PARAM_H 1
 #define HAVE_SYS_TIME_H 1
+#if OS(LINUX)
+#define HAVE_MADV_DONTNEED 1
+#endif
 
 #endif
 
@@ -1033,8 +1036,12 @@
 #define ENABLE_JIT 1
 #endif
 
-/* Currently only implemented for JSVALUE64, only tested on PLATFORM(MAC) */
-#if ENABLE(JIT) && USE(JSVALUE64) && PLATFORM(MAC)
+/* Currently only implemented for JSVALUE64, only tested on PLATFORM(MAC) and x86-64 Linux.
+ * There is no tier-up or OSR exit: a function the DFG can handle is compiled by it
+ * at first call instead of by the baseline JIT, and only when the JSGlobalData allows
+ * it (see JSGlobalData::canUseDFG()). JSVALUE32_64 builds, the kd port's among them,
+ * never use it. */
+#if ENABLE(JIT) && USE(JSVALUE64) && (PLATFORM(MAC) || (OS(LINUX) && CPU(X86_64)))
 #define ENABLE_DFG_JIT 1
 /* Enabled with restrictions to circumvent known performance regressions. */
 #define ENABLE_DFG_JIT_RESTRICTIONS 1
@@ -1076,6 +1083,9 @@
     #ifndef ENABLE_JIT_OPTIMIZE_METHOD_CALLS
     #define ENABLE_JIT_OPTIMIZE_METHOD_CALLS 1
     #endif
+    #if !defined(ENABLE_MEGAMORPHIC_CACHE) && ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
+    #define ENABLE_MEGAMORPHIC_CACHE 1
+    #endif
 #endif
 
 #if CPU(X86) && COMPILER(MSVC)
@@ -1185,6 +1195,13 @@
 
 #define ENABLE_JSC_ZOMBIES 0
 
+/* Parallel marking uses native threads directly, so it does not depend on
+   ENABLE(SINGLE_THREADED). It stays off at runtime until the embedder asks
+   for helper threads through Heap::setMarkingHelperThreadCount(). */
+#if !defined(ENABLE_PARALLEL_GC) && (OS(WINDOWS) || (OS(LINUX) && COMPILER(GCC)))
+#define ENABLE_PARALLEL_GC 1
+#endif
+
 /* FIXME: Eventually we should enable this for all platforms and get rid of the define. */
 #if PLATFORM(MAC) || PLATFORM(WIN) || PLATFORM(QT)
 #define WTF_USE_PLATFORM_STRATEGIES 0 // weolar 
@@ -31,6 +31,8 @@
 #include "config.h"
 #include "MainThread.h"
 
+#include "Threading.h"
+
 //#include <QtCore/QObject>
 //#include <QtCore/QCoreApplication>
 //#include <QThread>
@@ -48,7 +50,9 @@ private /*Q_SLOTS*/:
 
 MainThreadInvoker::MainThreadInvoker()
 {
+#if COMPILER(MSVC)
     __asm int 3; // weolar
+#endif
     //moveToThread(QCoreApplication::instance()->thread());
 }
 
@@ -81,24 +85,45 @@ void MainThreadInvoker::dispatch()
 //     }
 // }
 
+#if OS(WINDOWS)
 static DWORD gMainThreadId = 0;
+#else
+static ThreadIdentifier gMainThreadId = 0;
+#endif
+
+static MainThreadDispatchScheduler* gDispatchScheduler = 0;
 
 void initializeMainThreadPlatform()
 {
+#if OS(WINDOWS)
     ::OutputDebugStringW(L"initializeMainThreadPlatform\n");
     gMainThreadId = GetCurrentThreadId();
+#else
+    gMainThreadId = currentThread();
+#endif
     //SetThreadName(GetCurrentThreadId(), LPCSTR szThreadName);
 }
 
+void setMainThreadDispatchScheduler(MainThreadDispatchScheduler* scheduler)
+{
+    gDispatchScheduler = scheduler;
+}
+
 void scheduleDispatchFunctionsOnMainThread()
 {
-    //__asm int 3; // weolar
+    // Without a scheduler the queue is drained by KWebPage::timerFired().
+    if (gDispatchScheduler)
+        gDispatchScheduler();
     //QMetaObject::invokeMethod(webkit_main_thread_invoker(), "dispatch", Qt::QueuedConnection);
 }
 
 bool isMainThread()
 {
+#if OS(WINDOWS)
     return gMainThreadId == GetCurrentThreadId(); // weolar
+#else
+    return gMainThreadId == currentThread();
+#endif
     //return QThread::currentThread() == QCoreApplication::instance()->thread();
 }
 
@@ -93,6 +93,14 @@ struct CStringTranslator {
     static bool equal(StringImpl* r, const char* s)
     {
         int length = r->length();
+        if (r->is8Bit()) {
+            const LChar* d = r->characters8();
+            for (int i = 0; i != length; ++i) {
+                if (d[i] != static_cast<LChar>(s[i]))
+                    return false;
+            }
+            return !s[length];
+        }
         const UChar* d = r->characters();
         for (int i = 0; i != length; ++i) {
             unsigned char c = s[i];
@@ -113,9 +121,9 @@ struct CStringTranslator {
 bool operator==(const AtomicString& a, const char* b)
 { 
     StringImpl* impl = a.impl();
-    if ((!impl || !impl->characters()) && !b)
+    if (!impl && !b)
         return true;
-    if ((!impl || !impl->characters()) || !b)
+    if (!impl || !b)
         return false;
     return CStringTranslator::equal(impl, b); 
 }
@@ -140,6 +148,9 @@ static inline bool equal(StringImpl* string, const UChar* characters, unsigned l
     if (string->length() != length)
         return false;
 
+    if (string->is8Bit())
+        return equal(string->characters8(), characters, length);
+
     // FIXME: perhaps we should have a more abstract macro that indicates when
     // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS) || CPU(SPARC)
@@ -186,7 +197,7 @@ struct UCharBufferTranslator {
 
     static void translate(StringImpl*& location, const UCharBuffer& buf, unsigned hash)
     {
-        location = StringImpl::create(buf.s, buf.length).leakRef();
+        location = StringImpl::create8BitIfPossible(buf.s, buf.length).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -236,9 +247,12 @@ struct HashAndUTF8CharactersTranslator {
         if (buffer.utf16Length != string->length())
             return false;
 
+        // If buffer contains only ASCII characters UTF-8 and UTF16 length are the same.
+        if (buffer.utf16Length == buffer.length && string->is8Bit())
+            return WTF::equal(string->characters8(), reinterpret_cast<const LChar*>(buffer.characters), buffer.length);
+
         const UChar* stringCharacters = string->characters();
 
-        // If buffer contains only ASCII characters UTF-8 and UTF16 length are the same.
         if (buffer.utf16Length != buffer.length)
             return equalUTF16WithUTF8(stringCharacters, stringCharacters + string->length(), buffer.characters, buffer.characters + buffer.length);
 
@@ -253,6 +267,15 @@ struct HashAndUTF8CharactersTranslator {
 
     static void translate(StringImpl*& location, const HashAndUTF8Characters& buffer, unsigned hash)
     {
+        if (buffer.utf16Length == buffer.length) {
+            LChar* target;
+            location = StringImpl::createUninitialized(buffer.length, target).releaseRef();
+            memcpy(target, buffer.characters, buffer.length);
+            location->setHash(hash);
+            location->setIsAtomic(true);
+            return;
+        }
+
         UChar* target;
         location = StringImpl::createUninitialized(buffer.utf16Length, target).releaseRef();
 
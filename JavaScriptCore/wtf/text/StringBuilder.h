@@ -40,6 +40,7 @@ public:
 
     void append(const UChar*, unsigned);
     void append(const char*, unsigned);
+    void append(const LChar* characters, unsigned length) { append(reinterpret_cast<const char*>(characters), length); }
 
     void append(const String& string)
     {
@@ -51,7 +52,10 @@ public:
             m_length = string.length();
             return;
         }
-        append(string.characters(), string.length());
+        if (string.is8Bit())
+            append(string.characters8(), string.length());
+        else
+            append(string.characters(), string.length());
     }
 
     void append(const char* characters)
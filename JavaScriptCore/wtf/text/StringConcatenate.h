@@ -174,8 +174,14 @@ public:
 
     void writeTo(UChar* destination)
     {
-        const UChar* data = m_buffer.characters();
         unsigned length = m_buffer.length();
+        if (m_buffer.is8Bit()) {
+            const LChar* data = m_buffer.characters8();
+            for (unsigned i = 0; i < length; ++i)
+                destination[i] = data[i];
+            return;
+        }
+        const UChar* data = m_buffer.characters();
         for (unsigned i = 0; i < length; ++i)
             destination[i] = data[i];
     }
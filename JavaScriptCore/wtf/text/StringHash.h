@@ -53,6 +53,12 @@ namespace WTF {
             if (aLength != bLength)
                 return false;
 
+            if (a->is8Bit() || b->is8Bit())
+                return equalCharacters(a, b);
+
+            if (aLength >= 16)
+                return WTF::equal(a->characters(), b->characters(), aLength);
+
             // FIXME: perhaps we should have a more abstract macro that indicates when
             // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS) || CPU(SPARC)
@@ -109,6 +115,8 @@ namespace WTF {
 
         static unsigned hash(StringImpl* str)
         {
+            if (str->is8Bit())
+                return StringHasher::computeHash<LChar, foldCase<LChar> >(str->characters8(), str->length());
             return hash(str->characters(), str->length());
         }
 
@@ -126,7 +134,14 @@ namespace WTF {
             unsigned length = a->length();
             if (length != b->length())
                 return false;
-            return WTF::Unicode::umemcasecmp(a->characters(), b->characters(), length) == 0;
+            if (a->is8Bit() || b->is8Bit()) {
+                for (unsigned i = 0; i < length; ++i) {
+                    if (foldCase((*a)[i]) != foldCase((*b)[i]))
+                        return false;
+                }
+                return true;
+            }
+            return equalIgnoringCase(a->characters(), b->characters(), length);
         }
 
         static unsigned hash(const RefPtr<StringImpl>& key) 
@@ -28,6 +28,8 @@
 #include "AtomicString.h"
 #include "StringBuffer.h"
 #include "StringHash.h"
+#include <wtf/Atomics.h>
+#include <wtf/CPUFeatures.h>
 #include <wtf/StdLibExtras.h>
 #include <wtf/WTFThreadData.h>
 
@@ -39,7 +41,7 @@ using namespace Unicode;
 
 static const unsigned minLengthToShare = 20;
 
-COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 3 * sizeof(void*), StringImpl_should_stay_small);
+COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 4 * sizeof(void*), StringImpl_should_stay_small);
 
 StringImpl::~StringImpl()
 {
@@ -55,6 +57,11 @@ StringImpl::~StringImpl()
 #endif
 
     BufferOwnership ownership = bufferOwnership();
+
+    // An 8-bit string owns the UChar copy it made, substrings included.
+    if (is8Bit() && m_data)
+        fastFree(const_cast<UChar*>(m_data));
+
     if (ownership != BufferInternal) {
         if (ownership == BufferOwned) {
             ASSERT(!m_sharedBuffer);
@@ -90,6 +97,44 @@ PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, UChar*&
     return adoptRef(new (string) StringImpl(length));
 }
 
+PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, LChar*& data)
+{
+    if (!length) {
+        data = 0;
+        return empty();
+    }
+
+    if (length > std::numeric_limits<unsigned>::max() - sizeof(StringImpl))
+        CRASH();
+    StringImpl* string = static_cast<StringImpl*>(fastMalloc(sizeof(StringImpl) + length));
+
+    data = reinterpret_cast<LChar*>(string + 1);
+    return adoptRef(new (string) StringImpl(length, Force8BitConstructor));
+}
+
+void StringImpl::upconvertCharacters() const
+{
+    ASSERT(is8Bit());
+    ASSERT(!m_data);
+
+    // A substring widens only its own characters, not its base string's.
+    UChar* data = static_cast<UChar*>(fastMalloc(m_length * sizeof(UChar)));
+    copyChars(data, m_data8, m_length);
+#if USE(COMPARE_AND_SWAP)
+    // Two threads reading the same string may both get here. The first copy
+    // published wins and the other is thrown away, so neither leaks nor
+    // frees a buffer the other has already returned.
+    void* volatile* location = reinterpret_cast<void* volatile*>(const_cast<UChar**>(&m_data));
+    while (!m_data) {
+        if (weakCompareAndSwap(location, 0, data))
+            return;
+    }
+    fastFree(data);
+#else
+    m_data = data;
+#endif
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned length)
 {
     if (!characters || !length)
@@ -101,16 +146,34 @@ PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned leng
     return string.release();
 }
 
+PassRefPtr<StringImpl> StringImpl::create(const LChar* characters, unsigned length)
+{
+    if (!characters || !length)
+        return empty();
+
+    LChar* data;
+    RefPtr<StringImpl> string = createUninitialized(length, data);
+    memcpy(data, characters, length);
+    return string.release();
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const char* characters, unsigned length)
+{
+    return create(reinterpret_cast<const LChar*>(characters), length);
+}
+
+PassRefPtr<StringImpl> StringImpl::create8BitIfPossible(const UChar* characters, unsigned length)
 {
     if (!characters || !length)
         return empty();
 
-    UChar* data;
+    LChar* data;
     RefPtr<StringImpl> string = createUninitialized(length, data);
     for (unsigned i = 0; i != length; ++i) {
-        unsigned char c = characters[i];
-        data[i] = c;
+        UChar c = characters[i];
+        if (c & 0xFF00)
+            return create(characters, length);
+        data[i] = static_cast<LChar>(c);
     }
     return string.release();
 }
@@ -146,6 +209,7 @@ SharedUChar* StringImpl::sharedBuffer()
     if (ownership == BufferSubstring)
         return m_substringBuffer->sharedBuffer();
     if (ownership == BufferOwned) {
+        ASSERT(!is8Bit());
         ASSERT(!m_sharedBuffer);
         m_sharedBuffer = SharedUChar::create(new SharableUChar(m_data)).leakRef();
         m_refCountAndFlags = (m_refCountAndFlags & ~s_refCountMaskBufferOwnership) | BufferShared;
@@ -161,6 +225,13 @@ bool StringImpl::containsOnlyWhitespace()
     // FIXME: The definition of whitespace here includes a number of characters
     // that are not whitespace from the point of view of RenderText; I wonder if
     // that's a problem in practice.
+    if (is8Bit()) {
+        for (unsigned i = 0; i < m_length; i++) {
+            if (!isASCIISpace(m_data8[i]))
+                return false;
+        }
+        return true;
+    }
     for (unsigned i = 0; i < m_length; i++)
         if (!isASCIISpace(m_data[i]))
             return false;
@@ -177,11 +248,21 @@ PassRefPtr<StringImpl> StringImpl::substring(unsigned start, unsigned length)
             return this;
         length = maxLength;
     }
+    if (is8Bit())
+        return create(m_data8 + start, length);
     return create(m_data + start, length);
 }
 
+static inline bool isLatin1Upper(LChar c)
+{
+    // 0xD7 is the multiplication sign, which sits among the capitals.
+    return isASCIIUpper(c) || (c >= 0xC0 && c <= 0xDE && c != 0xD7);
+}
+
 UChar32 StringImpl::characterStartingAt(unsigned i)
 {
+    if (is8Bit())
+        return m_data8[i];
     if (U16_IS_SINGLE(m_data[i]))
         return m_data[i];
     if (i + 1 < m_length && U16_IS_LEAD(m_data[i]) && U16_IS_TRAIL(m_data[i + 1]))
@@ -193,6 +274,22 @@ PassRefPtr<StringImpl> StringImpl::lower()
 {
     // Note: This is a hot function in the Dromaeo benchmark, specifically the
     // no-op code path up through the first 'return' statement.
+
+    if (is8Bit()) {
+        // Latin-1 capitals lower to Latin-1 letters, so the result stays 8-bit.
+        unsigned firstUpper = 0;
+        while (firstUpper < m_length && !isLatin1Upper(m_data8[firstUpper]))
+            ++firstUpper;
+        if (firstUpper == m_length)
+            return this;
+
+        LChar* data8;
+        RefPtr<StringImpl> newImpl = createUninitialized(m_length, data8);
+        memcpy(data8, m_data8, firstUpper);
+        for (unsigned i = firstUpper; i < m_length; ++i)
+            data8[i] = isLatin1Upper(m_data8[i]) ? m_data8[i] + 0x20 : m_data8[i];
+        return newImpl.release();
+    }
     
     // First scan the string for uppercase and non-ASCII characters:
     UChar ored = 0;
@@ -241,17 +338,38 @@ PassRefPtr<StringImpl> StringImpl::upper()
     // This function could be optimized for no-op cases the way lower() is,
     // but in empirical testing, few actual calls to upper() are no-ops, so
     // it wouldn't be worth the extra time for pre-scanning.
+
+    if (is8Bit()) {
+        // Latin-1 lowercase letters other than micro sign, sharp s and y with
+        // diaeresis have Latin-1 capitals, so most results stay 8-bit.
+        LChar* data8;
+        RefPtr<StringImpl> newImpl = createUninitialized(m_length, data8);
+        unsigned i = 0;
+        for (; i < m_length; ++i) {
+            LChar c = m_data8[i];
+            if (isASCIILower(c) || (c >= 0xE0 && c <= 0xFE && c != 0xF7))
+                data8[i] = c - 0x20;
+            else if (c == 0xB5 || c == 0xDF || c == 0xFF)
+                break;
+            else
+                data8[i] = c;
+        }
+        if (i == m_length)
+            return newImpl.release();
+    }
+
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
     if (m_length > static_cast<unsigned>(numeric_limits<int32_t>::max()))
         CRASH();
     int32_t length = m_length;
+    const UChar* source = characters();
 
     // Do a faster loop for the case where all the characters are ASCII.
     UChar ored = 0;
     for (int i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = source[i];
         ored |= c;
         data[i] = toASCIIUpper(c);
     }
@@ -260,11 +378,11 @@ PassRefPtr<StringImpl> StringImpl::upper()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toUpper(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toUpper(data, length, source, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toUpper(data, realLength, m_data, m_length, &error);
+    Unicode::toUpper(data, realLength, source, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -290,11 +408,12 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
     if (m_length > static_cast<unsigned>(numeric_limits<int32_t>::max()))
         CRASH();
     int32_t length = m_length;
+    const UChar* source = characters();
 
     // Do a faster loop for the case where all the characters are ASCII.
     UChar ored = 0;
     for (int32_t i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = source[i];
         ored |= c;
         data[i] = toASCIILower(c);
     }
@@ -303,11 +422,11 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::foldCase(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::foldCase(data, length, source, m_length, &error);
     if (!error && realLength == length)
         return newImpl.release();
     newImpl = createUninitialized(realLength, data);
-    Unicode::foldCase(data, realLength, m_data, m_length, &error);
+    Unicode::foldCase(data, realLength, source, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -322,7 +441,7 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
     unsigned end = m_length - 1;
     
     // skip white space from start
-    while (start <= end && isSpaceOrNewline(m_data[start]))
+    while (start <= end && isSpaceOrNewline((*this)[start]))
         start++;
     
     // only white space
@@ -330,17 +449,18 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
         return empty();
 
     // skip white space from end
-    while (end && isSpaceOrNewline(m_data[end]))
+    while (end && isSpaceOrNewline((*this)[end]))
         end--;
 
     if (!start && end == m_length - 1)
         return this;
-    return create(m_data + start, end + 1 - start);
+    return substring(start, end + 1 - start);
 }
 
 PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr findMatch)
 {
-    const UChar* from = m_data;
+    const UChar* start = characters();
+    const UChar* from = start;
     const UChar* fromend = from + m_length;
 
     // Assume the common case will not remove any characters
@@ -351,10 +471,10 @@ PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr fi
 
     StringBuffer data(m_length);
     UChar* to = data.characters();
-    unsigned outc = from - m_data;
+    unsigned outc = from - start;
 
     if (outc)
-        memcpy(to, m_data, outc * sizeof(UChar));
+        memcpy(to, start, outc * sizeof(UChar));
 
     while (true) {
         while (from != fromend && findMatch(*from))
@@ -374,7 +494,7 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 {
     StringBuffer data(m_length);
 
-    const UChar* from = m_data;
+    const UChar* from = characters();
     const UChar* fromend = from + m_length;
     int outc = 0;
     bool changedToSpace = false;
@@ -408,62 +528,62 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 
 int StringImpl::toIntStrict(bool* ok, int base)
 {
-    return charactersToIntStrict(m_data, m_length, ok, base);
+    return charactersToIntStrict(characters(), m_length, ok, base);
 }
 
 unsigned StringImpl::toUIntStrict(bool* ok, int base)
 {
-    return charactersToUIntStrict(m_data, m_length, ok, base);
+    return charactersToUIntStrict(characters(), m_length, ok, base);
 }
 
 int64_t StringImpl::toInt64Strict(bool* ok, int base)
 {
-    return charactersToInt64Strict(m_data, m_length, ok, base);
+    return charactersToInt64Strict(characters(), m_length, ok, base);
 }
 
 uint64_t StringImpl::toUInt64Strict(bool* ok, int base)
 {
-    return charactersToUInt64Strict(m_data, m_length, ok, base);
+    return charactersToUInt64Strict(characters(), m_length, ok, base);
 }
 
 intptr_t StringImpl::toIntPtrStrict(bool* ok, int base)
 {
-    return charactersToIntPtrStrict(m_data, m_length, ok, base);
+    return charactersToIntPtrStrict(characters(), m_length, ok, base);
 }
 
 int StringImpl::toInt(bool* ok)
 {
-    return charactersToInt(m_data, m_length, ok);
+    return charactersToInt(characters(), m_length, ok);
 }
 
 unsigned StringImpl::toUInt(bool* ok)
 {
-    return charactersToUInt(m_data, m_length, ok);
+    return charactersToUInt(characters(), m_length, ok);
 }
 
 int64_t StringImpl::toInt64(bool* ok)
 {
-    return charactersToInt64(m_data, m_length, ok);
+    return charactersToInt64(characters(), m_length, ok);
 }
 
 uint64_t StringImpl::toUInt64(bool* ok)
 {
-    return charactersToUInt64(m_data, m_length, ok);
+    return charactersToUInt64(characters(), m_length, ok);
 }
 
 intptr_t StringImpl::toIntPtr(bool* ok)
 {
-    return charactersToIntPtr(m_data, m_length, ok);
+    return charactersToIntPtr(characters(), m_length, ok);
 }
 
 double StringImpl::toDouble(bool* ok, bool* didReadNumber)
 {
-    return charactersToDouble(m_data, m_length, ok, didReadNumber);
+    return charactersToDouble(characters(), m_length, ok, didReadNumber);
 }
 
 float StringImpl::toFloat(bool* ok, bool* didReadNumber)
 {
-    return charactersToFloat(m_data, m_length, ok, didReadNumber);
+    return charactersToFloat(characters(), m_length, ok, didReadNumber);
 }
 
 static bool equal(const UChar* a, const char* b, int length)
@@ -487,28 +607,164 @@ bool equalIgnoringCase(const UChar* a, const char* b, unsigned length)
     return true;
 }
 
-static inline bool equalIgnoringCase(const UChar* a, const UChar* b, int length)
+bool equalIgnoringCase(const UChar* a, const UChar* b, unsigned length)
 {
-    ASSERT(length >= 0);
-    return umemcasecmp(a, b, length) == 0;
+    unsigned i = 0;
+#if HAVE(SSE2_INTRINSICS)
+    // ASCII characters only fold to ASCII characters, so all-ASCII blocks can
+    // be compared after lowering A-Z. Full case folding takes over from the
+    // first block holding anything else.
+    if (length >= 8 && isSSE2Present()) {
+        const __m128i nonASCII = _mm_set1_epi16(static_cast<short>(0xFF80));
+        const __m128i beforeA = _mm_set1_epi16('A' - 1);
+        const __m128i afterZ = _mm_set1_epi16('Z' + 1);
+        const __m128i caseBit = _mm_set1_epi16(0x20);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= length; i += 8) {
+            __m128i aCharacters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i bCharacters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(aCharacters, bCharacters), nonASCII), zero)) != 0xFFFF)
+                break;
+            // ASCII is positive as signed 16-bit, so the signed compares hold.
+            __m128i aIsUpper = _mm_and_si128(_mm_cmpgt_epi16(aCharacters, beforeA), _mm_cmplt_epi16(aCharacters, afterZ));
+            __m128i bIsUpper = _mm_and_si128(_mm_cmpgt_epi16(bCharacters, beforeA), _mm_cmplt_epi16(bCharacters, afterZ));
+            aCharacters = _mm_or_si128(aCharacters, _mm_and_si128(aIsUpper, caseBit));
+            bCharacters = _mm_or_si128(bCharacters, _mm_and_si128(bIsUpper, caseBit));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(aCharacters, bCharacters)) != 0xFFFF)
+                return false;
+        }
+    }
+#endif
+    return umemcasecmp(a + i, b + i, length - i) == 0;
 }
 
-int codePointCompare(const StringImpl* s1, const StringImpl* s2)
+// Returns the index of the first character that differs, or length.
+static inline unsigned findFirstMismatch(const UChar* a, const UChar* b, unsigned length)
 {
-    const unsigned l1 = s1 ? s1->length() : 0;
-    const unsigned l2 = s2 ? s2->length() : 0;
-    const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1 ? s1->characters() : 0;
-    const UChar* c2 = s2 ? s2->characters() : 0;
-    unsigned pos = 0;
-    while (pos < lmin && *c1 == *c2) {
-        c1++;
-        c2++;
-        pos++;
+    unsigned i = 0;
+#if HAVE(SSE2_INTRINSICS)
+    if (length >= 8 && isSSE2Present()) {
+        for (; i + 8 <= length; i += 8) {
+            __m128i aCharacters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i bCharacters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(aCharacters, bCharacters)) != 0xFFFF)
+                break;
+        }
+    }
+#endif
+    while (i < length && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+bool equal(const UChar* a, const UChar* b, unsigned length)
+{
+    return findFirstMismatch(a, b, length) == length;
+}
+
+static inline size_t findCharacter(const UChar* characters, unsigned length, UChar matchCharacter, unsigned index)
+{
+#if HAVE(SSE2_INTRINSICS)
+    if (index < length && length - index >= 8 && isSSE2Present()) {
+        const __m128i match = _mm_set1_epi16(matchCharacter);
+        for (; index + 8 <= length; index += 8) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters + index));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(block, match)))
+                break;
+        }
+    }
+#endif
+    return WTF::find(characters, length, matchCharacter, index);
+}
+
+static inline size_t reverseFindCharacter(const UChar* characters, unsigned length, UChar matchCharacter, unsigned index)
+{
+#if HAVE(SSE2_INTRINSICS)
+    if (index >= length)
+        index = length - 1;
+    if (length && index >= 8 && isSSE2Present()) {
+        const __m128i match = _mm_set1_epi16(matchCharacter);
+        for (; index >= 8; index -= 8) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters + index - 7));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(block, match)))
+                break;
+        }
     }
+#endif
+    return WTF::reverseFind(characters, length, matchCharacter, index);
+}
+
+#if HAVE(SSE2_INTRINSICS)
+// Tests 8 alignments of the match string per step by comparing its first
+// and last characters, and only compares the rest where both agree. Returns
+// true with i set to the first match, or false with i set to the first
+// alignment not yet ruled out. Requires matchLength >= 2.
+template <typename MatchCharacterType>
+static inline bool findSubstringCandidates(const UChar* searchCharacters, unsigned delta, const MatchCharacterType* matchCharacters, unsigned matchLength, unsigned& i)
+{
+    if (delta < 8 || !isSSE2Present())
+        return false;
+
+    const __m128i first = _mm_set1_epi16(matchCharacters[0]);
+    const __m128i last = _mm_set1_epi16(matchCharacters[matchLength - 1]);
+    for (; i + 8 <= delta + 1; i += 8) {
+        __m128i firstMatches = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(searchCharacters + i)), first);
+        __m128i lastMatches = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(searchCharacters + i + matchLength - 1)), last);
+        unsigned candidates = _mm_movemask_epi8(_mm_and_si128(firstMatches, lastMatches));
+        for (unsigned j = 0; candidates; ++j, candidates >>= 2) {
+            if ((candidates & 1) && equal(searchCharacters + i + j + 1, matchCharacters + 1, matchLength - 2)) {
+                i += j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// The backward counterpart of findSubstringCandidates: tests the 8
+// alignments ending at delta per step, nearest to delta first.
+static inline bool reverseFindSubstringCandidates(const UChar* searchCharacters, const UChar* matchCharacters, unsigned matchLength, unsigned& delta)
+{
+    if (delta < 8 || !isSSE2Present())
+        return false;
+
+    const __m128i first = _mm_set1_epi16(matchCharacters[0]);
+    const __m128i last = _mm_set1_epi16(matchCharacters[matchLength - 1]);
+    for (; delta >= 8; delta -= 8) {
+        const UChar* block = searchCharacters + delta - 7;
+        __m128i firstMatches = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)), first);
+        __m128i lastMatches = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + matchLength - 1)), last);
+        unsigned candidates = _mm_movemask_epi8(_mm_and_si128(firstMatches, lastMatches));
+        if (!candidates)
+            continue;
+        for (unsigned j = 8; j--; ) {
+            if ((candidates & (1 << (2 * j))) && equal(block + j + 1, matchCharacters + 1, matchLength - 2)) {
+                delta = delta - 7 + j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+#endif
+
+template<typename CharType1, typename CharType2>
+static inline unsigned findFirstMismatch(const CharType1* a, const CharType2* b, unsigned length)
+{
+    unsigned i = 0;
+    while (i < length && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+template<typename CharType1, typename CharType2>
+static inline int codePointCompare(unsigned l1, unsigned l2, const CharType1* c1, const CharType2* c2)
+{
+    const unsigned lmin = l1 < l2 ? l1 : l2;
+    unsigned pos = findFirstMismatch(c1, c2, lmin);
 
     if (pos < lmin)
-        return (c1[0] > c2[0]) ? 1 : -1;
+        return (c1[pos] > c2[pos]) ? 1 : -1;
 
     if (l1 == l2)
         return 0;
@@ -516,14 +772,37 @@ int codePointCompare(const StringImpl* s1, const StringImpl* s2)
     return (l1 > l2) ? 1 : -1;
 }
 
+int codePointCompare(const StringImpl* s1, const StringImpl* s2)
+{
+    const unsigned l1 = s1 ? s1->length() : 0;
+    const unsigned l2 = s2 ? s2->length() : 0;
+    if (!l1 || !l2)
+        return l1 == l2 ? 0 : (l1 > l2 ? 1 : -1);
+
+    if (s1->is8Bit()) {
+        if (s2->is8Bit())
+            return codePointCompare(l1, l2, s1->characters8(), s2->characters8());
+        return codePointCompare(l1, l2, s1->characters8(), s2->characters());
+    }
+    if (s2->is8Bit())
+        return codePointCompare(l1, l2, s1->characters(), s2->characters8());
+    return codePointCompare(l1, l2, s1->characters(), s2->characters());
+}
+
 size_t StringImpl::find(UChar c, unsigned start)
 {
-    return WTF::find(m_data, m_length, c, start);
+    if (is8Bit()) {
+        if ((c & 0xFF00) || start >= m_length)
+            return notFound;
+        const void* found = memchr(m_data8 + start, c, m_length - start);
+        return found ? static_cast<const LChar*>(found) - m_data8 : notFound;
+    }
+    return findCharacter(m_data, m_length, c, start);
 }
 
 size_t StringImpl::find(CharacterMatchFunctionPtr matchFunction, unsigned start)
 {
-    return WTF::find(m_data, m_length, matchFunction, start);
+    return WTF::find(characters(), m_length, matchFunction, start);
 }
 
 size_t StringImpl::find(const char* matchString, unsigned index)
@@ -540,7 +819,7 @@ size_t StringImpl::find(const char* matchString, unsigned index)
 
     // Optimization 1: fast case for strings of length 1.
     if (matchLength == 1)
-        return WTF::find(characters(), length(), *(const unsigned char*)matchString, index);
+        return findCharacter(characters(), length(), *(const unsigned char*)matchString, index);
 
     // Check index & matchLength are in range.
     if (index > length())
@@ -554,17 +833,23 @@ size_t StringImpl::find(const char* matchString, unsigned index)
     const UChar* searchCharacters = characters() + index;
     const unsigned char* matchCharacters = (const unsigned char*)matchString;
 
+    unsigned i = 0;
+#if HAVE(SSE2_INTRINSICS)
+    if (findSubstringCandidates(searchCharacters, delta, matchCharacters, matchLength, i))
+        return index + i;
+    if (i > delta)
+        return notFound;
+#endif
+
     // Optimization 2: keep a running hash of the strings,
     // only call memcmp if the hashes match.
     unsigned searchHash = 0;
     unsigned matchHash = 0;
-    unsigned i = 0;
-    for (i = 0; i < matchLength; ++i) {
-        searchHash += searchCharacters[i];
-        matchHash += matchCharacters[i];
+    for (unsigned j = 0; j < matchLength; ++j) {
+        searchHash += searchCharacters[i + j];
+        matchHash += matchCharacters[j];
     }
 
-    i = 0;
     // keep looping until we match
     while (searchHash != matchHash || !equal(searchCharacters + i, matchString, matchLength)) {
         if (i == delta)
@@ -609,6 +894,28 @@ size_t StringImpl::findIgnoringCase(const char* matchString, unsigned index)
     return index + i;
 }
 
+template<typename SearchCharType, typename MatchCharType>
+static inline size_t findInner(const SearchCharType* searchCharacters, const MatchCharType* matchCharacters, unsigned index, unsigned delta, unsigned matchLength)
+{
+    // Keep a running hash of the strings, only compare them if the hashes match.
+    unsigned searchHash = 0;
+    unsigned matchHash = 0;
+    for (unsigned j = 0; j < matchLength; ++j) {
+        searchHash += searchCharacters[j];
+        matchHash += matchCharacters[j];
+    }
+
+    unsigned i = 0;
+    while (searchHash != matchHash || !equal(searchCharacters + i, matchCharacters, matchLength)) {
+        if (i == delta)
+            return notFound;
+        searchHash += searchCharacters[i + matchLength];
+        searchHash -= searchCharacters[i];
+        ++i;
+    }
+    return index + i;
+}
+
 size_t StringImpl::find(StringImpl* matchString, unsigned index)
 {
     // Check for null or empty string to match against
@@ -620,7 +927,7 @@ size_t StringImpl::find(StringImpl* matchString, unsigned index)
 
     // Optimization 1: fast case for strings of length 1.
     if (matchLength == 1)
-        return WTF::find(characters(), length(), matchString->characters()[0], index);
+        return find((*matchString)[0], index);
 
     // Check index & matchLength are in range.
     if (index > length())
@@ -631,20 +938,33 @@ size_t StringImpl::find(StringImpl* matchString, unsigned index)
     // delta is the number of additional times to test; delta == 0 means test only once.
     unsigned delta = searchLength - matchLength;
 
+    // Search 8-bit strings as they are rather than widening them.
+    if (is8Bit()) {
+        if (matchString->is8Bit())
+            return findInner(characters8() + index, matchString->characters8(), index, delta, matchLength);
+        return findInner(characters8() + index, matchString->characters(), index, delta, matchLength);
+    }
+
     const UChar* searchCharacters = characters() + index;
     const UChar* matchCharacters = matchString->characters();
 
+    unsigned i = 0;
+#if HAVE(SSE2_INTRINSICS)
+    if (findSubstringCandidates(searchCharacters, delta, matchCharacters, matchLength, i))
+        return index + i;
+    if (i > delta)
+        return notFound;
+#endif
+
     // Optimization 2: keep a running hash of the strings,
     // only call memcmp if the hashes match.
     unsigned searchHash = 0;
     unsigned matchHash = 0;
-    unsigned i = 0;
-    for (i = 0; i < matchLength; ++i) {
-        searchHash += searchCharacters[i];
-        matchHash += matchCharacters[i];
+    for (unsigned j = 0; j < matchLength; ++j) {
+        searchHash += searchCharacters[i + j];
+        matchHash += matchCharacters[j];
     }
 
-    i = 0;
     // keep looping until we match
     while (searchHash != matchHash || memcmp(searchCharacters + i, matchCharacters, matchLength * sizeof(UChar))) {
         if (i == delta)
@@ -689,7 +1009,39 @@ size_t StringImpl::findIgnoringCase(StringImpl* matchString, unsigned index)
 
 size_t StringImpl::reverseFind(UChar c, unsigned index)
 {
-    return WTF::reverseFind(m_data, m_length, c, index);
+    if (is8Bit()) {
+        if ((c & 0xFF00) || !m_length)
+            return notFound;
+        if (index >= m_length)
+            index = m_length - 1;
+        while (m_data8[index] != c) {
+            if (!index--)
+                return notFound;
+        }
+        return index;
+    }
+    return reverseFindCharacter(m_data, m_length, c, index);
+}
+
+template<typename SearchCharType, typename MatchCharType>
+static inline size_t reverseFindInner(const SearchCharType* searchCharacters, const MatchCharType* matchCharacters, unsigned delta, unsigned matchLength)
+{
+    // Keep a running hash of the strings, only compare them if the hashes match.
+    unsigned searchHash = 0;
+    unsigned matchHash = 0;
+    for (unsigned i = 0; i < matchLength; ++i) {
+        searchHash += searchCharacters[delta + i];
+        matchHash += matchCharacters[i];
+    }
+
+    while (searchHash != matchHash || !equal(searchCharacters + delta, matchCharacters, matchLength)) {
+        if (!delta)
+            return notFound;
+        delta--;
+        searchHash -= searchCharacters[delta + matchLength];
+        searchHash += searchCharacters[delta];
+    }
+    return delta;
 }
 
 size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
@@ -703,7 +1055,7 @@ size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
 
     // Optimization 1: fast case for strings of length 1.
     if (matchLength == 1)
-        return WTF::reverseFind(characters(), length(), matchString->characters()[0], index);
+        return reverseFind((*matchString)[0], index);
 
     // Check index & matchLength are in range.
     if (matchLength > length())
@@ -711,9 +1063,20 @@ size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
     // delta is the number of additional times to test; delta == 0 means test only once.
     unsigned delta = min(index, length() - matchLength);
 
+    if (is8Bit()) {
+        if (matchString->is8Bit())
+            return reverseFindInner(characters8(), matchString->characters8(), delta, matchLength);
+        return reverseFindInner(characters8(), matchString->characters(), delta, matchLength);
+    }
+
     const UChar *searchCharacters = characters();
     const UChar *matchCharacters = matchString->characters();
 
+#if HAVE(SSE2_INTRINSICS)
+    if (reverseFindSubstringCandidates(searchCharacters, matchCharacters, matchLength, delta))
+        return delta;
+#endif
+
     // Optimization 2: keep a running hash of the strings,
     // only call memcmp if the hashes match.
     unsigned searchHash = 0;
@@ -777,7 +1140,7 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar oldC, UChar newC)
         return this;
     unsigned i;
     for (i = 0; i != m_length; ++i)
-        if (m_data[i] == oldC)
+        if ((*this)[i] == oldC)
             break;
     if (i == m_length)
         return this;
@@ -785,8 +1148,9 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar oldC, UChar newC)
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
+    const UChar* source = characters();
     for (i = 0; i != m_length; ++i) {
-        UChar ch = m_data[i];
+        UChar ch = source[i];
         if (ch == oldC)
             ch = newC;
         data[i] = ch;
@@ -856,15 +1220,15 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar pattern, StringImpl* replacemen
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacement->characters(), repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + 1;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -914,15 +1278,15 @@ PassRefPtr<StringImpl> StringImpl::replace(StringImpl* pattern, StringImpl* repl
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacement->characters(), repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + patternLength;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -942,6 +1306,16 @@ bool equal(const StringImpl* a, const char* b)
         return !a;
 
     unsigned length = a->length();
+    if (a->is8Bit()) {
+        const LChar* as = a->characters8();
+        for (unsigned i = 0; i != length; ++i) {
+            LChar bc = b[i];
+            if (!bc || as[i] != bc)
+                return false;
+        }
+        return !b[length];
+    }
+
     const UChar* as = a->characters();
     for (unsigned i = 0; i != length; ++i) {
         unsigned char bc = b[i];
@@ -1008,7 +1382,7 @@ bool equalIgnoringNullity(StringImpl* a, StringImpl* b)
 WTF::Unicode::Direction StringImpl::defaultWritingDirection(bool* hasStrongDirectionality)
 {
     for (unsigned i = 0; i < m_length; ++i) {
-        WTF::Unicode::Direction charDirection = WTF::Unicode::direction(m_data[i]);
+        WTF::Unicode::Direction charDirection = WTF::Unicode::direction((*this)[i]);
         if (charDirection == WTF::Unicode::LeftToRight) {
             if (hasStrongDirectionality)
                 *hasStrongDirectionality = true;
@@ -1056,7 +1430,7 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
     if (length >= numeric_limits<unsigned>::max())
         CRASH();
     RefPtr<StringImpl> terminatedString = createUninitialized(length + 1, data);
-    memcpy(data, string.m_data, length * sizeof(UChar));
+    memcpy(data, string.characters(), length * sizeof(UChar));
     data[length] = 0;
     terminatedString->m_length--;
     terminatedString->m_hash = string.m_hash;
@@ -1066,6 +1440,8 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
 
 PassRefPtr<StringImpl> StringImpl::threadsafeCopy() const
 {
+    if (is8Bit())
+        return create(m_data8, m_length);
     return create(m_data, m_length);
 }
 
@@ -79,6 +79,7 @@ private:
         , m_data(characters)
         , m_buffer(0)
         , m_hash(0)
+        , m_data8(0)
     {
         // Ensure that the hash is computed so that AtomicStringHash can call existingHash()
         // with impunity. The empty string is special because it is never entered into
@@ -92,17 +93,31 @@ private:
         , m_data(reinterpret_cast<const UChar*>(this + 1))
         , m_buffer(0)
         , m_hash(0)
+        , m_data8(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
     }
 
+    // Create an 8-bit string with internal storage (BufferInternal)
+    enum Force8Bit { Force8BitConstructor };
+    StringImpl(unsigned length, Force8Bit)
+        : StringImplBase(length, BufferInternal)
+        , m_data(0)
+        , m_buffer(0)
+        , m_hash(0)
+        , m_data8(reinterpret_cast<const LChar*>(this + 1))
+    {
+        ASSERT(m_length);
+    }
+
     // Create a StringImpl adopting ownership of the provided buffer (BufferOwned)
     StringImpl(const UChar* characters, unsigned length)
         : StringImplBase(length, BufferOwned)
         , m_data(characters)
         , m_buffer(0)
         , m_hash(0)
+        , m_data8(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
@@ -114,18 +129,34 @@ private:
         , m_data(characters)
         , m_substringBuffer(base.leakRef())
         , m_hash(0)
+        , m_data8(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
         ASSERT(m_substringBuffer->bufferOwnership() != BufferSubstring);
     }
 
+    // Used to create new 8-bit strings that are a substring of an existing 8-bit StringImpl (BufferSubstring)
+    StringImpl(const LChar* characters, unsigned length, PassRefPtr<StringImpl> base)
+        : StringImplBase(length, BufferSubstring)
+        , m_data(0)
+        , m_substringBuffer(base.leakRef())
+        , m_hash(0)
+        , m_data8(characters)
+    {
+        ASSERT(m_data8);
+        ASSERT(m_length);
+        ASSERT(m_substringBuffer->bufferOwnership() != BufferSubstring);
+        ASSERT(m_substringBuffer->is8Bit());
+    }
+
     // Used to construct new strings sharing an existing SharedUChar (BufferShared)
     StringImpl(const UChar* characters, unsigned length, PassRefPtr<SharedUChar> sharedBuffer)
         : StringImplBase(length, BufferShared)
         , m_data(characters)
         , m_sharedBuffer(sharedBuffer.leakRef())
         , m_hash(0)
+        , m_data8(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
@@ -136,7 +167,7 @@ private:
     {
         ASSERT(!isStatic());
         ASSERT(!m_hash);
-        ASSERT(hash == StringHasher::computeHash(m_data, m_length));
+        ASSERT(hash == computeHash());
         m_hash = hash;
     }
 
@@ -144,6 +175,7 @@ public:
     ~StringImpl();
 
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length);
+    static PassRefPtr<StringImpl> create(const LChar*, unsigned length);
     static PassRefPtr<StringImpl> create(const char*, unsigned length);
     static PassRefPtr<StringImpl> create(const char*);
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length, PassRefPtr<SharedUChar> sharedBuffer);
@@ -156,10 +188,16 @@ public:
             return empty();
 
         StringImpl* ownerRep = (rep->bufferOwnership() == BufferSubstring) ? rep->m_substringBuffer : rep.get();
+        if (rep->is8Bit())
+            return adoptRef(new StringImpl(rep->m_data8 + offset, length, ownerRep));
         return adoptRef(new StringImpl(rep->m_data + offset, length, ownerRep));
     }
 
+    // Returns an 8-bit string when every character fits in one byte.
+    static PassRefPtr<StringImpl> create8BitIfPossible(const UChar*, unsigned length);
+
     static PassRefPtr<StringImpl> createUninitialized(unsigned length, UChar*& data);
+    static PassRefPtr<StringImpl> createUninitialized(unsigned length, LChar*& data);
     static ALWAYS_INLINE PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, UChar*& output)
     {
         if (!length) {
@@ -179,8 +217,28 @@ public:
         output = reinterpret_cast<UChar*>(resultImpl + 1);
         return adoptRef(new(resultImpl) StringImpl(length));
     }
+    static ALWAYS_INLINE PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, LChar*& output)
+    {
+        if (!length) {
+            output = 0;
+            return empty();
+        }
+
+        if (length > std::numeric_limits<unsigned>::max() - sizeof(StringImpl)) {
+            output = 0;
+            return 0;
+        }
+        StringImpl* resultImpl;
+        if (!tryFastMalloc(length + sizeof(StringImpl)).getValue(resultImpl)) {
+            output = 0;
+            return 0;
+        }
+        output = reinterpret_cast<LChar*>(resultImpl + 1);
+        return adoptRef(new(resultImpl) StringImpl(length, Force8BitConstructor));
+    }
 
     static unsigned dataOffset() { return OBJECT_OFFSETOF(StringImpl, m_data); }
+    static unsigned data8Offset() { return OBJECT_OFFSETOF(StringImpl, m_data8); }
     static PassRefPtr<StringImpl> createWithTerminatingNullCharacter(const StringImpl&);
     static PassRefPtr<StringImpl> createStrippingNullCharacters(const UChar*, unsigned length);
 
@@ -198,7 +256,18 @@ public:
     static PassRefPtr<StringImpl> adopt(StringBuffer&);
 
     SharedUChar* sharedBuffer();
-    const UChar* characters() const { return m_data; }
+
+    // An 8-bit string keeps one byte per character and only builds a UChar
+    // copy, kept for the rest of its life, when characters() is first asked
+    // for. Code on hot paths should check is8Bit() and use characters8().
+    bool is8Bit() const { return m_data8; }
+    const LChar* characters8() const { ASSERT(is8Bit()); return m_data8; }
+    const UChar* characters() const
+    {
+        if (UNLIKELY(!m_data))
+            upconvertCharacters();
+        return m_data;
+    }
 
     size_t cost()
     {
@@ -235,7 +304,7 @@ public:
             m_refCountAndFlags &= ~s_refCountFlagIsAtomic;
     }
 
-    unsigned hash() const { if (!m_hash) m_hash = StringHasher::computeHash(m_data, m_length); return m_hash; }
+    unsigned hash() const { if (!m_hash) m_hash = computeHash(); return m_hash; }
     unsigned existingHash() const { ASSERT(m_hash); return m_hash; }
 
     ALWAYS_INLINE void deref() { m_refCountAndFlags -= s_refCountIncrement; if (!(m_refCountAndFlags & (s_refCountMask | s_refCountFlagStatic))) delete this; }
@@ -252,6 +321,12 @@ public:
             memcpy(destination, source, numCharacters * sizeof(UChar));
     }
 
+    static void copyChars(UChar* destination, const LChar* source, unsigned numCharacters)
+    {
+        for (unsigned i = 0; i < numCharacters; ++i)
+            destination[i] = source[i];
+    }
+
     // Returns a StringImpl suitable for use on another thread.
     PassRefPtr<StringImpl> crossThreadString();
     // Makes a deep copy. Helpful only if you need to use a String on another thread
@@ -261,7 +336,13 @@ public:
 
     PassRefPtr<StringImpl> substring(unsigned pos, unsigned len = UINT_MAX);
 
-    UChar operator[](unsigned i) { ASSERT(i < m_length); return m_data[i]; }
+    UChar operator[](unsigned i) const
+    {
+        ASSERT(i < m_length);
+        if (is8Bit())
+            return m_data8[i];
+        return m_data[i];
+    }
     UChar32 characterStartingAt(unsigned);
 
     bool containsOnlyWhitespace();
@@ -325,16 +406,21 @@ private:
     static const unsigned s_copyCharsInlineCutOff = 20;
 
     static PassRefPtr<StringImpl> createStrippingNullCharactersSlowCase(const UChar*, unsigned length);
+
+    unsigned computeHash() const { return is8Bit() ? StringHasher::computeHash(m_data8, m_length) : StringHasher::computeHash(m_data, m_length); }
+    void upconvertCharacters() const;
     
     BufferOwnership bufferOwnership() const { return static_cast<BufferOwnership>(m_refCountAndFlags & s_refCountMaskBufferOwnership); }
     bool isStatic() const { return m_refCountAndFlags & s_refCountFlagStatic; }
-    const UChar* m_data;
+    // Null for an 8-bit string until upconvertCharacters() fills it in.
+    mutable const UChar* m_data;
     union {
         void* m_buffer;
         StringImpl* m_substringBuffer;
         SharedUChar* m_sharedBuffer;
     };
     mutable unsigned m_hash;
+    const LChar* m_data8;
 };
 
 bool equal(const StringImpl*, const StringImpl*);
@@ -345,6 +431,7 @@ bool equalIgnoringCase(StringImpl*, StringImpl*);
 bool equalIgnoringCase(StringImpl*, const char*);
 inline bool equalIgnoringCase(const char* a, StringImpl* b) { return equalIgnoringCase(b, a); }
 bool equalIgnoringCase(const UChar* a, const char* b, unsigned length);
+bool equalIgnoringCase(const UChar*, const UChar*, unsigned length);
 inline bool equalIgnoringCase(const char* a, const UChar* b, unsigned length) { return equalIgnoringCase(b, a, length); }
 
 bool equalIgnoringNullity(StringImpl*, StringImpl*);
@@ -361,6 +448,44 @@ bool equalIgnoringNullity(const Vector<UChar, inlineCapacity>& a, StringImpl* b)
 
 int codePointCompare(const StringImpl*, const StringImpl*);
 
+inline bool equal(const LChar* a, const LChar* b, unsigned length)
+{
+    return !memcmp(a, b, length);
+}
+
+// Compares 8 characters at a time where SSE2 is present.
+bool equal(const UChar*, const UChar*, unsigned length);
+
+inline bool equal(const LChar* a, const UChar* b, unsigned length)
+{
+    for (unsigned i = 0; i < length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+inline bool equal(const UChar* a, const LChar* b, unsigned length)
+{
+    return equal(b, a, length);
+}
+
+// Compares two strings of the same length when either of them may be 8-bit,
+// without widening them.
+inline bool equalCharacters(const StringImpl* a, const StringImpl* b)
+{
+    ASSERT(a->length() == b->length());
+    unsigned length = a->length();
+    if (a->is8Bit()) {
+        if (b->is8Bit())
+            return equal(a->characters8(), b->characters8(), length);
+        return equal(a->characters8(), b->characters(), length);
+    }
+    if (b->is8Bit())
+        return equal(a->characters(), b->characters8(), length);
+    return !memcmp(a->characters(), b->characters(), length * sizeof(UChar));
+}
+
 static inline bool isSpaceOrNewline(UChar c)
 {
     // Use isASCIISpace() for basic Latin-1.
@@ -406,6 +531,7 @@ template<> struct DefaultHash<RefPtr<StringImpl> > {
 
 using WTF::StringImpl;
 using WTF::equal;
+using WTF::equalCharacters;
 using WTF::TextCaseSensitivity;
 using WTF::TextCaseSensitive;
 using WTF::TextCaseInsensitive;
@@ -141,6 +141,9 @@ public:
         return m_impl->characters();
     }
 
+    bool is8Bit() const { return m_impl && m_impl->is8Bit(); }
+    const LChar* characters8() const { return m_impl->characters8(); }
+
     CString ascii() const;
     CString latin1() const;
     CString utf8(bool strict = false) const;
@@ -149,7 +152,7 @@ public:
     {
         if (!m_impl || index >= m_impl->length())
             return 0;
-        return m_impl->characters()[index];
+        return (*m_impl)[index];
     }
 
     static String number(short);
@@ -254,6 +257,7 @@ public:
     // into the buffer returned in data before the returned string is used.
     // Failure to do this will have unpredictable results.
     static String createUninitialized(unsigned length, UChar*& data) { return StringImpl::createUninitialized(length, data); }
+    static String createUninitialized(unsigned length, LChar*& data) { return StringImpl::createUninitialized(length, data); }
 
     void split(const String& separator, Vector<String>& result) const;
     void split(const String& separator, bool allowEmptyEntries, Vector<String>& result) const;
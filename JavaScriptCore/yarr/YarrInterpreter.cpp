@@ -102,9 +102,14 @@ public:
         uintptr_t frame[1];
     };
 
+    static size_t disjunctionContextSize(ByteDisjunction* disjunction)
+    {
+        return sizeof(DisjunctionContext) - sizeof(uintptr_t) + disjunction->m_frameSize * sizeof(uintptr_t);
+    }
+
     DisjunctionContext* allocDisjunctionContext(ByteDisjunction* disjunction)
     {
-        size_t size = sizeof(DisjunctionContext) - sizeof(uintptr_t) + disjunction->m_frameSize * sizeof(uintptr_t);
+        size_t size = disjunctionContextSize(disjunction);
         allocatorPool = allocatorPool->ensureCapacity(size);
         if (!allocatorPool)
             CRASH();
@@ -152,9 +157,15 @@ public:
         int subpatternBackup[1];
     };
 
+    static size_t parenthesesDisjunctionContextSize(ByteDisjunction* disjunction)
+    {
+        return sizeof(ParenthesesDisjunctionContext) - sizeof(int) + (disjunction->m_numSubpatterns << 1) * sizeof(int) + disjunctionContextSize(disjunction);
+    }
+
     ParenthesesDisjunctionContext* allocParenthesesDisjunctionContext(ByteDisjunction* disjunction, int* output, ByteTerm& term)
     {
-        size_t size = sizeof(ParenthesesDisjunctionContext) - sizeof(int) + (term.atom.parenthesesDisjunction->m_numSubpatterns << 1) * sizeof(int) + sizeof(DisjunctionContext) - sizeof(uintptr_t) + disjunction->m_frameSize * sizeof(uintptr_t);
+        ASSERT(disjunction == term.atom.parenthesesDisjunction);
+        size_t size = parenthesesDisjunctionContextSize(disjunction);
         allocatorPool = allocatorPool->ensureCapacity(size);
         if (!allocatorPool)
             CRASH();
@@ -166,6 +177,35 @@ public:
         allocatorPool = allocatorPool->dealloc(context);
     }
 
+    // The contexts a match of the pattern stacks up when it goes through
+    // each group once, or count times for a fixed count group, so that the
+    // allocator can start out with a single pool big enough for all of them.
+    // Groups that repeat more often than that make the allocator keep a
+    // bigger pool for the next match.
+    static size_t frameLayoutSize(ByteDisjunction* body)
+    {
+        size_t size = disjunctionContextSize(body) + nestedContextsSize(body);
+        return size < maximumFrameLayoutSize ? size : maximumFrameLayoutSize;
+    }
+
+    static size_t nestedContextsSize(ByteDisjunction* disjunction)
+    {
+        size_t size = 0;
+        for (unsigned i = 0; i < disjunction->terms.size(); ++i) {
+            ByteTerm& term = disjunction->terms[i];
+            if (term.type != ByteTerm::TypeParenthesesSubpattern)
+                continue;
+
+            ByteDisjunction* parenthesesDisjunction = term.atom.parenthesesDisjunction;
+            size_t repetitionSize = parenthesesDisjunctionContextSize(parenthesesDisjunction) + nestedContextsSize(parenthesesDisjunction);
+            size_t count = term.atom.quantityType == QuantifierFixedCount ? term.atom.quantityCount : 1;
+            if (count > (maximumFrameLayoutSize - size) / repetitionSize)
+                return maximumFrameLayoutSize;
+            size += count * repetitionSize;
+        }
+        return size;
+    }
+
     class InputStream {
     public:
         InputStream(const UChar* input, unsigned start, unsigned length)
@@ -1386,7 +1426,7 @@ public:
 
     int interpret()
     {
-        allocatorPool = pattern->m_allocator->startAllocator();
+        allocatorPool = pattern->m_allocator->startAllocator(pattern->m_frameLayoutSize);
         if (!allocatorPool)
             CRASH();
 
@@ -1420,6 +1460,8 @@ public:
     }
 
 private:
+    static const size_t maximumFrameLayoutSize = MAXIMUM_RETAINED_BUMP_POOL_SIZE;
+
     BytecodePattern* pattern;
     int* output;
     InputStream input;
@@ -1453,7 +1495,9 @@ public:
         emitDisjunction(m_pattern.m_body);
         regexEnd();
 
-        return adoptPtr(new BytecodePattern(m_bodyDisjunction.release(), m_allParenthesesInfo, m_pattern, allocator));
+        OwnPtr<BytecodePattern> bytecodePattern = adoptPtr(new BytecodePattern(m_bodyDisjunction.release(), m_allParenthesesInfo, m_pattern, allocator));
+        bytecodePattern->m_frameLayoutSize = Interpreter::frameLayoutSize(bytecodePattern->m_body.get());
+        return bytecodePattern.release();
     }
 
     void checkInput(unsigned count)
@@ -330,6 +330,7 @@ public:
         , m_multiline(pattern.m_multiline)
         , m_containsBeginChars(pattern.m_containsBeginChars)
         , m_allocator(allocator)
+        , m_frameLayoutSize(0)
     {
         newlineCharacterClass = pattern.newlineCharacterClass();
         wordcharCharacterClass = pattern.wordcharCharacterClass();
@@ -350,6 +351,15 @@ public:
         deleteAllValues(m_userCharacterClasses);
     }
 
+    size_t sizeInBytes() const
+    {
+        size_t size = sizeof(*this) + sizeof(ByteDisjunction) + m_body->terms.size() * sizeof(ByteTerm);
+        for (size_t i = 0; i < m_allParenthesesInfo.size(); ++i)
+            size += sizeof(ByteDisjunction) + m_allParenthesesInfo[i]->terms.size() * sizeof(ByteTerm);
+        size += m_userCharacterClasses.size() * sizeof(CharacterClass);
+        return size;
+    }
+
     OwnPtr<ByteDisjunction> m_body;
     bool m_ignoreCase;
     bool m_multiline;
@@ -357,6 +367,9 @@ public:
     // Each BytecodePattern is associated with a RegExp, each RegExp is associated
     // with a JSGlobalData.  Cache a pointer to out JSGlobalData's m_regExpAllocator.
     BumpPointerAllocator* m_allocator;
+    // Bytes of interpreter contexts a match needs at least; see
+    // Interpreter::frameLayoutSize().
+    size_t m_frameLayoutSize;
 
     CharacterClass* newlineCharacterClass;
     CharacterClass* wordcharCharacterClass;
@@ -1125,6 +1125,124 @@ class YarrGenerator : private MacroAssembler {
         }
     }
 
+    // Reads the character at inputPosition into regT0 for comparing against
+    // requiredPrefixKey(); case insensitive patterns fold ASCII letters.
+    void readRequiredPrefixCharacter(int inputPosition)
+    {
+        readCharacter(inputPosition, regT0);
+        if (m_pattern.m_ignoreCase)
+            or32(TrustedImm32(32), regT0);
+    }
+
+    UChar requiredPrefixKey(UChar ch)
+    {
+        return m_pattern.m_ignoreCase ? (ch | 32) : ch;
+    }
+
+    void jumpIfFirstCharacterClassMatches(JumpList& matchDest)
+    {
+        if (!m_pattern.m_firstCharacterClassInverted) {
+            matchCharacterClass(regT0, matchDest, m_pattern.m_firstCharacterClass);
+            return;
+        }
+        JumpList inClass;
+        matchCharacterClass(regT0, inClass, m_pattern.m_firstCharacterClass);
+        matchDest.append(jump());
+        inClass.link(this);
+    }
+
+    // Planted at the reentry of a lone repeating body alternative, so before
+    // each attempt to match, to move the input position on to the next index
+    // at which the pattern's required prefix or first character class occurs.
+    // The alternative's own code still matches the prefix, so the scan only
+    // has to be conservative. Jumps to noInput if it runs out of input.
+    //
+    // The prefix is found with a Boyer-Moore-Horspool scan: look at the
+    // character under the prefix's last one, and if it differs, skip ahead so
+    // that its rightmost occurrence in the rest of the prefix lines up with it,
+    // or past it altogether if it does not occur. The skip table is planted as
+    // a chain of compares. Folding case may merge keys, which only ever makes
+    // skips shorter.
+    void generateRequiredPrefixScan(PatternAlternative* alternative, JumpList& noInput)
+    {
+        JumpList found;
+        JumpList foundAfterSkip;
+
+        if (unsigned prefixLength = m_pattern.m_requiredPrefix.size()) {
+            const Vector<UChar>& prefix = m_pattern.m_requiredPrefix;
+            int lastPosition = prefixLength - 1 - m_checked;
+            UChar lastKey = requiredPrefixKey(prefix[prefixLength - 1]);
+
+            Vector<UChar, 16> keys;
+            Vector<unsigned, 16> skips;
+            for (unsigned i = 0; i < prefixLength - 1; ++i) {
+                UChar key = requiredPrefixKey(prefix[i]);
+                if (key == lastKey)
+                    continue;
+                size_t k = keys.find(key);
+                if (k == notFound) {
+                    keys.append(key);
+                    skips.append(prefixLength - 1 - i);
+                } else
+                    skips[k] = prefixLength - 1 - i;
+            }
+
+            readRequiredPrefixCharacter(lastPosition);
+            found.append(branch32(Equal, regT0, Imm32(lastKey)));
+
+            Label skip(this);
+            Vector<unsigned, 16> skipValues;
+            Vector<JumpList, 16> skipJumps;
+            for (unsigned k = 0; k < keys.size(); ++k) {
+                size_t j = skipValues.find(skips[k]);
+                if (j == notFound) {
+                    j = skipValues.size();
+                    skipValues.append(skips[k]);
+                    skipJumps.append(JumpList());
+                }
+                skipJumps[j].append(branch32(Equal, regT0, Imm32(keys[k])));
+            }
+            JumpList skipped;
+            add32(Imm32(prefixLength), index);
+            skipped.append(jump());
+            for (unsigned j = 0; j < skipValues.size(); ++j) {
+                skipJumps[j].link(this);
+                add32(Imm32(skipValues[j]), index);
+                if (j + 1 < skipValues.size())
+                    skipped.append(jump());
+            }
+            skipped.link(this);
+
+            noInput.append(jumpIfNoAvailableInput());
+            readRequiredPrefixCharacter(lastPosition);
+            foundAfterSkip.append(branch32(Equal, regT0, Imm32(lastKey)));
+            jump(skip);
+        } else {
+            ASSERT(m_pattern.m_firstCharacterClass);
+            int firstPosition = -m_checked;
+
+            readCharacter(firstPosition, regT0);
+            jumpIfFirstCharacterClassMatches(found);
+
+            Label skip(this);
+            add32(TrustedImm32(1), index);
+            noInput.append(jumpIfNoAvailableInput());
+            readCharacter(firstPosition, regT0);
+            jumpIfFirstCharacterClassMatches(foundAfterSkip);
+            jump(skip);
+        }
+
+        // Having moved on, record where this attempt starts, as the loop back
+        // into the alternative would have.
+        foundAfterSkip.link(this);
+        if (!m_pattern.m_body->m_hasFixedSize) {
+            move(index, regT0);
+            sub32(Imm32(alternative->m_minimumSize), regT0);
+            store32(regT0, Address(output));
+        }
+        found.link(this);
+    }
+
     void generate()
     {
         // Forwards generate the matching code.
@@ -1172,6 +1290,12 @@ class YarrGenerator : private MacroAssembler {
                 op.m_reentry = label();
 
                 m_checked += alternative->m_minimumSize;
+
+                // Only set for a lone repeating alternative, so on each reentry.
+                if (!m_pattern.m_requiredPrefix.isEmpty() || m_pattern.m_firstCharacterClass) {
+                    ASSERT(m_pattern.m_body->m_alternatives.size() == 1 && !alternative->onceThrough());
+                    generateRequiredPrefixScan(alternative, op.m_jumps);
+                }
                 break;
             }
             case OpBodyAlternativeNext:
@@ -947,7 +947,39 @@ public:
         }
     }
 
+    // The literal characters a match has to begin with, at most
+    // maximumRequiredPrefixLength of them, or else the class its first
+    // character has to be in. Only a lone body alternative that is retried at
+    // each index benefits from a scan, so nothing is collected otherwise.
+    void setupRequiredPrefix()
+    {
+        Vector<PatternAlternative*>& alternatives = m_pattern.m_body->m_alternatives;
+        if (alternatives.size() != 1 || alternatives[0]->onceThrough())
+            return;
+
+        Vector<PatternTerm>& terms = alternatives[0]->m_terms;
+        for (unsigned i = 0; i < terms.size(); ++i) {
+            PatternTerm& term = terms[i];
+            if (term.type != PatternTerm::TypePatternCharacter || term.quantityType != QuantifierFixedCount)
+                break;
+            for (unsigned count = 0; count < term.quantityCount && m_pattern.m_requiredPrefix.size() < maximumRequiredPrefixLength; ++count)
+                m_pattern.m_requiredPrefix.append(term.patternCharacter);
+            if (m_pattern.m_requiredPrefix.size() == maximumRequiredPrefixLength)
+                break;
+        }
+
+        if (!m_pattern.m_requiredPrefix.isEmpty() || terms.isEmpty())
+            return;
+        PatternTerm& term = terms[0];
+        if (term.type == PatternTerm::TypeCharacterClass && term.quantityType == QuantifierFixedCount && term.quantityCount) {
+            m_pattern.m_firstCharacterClass = term.characterClass;
+            m_pattern.m_firstCharacterClassInverted = term.invert();
+        }
+    }
+
 private:
+    static const unsigned maximumRequiredPrefixLength = 16;
+
     YarrPattern& m_pattern;
     PatternAlternative* m_alternative;
     CharacterClassConstructor m_characterClassConstructor;
@@ -985,6 +1017,7 @@ const char* YarrPattern::compile(const UString& patternString)
         
     constructor.setupOffsets();
     constructor.setupBeginChars();
+    constructor.setupRequiredPrefix();
 
     return 0;
 }
@@ -995,8 +1028,10 @@ YarrPattern::YarrPattern(const UString& pattern, bool ignoreCase, bool multiline
     , m_containsBackreferences(false)
     , m_containsBeginChars(false)
     , m_containsBOL(false)
+    , m_firstCharacterClassInverted(false)
     , m_numSubpatterns(0)
     , m_maxBackReference(0)
+    , m_firstCharacterClass(0)
     , newlineCached(0)
     , digitsCached(0)
     , spacesCached(0)
@@ -329,6 +329,7 @@ struct YarrPattern {
         m_containsBackreferences = false;
         m_containsBeginChars = false;
         m_containsBOL = false;
+        m_firstCharacterClassInverted = false;
 
         newlineCached = 0;
         digitsCached = 0;
@@ -343,6 +344,8 @@ struct YarrPattern {
         deleteAllValues(m_userCharacterClasses);
         m_userCharacterClasses.clear();
         m_beginChars.clear();
+        m_requiredPrefix.clear();
+        m_firstCharacterClass = 0;
     }
 
     bool containsIllegalBackReference()
@@ -398,6 +401,7 @@ struct YarrPattern {
     bool m_containsBackreferences : 1;
     bool m_containsBeginChars : 1;
     bool m_containsBOL : 1;
+    bool m_firstCharacterClassInverted : 1;
     unsigned m_numSubpatterns;
     unsigned m_maxBackReference;
     PatternDisjunction* m_body;
@@ -405,6 +409,13 @@ struct YarrPattern {
     Vector<CharacterClass*> m_userCharacterClasses;
     Vector<BeginChar> m_beginChars;
 
+    // What every match starts with, for the JIT to scan ahead for before
+    // trying to match: a run of literal characters, or failing that a class
+    // the first character falls in. Both are left empty unless the body is a
+    // single alternative that is retried at every index.
+    Vector<UChar> m_requiredPrefix;
+    CharacterClass* m_firstCharacterClass;
+
 private:
     const char* compile(const UString& patternString);
 
@@ -31,17 +31,68 @@
 #include "config.h"
 #include "ScriptGCEvent.h"
 
-#if ENABLE(INSPECTOR)
-
 #include "JSDOMWindow.h"
 #include <heap/Heap.h>
 #include <runtime/JSGlobalData.h>
+
+#if ENABLE(INSPECTOR)
+#include "ScriptGCEventListener.h"
 #include <wtf/CurrentTime.h>
+#endif
 
 namespace WebCore {
 
 using namespace JSC;
 
+#if ENABLE(INSPECTOR)
+
+typedef Vector<ScriptGCEventListener*> GCEventListeners;
+
+static GCEventListeners& listeners()
+{
+    DEFINE_STATIC_LOCAL(GCEventListeners, listeners, ());
+    return listeners;
+}
+
+// Forwards collections of the common heap to the listeners, with times in
+// milliseconds like the rest of the timeline.
+class ScriptGCEventObserver : public HeapCollectionObserver {
+public:
+    virtual void didCollect(double startTime, double endTime, size_t collectedBytes)
+    {
+        GCEventListeners copy = listeners();
+        for (size_t i = 0; i < copy.size(); ++i)
+            copy[i]->didGC(startTime * 1000.0, endTime * 1000.0, collectedBytes);
+    }
+};
+
+static ScriptGCEventObserver& observer()
+{
+    DEFINE_STATIC_LOCAL(ScriptGCEventObserver, observer, ());
+    return observer;
+}
+
+void ScriptGCEvent::addEventListener(ScriptGCEventListener* eventListener)
+{
+    GCEventListeners& eventListeners = listeners();
+    if (eventListeners.contains(eventListener))
+        return;
+    eventListeners.append(eventListener);
+    if (eventListeners.size() == 1)
+        JSDOMWindow::commonJSGlobalData()->heap.addCollectionObserver(&observer());
+}
+
+void ScriptGCEvent::removeEventListener(ScriptGCEventListener* eventListener)
+{
+    GCEventListeners& eventListeners = listeners();
+    size_t index = eventListeners.find(eventListener);
+    if (index == notFound)
+        return;
+    eventListeners.remove(index);
+    if (eventListeners.isEmpty())
+        JSDOMWindow::commonJSGlobalData()->heap.removeCollectionObserver(&observer());
+}
+
 void ScriptGCEvent::getHeapSize(size_t& usedHeapSize, size_t& totalHeapSize, size_t& heapSizeLimit)
 {
     JSGlobalData* globalData = JSDOMWindow::commonJSGlobalData();
@@ -50,6 +101,16 @@ void ScriptGCEvent::getHeapSize(size_t& usedHeapSize, size_t& totalHeapSize, siz
     heapSizeLimit = 0;
 }
 
-} // namespace WebCore
+#endif // ENABLE(INSPECTOR)
 
-#endif // !ENABLE(INSPECTOR)
+const GCPauseHistogram& ScriptGCEvent::pauseHistogram()
+{
+    return JSDOMWindow::commonJSGlobalData()->heap.pauseHistogram();
+}
+
+void ScriptGCEvent::resetPauseHistogram()
+{
+    JSDOMWindow::commonJSGlobalData()->heap.resetPauseHistogram();
+}
+
+} // namespace WebCore
@@ -31,7 +31,9 @@
 #ifndef ScriptGCEvent_h
 #define ScriptGCEvent_h
 
-#if ENABLE(INSPECTOR)
+namespace JSC {
+struct GCPauseHistogram;
+}
 
 namespace WebCore {
 
@@ -40,12 +42,16 @@ class ScriptGCEventListener;
 class ScriptGCEvent
 {
 public:
-    static void addEventListener(ScriptGCEventListener*) { }
-    static void removeEventListener(ScriptGCEventListener*) { }
+#if ENABLE(INSPECTOR)
+    static void addEventListener(ScriptGCEventListener*);
+    static void removeEventListener(ScriptGCEventListener*);
     static void getHeapSize(size_t& usedHeapSize, size_t& totalHeapSize, size_t& heapSizeLimit);
+#endif
+    // Kept for every collection of the common heap, inspector or not.
+    static const JSC::GCPauseHistogram& pauseHistogram();
+    static void resetPauseHistogram();
 };
 
 } // namespace WebCore
 
-#endif // !ENABLE(INSPECTOR)
 #endif // !defined(ScriptGCEvent_h)
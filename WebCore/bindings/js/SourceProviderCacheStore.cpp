@@ -0,0 +1,99 @@
+#include "config.h"
+#include "SourceProviderCacheStore.h"
+
+#include "FileSystem.h"
+#include "JSDOMWindowBase.h"
+#include <parser/SourceProvider.h>
+#include <wtf/CryptographicallyRandomNumber.h>
+#include <wtf/SHA1.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringBuilder.h>
+#include <wtf/text/StringConcatenate.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+// A cache this large is either damaged or not worth the read.
+static const long long maximumCacheFileSize = 8 * 1024 * 1024;
+
+static String& cacheDirectory()
+{
+    DEFINE_STATIC_LOCAL(String, directory, ());
+    return directory;
+}
+
+void SourceProviderCacheStore::setDirectory(const String& directory)
+{
+    cacheDirectory() = directory;
+    if (!directory.isEmpty())
+        makeAllDirectories(directory);
+}
+
+String SourceProviderCacheStore::keyForSource(const String& source)
+{
+    if (cacheDirectory().isEmpty() || source.isEmpty())
+        return String();
+
+    SHA1 sha1;
+    sha1.addBytes(reinterpret_cast<const uint8_t*>(source.characters()), source.length() * sizeof(UChar));
+    Vector<uint8_t, 20> digest;
+    sha1.computeHash(digest);
+
+    static const char hexDigits[] = "0123456789abcdef";
+    StringBuilder key;
+    for (size_t i = 0; i < digest.size(); ++i) {
+        key.append(hexDigits[digest[i] >> 4]);
+        key.append(hexDigits[digest[i] & 0xf]);
+    }
+    key.append(".jspc");
+    return key.toString();
+}
+
+void SourceProviderCacheStore::load(const String& key, const String& source, JSC::SourceProviderCache* cache)
+{
+    if (key.isEmpty() || cacheDirectory().isEmpty())
+        return;
+
+    String path = pathByAppendingComponent(cacheDirectory(), key);
+    long long fileSize;
+    if (!getFileSize(path, fileSize) || fileSize <= 0 || fileSize > maximumCacheFileSize)
+        return;
+
+    PlatformFileHandle file = openFile(path, OpenForRead);
+    if (!isHandleValid(file))
+        return;
+
+    Vector<char> data(static_cast<size_t>(fileSize));
+    int bytesRead = readFromFile(file, data.data(), data.size());
+    closeFile(file);
+    if (bytesRead != static_cast<int>(data.size()))
+        return;
+
+    cache->decode(JSDOMWindowBase::commonJSGlobalData(), data.data(), data.size(), source.characters(), source.length());
+}
+
+void SourceProviderCacheStore::save(const String& key, const JSC::SourceProviderCache& cache)
+{
+    if (key.isEmpty() || cacheDirectory().isEmpty() || cache.isEmpty())
+        return;
+
+    Vector<char> data;
+    cache.encode(data);
+    if (data.size() > static_cast<size_t>(maximumCacheFileSize))
+        return;
+
+    // Another process may be writing the same entry, so the temporary name
+    // is made unique.
+    String path = pathByAppendingComponent(cacheDirectory(), key);
+    String temporaryPath = makeString(path, ".", String::number(cryptographicallyRandomNumber()), ".tmp");
+    PlatformFileHandle file = openFile(temporaryPath, OpenForWrite);
+    if (!isHandleValid(file))
+        return;
+
+    int bytesWritten = writeToFile(file, data.data(), data.size());
+    closeFile(file);
+    if (bytesWritten != static_cast<int>(data.size()) || !moveFile(temporaryPath, path))
+        deleteFile(temporaryPath);
+}
+
+} // namespace WebCore
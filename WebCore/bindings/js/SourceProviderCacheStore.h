@@ -0,0 +1,37 @@
+#ifndef SourceProviderCacheStore_h
+#define SourceProviderCacheStore_h
+
+#include <wtf/Forward.h>
+
+namespace JSC {
+    class SourceProviderCache;
+}
+
+namespace WebCore {
+
+// Keeps the parser's per-script function cache on disk between runs.
+//
+// The cache records where every function body the parser has seen ends and
+// which names it uses, which is what lets the parser skip the body the next
+// time it meets it. Saving it means the first parse of a script after a
+// restart is as cheap as a reparse. Entries are named by the SHA-1 of the
+// script text, so a changed script simply misses. Nothing is stored until
+// the embedder names a directory.
+class SourceProviderCacheStore {
+public:
+    static void setDirectory(const String&);
+
+    // Returns an empty string when the store is disabled.
+    static String keyForSource(const String& source);
+
+    // source is the script text the key was computed from; entries that do
+    // not match it are rejected.
+    static void load(const String& key, const String& source, JSC::SourceProviderCache*);
+    // Writes to a temporary file and renames it over the entry, so a reader
+    // never sees a partly written cache.
+    static void save(const String& key, const JSC::SourceProviderCache&);
+};
+
+} // namespace WebCore
+
+#endif // SourceProviderCacheStore_h
@@ -207,7 +207,10 @@ void CSSParser::setupParser(const char* prefix, const String& string, const char
     for (unsigned i = 0; i < strlen(prefix); i++)
         m_data[i] = prefix[i];
 
-    memcpy(m_data + strlen(prefix), string.characters(), string.length() * sizeof(UChar));
+    if (string.is8Bit())
+        StringImpl::copyChars(m_data + strlen(prefix), string.characters8(), string.length());
+    else
+        memcpy(m_data + strlen(prefix), string.characters(), string.length() * sizeof(UChar));
 
     unsigned start = strlen(prefix) + string.length();
     unsigned end = start + strlen(suffix);
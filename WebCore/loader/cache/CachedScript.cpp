@@ -35,6 +35,7 @@
 #include <wtf/Vector.h>
 
 #if USE(JSC)  
+#include "SourceProviderCacheStore.h"
 #include <parser/SourceProvider.h>
 #endif
 
@@ -44,6 +45,9 @@ CachedScript::CachedScript(const String& url, const String& charset)
     : CachedResource(url, Script)
     , m_decoder(TextResourceDecoder::create("application/javascript", charset))
     , m_decodedDataDeletionTimer(this, &CachedScript::decodedDataDeletionTimerFired)
+#if USE(JSC)
+    , m_sourceProviderCacheSaveTimer(this, &CachedScript::sourceProviderCacheSaveTimerFired)
+#endif
 {
     // It's javascript we want.
     // But some websites think their scripts are <some wrong mimetype here>
@@ -53,6 +57,10 @@ CachedScript::CachedScript(const String& url, const String& charset)
 
 CachedScript::~CachedScript()
 {
+#if USE(JSC)
+    if (m_sourceProviderCacheSaveTimer.isActive())
+        saveSourceProviderCache();
+#endif
 }
 
 void CachedScript::didAddClient(CachedResourceClient* c)
@@ -86,6 +94,14 @@ const String& CachedScript::script()
     if (!m_script && m_data) {
         m_script = m_decoder->decode(m_data->data(), encodedSize());
         m_script += m_decoder->flush();
+        // The JavaScript parser reads UChars, so keep a single 16-bit copy
+        // rather than the 8-bit text plus the copy it would be widened into.
+        if (m_script.is8Bit()) {
+            UChar* characters;
+            String script = String::createUninitialized(m_script.length(), characters);
+            StringImpl::copyChars(characters, m_script.characters8(), m_script.length());
+            m_script = script;
+        }
         setDecodedSize(m_script.length() * sizeof(UChar));
     }
     m_decodedDataDeletionTimer.startOneShot(0);
@@ -117,8 +133,14 @@ void CachedScript::destroyDecodedData()
     m_script = String();
     unsigned extraSize = 0;
 #if USE(JSC)
-    if (m_sourceProviderCache && m_clients.isEmpty())
+    if (m_sourceProviderCache && m_clients.isEmpty()) {
+        if (m_sourceProviderCacheSaveTimer.isActive())
+            saveSourceProviderCache();
         m_sourceProviderCache->clear();
+        // From here on the cache only holds what later parses add, which
+        // must not replace the complete copy on disk.
+        m_sourceProviderCacheKey = String();
+    }
 
     extraSize = m_sourceProviderCache ? m_sourceProviderCache->byteSize() : 0;
 #endif
@@ -135,14 +157,36 @@ void CachedScript::decodedDataDeletionTimerFired(Timer<CachedScript>*)
 #if USE(JSC)
 JSC::SourceProviderCache* CachedScript::sourceProviderCache() const
 {   
-    if (!m_sourceProviderCache) 
-        m_sourceProviderCache = adoptPtr(new JSC::SourceProviderCache); 
+    if (!m_sourceProviderCache) {
+        m_sourceProviderCache = adoptPtr(new JSC::SourceProviderCache);
+        const String& source = const_cast<CachedScript*>(this)->script();
+        m_sourceProviderCacheKey = SourceProviderCacheStore::keyForSource(source);
+        SourceProviderCacheStore::load(m_sourceProviderCacheKey, source, m_sourceProviderCache.get());
+        if (unsigned loadedSize = m_sourceProviderCache->byteSize())
+            const_cast<CachedScript*>(this)->setDecodedSize(decodedSize() + loadedSize);
+    }
     return m_sourceProviderCache.get(); 
 }
 
 void CachedScript::sourceProviderCacheSizeChanged(int delta)
 {
     setDecodedSize(decodedSize() + delta);
+
+    // Parsing tends to add functions in bursts, so write once things settle.
+    if (delta > 0 && !m_sourceProviderCacheKey.isEmpty())
+        m_sourceProviderCacheSaveTimer.startOneShot(2);
+}
+
+void CachedScript::sourceProviderCacheSaveTimerFired(Timer<CachedScript>*)
+{
+    saveSourceProviderCache();
+}
+
+void CachedScript::saveSourceProviderCache()
+{
+    m_sourceProviderCacheSaveTimer.stop();
+    if (m_sourceProviderCache)
+        SourceProviderCacheStore::save(m_sourceProviderCacheKey, *m_sourceProviderCache);
 }
 #endif
 
@@ -63,6 +63,10 @@ namespace WebCore {
 #endif
     private:
         void decodedDataDeletionTimerFired(Timer<CachedScript>*);
+#if USE(JSC)
+        void sourceProviderCacheSaveTimerFired(Timer<CachedScript>*);
+        void saveSourceProviderCache();
+#endif
         virtual PurgePriority purgePriority() const { return PurgeLast; }
 
         String m_script;
@@ -70,6 +74,10 @@ namespace WebCore {
         Timer<CachedScript> m_decodedDataDeletionTimer;
 #if USE(JSC)        
         mutable OwnPtr<JSC::SourceProviderCache> m_sourceProviderCache;
+        // Names the on-disk copy of m_sourceProviderCache; empty when the
+        // store is disabled. See SourceProviderCacheStore.
+        mutable String m_sourceProviderCacheKey;
+        Timer<CachedScript> m_sourceProviderCacheSaveTimer;
 #endif
     };
 }
@@ -2205,6 +2205,9 @@ public:
     }
 };
 
+// Client notifications only tell the client about icons, so they wait for idle
+// time rather than compete with loading. They share a priority with each
+// other, so they still arrive in the order they were sent.
 static void performWorkItem(void* context)
 {
     ClientWorkItem* item = static_cast<ClientWorkItem*>(context);
@@ -2217,7 +2220,7 @@ void IconDatabase::dispatchDidImportIconURLForPageURLOnMainThread(const String&
     ASSERT_ICON_SYNC_THREAD();
 
     ImportedIconURLForPageURLWorkItem* work = new ImportedIconURLForPageURLWorkItem(m_client, pageURL);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 void IconDatabase::dispatchDidImportIconDataForPageURLOnMainThread(const String& pageURL)
@@ -2225,7 +2228,7 @@ void IconDatabase::dispatchDidImportIconDataForPageURLOnMainThread(const String&
     ASSERT_ICON_SYNC_THREAD();
 
     ImportedIconDataForPageURLWorkItem* work = new ImportedIconDataForPageURLWorkItem(m_client, pageURL);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 void IconDatabase::dispatchDidRemoveAllIconsOnMainThread()
@@ -2233,7 +2236,7 @@ void IconDatabase::dispatchDidRemoveAllIconsOnMainThread()
     ASSERT_ICON_SYNC_THREAD();
 
     RemovedAllIconsWorkItem* work = new RemovedAllIconsWorkItem(m_client);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 void IconDatabase::dispatchDidFinishURLImportOnMainThread()
@@ -2241,7 +2244,7 @@ void IconDatabase::dispatchDidFinishURLImportOnMainThread()
     ASSERT_ICON_SYNC_THREAD();
 
     FinishedURLImport* work = new FinishedURLImport(m_client);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 
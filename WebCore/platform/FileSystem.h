@@ -161,6 +161,8 @@ static const char PlatformFilePathSeparator = '/';
 void revealFolderInOS(const String&);
 bool fileExists(const String&);
 bool deleteFile(const String&);
+// Replaces newPath if it exists. Only moves within one volume are supported.
+bool moveFile(const String& oldPath, const String& newPath);
 bool deleteEmptyDirectory(const String&);
 bool getFileSize(const String&, long long& result);
 bool getFileModificationTime(const String&, time_t& result);
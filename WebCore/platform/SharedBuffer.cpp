@@ -59,17 +59,29 @@ static inline void freeSegment(char* p)
 
 SharedBuffer::SharedBuffer()
     : m_size(0)
+#if !USE(CF) || PLATFORM(QT)
+    , m_externalData(0)
+    , m_externalDataSize(0)
+#endif
 {
 }
 
 SharedBuffer::SharedBuffer(const char* data, int size)
     : m_size(0)
+#if !USE(CF) || PLATFORM(QT)
+    , m_externalData(0)
+    , m_externalDataSize(0)
+#endif
 {
     append(data, size);
 }
 
 SharedBuffer::SharedBuffer(const unsigned char* data, int size)
     : m_size(0)
+#if !USE(CF) || PLATFORM(QT)
+    , m_externalData(0)
+    , m_externalDataSize(0)
+#endif
 {
     append(reinterpret_cast<const char*>(data), size);
 }
@@ -247,31 +259,46 @@ unsigned SharedBuffer::getSomeData(const char*& someData, unsigned position) con
 
 #if !USE(CF) || PLATFORM(QT)
 
+PassRefPtr<SharedBuffer> SharedBuffer::wrapExternalData(const char* data, unsigned size)
+{
+    RefPtr<SharedBuffer> buffer = create();
+    buffer->m_externalData = data;
+    buffer->m_externalDataSize = size;
+    return buffer.release();
+}
+
 inline void SharedBuffer::clearPlatformData()
 {
+    m_externalData = 0;
+    m_externalDataSize = 0;
 }
 
 inline void SharedBuffer::maybeTransferPlatformData()
 {
+    if (!m_externalData)
+        return;
+
+    ASSERT(!m_size);
+
+    const char* data = m_externalData;
+    unsigned size = m_externalDataSize;
+    clearPlatformData();
+    append(data, size);
 }
 
 inline bool SharedBuffer::hasPlatformData() const
 {
-    return false;
+    return m_externalData;
 }
 
 inline const char* SharedBuffer::platformData() const
 {
-    ASSERT_NOT_REACHED();
-
-    return 0;
+    return m_externalData;
 }
 
 inline unsigned SharedBuffer::platformDataSize() const
 {
-    ASSERT_NOT_REACHED();
-    
-    return 0;
+    return m_externalDataSize;
 }
 
 #endif
@@ -73,6 +73,12 @@ public:
     CFDataRef createCFData();
     static PassRefPtr<SharedBuffer> wrapCFData(CFDataRef);
 #endif
+#if !USE(CF) || PLATFORM(QT)
+    // Wraps memory owned by someone else without copying it. The caller must
+    // keep the bytes alive and unchanged for as long as the buffer is used;
+    // the first append() copies them into the buffer's own storage.
+    static PassRefPtr<SharedBuffer> wrapExternalData(const char*, unsigned);
+#endif
 
     // Calling this function will force internal segmented buffers
     // to be merged into a flat buffer. Use getSomeData() whenever possible
@@ -142,6 +148,10 @@ private:
     SharedBuffer(CFDataRef);
     RetainPtr<CFDataRef> m_cfData;
 #endif
+#if !USE(CF) || PLATFORM(QT)
+    const char* m_externalData;
+    unsigned m_externalDataSize;
+#endif
 };
     
 }
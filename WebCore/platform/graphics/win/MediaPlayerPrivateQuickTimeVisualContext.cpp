@@ -780,8 +780,9 @@ void MediaPlayerPrivateQuickTimeVisualContext::VisualContextClient::retrieveCurr
 
 void MediaPlayerPrivateQuickTimeVisualContext::VisualContextClient::imageAvailableForTime(const QTCVTimeStamp* timeStamp)
 {
-    // This call may come in on another thread, so marshall to the main thread first:
-    callOnMainThread(&retrieveCurrentImageProc, m_parent);
+    // This call may come in on another thread, so marshall to the main thread first.
+    // A new frame is something to paint, so it goes ahead of loading work:
+    callOnMainThread(&retrieveCurrentImageProc, m_parent, MainThreadPaintPriority);
 
     // callOnMainThread must be paired with cancelCallOnMainThread in the destructor,
     // in case this object is deleted before the main thread request is handled.
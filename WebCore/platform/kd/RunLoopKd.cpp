@@ -0,0 +1,120 @@
+#include "config.h"
+#include "RunLoopKd.h"
+
+#include "SharedTimerKd.h"
+
+#include <wtf/MainThread.h>
+#include <wtf/ThreadSpecific.h>
+
+namespace WebCore {
+
+static WTF::ThreadSpecific<RunLoopKd>* runLoopKdSpecific;
+static RunLoopKd* mainThreadRunLoop;
+
+void RunLoopKd::wakeUpMain()
+{
+    // Called from whichever thread used callOnMainThread(), so it must not
+    // go through current().
+    if (mainThreadRunLoop)
+        mainThreadRunLoop->wakeUp();
+}
+
+RunLoopKd* RunLoopKd::current()
+{
+    if (!runLoopKdSpecific)
+        runLoopKdSpecific = new WTF::ThreadSpecific<RunLoopKd>;
+
+    RunLoopKd* runLoop = *runLoopKdSpecific;
+    if (!runLoop) {
+        runLoop = new RunLoopKd();
+        *runLoopKdSpecific = runLoop;
+    }
+    return runLoop;
+}
+
+RunLoopKd::RunLoopKd()
+    : m_stopped(false)
+{
+    platformInit();
+
+    if (isMainThread()) {
+        mainThreadRunLoop = this;
+        WTF::setMainThreadDispatchScheduler(wakeUpMain);
+    }
+}
+
+RunLoopKd::~RunLoopKd()
+{
+    if (mainThreadRunLoop == this) {
+        WTF::setMainThreadDispatchScheduler(0);
+        mainThreadRunLoop = 0;
+    }
+    platformDestroy();
+}
+
+void RunLoopKd::addWorkFunction(WorkFunction* function, void* context)
+{
+    WorkItem item = { function, context };
+    m_workFunctions.append(item);
+}
+
+void RunLoopKd::removeWorkFunction(WorkFunction* function, void* context)
+{
+    size_t index = findWorkFunction(function, context);
+    if (index != notFound)
+        m_workFunctions.remove(index);
+}
+
+size_t RunLoopKd::findWorkFunction(WorkFunction* function, void* context) const
+{
+    for (size_t i = 0; i < m_workFunctions.size(); ++i) {
+        if (m_workFunctions[i].function == function && m_workFunctions[i].context == context)
+            return i;
+    }
+    return notFound;
+}
+
+void RunLoopKd::runWorkFunctions()
+{
+    // A work function may unregister itself or another page's (page
+    // teardown), so walk a copy and skip anything removed earlier in the pass;
+    // its context may already be deleted.
+    Vector<WorkItem> workFunctions = m_workFunctions;
+    for (size_t i = 0; i < workFunctions.size(); ++i) {
+        if (findWorkFunction(workFunctions[i].function, workFunctions[i].context) == notFound)
+            continue;
+        workFunctions[i].function(workFunctions[i].context);
+    }
+}
+
+bool RunLoopKd::iterate(int timeoutMS)
+{
+    if (m_stopped)
+        return false;
+
+    bool timerFired = false;
+    bool woken = wait(timeoutMS, timerFired);
+
+    if (timerFired)
+        SharedTimerKd::inst()->timerEvent();
+    WTF::dispatchFunctionsFromMainThread();
+
+    if (woken)
+        runWorkFunctions();
+
+    return !m_stopped;
+}
+
+void RunLoopKd::run()
+{
+    m_stopped = false;
+    while (iterate(-1)) { }
+}
+
+void RunLoopKd::stop()
+{
+    m_stopped = true;
+    wakeUp();
+}
+
+} // namespace WebCore
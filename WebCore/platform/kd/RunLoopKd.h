@@ -0,0 +1,84 @@
+#ifndef RunLoopKd_h
+#define RunLoopKd_h
+
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+#if OS(WINDOWS)
+#include <windows.h>
+#endif
+
+namespace WebCore {
+
+// Event-driven run loop for headless pages.
+//
+// Sleeps until one of three things happens: the shared timer armed through
+// setSharedTimerFireTime() becomes due, another thread posts a function with
+// callOnMainThread(), or the embedder calls wakeUp() because a page queued
+// paint or resource work. Nothing is polled. On Linux it waits in epoll_wait()
+// on a timerfd and an eventfd (RunLoopKdLinux.cpp); on Windows it waits in
+// MsgWaitForMultipleObjectsEx() on a waitable timer and an event, and also
+// dispatches the thread's window messages (RunLoopKdWin.cpp).
+class RunLoopKd {
+    WTF_MAKE_NONCOPYABLE(RunLoopKd);
+public:
+    typedef void WorkFunction(void* context);
+
+    static RunLoopKd* current();
+    ~RunLoopKd();
+
+    // Work functions are run once per wake-up, after timers and main-thread
+    // functions have been dispatched. KWebPage registers its paint and
+    // resource-loader pass here.
+    void addWorkFunction(WorkFunction*, void* context);
+    void removeWorkFunction(WorkFunction*, void* context);
+
+    // Absolute time in seconds, as returned by WTF::currentTime().
+    void setTimerFireTime(double fireTime);
+    void stopTimer();
+
+    // Thread safe.
+    void wakeUp();
+    // Wakes the main thread's run loop, if it has one. Thread safe.
+    static void wakeUpMain();
+
+    void run();
+    void stop();
+
+    // Waits at most timeoutMS (-1 waits forever) and services whatever is
+    // ready. Returns false once stop() has been called, or on Windows once
+    // WM_QUIT has been received.
+    bool iterate(int timeoutMS);
+
+private:
+    RunLoopKd();
+
+    void platformInit();
+    void platformDestroy();
+    // Waits for the timer, a wake-up or (on Windows) a window message.
+    // Returns false if the wait timed out.
+    bool wait(int timeoutMS, bool& timerFired);
+
+    void runWorkFunctions();
+    size_t findWorkFunction(WorkFunction*, void* context) const;
+
+#if OS(WINDOWS)
+    HANDLE m_timer;
+    HANDLE m_event;
+#else
+    int m_epollFd;
+    int m_timerFd;
+    int m_eventFd;
+#endif
+    bool m_stopped;
+
+    struct WorkItem {
+        WorkFunction* function;
+        void* context;
+    };
+    Vector<WorkItem> m_workFunctions;
+};
+
+} // namespace WebCore
+
+#endif // RunLoopKd_h
@@ -0,0 +1,91 @@
+#include "config.h"
+#include "RunLoopKd.h"
+
+#include <wtf/CurrentTime.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace WebCore {
+
+static void drainFd(int fd)
+{
+    uint64_t count;
+    while (read(fd, &count, sizeof(count)) < 0 && errno == EINTR) { }
+}
+
+void RunLoopKd::platformInit()
+{
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_timerFd < 0 || m_eventFd < 0)
+        CRASH();
+
+    struct epoll_event event = { 0 };
+    event.events = EPOLLIN;
+    event.data.fd = m_timerFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_timerFd, &event);
+    event.data.fd = m_eventFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_eventFd, &event);
+}
+
+void RunLoopKd::platformDestroy()
+{
+    close(m_eventFd);
+    close(m_timerFd);
+    close(m_epollFd);
+}
+
+void RunLoopKd::setTimerFireTime(double fireTime)
+{
+    // timerfd works on CLOCK_MONOTONIC while WebCore hands us wall-clock
+    // seconds, so convert through the interval rather than the absolute time.
+    double interval = fireTime - currentTime();
+
+    struct itimerspec spec = { { 0, 0 }, { 0, 0 } };
+    if (interval <= 0) {
+        // A zero it_value disarms the timer; use the smallest non-zero value
+        // so an already expired timer still fires on the next iteration.
+        spec.it_value.tv_nsec = 1;
+    } else {
+        spec.it_value.tv_sec = static_cast<time_t>(interval);
+        spec.it_value.tv_nsec = static_cast<long>((interval - spec.it_value.tv_sec) * 1000000000.0);
+        if (!spec.it_value.tv_sec && !spec.it_value.tv_nsec)
+            spec.it_value.tv_nsec = 1;
+    }
+    timerfd_settime(m_timerFd, 0, &spec, 0);
+}
+
+void RunLoopKd::stopTimer()
+{
+    struct itimerspec spec = { { 0, 0 }, { 0, 0 } };
+    timerfd_settime(m_timerFd, 0, &spec, 0);
+}
+
+void RunLoopKd::wakeUp()
+{
+    uint64_t one = 1;
+    while (write(m_eventFd, &one, sizeof(one)) < 0 && errno == EINTR) { }
+}
+
+bool RunLoopKd::wait(int timeoutMS, bool& timerFired)
+{
+    struct epoll_event events[2];
+    int count = epoll_wait(m_epollFd, events, 2, timeoutMS);
+    if (count < 0 && errno != EINTR)
+        CRASH();
+
+    for (int i = 0; i < count; ++i) {
+        drainFd(events[i].data.fd);
+        if (events[i].data.fd == m_timerFd)
+            timerFired = true;
+    }
+    return count > 0;
+}
+
+} // namespace WebCore
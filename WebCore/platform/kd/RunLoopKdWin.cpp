@@ -0,0 +1,80 @@
+#include "config.h"
+#include "RunLoopKd.h"
+
+#include <wtf/CurrentTime.h>
+
+namespace WebCore {
+
+void RunLoopKd::platformInit()
+{
+    // A synchronization timer and an auto-reset event: a successful wait
+    // resets both, so nothing needs draining afterwards.
+    m_timer = ::CreateWaitableTimerW(0, FALSE, 0);
+    m_event = ::CreateEventW(0, FALSE, FALSE, 0);
+    if (!m_timer || !m_event)
+        CRASH();
+}
+
+void RunLoopKd::platformDestroy()
+{
+    ::CloseHandle(m_event);
+    ::CloseHandle(m_timer);
+}
+
+void RunLoopKd::setTimerFireTime(double fireTime)
+{
+    // A negative due time is relative, in 100ns units; like the Linux timerfd
+    // this avoids mixing WebCore's wall-clock seconds with the system clock.
+    double interval = fireTime - currentTime();
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -1;
+    if (interval > 0 && static_cast<LONGLONG>(interval * 10000000.0) > 0)
+        dueTime.QuadPart = -static_cast<LONGLONG>(interval * 10000000.0);
+    ::SetWaitableTimer(m_timer, &dueTime, 0, 0, 0, FALSE);
+}
+
+void RunLoopKd::stopTimer()
+{
+    ::CancelWaitableTimer(m_timer);
+}
+
+void RunLoopKd::wakeUp()
+{
+    ::SetEvent(m_event);
+}
+
+bool RunLoopKd::wait(int timeoutMS, bool& timerFired)
+{
+    // MWMO_INPUTAVAILABLE also returns for messages that were already in the
+    // queue before the wait, which a previous PeekMessage may have left.
+    HANDLE handles[] = { m_timer, m_event };
+    DWORD result = ::MsgWaitForMultipleObjectsEx(WTF_ARRAY_LENGTH(handles), handles,
+        timeoutMS < 0 ? INFINITE : timeoutMS, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    if (result == WAIT_FAILED)
+        CRASH();
+    if (result == WAIT_TIMEOUT)
+        return false;
+
+    // Only the first signalled handle is reported (and reset), so look at the
+    // timer again when the event or a message woke us.
+    if (result == WAIT_OBJECT_0 || ::WaitForSingleObject(m_timer, 0) == WAIT_OBJECT_0)
+        timerFired = true;
+
+    // Headless pages have no window, but the thread may still own windows
+    // (windowed pages, the embedder's own) that only get messages from here.
+    MSG message;
+    while (::PeekMessageW(&message, 0, 0, 0, PM_REMOVE)) {
+        if (message.message == WM_QUIT) {
+            // Leave it for any message loop this one runs inside of.
+            ::PostQuitMessage(static_cast<int>(message.wParam));
+            m_stopped = true;
+            break;
+        }
+        ::TranslateMessage(&message);
+        ::DispatchMessageW(&message);
+    }
+    return true;
+}
+
+} // namespace WebCore
@@ -34,6 +34,8 @@
 
 #include "SystemTime.h"
 #include "wtf/CurrentTime.h"
+#include "wtf/MathExtras.h"
+#include "RunLoopKd.h"
 
 namespace WebCore {
 
@@ -68,6 +70,8 @@ public:
 
 SharedTimerKd::SharedTimerKd(/*QObject* parent*/)
     : m_timerFunction(0)
+    , m_fireTime(0)
+    , m_isActive(false)
 {}
 
 SharedTimerKd::~SharedTimerKd()
@@ -79,7 +83,11 @@ SharedTimerKd::~SharedTimerKd()
 static WTF::ThreadSpecific<SharedTimerKd> sharedTimerKdTimer;
 SharedTimerKd* SharedTimerKd::inst()
 {
+#if OS(WINDOWS)
     if (!sharedTimerKdTimer.hasInit())
+#else
+    if (!static_cast<SharedTimerKd*>(sharedTimerKdTimer))
+#endif
         sharedTimerKdTimer = new SharedTimerKd(/*QCoreApplication::instance()*/);
 
     return sharedTimerKdTimer;
@@ -87,32 +95,48 @@ SharedTimerKd* SharedTimerKd::inst()
 
 void SharedTimerKd::start(double fireTime)
 {
-    double interval = fireTime - WTF::currentTime();
-    unsigned int intervalInMS;
-    if (interval < 0)
-        intervalInMS = 0;
-    else {
-        interval *= 1000;
-        intervalInMS = (unsigned int)interval;
-    }
+    m_fireTime = fireTime;
+    m_isActive = true;
 
-    //m_timer.start(intervalInMS/*, this*/);
+    RunLoopKd::current()->setTimerFireTime(fireTime);
 }
 
 void SharedTimerKd::stop()
 {
-    //m_timer.stop();
+    m_isActive = false;
+
+    RunLoopKd::current()->stopTimer();
+}
+
+int SharedTimerKd::nextFireInterval() const
+{
+    if (!m_isActive)
+        return -1;
+
+    double interval = m_fireTime - WTF::currentTime();
+    if (interval <= 0)
+        return 0;
+    return static_cast<int>(ceil(interval * 1000));
 }
 
 void SharedTimerKd::timerEvent(/*QTimerEvent* ev*/)
 {
-    //if (!m_timerFunction || ev->timerId() != m_timer.timerId())
-    //    return;
+    if (!m_timerFunction)
+        return;
 
-    //m_timer.stop();
+    // ThreadTimers re-arms us from inside the callback if more timers are pending.
+    m_isActive = false;
     (m_timerFunction)();
 }
 
+void SharedTimerKd::timerEventIfDue()
+{
+    if (!m_isActive || m_fireTime > WTF::currentTime())
+        return;
+
+    timerEvent();
+}
+
 void setSharedTimerFiredFunction(void (*f)())
 {
 //     if (!QCoreApplication::instance())
@@ -40,14 +40,26 @@ public:
     void start(double);
     void stop();
 
+    bool isActive() const { return m_isActive; }
+    double fireTime() const { return m_fireTime; }
+
+    // Milliseconds until the shared timer is due, 0 if it is overdue and
+    // -1 if it is stopped. Hosts use this to size their wait.
+    int nextFireInterval() const;
+
     //protected:
+    // Fires unconditionally; used to flush pending work during teardown.
     void timerEvent();
+    // Fires only if setSharedTimerFireTime() asked for a time that has passed.
+    void timerEventIfDue();
 
 private:
     SharedTimerKd();
     ~SharedTimerKd();
     //KBasicTimer m_timer;
     void (*m_timerFunction)();
+    double m_fireTime;
+    bool m_isActive;
 };
 
 }
@@ -178,13 +178,19 @@ bool ResourceHandle::start(NetworkingContext* context) /*Frame* frame*/
 
 void ResourceHandle::cancel()
 {
-    //__asm int 3; // TODO_weolar
-#if QT_VERSION < 0x040400
-    //QWebNetworkManager::self()->cancel(this);
-#else
-//     if (d->m_job)
-//         d->m_job->abort();
-#endif
+    KNetworkReplyHandler* job = d->m_job;
+    if (!job)
+        return;
+    d->m_job = 0;
+
+    // Take the handler off the page's queue and cut it loose from the client
+    // before anything can deliver to it again. Deleting it also cancels its
+    // file read if a pool thread has not picked that up yet.
+    if (d->m_context)
+        static_cast<KFrameNetworkingContext*>(d->m_context.get())->arrReplyHandler.remove(job);
+    job->detach();
+    if (!job->m_delivering)
+        delete job;
 }
 
 bool ResourceHandle::loadsBlocked()
@@ -26,15 +26,11 @@ SegmentedString::SegmentedString(const SegmentedString& other)
     : m_pushedChar1(other.m_pushedChar1)
     , m_pushedChar2(other.m_pushedChar2)
     , m_currentString(other.m_currentString)
+    , m_currentChar(other.m_currentChar)
+    , m_fastPath(other.m_fastPath)
     , m_substrings(other.m_substrings)
     , m_closed(other.m_closed)
 {
-    if (other.m_currentChar == &other.m_pushedChar1)
-        m_currentChar = &m_pushedChar1;
-    else if (other.m_currentChar == &other.m_pushedChar2)
-        m_currentChar = &m_pushedChar2;
-    else
-        m_currentChar = other.m_currentChar;
 }
 
 const SegmentedString& SegmentedString::operator=(const SegmentedString& other)
@@ -43,12 +39,8 @@ const SegmentedString& SegmentedString::operator=(const SegmentedString& other)
     m_pushedChar2 = other.m_pushedChar2;
     m_currentString = other.m_currentString;
     m_substrings = other.m_substrings;
-    if (other.m_currentChar == &other.m_pushedChar1)
-        m_currentChar = &m_pushedChar1;
-    else if (other.m_currentChar == &other.m_pushedChar2)
-        m_currentChar = &m_pushedChar2;
-    else
-        m_currentChar = other.m_currentChar;
+    m_currentChar = other.m_currentChar;
+    m_fastPath = other.m_fastPath;
     m_closed = other.m_closed;
     m_numberOfCharactersConsumedPriorToCurrentString = other.m_numberOfCharactersConsumedPriorToCurrentString;
     m_numberOfCharactersConsumedPriorToCurrentLine = other.m_numberOfCharactersConsumedPriorToCurrentLine;
@@ -90,6 +82,7 @@ void SegmentedString::clear()
     m_pushedChar1 = 0;
     m_pushedChar2 = 0;
     m_currentChar = 0;
+    m_fastPath = NoFastPath;
     m_currentString.clear();
     m_substrings.clear();
     m_closed = false;
@@ -149,7 +142,7 @@ void SegmentedString::append(const SegmentedString& s)
         for (; it != e; ++it)
             append(*it);
     }
-    m_currentChar = m_pushedChar1 ? &m_pushedChar1 : m_currentString.m_current;
+    updateCurrentChar();
 }
 
 void SegmentedString::prepend(const SegmentedString& s)
@@ -163,7 +156,7 @@ void SegmentedString::prepend(const SegmentedString& s)
             prepend(*it);
     }
     prepend(s.m_currentString);
-    m_currentChar = m_pushedChar1 ? &m_pushedChar1 : m_currentString.m_current;
+    updateCurrentChar();
 }
 
 void SegmentedString::advanceSubstring()
@@ -201,7 +194,7 @@ void SegmentedString::advance(unsigned count, UChar* consumedCharacters)
 {
     ASSERT(count <= length());
     for (unsigned i = 0; i < count; ++i) {
-        consumedCharacters[i] = *current();
+        consumedCharacters[i] = current();
         advance();
     }
 }
@@ -211,12 +204,12 @@ void SegmentedString::advanceSlowCase()
     if (m_pushedChar1) {
         m_pushedChar1 = m_pushedChar2;
         m_pushedChar2 = 0;
-    } else if (m_currentString.m_current) {
-        ++m_currentString.m_current;
+    } else if (m_currentString.m_length) {
+        m_currentString.incrementPosition();
         if (--m_currentString.m_length == 0)
             advanceSubstring();
     }
-    m_currentChar = m_pushedChar1 ? &m_pushedChar1 : m_currentString.m_current;
+    updateCurrentChar();
 }
 
 void SegmentedString::advanceSlowCase(int& lineNumber)
@@ -224,8 +217,10 @@ void SegmentedString::advanceSlowCase(int& lineNumber)
     if (m_pushedChar1) {
         m_pushedChar1 = m_pushedChar2;
         m_pushedChar2 = 0;
-    } else if (m_currentString.m_current) {
-        if (*m_currentString.m_current++ == '\n' && m_currentString.doNotExcludeLineNumbers()) {
+    } else if (m_currentString.m_length) {
+        bool atNewline = m_currentString.currentChar() == '\n';
+        m_currentString.incrementPosition();
+        if (atNewline && m_currentString.doNotExcludeLineNumbers()) {
             ++lineNumber;
             ++m_currentLine;
             // Plus 1 because numberOfCharactersConsumed value hasn't incremented yet; it does with m_length decrement below.
@@ -234,7 +229,7 @@ void SegmentedString::advanceSlowCase(int& lineNumber)
         if (--m_currentString.m_length == 0)
             advanceSubstring();
     }
-    m_currentChar = m_pushedChar1 ? &m_pushedChar1 : m_currentString.m_current;
+    updateCurrentChar();
 }
 
 WTF::ZeroBasedNumber SegmentedString::currentLine() const
@@ -32,20 +32,59 @@ class SegmentedSubstring {
 public:
     SegmentedSubstring()
         : m_length(0)
-        , m_current(0)
+        , m_current8(0)
+        , m_current16(0)
+        , m_is8Bit(false)
         , m_doNotExcludeLineNumbers(true)
     {
     }
 
     SegmentedSubstring(const String& str)
         : m_length(str.length())
-        , m_current(str.isEmpty() ? 0 : str.characters())
+        , m_current8(0)
+        , m_current16(0)
         , m_string(str)
+        , m_is8Bit(str.is8Bit())
         , m_doNotExcludeLineNumbers(true)
     {
+        // 8-bit input is read as it is, so it never needs widening.
+        if (!m_length)
+            return;
+        if (m_is8Bit)
+            m_current8 = str.characters8();
+        else
+            m_current16 = str.characters();
+    }
+
+    void clear() { m_length = 0; m_current8 = 0; m_current16 = 0; }
+
+    bool is8Bit() const { return m_is8Bit; }
+
+    UChar currentChar() const
+    {
+        ASSERT(m_length);
+        return m_is8Bit ? *m_current8 : *m_current16;
+    }
+
+    void incrementPosition()
+    {
+        if (m_is8Bit)
+            ++m_current8;
+        else
+            ++m_current16;
+    }
+
+    UChar incrementAndGetCurrentChar8()
+    {
+        ASSERT(m_length && m_is8Bit);
+        return *++m_current8;
     }
 
-    void clear() { m_length = 0; m_current = 0; }
+    UChar incrementAndGetCurrentChar16()
+    {
+        ASSERT(m_length && !m_is8Bit);
+        return *++m_current16;
+    }
     
     bool excludeLineNumbers() const { return !m_doNotExcludeLineNumbers; }
     bool doNotExcludeLineNumbers() const { return m_doNotExcludeLineNumbers; }
@@ -56,21 +95,23 @@ public:
 
     void appendTo(String& str) const
     {
-        if (m_string.characters() == m_current) {
+        if (!numberOfCharactersConsumed()) {
             if (str.isEmpty())
                 str = m_string;
             else
                 str.append(m_string);
         } else
-            str.append(String(m_current, m_length));
+            str.append(m_string.substring(numberOfCharactersConsumed()));
     }
 
 public:
     int m_length;
-    const UChar* m_current;
+    const LChar* m_current8;
+    const UChar* m_current16;
 
 private:
     String m_string;
+    bool m_is8Bit;
     bool m_doNotExcludeLineNumbers;
 };
 
@@ -80,6 +121,7 @@ public:
         : m_pushedChar1(0)
         , m_pushedChar2(0)
         , m_currentChar(0)
+        , m_fastPath(NoFastPath)
         , m_numberOfCharactersConsumedPriorToCurrentString(0)
         , m_numberOfCharactersConsumedPriorToCurrentLine(0)
         , m_currentLine(0)
@@ -91,12 +133,13 @@ public:
         : m_pushedChar1(0)
         , m_pushedChar2(0)
         , m_currentString(str)
-        , m_currentChar(m_currentString.m_current)
+        , m_currentChar(m_currentString.m_length ? m_currentString.currentChar() : 0)
         , m_numberOfCharactersConsumedPriorToCurrentString(0)
         , m_numberOfCharactersConsumedPriorToCurrentLine(0)
         , m_currentLine(0)
         , m_closed(false)
     {
+        updateFastPath();
     }
 
     SegmentedString(const SegmentedString&);
@@ -116,14 +159,14 @@ public:
     {
         if (!m_pushedChar1) {
             m_pushedChar1 = c;
-            m_currentChar = m_pushedChar1 ? &m_pushedChar1 : m_currentString.m_current;
+            updateCurrentChar();
         } else {
             ASSERT(!m_pushedChar2);
             m_pushedChar2 = c;
         }
     }
 
-    bool isEmpty() const { return !current(); }
+    bool isEmpty() const { return !m_pushedChar1 && !m_currentString.m_length; }
     unsigned length() const;
 
     bool isClosed() const { return m_closed; }
@@ -134,14 +177,17 @@ public:
         NotEnoughCharacters,
     };
 
-    LookAheadResult lookAhead(const String& string) { return lookAheadInline<SegmentedString::equalsLiterally>(string); }
-    LookAheadResult lookAheadIgnoringCase(const String& string) { return lookAheadInline<SegmentedString::equalsIgnoringCase>(string); }
+    LookAheadResult lookAhead(const String& string) { return lookAheadInline<SegmentedString::equalsLiterally, SegmentedString::equalsLiterally>(string); }
+    LookAheadResult lookAheadIgnoringCase(const String& string) { return lookAheadInline<SegmentedString::equalsIgnoringCase, SegmentedString::equalsIgnoringCase>(string); }
 
     void advance()
     {
-        if (!m_pushedChar1 && m_currentString.m_length > 1) {
-            --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
+        if (m_fastPath == Use8BitAdvance) {
+            advance8();
+            return;
+        }
+        if (m_fastPath == Use16BitAdvance) {
+            advance16();
             return;
         }
         advanceSlowCase();
@@ -149,53 +195,38 @@ public:
 
     void advanceAndASSERT(UChar expectedCharacter)
     {
-        ASSERT_UNUSED(expectedCharacter, *current() == expectedCharacter);
+        ASSERT_UNUSED(expectedCharacter, current() == expectedCharacter);
         advance();
     }
 
     void advanceAndASSERTIgnoringCase(UChar expectedCharacter)
     {
-        ASSERT_UNUSED(expectedCharacter, WTF::Unicode::foldCase(*current()) == WTF::Unicode::foldCase(expectedCharacter));
+        ASSERT_UNUSED(expectedCharacter, WTF::Unicode::foldCase(current()) == WTF::Unicode::foldCase(expectedCharacter));
         advance();
     }
 
     void advancePastNewline(int& lineNumber)
     {
-        ASSERT(*current() == '\n');
-        if (!m_pushedChar1 && m_currentString.m_length > 1) {
-            int newLineFlag = m_currentString.doNotExcludeLineNumbers();
-            lineNumber += newLineFlag;
-            m_currentLine += newLineFlag;
-            if (newLineFlag)
-                m_numberOfCharactersConsumedPriorToCurrentLine = numberOfCharactersConsumed() + 1;
-            --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
-            return;
-        }
-        advanceSlowCase(lineNumber);
+        ASSERT(current() == '\n');
+        advance(lineNumber);
     }
     
     void advancePastNonNewline()
     {
-        ASSERT(*current() != '\n');
-        if (!m_pushedChar1 && m_currentString.m_length > 1) {
-            --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
-            return;
-        }
-        advanceSlowCase();
+        ASSERT(current() != '\n');
+        advance();
     }
     
     void advance(int& lineNumber)
     {
-        if (!m_pushedChar1 && m_currentString.m_length > 1) {
-            int newLineFlag = (*m_currentString.m_current == '\n') & m_currentString.doNotExcludeLineNumbers();
-            lineNumber += newLineFlag;
-            m_currentLine += newLineFlag;
-            if (newLineFlag)
-                m_numberOfCharactersConsumedPriorToCurrentLine = numberOfCharactersConsumed() + 1;
-            --m_currentString.m_length;
-            m_currentChar = ++m_currentString.m_current;
+        if (m_fastPath == Use8BitAdvance) {
+            updateLineNumber(lineNumber);
+            advance8();
+            return;
+        }
+        if (m_fastPath == Use16BitAdvance) {
+            updateLineNumber(lineNumber);
+            advance16();
             return;
         }
         advanceSlowCase(lineNumber);
@@ -220,8 +251,7 @@ public:
 
     String toString() const;
 
-    const UChar& operator*() const { return *current(); }
-    const UChar* operator->() const { return current(); }
+    UChar operator*() const { return current(); }
     
 
     // The method is moderately slow, comparing to currentLine method.
@@ -232,24 +262,88 @@ public:
     void setCurrentPosition(WTF::ZeroBasedNumber line, WTF::ZeroBasedNumber columnAftreProlog, int prologLength);
 
 private:
+    // The fast paths step through the current substring when nothing has
+    // been pushed and more than one character remains. Which one applies
+    // is worked out when that state changes, so advancing does not test
+    // the substring's width for every character.
+    enum FastPath {
+        NoFastPath,
+        Use8BitAdvance,
+        Use16BitAdvance
+    };
+
+    void updateFastPath()
+    {
+        if (m_pushedChar1 || m_currentString.m_length <= 1)
+            m_fastPath = NoFastPath;
+        else
+            m_fastPath = m_currentString.is8Bit() ? Use8BitAdvance : Use16BitAdvance;
+    }
+
+    void advance8()
+    {
+        ASSERT(m_fastPath == Use8BitAdvance);
+        bool haveOneCharacterLeft = --m_currentString.m_length == 1;
+        m_currentChar = m_currentString.incrementAndGetCurrentChar8();
+        if (haveOneCharacterLeft)
+            m_fastPath = NoFastPath;
+    }
+
+    void advance16()
+    {
+        ASSERT(m_fastPath == Use16BitAdvance);
+        bool haveOneCharacterLeft = --m_currentString.m_length == 1;
+        m_currentChar = m_currentString.incrementAndGetCurrentChar16();
+        if (haveOneCharacterLeft)
+            m_fastPath = NoFastPath;
+    }
+
+    void updateLineNumber(int& lineNumber)
+    {
+        int newLineFlag = (m_currentChar == '\n') & m_currentString.doNotExcludeLineNumbers();
+        lineNumber += newLineFlag;
+        m_currentLine += newLineFlag;
+        if (newLineFlag)
+            m_numberOfCharactersConsumedPriorToCurrentLine = numberOfCharactersConsumed() + 1;
+    }
+
     void append(const SegmentedSubstring&);
     void prepend(const SegmentedSubstring&);
 
     void advanceSlowCase();
     void advanceSlowCase(int& lineNumber);
     void advanceSubstring();
-    const UChar* current() const { return m_currentChar; }
+    UChar current() const { return m_currentChar; }
+
+    void updateCurrentChar()
+    {
+        if (m_pushedChar1)
+            m_currentChar = m_pushedChar1;
+        else
+            m_currentChar = m_currentString.m_length ? m_currentString.currentChar() : 0;
+        updateFastPath();
+    }
 
     static bool equalsLiterally(const UChar* str1, const UChar* str2, size_t count) { return !memcmp(str1, str2, count * sizeof(UChar)); }
+    static bool equalsLiterally(const UChar* str1, const LChar* str2, size_t count) { return equal(str2, str1, count); }
     static bool equalsIgnoringCase(const UChar* str1, const UChar* str2, size_t count) { return !WTF::Unicode::umemcasecmp(str1, str2, count); }
+    static bool equalsIgnoringCase(const UChar* str1, const LChar* str2, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            if (WTF::Unicode::foldCase(str1[i]) != WTF::Unicode::foldCase(static_cast<UChar>(str2[i])))
+                return false;
+        }
+        return true;
+    }
 
-    template<bool equals(const UChar* str1, const UChar* str2, size_t count)>
+    template<bool equals(const UChar* str1, const UChar* str2, size_t count), bool equals8(const UChar* str1, const LChar* str2, size_t count)>
     inline LookAheadResult lookAheadInline(const String& string)
     {
         if (!m_pushedChar1 && string.length() <= static_cast<unsigned>(m_currentString.m_length)) {
-            if (equals(string.characters(), m_currentString.m_current, string.length()))
-                return DidMatch;
-            return DidNotMatch;
+            bool matched = m_currentString.is8Bit()
+                ? equals8(string.characters(), m_currentString.m_current8, string.length())
+                : equals(string.characters(), m_currentString.m_current16, string.length());
+            return matched ? DidMatch : DidNotMatch;
         }
         return lookAheadSlowCase<equals>(string);
     }
@@ -275,7 +369,8 @@ private:
     UChar m_pushedChar1;
     UChar m_pushedChar2;
     SegmentedSubstring m_currentString;
-    const UChar* m_currentChar;
+    UChar m_currentChar;
+    FastPath m_fastPath;
     int m_numberOfCharactersConsumedPriorToCurrentString;
     int m_numberOfCharactersConsumedPriorToCurrentLine;
     int m_currentLine;
@@ -116,8 +116,26 @@ void TextCodecLatin1::registerCodecs(TextCodecRegistrar registrar)
     registrar("US-ASCII", newStreamingTextDecoderWindowsLatin1, 0);
 }
 
+// Only bytes 0x80-0x9F decode to something other than the code point of the
+// same value.
+static bool hasWindowsLatin1Extensions(const uint8_t* source, const uint8_t* end)
+{
+    for (; source < end; ++source) {
+        if ((*source & 0xE0) == 0x80)
+            return true;
+    }
+    return false;
+}
+
 String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, bool&)
 {
+    if (!hasWindowsLatin1Extensions(reinterpret_cast<const uint8_t*>(bytes), reinterpret_cast<const uint8_t*>(bytes + length))) {
+        LChar* characters;
+        String result = String::createUninitialized(length, characters);
+        memcpy(characters, bytes, length);
+        return result;
+    }
+
     UChar* characters;
     String result = String::createUninitialized(length, characters);
 
@@ -213,8 +213,34 @@ void TextCodecUTF8::handlePartialSequence(UChar*& destination, const uint8_t*& s
     } while (m_partialSequenceSize);
 }
 
+static bool bytesAreAllASCII(const uint8_t* source, const uint8_t* end)
+{
+    const uint8_t* alignedEnd = alignToMachineWord(end);
+    while (source < end && !isAlignedToMachineWord(source)) {
+        if (!isASCII(*source++))
+            return false;
+    }
+    for (; source < alignedEnd; source += sizeof(MachineWord)) {
+        if (!isAllASCII(*reinterpret_cast_ptr<const MachineWord*>(source)))
+            return false;
+    }
+    for (; source < end; ++source) {
+        if (!isASCII(*source))
+            return false;
+    }
+    return true;
+}
+
 String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool stopOnError, bool& sawError)
 {
+    // ASCII text decodes to itself and can stay 8-bit.
+    if (!m_partialSequenceSize && bytesAreAllASCII(reinterpret_cast<const uint8_t*>(bytes), reinterpret_cast<const uint8_t*>(bytes + length))) {
+        LChar* characters;
+        String result = String::createUninitialized(length, characters);
+        memcpy(characters, bytes, length);
+        return result;
+    }
+
     // Each input byte might turn into a character.
     // That includes all bytes in the partial-sequence buffer because
     // each byte in an invalid sequence will turn into a replacement character.
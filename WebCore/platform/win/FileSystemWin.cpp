@@ -88,6 +88,13 @@ bool deleteFile(const String& path)
     return !!DeleteFileW((LPCWSTR)filename.charactersWithNullTermination());
 }
 
+bool moveFile(const String& oldPath, const String& newPath)
+{
+    String oldFilename = oldPath;
+    String newFilename = newPath;
+    return !!MoveFileExW((LPCWSTR)oldFilename.charactersWithNullTermination(), (LPCWSTR)newFilename.charactersWithNullTermination(), MOVEFILE_REPLACE_EXISTING);
+}
+
 bool deleteEmptyDirectory(const String& path)
 {
     String filename = path;
@@ -288,6 +295,19 @@ int writeToFile(PlatformFileHandle handle, const char* data, int length)
     return static_cast<int>(bytesWritten);
 }
 
+int readFromFile(PlatformFileHandle handle, char* data, int length)
+{
+    if (!isHandleValid(handle))
+        return -1;
+
+    DWORD bytesRead;
+    bool success = ReadFile(handle, data, length, &bytesRead, 0);
+
+    if (!success)
+        return -1;
+    return static_cast<int>(bytesRead);
+}
+
 bool unloadModule(PlatformModule module)
 {
     return ::FreeLibrary(module);
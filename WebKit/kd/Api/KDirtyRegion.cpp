@@ -0,0 +1,184 @@
+#include "config.h"
+#include "KDirtyRegion.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace WebCore {
+
+static const int bitsPerWord = sizeof(unsigned) * 8;
+
+// A horizontal run of dirty tiles and the row it started on.
+struct Run {
+    int firstColumn;
+    int lastColumn;
+    int firstRow;
+};
+
+KDirtyRegion::KDirtyRegion()
+    : m_tileSize(defaultTileSize)
+    , m_maxRects(defaultMaxRects)
+    , m_columns(0)
+    , m_rows(0)
+    , m_wordsPerRow(0)
+    , m_firstDirtyRow(0)
+    , m_lastDirtyRow(-1)
+    , m_rectsPostedSinceTake(0)
+{
+    resetStatistics();
+}
+
+void KDirtyRegion::resetStatistics()
+{
+    memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+void KDirtyRegion::setTileSize(int tileSize)
+{
+    if (tileSize < 1 || tileSize == m_tileSize)
+        return;
+
+    m_tileSize = tileSize;
+    setBounds(m_bounds);
+}
+
+void KDirtyRegion::setBounds(const IntRect& bounds)
+{
+    m_bounds = bounds;
+    resetTiles();
+    add(bounds);
+}
+
+void KDirtyRegion::resetTiles()
+{
+    m_columns = m_bounds.isEmpty() ? 0 : (m_bounds.width() + m_tileSize - 1) / m_tileSize;
+    m_rows = m_bounds.isEmpty() ? 0 : (m_bounds.height() + m_tileSize - 1) / m_tileSize;
+    m_wordsPerRow = (m_columns + bitsPerWord - 1) / bitsPerWord;
+
+    m_tiles.resize(m_rows * m_wordsPerRow);
+    m_tiles.fill(0);
+
+    m_dirtyBounds = IntRect();
+    m_firstDirtyRow = 0;
+    m_lastDirtyRow = -1;
+    m_rectsPostedSinceTake = 0;
+}
+
+void KDirtyRegion::clearTiles()
+{
+    if (m_lastDirtyRow >= m_firstDirtyRow)
+        memset(m_tiles.data() + m_firstDirtyRow * m_wordsPerRow, 0, (m_lastDirtyRow - m_firstDirtyRow + 1) * m_wordsPerRow * sizeof(unsigned));
+
+    m_dirtyBounds = IntRect();
+    m_firstDirtyRow = 0;
+    m_lastDirtyRow = -1;
+    m_rectsPostedSinceTake = 0;
+}
+
+inline bool KDirtyRegion::tileIsSet(int row, int column) const
+{
+    return m_tiles[row * m_wordsPerRow + column / bitsPerWord] & (1u << (column % bitsPerWord));
+}
+
+void KDirtyRegion::add(const IntRect& rect)
+{
+    IntRect dirty = intersection(rect, m_bounds);
+    if (dirty.isEmpty())
+        return;
+
+    ++m_statistics.rectsPosted;
+    ++m_rectsPostedSinceTake;
+
+    m_dirtyBounds.unite(dirty);
+
+    int firstColumn = (dirty.x() - m_bounds.x()) / m_tileSize;
+    int lastColumn = (dirty.maxX() - 1 - m_bounds.x()) / m_tileSize;
+    int firstRow = (dirty.y() - m_bounds.y()) / m_tileSize;
+    int lastRow = (dirty.maxY() - 1 - m_bounds.y()) / m_tileSize;
+
+    if (m_lastDirtyRow < m_firstDirtyRow) {
+        m_firstDirtyRow = firstRow;
+        m_lastDirtyRow = lastRow;
+    } else {
+        m_firstDirtyRow = std::min(m_firstDirtyRow, firstRow);
+        m_lastDirtyRow = std::max(m_lastDirtyRow, lastRow);
+    }
+
+    int firstWord = firstColumn / bitsPerWord;
+    int lastWord = lastColumn / bitsPerWord;
+    unsigned firstMask = ~0u << (firstColumn % bitsPerWord);
+    unsigned lastMask = ~0u >> (bitsPerWord - 1 - lastColumn % bitsPerWord);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        unsigned* words = m_tiles.data() + row * m_wordsPerRow;
+        if (firstWord == lastWord) {
+            words[firstWord] |= firstMask & lastMask;
+            continue;
+        }
+        words[firstWord] |= firstMask;
+        for (int word = firstWord + 1; word < lastWord; ++word)
+            words[word] = ~0u;
+        words[lastWord] |= lastMask;
+    }
+}
+
+void KDirtyRegion::take(Vector<IntRect>& rects)
+{
+    rects.shrink(0);
+    if (isEmpty())
+        return;
+
+    Vector<Run, 16> open;
+    Vector<Run, 16> next;
+
+    for (int row = m_firstDirtyRow; row <= m_lastDirtyRow + 1; ++row) {
+        // Collect this row's runs; the extra row past the end closes everything.
+        next.shrink(0);
+        if (row <= m_lastDirtyRow) {
+            for (int column = 0; column < m_columns; ) {
+                if (!tileIsSet(row, column)) {
+                    ++column;
+                    continue;
+                }
+                Run run = { column, column, row };
+                while (run.lastColumn + 1 < m_columns && tileIsSet(row, run.lastColumn + 1))
+                    ++run.lastColumn;
+                next.append(run);
+                column = run.lastColumn + 1;
+            }
+        }
+
+        // Runs that continue unchanged from the previous row grow downwards;
+        // every other open run is finished.
+        size_t j = 0;
+        for (size_t i = 0; i < open.size(); ++i) {
+            while (j < next.size() && next[j].firstColumn < open[i].firstColumn)
+                ++j;
+            if (j < next.size() && next[j].firstColumn == open[i].firstColumn && next[j].lastColumn == open[i].lastColumn) {
+                next[j].firstRow = open[i].firstRow;
+                continue;
+            }
+
+            IntRect tiles(m_bounds.x() + open[i].firstColumn * m_tileSize, m_bounds.y() + open[i].firstRow * m_tileSize,
+                (open[i].lastColumn - open[i].firstColumn + 1) * m_tileSize, (row - open[i].firstRow) * m_tileSize);
+            tiles.intersect(m_dirtyBounds);
+            if (!tiles.isEmpty())
+                rects.append(tiles);
+        }
+        open.swap(next);
+    }
+
+    if (rects.size() > m_maxRects) {
+        rects.shrink(0);
+        rects.append(m_dirtyBounds);
+        ++m_statistics.coalescedToBounds;
+    }
+
+    if (m_rectsPostedSinceTake > rects.size())
+        m_statistics.rectsMerged += m_rectsPostedSinceTake - rects.size();
+    m_statistics.rectsPainted += rects.size();
+
+    clearTiles();
+}
+
+} // namespace WebCore
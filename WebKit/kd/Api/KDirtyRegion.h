@@ -0,0 +1,76 @@
+#ifndef KDirtyRegion_h
+#define KDirtyRegion_h
+
+#include "IntRect.h"
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// Damage tracker for KWebPageImpl.
+//
+// The viewport is split into square tiles and every posted rect sets the bits
+// of the tiles it touches, so add() costs O(rows * words) regardless of how
+// many rects are already queued. take() turns the bitmap back into rects by
+// stacking identical horizontal runs of tiles, then clips them to the exact
+// bounding box of what was posted. If that produces more than maxRects rects
+// the whole bounding box is painted as one rect instead.
+class KDirtyRegion {
+    WTF_MAKE_NONCOPYABLE(KDirtyRegion);
+public:
+    struct Statistics {
+        unsigned rectsPosted;
+        unsigned rectsMerged;
+        unsigned rectsPainted;
+        unsigned coalescedToBounds;
+    };
+
+    KDirtyRegion();
+
+    // Resets the tile grid to cover bounds and marks all of it dirty.
+    void setBounds(const IntRect& bounds);
+    const IntRect& bounds() const { return m_bounds; }
+
+    void setTileSize(int tileSize);
+    int tileSize() const { return m_tileSize; }
+
+    void setMaxRects(size_t maxRects) { m_maxRects = maxRects ? maxRects : 1; }
+    size_t maxRects() const { return m_maxRects; }
+
+    void add(const IntRect&);
+    bool isEmpty() const { return m_dirtyBounds.isEmpty(); }
+    const IntRect& dirtyBounds() const { return m_dirtyBounds; }
+
+    // Replaces the contents of rects with the current damage and clears it.
+    void take(Vector<IntRect>& rects);
+
+    const Statistics& statistics() const { return m_statistics; }
+    void resetStatistics();
+
+    static const int defaultTileSize = 32;
+    static const size_t defaultMaxRects = 16;
+
+private:
+    void resetTiles();
+    void clearTiles();
+    bool tileIsSet(int row, int column) const;
+
+    int m_tileSize;
+    size_t m_maxRects;
+
+    IntRect m_bounds;
+    int m_columns;
+    int m_rows;
+    int m_wordsPerRow;
+    Vector<unsigned> m_tiles;
+
+    IntRect m_dirtyBounds;
+    int m_firstDirtyRow;
+    int m_lastDirtyRow;
+    unsigned m_rectsPostedSinceTake;
+
+    Statistics m_statistics;
+};
+
+} // namespace WebCore
+
+#endif // KDirtyRegion_h
@@ -0,0 +1,159 @@
+#include "config.h"
+#include "KResourcePackage.h"
+
+#include "KResourcePackageFormat.h"
+#include <wtf/text/CString.h>
+#include <zlib.h>
+
+#if !OS(WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WebCore {
+
+KResourcePackage* KResourcePackage::open(const String& path, const String& urlPrefix)
+{
+    KResourcePackage* package = new KResourcePackage(urlPrefix);
+    if (!package->map(path) || !package->readIndex()) {
+        delete package;
+        return 0;
+    }
+    return package;
+}
+
+KResourcePackage::KResourcePackage(const String& urlPrefix)
+    : m_urlPrefix(urlPrefix)
+    , m_base(0)
+    , m_mappedSize(0)
+#if OS(WINDOWS)
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(0)
+#endif
+{
+}
+
+KResourcePackage::~KResourcePackage()
+{
+    unmap();
+}
+
+bool KResourcePackage::map(const String& path)
+{
+#if OS(WINDOWS)
+    String nativePath = path;
+    m_file = CreateFileW((LPCWSTR)nativePath.charactersWithNullTermination(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
+    if (INVALID_HANDLE_VALUE == m_file)
+        return false;
+
+    LARGE_INTEGER fileSize = {0};
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.HighPart || !fileSize.LowPart)
+        return false;
+
+    m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m_mapping)
+        return false;
+
+    m_base = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_base)
+        return false;
+    m_mappedSize = fileSize.LowPart;
+#else
+    int fd = ::open(path.utf8().data(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) || fileStat.st_size <= 0 || static_cast<unsigned long long>(fileStat.st_size) > 0xffffffffu) {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == base)
+        return false;
+
+    m_base = static_cast<const char*>(base);
+    m_mappedSize = fileStat.st_size;
+#endif
+    return true;
+}
+
+void KResourcePackage::unmap()
+{
+#if OS(WINDOWS)
+    if (m_base)
+        UnmapViewOfFile(m_base);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (INVALID_HANDLE_VALUE != m_file)
+        CloseHandle(m_file);
+    m_mapping = 0;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_base)
+        munmap(const_cast<char*>(m_base), m_mappedSize);
+#endif
+    m_base = 0;
+    m_mappedSize = 0;
+}
+
+static inline bool rangeIsInside(unsigned offset, unsigned length, unsigned size)
+{
+    return offset <= size && length <= size - offset;
+}
+
+bool KResourcePackage::readIndex()
+{
+    if (m_mappedSize < sizeof(KdPackHeader))
+        return false;
+
+    const KdPackHeader* header = reinterpret_cast<const KdPackHeader*>(m_base);
+    if (memcmp(header->magic, KDPACK_MAGIC, 4) || KDPACK_VERSION != header->version)
+        return false;
+
+    // The index is used in place, so it has to be aligned and fully inside
+    // the mapping.
+    if (header->indexOffset % sizeof(unsigned int) || header->entryCount > m_mappedSize / sizeof(KdPackEntry)
+        || !rangeIsInside(header->indexOffset, header->entryCount * sizeof(KdPackEntry), m_mappedSize))
+        return false;
+
+    const KdPackEntry* entries = reinterpret_cast<const KdPackEntry*>(m_base + header->indexOffset);
+    for (unsigned i = 0; i < header->entryCount; ++i) {
+        const KdPackEntry* entry = entries + i;
+        if (!rangeIsInside(entry->nameOffset, entry->nameLength, m_mappedSize)
+            || !rangeIsInside(entry->dataOffset, entry->storedSize, m_mappedSize))
+            return false;
+        if (!(entry->flags & KdPackEntryCompressed) && entry->storedSize != entry->size)
+            return false;
+
+        m_entries.set(String::fromUTF8(m_base + entry->nameOffset, entry->nameLength), entry);
+    }
+    return true;
+}
+
+PassRefPtr<SharedBuffer> KResourcePackage::resourceForURL(const String& url) const
+{
+    if (!url.startsWith(m_urlPrefix, false))
+        return 0;
+
+    const KdPackEntry* entry = m_entries.get(url.substring(m_urlPrefix.length()));
+    if (!entry)
+        return 0;
+
+    const char* data = m_base + entry->dataOffset;
+    if (!(entry->flags & KdPackEntryCompressed))
+        return SharedBuffer::wrapExternalData(data, entry->size);
+
+    Vector<char> inflated(entry->size);
+    uLongf inflatedSize = entry->size;
+    if (Z_OK != uncompress(reinterpret_cast<Bytef*>(inflated.data()), &inflatedSize, reinterpret_cast<const Bytef*>(data), entry->storedSize)
+        || inflatedSize != entry->size)
+        return 0;
+    return SharedBuffer::adoptVector(inflated);
+}
+
+} // namespace WebCore
@@ -0,0 +1,59 @@
+#ifndef KResourcePackage_h
+#define KResourcePackage_h
+
+#include "PlatformString.h"
+#include "SharedBuffer.h"
+#include <wtf/HashMap.h>
+#include <wtf/text/StringHash.h>
+
+#if OS(WINDOWS)
+#include <windows.h>
+#endif
+
+struct KdPackEntry;
+
+namespace WebCore {
+
+// A read-only .kdpk package (see KResourcePackageFormat.h) mapped into
+// memory and mounted under a URL prefix.
+//
+// The index is hashed once at open() time, so resolving a URL is a single
+// HashMap lookup and never touches the file system. Stored entries are handed
+// out as SharedBuffers that point straight into the mapping; compressed ones
+// are inflated into a fresh buffer. The mapping stays alive until the package
+// is destroyed, which KWebPage does only when the page itself goes away.
+class KResourcePackage {
+    WTF_MAKE_NONCOPYABLE(KResourcePackage); WTF_MAKE_FAST_ALLOCATED;
+public:
+    // Returns 0 if the file cannot be mapped or is not a valid package.
+    static KResourcePackage* open(const String& path, const String& urlPrefix);
+    ~KResourcePackage();
+
+    const String& urlPrefix() const { return m_urlPrefix; }
+    unsigned entryCount() const { return m_entries.size(); }
+
+    // Returns 0 if url is not under the prefix or not in the package.
+    PassRefPtr<SharedBuffer> resourceForURL(const String& url) const;
+
+private:
+    KResourcePackage(const String& urlPrefix);
+
+    bool map(const String& path);
+    void unmap();
+    bool readIndex();
+
+    String m_urlPrefix;
+
+    const char* m_base;
+    unsigned m_mappedSize;
+#if OS(WINDOWS)
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+
+    HashMap<String, const KdPackEntry*> m_entries;
+};
+
+} // namespace WebCore
+
+#endif // KResourcePackage_h
@@ -0,0 +1,41 @@
+#ifndef KResourcePackageFormat_h
+#define KResourcePackageFormat_h
+
+// On-disk layout of a .kdpk resource package, shared by KResourcePackage and
+// the kdpack tool. All integers are little endian.
+//
+//   KdPackHeader
+//   entry data, each entry stored or zlib compressed
+//   entry names, UTF-8, '/' separated, not null terminated
+//   KdPackEntry[entryCount] at indexOffset
+//
+// Keep this header free of WebCore types so the tool can build on its own.
+
+#define KDPACK_MAGIC "KDPK"
+#define KDPACK_VERSION 1
+
+enum {
+    KdPackEntryCompressed = 1 // data was written with zlib compress2()
+};
+
+#pragma pack(push, 4)
+
+struct KdPackHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned int indexOffset;
+};
+
+struct KdPackEntry {
+    unsigned int nameOffset;
+    unsigned int nameLength;
+    unsigned int dataOffset;
+    unsigned int storedSize;
+    unsigned int size;
+    unsigned int flags;
+};
+
+#pragma pack(pop)
+
+#endif // KResourcePackageFormat_h
@@ -0,0 +1,108 @@
+#include "config.h"
+#include "KResourceStore.h"
+
+namespace WebCore {
+
+KResourceStore::KResourceStore()
+    : m_bytesHeld(0)
+    , m_byteBudget(0)
+{
+    resetStatistics();
+}
+
+void KResourceStore::add(const String& url, const void* data, int length, bool needCopy)
+{
+    if (length < 0)
+        length = 0;
+
+    // A later post of the same URL replaces the earlier one.
+    EntryMap::iterator it = m_entries.find(url);
+    if (it != m_entries.end())
+        remove(it);
+
+    Entry entry;
+    entry.owned = needCopy;
+    if (needCopy) {
+        // SharedBuffer::create() splits anything over a segment into 4 KB
+        // pieces, which are copied again when the loader asks for data().
+        // Build the contiguous vector once and hand it over.
+        Vector<char> bytes;
+        bytes.append(static_cast<const char*>(data), length);
+        entry.buffer = SharedBuffer::adoptVector(bytes);
+        m_bytesHeld += length;
+        m_ownedOrder.add(url);
+    } else
+        entry.buffer = SharedBuffer::wrapExternalData(static_cast<const char*>(data), length);
+    m_entries.set(url, entry);
+
+    evictIfNeeded();
+}
+
+PassRefPtr<SharedBuffer> KResourceStore::take(const String& url)
+{
+    EntryMap::iterator it = m_entries.find(url);
+    if (it == m_entries.end()) {
+        ++m_misses;
+        return 0;
+    }
+
+    ++m_hits;
+    RefPtr<SharedBuffer> buffer = it->second.buffer;
+    remove(it);
+    return buffer.release();
+}
+
+void KResourceStore::remove(EntryMap::iterator it)
+{
+    if (it->second.owned) {
+        m_bytesHeld -= it->second.buffer->size();
+        m_ownedOrder.remove(it->first);
+    }
+    m_entries.remove(it);
+}
+
+void KResourceStore::clear()
+{
+    m_entries.clear();
+    m_ownedOrder.clear();
+    m_bytesHeld = 0;
+}
+
+void KResourceStore::setByteBudget(size_t byteBudget)
+{
+    m_byteBudget = byteBudget;
+    evictIfNeeded();
+}
+
+void KResourceStore::evictIfNeeded()
+{
+    if (!m_byteBudget)
+        return;
+
+    while (m_bytesHeld > m_byteBudget && !m_ownedOrder.isEmpty()) {
+        EntryMap::iterator it = m_entries.find(m_ownedOrder.first());
+        ASSERT(it != m_entries.end());
+        remove(it);
+        ++m_evictions;
+    }
+}
+
+KResourceStore::Statistics KResourceStore::statistics() const
+{
+    Statistics statistics;
+    statistics.hits = m_hits;
+    statistics.misses = m_misses;
+    statistics.evictions = m_evictions;
+    statistics.entries = m_entries.size();
+    statistics.bytesHeld = m_bytesHeld;
+    return statistics;
+}
+
+void KResourceStore::resetStatistics()
+{
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
+
+} // namespace WebCore
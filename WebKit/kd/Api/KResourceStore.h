@@ -0,0 +1,68 @@
+#ifndef KResourceStore_h
+#define KResourceStore_h
+
+#include "PlatformString.h"
+#include "SharedBuffer.h"
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/text/StringHash.h>
+
+namespace WebCore {
+
+// Resources posted by the embedder through KdPostResToAsynchronousLoad,
+// indexed by URL.
+//
+// A copied resource (bNeedSavaRes) is held in a SharedBuffer owned by the
+// store and counts against the byte budget; when the budget is exceeded the
+// oldest copied resources that nobody has asked for yet are dropped. A
+// resource whose memory the embedder keeps alive is wrapped without a copy
+// and costs the store nothing. take() hands out the SharedBuffer and forgets
+// the entry, so each post satisfies one load, as before.
+class KResourceStore {
+    WTF_MAKE_NONCOPYABLE(KResourceStore);
+public:
+    struct Statistics {
+        unsigned hits;
+        unsigned misses;
+        unsigned evictions;
+        unsigned entries;
+        size_t bytesHeld;
+    };
+
+    KResourceStore();
+
+    void add(const String& url, const void* data, int length, bool needCopy);
+    PassRefPtr<SharedBuffer> take(const String& url);
+    void clear();
+
+    // Zero means no limit.
+    void setByteBudget(size_t byteBudget);
+    size_t byteBudget() const { return m_byteBudget; }
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    struct Entry {
+        RefPtr<SharedBuffer> buffer;
+        bool owned;
+    };
+    typedef HashMap<String, Entry> EntryMap;
+
+    void remove(EntryMap::iterator);
+    void evictIfNeeded();
+
+    EntryMap m_entries;
+    // Copied entries, oldest first.
+    ListHashSet<String> m_ownedOrder;
+    size_t m_bytesHeld;
+    size_t m_byteBudget;
+
+    unsigned m_hits;
+    unsigned m_misses;
+    unsigned m_evictions;
+};
+
+} // namespace WebCore
+
+#endif // KResourceStore_h
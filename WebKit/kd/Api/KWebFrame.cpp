@@ -158,12 +158,19 @@ public:
             long long size;
             GetUrlData(pReplyHandler->URL().string(), qbData, size);
 
+            // ResourceHandle owns the handler; if a callback cancels the load
+            // it is left to us to delete (see KNetworkReplyHandler).
+            pReplyHandler->m_delivering = true;
             sendResponseIfNeeded(pReplyHandler->URL(), pReplyHandler->client(), size, pReplyHandler->ResHandle());
-            pReplyHandler->client()->didReceiveData(pReplyHandler->ResHandle(), (const char*)(&qbData[0]), size, size);
-            pReplyHandler->client()->didFinishLoading(NULL, 0);
+            if (!pReplyHandler->isCancelled())
+                pReplyHandler->client()->didReceiveData(pReplyHandler->ResHandle(), (const char*)(&qbData[0]), size, size);
+            if (!pReplyHandler->isCancelled())
+                pReplyHandler->client()->didFinishLoading(NULL, 0);
+            pReplyHandler->m_delivering = false;
 
-            delete pReplyHandler;
             pContext->arrReplyHandler.remove(pReplyHandler);
+            if (pReplyHandler->isCancelled())
+                delete pReplyHandler;
 
         }
     }
@@ -17,6 +17,7 @@
 #include "PlatformKeyboardEvent.h"
 #include "MIMETypeRegistry.h"
 #include "KFrameNetworkingContext.h"
+#include "ResourceHandle.h"
 #include "KContextMenuClient.h"
 #include "KDragClient.h"
 #include "KEditorClient.h"
@@ -25,16 +26,19 @@
 #include "MemoryCache.h"
 
 #include "kd/SharedTimerKd.h"
+#include "kd/RunLoopKd.h"
 
 #include "bridge/npruntime_impl.h"
 
 #include "IntRect.h"
+#include "KDirtyRegion.h"
 #include <WTF/scoped_ptr.h>
 #include <WTF/RandomNumber.h>
 #include <Ext/platform_canvas.h>
 #include <Skia/PlatformContextSkia.h>
 #include <cpp/KdValArray.h>
 #include <text/TextEncoding.h>
+#include <wtf/CurrentTime.h>
 
 extern WCHAR szTitle[];
 extern WCHAR szWindowClass[];
@@ -46,14 +50,12 @@ static void sendResponseIfNeeded(
     /* in */ ResourceHandleClient* client,
     /* in */ long long size,
     /* in */ ResourceHandle* resourceHandle,
-    /* in */ bool needIgnoringCacheData
+    /* in */ bool needIgnoringCacheData,
+    /* in */ PassRefPtr<ResourceLoadTiming> timing
     );
 
-static bool GetUrlDataFromFile(
-    /* in */ String Url,
-    /* out */ KdValArray& OutData,
-    /* out */ long long& fileSize
-    );
+static String resourcePathFromURL(String Url);
+static void reportResourceLoadFailure(const String& Url);
 
 #define UseKdMsgSystem 1
 #define QueryPerformance 1
@@ -98,39 +100,6 @@ private:
     Vector<IntRect*> m_recordRectQueue;
 };
 
-struct AsynchronousResLoadInfo
-{
-    AsynchronousResLoadInfo(const UChar* pUrl, const void* pResBuf, int nResBufLen, bool bNeedSavaRes) 
-        : m_url(pUrl)
-    {
-        m_bNeedSavaRes = bNeedSavaRes;
-        if (bNeedSavaRes) {
-            m_pAlloc = new KdValArray(1, nResBufLen);
-            m_pAlloc->SetSize(nResBufLen);
-            memcpy(m_pAlloc->GetData(), pResBuf, nResBufLen);
-            m_pResBuf = 0;
-            m_nResBufLen = 0;
-        } else {
-            m_pResBuf = pResBuf;
-            m_nResBufLen = nResBufLen;
-        }
-    }
-
-    ~AsynchronousResLoadInfo()
-    {
-        if (m_bNeedSavaRes) {
-            delete m_pAlloc;
-            m_pAlloc = 0;
-        }
-    }
-
-    String m_url;
-    const void* m_pResBuf;
-    int m_nResBufLen;
-    KdValArray* m_pAlloc;
-    bool m_bNeedSavaRes;
-};
-
 class KWebPageImpl {
 public:
     KWebPageImpl()
@@ -148,7 +117,7 @@ public:
     }
 
     void Init(KWebPage* pagePtr) {
-        LONG windowStyle = GetWindowLong(pagePtr->getHWND(), GWL_EXSTYLE);
+        LONG windowStyle = pagePtr->getHWND() ? GetWindowLong(pagePtr->getHWND(), GWL_EXSTYLE) : 0;
         m_useLayeredBuffer = !!((windowStyle) & WS_EX_LAYERED);
 
         m_canScheduleResourceLoader = false;
@@ -186,124 +155,52 @@ public:
         canvas->drawRect(skrc, clearPaint);
     }
 
-    // Merge any areas that would reduce the total area
-    void mergeDirtyList()
-    { while ( doMergeDirtyList(true) ) {}; }
-    
-    bool doMergeDirtyList(bool forceMerge)
-    {
-        int nDirty = (int)m_paintMessageQueue.size();
-        if (nDirty < 1) {
-            return false;}
-        
-        int bestDelta = forceMerge ? 0x7FFFFFFF : 0;
-        int mergeA = 0;
-        int mergeB = 0;
-        for ( int i = 0; i < nDirty-1; i++ ) {
-            for ( int j = i+1; j < nDirty; j++ ) {
-                int delta = unionArea(m_paintMessageQueue[i], m_paintMessageQueue[j]) -
-                    m_paintMessageQueue[i]->rectArea() - m_paintMessageQueue[j]->rectArea();
-                if ( bestDelta > delta ) {
-                    mergeA = i;
-                    mergeB = j;
-                    bestDelta = delta;
-                }
-            }
-        }
-
-        if ( mergeA != mergeB ) {
-            m_paintMessageQueue[mergeA]->unite(*(m_paintMessageQueue[mergeB]));
-            for ( int i = mergeB+1; i < nDirty; i++ )
-            { *(m_paintMessageQueue[i-1]) = *(m_paintMessageQueue[i]); }
-           
-            fastFree(m_paintMessageQueue[nDirty - 1]);
-            m_paintMessageQueue.removeLast();
-            return true;
-        }
-
-        return false;
-    }
-
     void postPaintMessage(const IntRect* paintRect)
     {
         if (!paintRect || paintRect->isEmpty()) {
             return;}
 
         m_postpaintMessageCount++;
-
-        if (m_paintMessageQueue.size() > m_paintMessageQueueSize && 0 != m_scheduleMessageCount) {
-            return;} // SchedulePaintEvent͹
-
-        if (m_paintMessageQueue.size() > m_paintMessageQueueSize) {
-            IntRect* destroyRect = m_paintMessageQueue[0];
-            fastFree(destroyRect);
-            m_paintMessageQueue.remove(0);
-        }
-
-        // TODO κϲ
-        for (int i = 0; i < (int)m_paintMessageQueue.size(); ++i) {
-            IntRect* paintRectFromQueue = m_paintMessageQueue[i];
-            if (paintRectFromQueue ==  paintRect)
-            { paintRectFromQueue->setWidth(0); }
-        }
-
-        IntRect* paintRectDummy = new (fastMalloc(sizeof(RECT))) IntRect(*paintRect);
-        m_paintMessageQueue.append(paintRectDummy);
-
+        m_dirtyRegion.add(*paintRect);
         m_postpaintMessageCount--;
     }
 
-    void testPaint() {
-        for (size_t index = 0; index < m_paintMessageQueue.size(); ++index) {
-            IntRect* paintRect = m_paintMessageQueue[index];
-            WCHAR msg[100] = {0};
-            swprintf(msg, L"testPaint: %d %d %x\n", paintRect->y(), paintRect->height(), index);
-            OutputDebugStringW(msg);
-        }
-    }
-
     void SchedulePaintEvent()
     {
         if (0 != m_scheduleMessageCount)
         { notImplemented(); }
 
-        if (!m_pagePtr->getHWND()) 
+        if (m_dirtyRegion.isEmpty())
         { return; }
 
         m_scheduleMessageCount++;
 
-        HDC psHdc = ::GetDC(m_pagePtr->getHWND());
-
-        IntRect lastTimeRect;
+        // Headless pages have no window DC; they only paint into m_memoryCanvas.
+        HDC psHdc = m_pagePtr->getHWND() ? ::GetDC(m_pagePtr->getHWND()) : 0;
 
-BeginPaint:
-        lastTimeRect.setSize(IntSize());
-        mergeDirtyList();
-        int queueSize = (int)m_paintMessageQueue.size();
-        for (int i = 0; i < queueSize; ++i) {
-            IntRect* paintRect = m_paintMessageQueue[i];
-            if (lastTimeRect == *paintRect || lastTimeRect.contains(*paintRect)) {
-                fastFree(paintRect);
-                continue;
-            }
-            lastTimeRect = *paintRect;
-            fastFree(paintRect);
-            if (!lastTimeRect.isEmpty()) { // ܻpostPaintMessageҪºϲΣСһЩbug
-                //if (!m_paintRequestFilter.canFilter(&lastTimeRect))
-                { doPaint(psHdc, &lastTimeRect); }
-                // ﻹŻռ䣬԰Ѻ̼ܶĲ಻ľκԵ
-                if (queueSize != (int)m_paintMessageQueue.size()) { // ڻƵʱΣºϲ
-                    m_paintMessageQueue.remove(0, i + 1);
-                    goto BeginPaint;
-                }
-            }
+        // Layout inside doPaint can post more damage. Repaint it in a bounded
+        // number of extra passes; anything still dirty waits for the next tick.
+        Vector<IntRect> dirtyRects;
+        for (int pass = 0; pass < m_maxPaintPasses && !m_dirtyRegion.isEmpty(); ++pass) {
+            m_dirtyRegion.take(dirtyRects);
+            for (size_t i = 0; i < dirtyRects.size(); ++i)
+            { doPaint(psHdc, &dirtyRects[i]); }
         }
-        ::ReleaseDC(m_pagePtr->getHWND(), psHdc);
 
-        m_paintMessageQueue.clear();
+        if (psHdc)
+        { ::ReleaseDC(m_pagePtr->getHWND(), psHdc); }
+
         m_scheduleMessageCount--;
     }
 
+    void setClientRect(const IntRect& clientRect)
+    {
+        m_clientRect = clientRect;
+        m_dirtyRegion.setBounds(clientRect);
+    }
+
+    KDirtyRegion& dirtyRegion() { return m_dirtyRegion; }
+
     void doPaintUseLayeredBuffer(HDC psHdc, const IntRect* paintRect)
     {
         RECT rcPaint = {0, 0, 500, 500};
@@ -448,7 +345,9 @@ Exit0:
         if (!bNeedContinue)
             goto Exit0;
 
-        if (m_useLayeredBuffer) { // ٰڴdcpsHdc
+        if (!psHdc) {
+            // Headless: the frame stays in m_memoryCanvas for the paint callback.
+        } else if (m_useLayeredBuffer) { // ٰڴdcpsHdc
             RECT rtWnd;
             ::GetWindowRect(m_pagePtr->getHWND(), &rtWnd);
             m_winodwRect = rtWnd;
@@ -622,8 +521,8 @@ protected:
     //WebCore::Frame* m_frame;
     bool m_canScheduleResourceLoader;
 
-    Vector<IntRect*> m_paintMessageQueue;
-    static const int m_paintMessageQueueSize = 200;
+    KDirtyRegion m_dirtyRegion;
+    static const int m_maxPaintPasses = 3;
 
     int m_postpaintMessageCount;
     int m_scheduleMessageCount;
@@ -687,6 +586,9 @@ KWebPage::~KWebPage()
         m_pPageImpl = 0;
     }
 
+    deleteAllValues(m_resourcePackages);
+    m_resourcePackages.clear();
+
     // Page::~Page()
 //     if (m_contextMenuClient)
 //         delete m_contextMenuClient;
@@ -780,83 +682,170 @@ void KWebPage::setViewportSize(const IntSize& size)
     if (!m_pPageImpl) {
         return;}
 
-    m_pPageImpl->m_clientRect = IntRect(0, 0, size.width(), size.height());
+    m_pPageImpl->setClientRect(IntRect(0, 0, size.width(), size.height()));
 
-    RECT rtWnd;
-    ::GetWindowRect(m_hWnd, &rtWnd);
-    m_pPageImpl->m_winodwRect = rtWnd;
+    if (m_hWnd) {
+        RECT rtWnd;
+        ::GetWindowRect(m_hWnd, &rtWnd);
+        m_pPageImpl->m_winodwRect = rtWnd;
+    } else
+        m_pPageImpl->m_winodwRect = m_pPageImpl->m_clientRect;
     m_pPageImpl->m_hasResize = true;
 }
 
-static bool ResourceLoaderFromBuf(Vector<AsynchronousResLoadInfo*>& asynVec, const String url, KdValArray* resData)
+// Bytes handed to didReceiveData() per call, and how long one pass may spend
+// delivering them before the rest is left for the next timer tick.
+static const unsigned resourceChunkSize = 64 * 1024;
+static const double resourceDeliveryBudget = 0.008;
+
+void KWebPage::startResourceLoad(KNetworkReplyHandler* pReplyHandler)
 {
-    for (size_t i = 0; i < asynVec.size(); ++i) {
-        AsynchronousResLoadInfo* pInfo = asynVec[i];
-        if (url == pInfo->m_url) {
-            if (pInfo->m_bNeedSavaRes) {
-                resData->Resize(pInfo->m_pAlloc->GetSize());
-                resData->SetSize(pInfo->m_pAlloc->GetSize());
-                memcpy(resData->GetData(), pInfo->m_pAlloc->GetData(), resData->GetSize());
-            } else {
-                resData->Resize(pInfo->m_nResBufLen);
-                resData->SetSize(pInfo->m_nResBufLen);
-                memcpy(resData->GetData(), pInfo->m_pResBuf, resData->GetSize());
-            }
-            asynVec.remove(i, 1);
-            delete pInfo;
-            return true;
+    pReplyHandler->m_started = true;
+
+    String url = pReplyHandler->URL().string();
+    url = decodeURLEscapeSequences(url);
+
+    size_t needIgnoringCacheData = url.find("?content=no-store");
+    if (-1 != needIgnoringCacheData) {
+        url = url.left(needIgnoringCacheData);
+        pReplyHandler->m_ignoringCacheData = true;}
+
+    // Buffers posted by the embedder and the m_resHandle callback are served
+    // here on the UI thread, as before; only plain file reads go to the pool.
+    pReplyHandler->m_data = m_resourceStore.take(url);
+    if (pReplyHandler->m_data)
+    { return; }
+
+    for (size_t i = 0; i < m_resourcePackages.size(); ++i) {
+        pReplyHandler->m_data = m_resourcePackages[i]->resourceForURL(url);
+        if (pReplyHandler->m_data)
+        { return; }
+    }
+
+    if (m_callbacks.m_resHandle) {
+        KdValArray resData(sizeof(char), 0x1024);
+        HRESULT hr = m_callbacks.m_resHandle(this, getKdGuiObjPtr() ? getKdGuiObjPtr()->pForeignPtr : 0, getForeignPtr(), getHWND(),
+            (const WCHAR *)url.charactersWithNullTermination(), &resData);
+        if (0 == hr) {
+            pReplyHandler->m_data = SharedBuffer::create((const char*)resData.GetData(), resData.GetSize());
+            return;
         }
     }
 
-    return false;
+    ResourceLoadPriority priority = pReplyHandler->ResHandle() ? pReplyHandler->ResHandle()->firstRequest().priority() : ResourceLoadPriorityLow;
+    pReplyHandler->m_loadJob = KResourceLoadJob::create(resourcePathFromURL(url), priority);
+    KResourceLoadPool::shared()->setJobFinishedFunction(RunLoopKd::wakeUpMain);
+    KResourceLoadPool::shared()->post(pReplyHandler->m_loadJob);
 }
 
-void KWebPage::scheduleResourceLoader(KFrameNetworkingContext* pContext) {
-    KNetworkReplyHandler* pReplyHandler;
-    ListHashSet<KNetworkReplyHandler*>::iterator iter;
+// Returns true once the handler has been sent everything, including
+// didFinishLoading(). Gives up early if the deadline passes or the page
+// starts closing from inside a client callback.
+bool KWebPage::deliverResourceData(KNetworkReplyHandler* pReplyHandler, double deadline)
+{
+    ResourceHandleClient* client = pReplyHandler->client();
+    unsigned size = pReplyHandler->m_data ? pReplyHandler->m_data->size() : 0;
+
+    if (!pReplyHandler->m_responseSent) {
+        pReplyHandler->m_responseSent = true;
+        sendResponseIfNeeded(pReplyHandler->URL(), client, size, pReplyHandler->ResHandle(),
+            pReplyHandler->m_ignoringCacheData, pReplyHandler->m_timing.release());
+        if (INIT != m_state || pReplyHandler->isCancelled())
+        { return false; }
+    }
+
+    while (pReplyHandler->m_dataOffset < size) {
+        unsigned length = std::min(resourceChunkSize, size - pReplyHandler->m_dataOffset);
+        client->didReceiveData(pReplyHandler->ResHandle(), pReplyHandler->m_data->data() + pReplyHandler->m_dataOffset, length, length);
+        pReplyHandler->m_dataOffset += length;
+
+        if (INIT != m_state || pReplyHandler->isCancelled())
+        { return false; }
+        if (pReplyHandler->m_dataOffset < size && currentTime() > deadline)
+        { return false; }
+    }
+
+    client->didFinishLoading(NULL, 0);
+    return true;
+}
 
-    if (!m_canScheduleResourceLoader)
+void KWebPage::scheduleResourceLoader(KFrameNetworkingContext* pContext) {
+    if (!m_canScheduleResourceLoader || !pContext)
     { return; }
 
-    while (pContext && !pContext->arrReplyHandler.isEmpty()) {
-        iter = pContext->arrReplyHandler.begin();
-        pReplyHandler = *iter;
+    // Client callbacks may queue new loads; those wait for the next pass.
+    Vector<KNetworkReplyHandler*> replyHandlers;
+    ListHashSet<KNetworkReplyHandler*>::iterator end = pContext->arrReplyHandler.end();
+    for (ListHashSet<KNetworkReplyHandler*>::iterator iter = pContext->arrReplyHandler.begin(); iter != end; ++iter)
+    { replyHandlers.append(*iter); }
+
+    double deadline = currentTime() + resourceDeliveryBudget;
+    bool hasPendingData = false;
 
+    for (size_t i = 0; i < replyHandlers.size(); ++i) {
+        KNetworkReplyHandler* pReplyHandler = replyHandlers[i];
+        // A client callback earlier in this pass may have cancelled it.
+        if (!pContext->arrReplyHandler.contains(pReplyHandler))
+        { continue; }
         if (pReplyHandler->isDeferred())
         { break; }
 
-        String url = pReplyHandler->URL().string();
-        url = decodeURLEscapeSequences(url);
+        if (!pReplyHandler->m_started)
+        { startResourceLoad(pReplyHandler); }
+
+        KResourceLoadJob* job = pReplyHandler->m_loadJob;
+        if (job) {
+            // Still being read by a pool thread.
+            if (!job->isFinished())
+            { continue; }
+
+            if (job->succeeded())
+                pReplyHandler->m_data = SharedBuffer::adoptVector(job->data());
+            else
+                reportResourceLoadFailure(pReplyHandler->URL().string());
+
+            RefPtr<ResourceLoadTiming> timing = ResourceLoadTiming::create();
+            timing->requestTime = job->queueTime();
+            timing->sendStart = static_cast<int>((job->startTime() - job->queueTime()) * 1000);
+            timing->sendEnd = timing->sendStart;
+            timing->receiveHeadersEnd = static_cast<int>((job->finishTime() - job->queueTime()) * 1000);
+            pReplyHandler->m_timing = timing.release();
+
+            pReplyHandler->m_loadJob = 0;
+            job->deref();
+        }
 
-        size_t needIgnoringCacheData = url.find("?content=no-store");
-        if (-1 != needIgnoringCacheData) {
-            url = url.left(needIgnoringCacheData);}
-        
-        KdValArray resData(sizeof(char), 0x1024);
-        long long size = 0;
-        bool needLoadResMyself = true;
-
-        if (ResourceLoaderFromBuf(m_asynResQueue, url, &resData)) {
-            size = resData.GetSize();
-            needLoadResMyself = false;
-        } else if (m_callbacks.m_resHandle) {
-            HRESULT hr = m_callbacks.m_resHandle(this, getKdGuiObjPtr() ? getKdGuiObjPtr()->pForeignPtr : 0, getForeignPtr(), getHWND(),
-                (const WCHAR *)url.charactersWithNullTermination(), &resData);
-            if (0 == hr) {
-                size = resData.GetSize();
-                needLoadResMyself = false;
-            }
+        if (currentTime() > deadline) {
+            hasPendingData = true;
+            break;
         }
-        if (needLoadResMyself) {
-            GetUrlDataFromFile(url, resData, size);}
 
-        sendResponseIfNeeded(pReplyHandler->URL(), pReplyHandler->client(), size, pReplyHandler->ResHandle(), -1 != needIgnoringCacheData);
-        pReplyHandler->client()->didReceiveData(pReplyHandler->ResHandle(), (const char*)(resData.GetData()), size, size);
-        pReplyHandler->client()->didFinishLoading(NULL, 0);
+        pReplyHandler->m_delivering = true;
+        bool delivered = deliverResourceData(pReplyHandler, deadline);
+        pReplyHandler->m_delivering = false;
+
+        if (pReplyHandler->isCancelled()) {
+            // ResourceHandle::cancel() ran inside a client callback and left
+            // the handler to us; it is already off the queue.
+            delete pReplyHandler;
+            if (INIT != m_state)
+            { return; }
+            continue;
+        }
+
+        if (!delivered) {
+            if (INIT != m_state)
+            { return; }
+            hasPendingData = true;
+            break;
+        }
 
-        delete pReplyHandler;
+        // The ResourceHandle still owns the handler and deletes it.
         pContext->arrReplyHandler.remove(pReplyHandler);
     }
+
+    if (hasPendingData)
+    { scheduleWork(); }
 }
 
 // εһģ
@@ -933,6 +922,44 @@ Exit0:
     return page;
 }
 
+// Creates a page with no HWND. Painting goes to the page's memory canvas and is
+// handed to the embedder through the KDPPaintStep* paint callbacks. The page is
+// driven by the thread's RunLoopKd, which the embedder runs with KdRunLoop() or
+// KdRunLoopIterate().
+KWebPage* KWebPage::createHeadlessWindow(
+    KdGuiObjPtr kdGuiObj,
+    const IntSize& size,
+    void* foreignPtr
+    )
+{
+    KWebPage* page = new KWebPage(kdGuiObj, foreignPtr);
+    page->Init(0);
+    page->setViewportSize(size);
+
+    if (kdGuiObj)
+    { kdGuiObj->pages.append(page); }
+
+    RunLoopKd::current()->addWorkFunction(runLoopWork, page);
+
+    return page;
+}
+
+void KWebPage::runLoopWork(void* context)
+{
+    KWebPage* page = static_cast<KWebPage*>(context);
+    if (INIT != page->m_state)
+    { return; }
+
+    page->scheduleResourceLoader(page->m_pFrameNetworkingContext);
+    if (page->m_pPageImpl)
+    { page->m_pPageImpl->SchedulePaintEvent(); }
+}
+
+void KWebPage::scheduleWork()
+{
+    RunLoopKd::current()->wakeUp();
+}
+
 void KWebPage::javaScriptAlert(String& message)
 {
     if (true == m_isAlert)
@@ -1056,7 +1083,10 @@ void KWebPage::windowCloseRequested()
     // webkitԴ
     memoryCache()->evictResources();
 
-    ::KillTimer(m_hWnd, (UINT_PTR)this);
+    RunLoopKd::current()->removeWorkFunction(runLoopWork, this);
+
+    if (m_hWnd)
+    { ::KillTimer(m_hWnd, (UINT_PTR)this); }
 }
 
 #ifndef NDEBUG
@@ -1065,7 +1095,9 @@ BOOL gd_bShowTree = FALSE;
 
 void KWebPage::timerFired()
 {
-    SharedTimerKd::inst()->timerEvent();
+    // The shared timer is shared by every page on this thread; only run the
+    // WebCore timers when the requested fire time has actually passed.
+    SharedTimerKd::inst()->timerEventIfDue();
     WTF::dispatchFunctionsFromMainThread();
 
     scheduleResourceLoader(m_pFrameNetworkingContext);
@@ -1117,7 +1149,8 @@ void KWebPage::repaintRequested(const IntRect& windowRect)
  
 #if UseKdMsgSystem
     if (!windowRect.isEmpty()) {
-        m_pPageImpl->postPaintMessage(&windowRect); }
+        m_pPageImpl->postPaintMessage(&windowRect);
+        scheduleWork(); }
 #else
     ::InvalidateRect(m_hWnd, &winRect, false);
 #endif
@@ -1322,53 +1355,25 @@ bool KWebPage::inputEventToRichEdit(HWND hWnd, UINT message, WPARAM wParam, LPAR
 
 #endif
 
-static int gTest = 0;
-static bool GetUrlDataFromFile(
-    /* in */ String Url,
-    /* out */ KdValArray& OutData,
-    /* out */ long long& fileSize
-    )
+static String resourcePathFromURL(String Url)
 {
-    HANDLE        hFile        = NULL;
-    DWORD         bytesReaded  = 0;
-    UINT          DataSize     = 8;
-    bool          bRet         = false;
-    LARGE_INTEGER FileSize     = {0};
-
     if (-1 != Url.find(String((const UChar*)L"file:"), 0, false))
     { Url.remove(0, 8); }
-    
-    hFile = CreateFileW((LPCWSTR)Url.charactersWithNullTermination(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
-    if(!hFile || INVALID_HANDLE_VALUE == hFile) {
-        if (gTest++ > 2)
-        { return false; }
-
-        __asm int 3;
-        OutputDebugStringW((LPCWSTR)Url.charactersWithNullTermination());
-        MessageBoxW(0, (LPCWSTR)Url.charactersWithNullTermination(), L"ļʧ", 0);
-        
-        return false; 
-    }
-
-    bRet = GetFileSizeEx(hFile, &FileSize);
-    if (!bRet || (0 == FileSize.HighPart && 0 == FileSize.LowPart))
-    { goto Exit0; }
-
-    OutData.Resize(FileSize.LowPart + 10);
-
-    if(!::ReadFile(hFile, (LPVOID)(OutData.GetData()), FileSize.LowPart, &bytesReaded, NULL))
-    { goto Exit0; }
-
-    fileSize = FileSize.QuadPart;
-    bRet = true;
+    return Url;
+}
 
-Exit0:
-    if (hFile && INVALID_HANDLE_VALUE != hFile) { 
-        ::CloseHandle(hFile);
-        hFile = NULL;
-    }
+static int gTest = 0;
+static void reportResourceLoadFailure(const String& Url)
+{
+    if (gTest++ > 2)
+    { return; }
 
-    return bRet;
+    String path = resourcePathFromURL(decodeURLEscapeSequences(Url));
+#if COMPILER(MSVC)
+    __asm int 3;
+#endif
+    OutputDebugStringW((LPCWSTR)path.charactersWithNullTermination());
+    MessageBoxW(0, (LPCWSTR)path.charactersWithNullTermination(), L"ļʧ", 0);
 }
 
 static void sendResponseIfNeeded (
@@ -1376,7 +1381,8 @@ static void sendResponseIfNeeded (
     ResourceHandleClient* client,
     long long size,
     ResourceHandle* resourceHandle,
-    bool needIgnoringCacheData
+    bool needIgnoringCacheData,
+    PassRefPtr<ResourceLoadTiming> timing
     )
 {
     if (!client)
@@ -1407,7 +1413,10 @@ static void sendResponseIfNeeded (
     if (needIgnoringCacheData) {
         //response.setCachePolicy(ReloadIgnoringCacheData);
         response.setHTTPHeaderField(AtomicString("no-store"), String("yes"));}
-    
+
+    if (timing)
+    { response.setResourceLoadTiming(timing); }
+
     client->didReceiveResponse(resourceHandle, response);    
 }
 
@@ -1441,8 +1450,36 @@ void KWebPage::loadFormData(const void* lpData, int nLen)
 
 void KWebPage::postResToAsynchronousLoad(const WCHAR* pUrl, const void* pResBuf, int nResBufLen, bool bNeedSavaRes)
 {
-    AsynchronousResLoadInfo* pInfo = new AsynchronousResLoadInfo((const UChar *)pUrl, pResBuf, nResBufLen, bNeedSavaRes);
-    m_asynResQueue.append(pInfo);
+    m_resourceStore.add(String((const UChar *)pUrl), pResBuf, nResBufLen, bNeedSavaRes);
+    scheduleWork();
+}
+
+void KWebPage::setResourceStoreBudget(size_t byteBudget)
+{
+    m_resourceStore.setByteBudget(byteBudget);
+}
+
+void KWebPage::getResourceStoreStatistics(KdResourceStoreStatistics* statistics)
+{
+    KResourceStore::Statistics storeStatistics = m_resourceStore.statistics();
+    statistics->nHits = storeStatistics.hits;
+    statistics->nMisses = storeStatistics.misses;
+    statistics->nEvictions = storeStatistics.evictions;
+    statistics->nEntries = storeStatistics.entries;
+    statistics->nBytesHeld = storeStatistics.bytesHeld;
+}
+
+bool KWebPage::mountResourcePackage(const WCHAR* packagePath, const WCHAR* urlPrefix)
+{
+    if (!packagePath || !urlPrefix)
+    { return false; }
+
+    KResourcePackage* package = KResourcePackage::open(String((const UChar*)packagePath), String((const UChar*)urlPrefix));
+    if (!package)
+    { return false; }
+
+    m_resourcePackages.append(package);
+    return true;
 }
 
 int KWebPage::notifFromResHandle(LPCWSTR lpMsg, void* pContent)
@@ -1455,6 +1492,7 @@ int KWebPage::notifFromResHandle(LPCWSTR lpMsg, void* pContent)
             } else {
                 ASSERT(m_pFrameNetworkingContext == pContent);
             }
+            scheduleWork();
         }
     } else if (0 == wcscmp(L"KdCallbackWhenSvgInit", lpMsg) && m_pPageImpl) {
         m_pPageImpl->m_bNeedCallXmlHaveFinished = true;
@@ -1468,6 +1506,30 @@ int KWebPage::notifFromResHandle(LPCWSTR lpMsg, void* pContent)
     return 0;
 }
 
+void KWebPage::setDirtyRegionPolicy(int maxRects, int tileSize)
+{
+    if (!m_pPageImpl)
+    { return; }
+
+    if (maxRects > 0)
+    { m_pPageImpl->dirtyRegion().setMaxRects(maxRects); }
+    if (tileSize > 0)
+    { m_pPageImpl->dirtyRegion().setTileSize(tileSize); }
+}
+
+void KWebPage::getPaintStatistics(KdPaintStatistics* statistics)
+{
+    memset(statistics, 0, sizeof(KdPaintStatistics));
+    if (!m_pPageImpl)
+    { return; }
+
+    const KDirtyRegion::Statistics& regionStatistics = m_pPageImpl->dirtyRegion().statistics();
+    statistics->nRectsPosted = regionStatistics.rectsPosted;
+    statistics->nRectsMerged = regionStatistics.rectsMerged;
+    statistics->nRectsPainted = regionStatistics.rectsPainted;
+    statistics->nCoalescedToBounds = regionStatistics.coalescedToBounds;
+}
+
 void KWebPage::setBackgroundColor(COLORREF c) {
     m_pPageImpl->m_bdColor = c;
 }
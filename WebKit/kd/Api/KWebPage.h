@@ -16,6 +16,8 @@
 #include "KdGuiApiImp.h"
 
 #include "KdPageInfo.h"
+#include "KResourceStore.h"
+#include "KResourcePackage.h"
 
 #include "bridge/npruntime.h"
 
@@ -35,9 +37,9 @@ class KContextMenuClient;
 class KEditorClient;
 class Page;
 class KFrameNetworkingContext;
+class KNetworkReplyHandler;
 class KWidget;
 class KWebPageImpl;
-struct AsynchronousResLoadInfo;
 
 struct KWebApiCallbackSet {
     PFN_KdPageCallback m_xmlHaveFinished;
@@ -81,6 +83,11 @@ public:
         KdPageInfoPtr pageInfo,
         void* foreignPtr
         );
+    static KWebPage* createHeadlessWindow(
+        KdGuiObjPtr kdGuiObj,
+        const IntSize& size,
+        void* foreignPtr
+        );
 
 #if 0
     void appendAnimNode(KQuery* node);
@@ -105,6 +112,10 @@ public:
 
     void timerFired();
 
+    // Asks the host run loop for a pass of timerFired()-style work as soon as
+    // possible. A no-op where the 10 ms window timer still drives the page.
+    void scheduleWork();
+
     void resizeEvent(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 
     IntSize viewportSize() const {return m_viewportSize;}
@@ -128,9 +139,20 @@ public:
 
     void setBackgroundColor(COLORREF c);
 
+    // maxRects: damage rects per paint pass before painting their bounding
+    // box instead. tileSize: damage granularity in pixels. 0 keeps the value.
+    void setDirtyRegionPolicy(int maxRects, int tileSize);
+    void getPaintStatistics(KdPaintStatistics* statistics);
+
     void showDebugNodeData();
 
     void postResToAsynchronousLoad(const WCHAR* pUrl, const void* pResBuf, int nResBufLen, bool bNeedSavaRes);
+    // byteBudget: bytes of copied resources kept before the oldest are
+    // dropped. 0 means no limit.
+    void setResourceStoreBudget(size_t byteBudget);
+    void getResourceStoreStatistics(KdResourceStoreStatistics* statistics);
+    // Serves every URL under urlPrefix from the .kdpk package at packagePath.
+    bool mountResourcePackage(const WCHAR* packagePath, const WCHAR* urlPrefix);
 
     bool invokeScript(NPIdentifier methodName, const NPVariant* args, uint32_t argCount, NPVariant* result);
     NPInvokeFunctionPtr getJavascriptCallCppCallback() { return m_callbacks.m_javascriptCallCppPtr; }
@@ -159,6 +181,10 @@ protected:
     bool m_canScheduleResourceLoader;
 
     void scheduleResourceLoader(KFrameNetworkingContext* pContext);
+    void startResourceLoad(KNetworkReplyHandler* pReplyHandler);
+    bool deliverResourceData(KNetworkReplyHandler* pReplyHandler, double deadline);
+
+    static void runLoopWork(void* context);
 
     KFrameLoaderClient* m_frameLoaderClient;
     Frame* m_frame;
@@ -191,7 +217,8 @@ protected:
 
     Vector<KQuery*> m_animatingNodeQueue; // ڽжĽڵ㣬ڹرʱͳһɾ
 
-    Vector<AsynchronousResLoadInfo*> m_asynResQueue;
+    KResourceStore m_resourceStore;
+    Vector<KResourcePackage*> m_resourcePackages;
 
     
     bool m_isAlert;
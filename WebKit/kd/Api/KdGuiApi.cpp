@@ -26,9 +26,14 @@
 
 #include "KWebPage.h"
 #include "Document.h"
+#include "JSDOMWindowBase.h"
+#include "RegExpCache.h"
 #include "ScriptController.h"
+#include "SourceProviderCacheStore.h"
 #include "KdGuiApi.h"
 #include "KdGuiApiImp.h"
+#include "ScriptGCEvent.h"
+#include "kd/RunLoopKd.h"
 
 #include "AtomicString.h"
 #include "HTMLNames.h"
@@ -45,6 +50,7 @@
 #include "SVGTextMetrics.h"
 
 #include <WTF/Vector.h>
+#include <wtf/MainThread.h>
 #include <wtf/PageBlock.h>
 #include <wtf/RandomNumber.h>
 #include <platform/win/SystemInfo.h>
@@ -100,6 +106,36 @@ KdCreateRealWndAttachedWebPage(
     return page;
 }
 
+// A page without a window; see KWebPage::createHeadlessWindow.
+KDEXPORT KdPagePtr KDCALL
+KdCreateHeadlessWebPage(
+    KdGuiObjPtr kdHandle,
+    int nWidth,
+    int nHeight,
+    void* pForeignPtr
+    )
+{
+    return WebCore::KWebPage::createHeadlessWindow(kdHandle, WebCore::IntSize(nWidth, nHeight), pForeignPtr);
+}
+
+KDEXPORT void KDCALL
+KdRunLoop()
+{
+    WebCore::RunLoopKd::current()->run();
+}
+
+KDEXPORT bool KDCALL
+KdRunLoopIterate(int nTimeoutMs)
+{
+    return WebCore::RunLoopKd::current()->iterate(nTimeoutMs);
+}
+
+KDEXPORT void KDCALL
+KdQuitRunLoop()
+{
+    WebCore::RunLoopKd::current()->stop();
+}
+
 KDEXPORT HWND KDCALL
 KdGetHWNDFromPagePtr(KdPagePtr kdPage)
 {
@@ -139,6 +175,21 @@ KdPostResToAsynchronousLoad(KdPagePtr kdPageHandle, const WCHAR* pUrl, void* pRe
     kdPageHandle->postResToAsynchronousLoad(pUrl, pResBuf, nResBufLen, bNeedSavaRes);
 }
 
+KDEXPORT void KDCALL KdSetResourceStoreBudget(KdPagePtr kdPageHandle, size_t nByteBudget)
+{
+    kdPageHandle->setResourceStoreBudget(nByteBudget);
+}
+
+KDEXPORT void KDCALL KdGetResourceStoreStatistics(KdPagePtr kdPageHandle, KdResourceStoreStatistics* pStatistics)
+{
+    kdPageHandle->getResourceStoreStatistics(pStatistics);
+}
+
+KDEXPORT bool KDCALL KdMountResourcePackage(KdPagePtr kdPageHandle, LPCWSTR lpPackagePath, LPCWSTR lpUrlPrefix)
+{
+    return kdPageHandle->mountResourcePackage(lpPackagePath, lpUrlPrefix);
+}
+
 KDEXPORT void KDCALL
 KdGetMainVM(KdGuiObjPtr kdHandle)
 {
@@ -284,6 +335,16 @@ KDEXPORT void KDCALL KdShowDebugNodeData(KdPagePtr kdPageHandle)
     return kdPageHandle->showDebugNodeData();
 }
 
+KDEXPORT void KDCALL KdSetDirtyRegionPolicy(KdPagePtr kdPageHandle, int nMaxRects, int nTileSize)
+{
+    kdPageHandle->setDirtyRegionPolicy(nMaxRects, nTileSize);
+}
+
+KDEXPORT void KDCALL KdGetPaintStatistics(KdPagePtr kdPageHandle, KdPaintStatistics* pStatistics)
+{
+    kdPageHandle->getPaintStatistics(pStatistics);
+}
+
 KDEXPORT void KDCALL
 KdInitThread()
 {
@@ -320,6 +381,162 @@ KdUninitThread()
 //    WTF::ThreadSpecificThreadExit();
 }
 
+KDEXPORT void KDCALL KdPostToMainThread(PFN_KdMainThreadCallback pCallBack, void* pContext, KdMainThreadPriority emPriority)
+{
+    if (emPriority < KDMainThreadInputPriority || emPriority >= KDMainThreadPriorityCount)
+        emPriority = KDMainThreadLoadingPriority;
+    WTF::callOnMainThread(pCallBack, pContext, static_cast<WTF::MainThreadTaskPriority>(emPriority));
+}
+
+KDEXPORT void KDCALL KdSetMainThreadQueueTiming(bool bEnabled)
+{
+    WTF::setMainThreadQueueTimingEnabled(bEnabled);
+}
+
+KDEXPORT void KDCALL KdGetMainThreadQueueStatistics(KdMainThreadQueueStatistics* pStatistics)
+{
+    COMPILE_ASSERT(KDMainThreadPriorityCount == WTF::numberOfMainThreadTaskPriorities, KdMainThreadPriority_matches_MainThreadTaskPriority);
+
+    WTF::MainThreadQueueStatistics statistics = WTF::mainThreadQueueStatistics();
+    pStatistics->nDepth = statistics.depth;
+    for (unsigned i = 0; i < WTF::numberOfMainThreadTaskPriorities; ++i) {
+        const WTF::MainThreadQueueStatistics::Lane& lane = statistics.lanes[i];
+        pStatistics->lanes[i].nMaximumDepth = lane.maximumDepth;
+        pStatistics->lanes[i].nDispatched = lane.dispatched;
+        pStatistics->lanes[i].nTimed = lane.timed;
+        pStatistics->lanes[i].dTotalTimeInQueue = lane.totalTimeInQueue;
+        pStatistics->lanes[i].dMaximumTimeInQueue = lane.maximumTimeInQueue;
+    }
+}
+
+KDEXPORT void KDCALL KdResetMainThreadQueueStatistics()
+{
+    WTF::resetMainThreadQueueStatistics();
+}
+
+KDEXPORT void KDCALL KdSetScriptCacheDirectory(LPCWSTR lpDirectory)
+{
+    WebCore::SourceProviderCacheStore::setDirectory(lpDirectory ? String(lpDirectory) : String());
+}
+
+KDEXPORT void KDCALL KdStartScriptProfiler(unsigned nIntervalMs)
+{
+    WebCore::JSDOMWindowBase::commonJSGlobalData()->samplingProfiler.start(nIntervalMs);
+}
+
+KDEXPORT void KDCALL KdStopScriptProfiler()
+{
+    WebCore::JSDOMWindowBase::commonJSGlobalData()->samplingProfiler.stop();
+}
+
+KDEXPORT void KDCALL KdClearScriptProfile()
+{
+    WebCore::JSDOMWindowBase::commonJSGlobalData()->samplingProfiler.clear();
+}
+
+// Copies as much of text as fits, null terminated, and returns the length
+// the whole of it needs.
+static int _CopyToBuffer(const JSC::UString& text, WCHAR* pBuffer, int nBufferLength)
+{
+    int nLength = text.length() + 1;
+    if (pBuffer && nBufferLength > 0) {
+        int nCopy = min(nLength, nBufferLength) - 1;
+        memcpy(pBuffer, text.characters(), nCopy * sizeof(WCHAR));
+        pBuffer[nCopy] = 0;
+    }
+    return nLength;
+}
+
+KDEXPORT int KDCALL KdGetScriptProfile(WCHAR* pBuffer, int nBufferLength)
+{
+    return _CopyToBuffer(WebCore::JSDOMWindowBase::commonJSGlobalData()->samplingProfiler.foldedStacks(), pBuffer, nBufferLength);
+}
+
+KDEXPORT int KDCALL KdGetPropertyCacheStatistics(WCHAR* pBuffer, int nBufferLength)
+{
+#if ENABLE(MEGAMORPHIC_CACHE)
+    return _CopyToBuffer(WebCore::JSDOMWindowBase::commonJSGlobalData()->megamorphicCache.siteStatistics(), pBuffer, nBufferLength);
+#else
+    return _CopyToBuffer(JSC::UString(), pBuffer, nBufferLength);
+#endif
+}
+
+KDEXPORT void KDCALL KdResetPropertyCacheStatistics()
+{
+#if ENABLE(MEGAMORPHIC_CACHE)
+    WebCore::JSDOMWindowBase::commonJSGlobalData()->megamorphicCache.resetSiteCounts();
+#endif
+}
+
+KDEXPORT void KDCALL KdSetGCMarkingHelperThreadCount(unsigned nCount)
+{
+    WebCore::JSDOMWindowBase::commonJSGlobalData()->heap.setMarkingHelperThreadCount(nCount);
+}
+
+KDEXPORT unsigned KDCALL KdGetGCMarkingHelperThreadCount()
+{
+    return WebCore::JSDOMWindowBase::commonJSGlobalData()->heap.markingHelperThreadCount();
+}
+
+KDEXPORT void KDCALL KdGetGCPauseStatistics(KdGCPauseStatistics* pStatistics)
+{
+    COMPILE_ASSERT(KDGCPauseBucketCount == JSC::GCPauseHistogram::bucketCount, KdGCPauseStatistics_matches_GCPauseHistogram);
+
+    const JSC::GCPauseHistogram& histogram = WebCore::ScriptGCEvent::pauseHistogram();
+    pStatistics->nCollections = histogram.collectionCount;
+    for (size_t i = 0; i < JSC::GCPauseHistogram::bucketCount; ++i)
+        pStatistics->nPauses[i] = histogram.buckets[i];
+    pStatistics->dTotalPauseTime = histogram.totalPauseTime;
+    pStatistics->dTotalMarkTime = histogram.totalMarkTime;
+    pStatistics->dMaximumPauseTime = histogram.maxPauseTime;
+}
+
+KDEXPORT void KDCALL KdResetGCPauseStatistics()
+{
+    WebCore::ScriptGCEvent::resetPauseHistogram();
+}
+
+KDEXPORT void KDCALL KdGetScriptCompilationStatistics(KdScriptCompilationStatistics* pStatistics)
+{
+    const JSC::CompilationStatistics& statistics = WebCore::JSDOMWindowBase::commonJSGlobalData()->compilationStatistics();
+    pStatistics->nCompilations = statistics.compilations;
+    pStatistics->dParseTime = statistics.parseTime;
+    pStatistics->dBytecodeTime = statistics.bytecodeTime;
+    pStatistics->dMachineCodeTime = statistics.machineCodeTime;
+}
+
+KDEXPORT void KDCALL KdResetScriptCompilationStatistics()
+{
+    WebCore::JSDOMWindowBase::commonJSGlobalData()->resetCompilationStatistics();
+}
+
+KDEXPORT void KDCALL KdSetRegExpCacheCapacity(size_t nBytes)
+{
+    WebCore::JSDOMWindowBase::commonJSGlobalData()->regExpCache()->setCapacity(nBytes);
+}
+
+KDEXPORT void KDCALL KdGetRegExpCacheStatistics(KdRegExpCacheStatistics* pStatistics)
+{
+    JSC::JSGlobalData* globalData = WebCore::JSDOMWindowBase::commonJSGlobalData();
+    const JSC::RegExpCacheStatistics& statistics = globalData->regExpCacheStatistics;
+    pStatistics->nHits = statistics.hits;
+    pStatistics->nMisses = statistics.misses;
+    pStatistics->nEvictions = statistics.evictions;
+    pStatistics->dCompileTime = statistics.compileTime;
+    pStatistics->nEntries = statistics.entries;
+    pStatistics->nCachedBytes = statistics.cachedBytes;
+    pStatistics->nCapacity = globalData->regExpCache()->capacity();
+}
+
+KDEXPORT void KDCALL KdResetRegExpCacheStatistics()
+{
+    JSC::RegExpCacheStatistics& statistics = WebCore::JSDOMWindowBase::commonJSGlobalData()->regExpCacheStatistics;
+    statistics.hits = 0;
+    statistics.misses = 0;
+    statistics.evictions = 0;
+    statistics.compileTime = 0;
+}
+
 static ATOM _RegisterClass(HINSTANCE hInstance)
 {
     WNDCLASSEX wcex = {0};
@@ -86,6 +86,74 @@ typedef LRESULT (__stdcall* PFN_KdPagePaintCallback) (
     HDC hPaintDC
     );
 
+typedef struct _KdPaintStatistics {
+    unsigned nRectsPosted;       // invalidations received from WebCore and KdRepaintRequested
+    unsigned nRectsMerged;       // invalidations absorbed into another rect
+    unsigned nRectsPainted;      // rects actually painted
+    unsigned nCoalescedToBounds; // paint passes that fell back to the bounding box
+} KdPaintStatistics;
+
+typedef struct _KdResourceStoreStatistics {
+    unsigned nHits;      // loads served from KdPostResToAsynchronousLoad resources
+    unsigned nMisses;    // loads that had to go to the callback or the file system
+    unsigned nEvictions; // copied resources dropped to stay within the byte budget
+    unsigned nEntries;   // resources currently waiting to be loaded
+    size_t nBytesHeld;   // bytes of copied resources currently held
+} KdResourceStoreStatistics;
+
+// Callbacks of a higher priority run before any waiting callback of a lower
+// one; within a priority they run in the order they were posted.
+enum KdMainThreadPriority {
+    KDMainThreadInputPriority,
+    KDMainThreadPaintPriority,
+    KDMainThreadLoadingPriority,
+    KDMainThreadIdlePriority,
+    KDMainThreadPriorityCount
+};
+// __cdecl, as WebCore's own main thread functions are, so that posting does
+// not need to wrap the callback.
+typedef void (__cdecl* PFN_KdMainThreadCallback) (void* pContext);
+
+typedef struct _KdMainThreadQueueLaneStatistics {
+    unsigned nMaximumDepth;     // most callbacks seen waiting at once
+    unsigned nDispatched;       // callbacks run
+    unsigned nTimed;            // callbacks run that were posted with timing on
+    double dTotalTimeInQueue;   // seconds the timed callbacks waited, in all
+    double dMaximumTimeInQueue; // longest a timed callback waited, in seconds
+} KdMainThreadQueueLaneStatistics;
+
+typedef struct _KdMainThreadQueueStatistics {
+    unsigned nDepth; // callbacks waiting now, over all priorities
+    KdMainThreadQueueLaneStatistics lanes[KDMainThreadPriorityCount]; // by KdMainThreadPriority
+} KdMainThreadQueueStatistics;
+
+enum { KDGCPauseBucketCount = 10 };
+
+typedef struct _KdGCPauseStatistics {
+    unsigned nCollections;
+    unsigned nPauses[KDGCPauseBucketCount]; // [i] counts pauses shorter than 2^i ms; the last counts the rest
+    double dTotalPauseTime;   // seconds spent collecting, in all
+    double dTotalMarkTime;    // seconds of that spent marking
+    double dMaximumPauseTime; // longest pause, in seconds
+} KdGCPauseStatistics;
+
+typedef struct _KdScriptCompilationStatistics {
+    unsigned nCompilations;
+    double dParseTime;       // seconds
+    double dBytecodeTime;    // seconds
+    double dMachineCodeTime; // seconds, including the baseline JIT
+} KdScriptCompilationStatistics;
+
+typedef struct _KdRegExpCacheStatistics {
+    unsigned nHits;
+    unsigned nMisses;        // including patterns too large to cache
+    unsigned nEvictions;
+    double dCompileTime;     // seconds spent compiling on misses
+    unsigned nEntries;       // patterns cached now
+    size_t nCachedBytes;     // bytes they hold now
+    size_t nCapacity;        // see KdSetRegExpCacheCapacity
+} KdRegExpCacheStatistics;
+
 KDEXPORT KdGuiObjPtr KDCALL KdCreateGuiObj(void* pForeignPtr);
 
 KDEXPORT KdPagePtr KDCALL KdCreateRealWndAttachedWebPage(
@@ -95,6 +163,21 @@ KDEXPORT KdPagePtr KDCALL KdCreateRealWndAttachedWebPage(
     bool bShow
     );
 
+KDEXPORT KdPagePtr KDCALL KdCreateHeadlessWebPage(
+    KdGuiObjPtr kdHandle,
+    int nWidth,
+    int nHeight,
+    void* pForeignPtr
+    );
+
+// Headless pages are driven by the calling thread's run loop. KdRunLoop()
+// dispatches window messages too and returns after WM_QUIT or KdQuitRunLoop();
+// hosts with their own message loop call KdRunLoopIterate() instead, which
+// waits at most nTimeoutMs (-1 waits forever) and returns false once stopped.
+KDEXPORT void KDCALL KdRunLoop();
+KDEXPORT bool KDCALL KdRunLoopIterate(int nTimeoutMs);
+KDEXPORT void KDCALL KdQuitRunLoop();
+
 KDEXPORT HWND KDCALL KdGetHWNDFromPagePtr(KdPagePtr kdPage);
 
 KDEXPORT void KDCALL
@@ -106,7 +189,15 @@ KdCloseRealWndAttachedWebPage(
 KDEXPORT bool KDCALL KdLoadPageFormUrl(KdPagePtr kdPageHandle, LPCWSTR lpUrl);
 KDEXPORT bool KDCALL KdLoadPageFormData(KdPagePtr kdPageHandle, const void* lpData, int nLen);
 
+// With bNeedSavaRes false the buffer is used in place and must stay valid until
+// the resource has finished loading.
 KDEXPORT void KDCALL KdPostResToAsynchronousLoad(KdPagePtr kdPageHandle, const WCHAR* pUrl, void* pResBuf, int nResBufLen, bool bNeedSavaRes);
+KDEXPORT void KDCALL KdSetResourceStoreBudget(KdPagePtr kdPageHandle, size_t nByteBudget);
+KDEXPORT void KDCALL KdGetResourceStoreStatistics(KdPagePtr kdPageHandle, KdResourceStoreStatistics* pStatistics);
+// Serves URLs starting with lpUrlPrefix from a .kdpk package built by kdpack,
+// e.g. lpUrlPrefix L"res:///skin/" and entry "main.xml". Packages are checked
+// in mount order after posted resources and before PFN_KdResCallback.
+KDEXPORT bool KDCALL KdMountResourcePackage(KdPagePtr kdPageHandle, LPCWSTR lpPackagePath, LPCWSTR lpUrlPrefix);
 
 KDEXPORT void KDCALL KdRegisterXMLOnRealy(KdPagePtr kdPageHandle, PFN_KdPageCallback pCallBack);
 KDEXPORT void KDCALL KdRegisterUninit(KdPagePtr kdPageHandle, PFN_KdPageCallback pCallBack);
@@ -134,10 +225,66 @@ KDEXPORT void KDCALL KdIsDraggableRegionNcHitTest(KdPagePtr kdPageHandle);
 KDEXPORT void KDCALL KdInitThread();
 KDEXPORT void KDCALL KdUninitThread();
 
+// Runs pCallBack(pContext) on the thread that called KdInitThread(), the same
+// queue WebCore's database, icon and loader threads post to. Any thread may
+// call it; posting takes no lock. Input from a hook or device thread should
+// use KDMainThreadInputPriority so it is not stuck behind loading work.
+KDEXPORT void KDCALL KdPostToMainThread(PFN_KdMainThreadCallback pCallBack, void* pContext, KdMainThreadPriority emPriority);
+// Times in queue are only kept while timing is on, as it costs a clock read on
+// every post. The statistics calls must be made on the main thread.
+KDEXPORT void KDCALL KdSetMainThreadQueueTiming(bool bEnabled);
+KDEXPORT void KDCALL KdGetMainThreadQueueStatistics(KdMainThreadQueueStatistics* pStatistics);
+KDEXPORT void KDCALL KdResetMainThreadQueueStatistics();
+// Keeps the parser's function cache for each external script in lpDirectory,
+// so scripts seen in an earlier run skip most of their first parse. Pass NULL
+// or an empty string to stop using the cache. Call after KdInitThread().
+KDEXPORT void KDCALL KdSetScriptCacheDirectory(LPCWSTR lpDirectory);
+
+// Samples the script running on this thread every nIntervalMs milliseconds
+// until stopped. Samples accumulate across start and stop until cleared.
+// KdGetScriptProfile copies them as folded stacks, one "outer;inner count"
+// line per distinct stack as flame graph tools read them, and returns the
+// number of characters the whole text needs including the terminating null;
+// pass a NULL buffer to ask for the size.
+KDEXPORT void KDCALL KdStartScriptProfiler(unsigned nIntervalMs);
+KDEXPORT void KDCALL KdStopScriptProfiler();
+KDEXPORT void KDCALL KdClearScriptProfile();
+KDEXPORT int KDCALL KdGetScriptProfile(WCHAR* pBuffer, int nBufferLength);
+
+// Counts accesses at the property sites whose inline caches have given up,
+// one "url:line get|put name accesses misses" line per site, busiest first.
+// Returns the length like KdGetScriptProfile. The text is empty in builds
+// without JIT property access caching, which the cache sits behind.
+KDEXPORT int KDCALL KdGetPropertyCacheStatistics(WCHAR* pBuffer, int nBufferLength);
+KDEXPORT void KDCALL KdResetPropertyCacheStatistics();
+
+// Extra threads that help mark during a garbage collection. 0, the default,
+// marks on the collecting thread alone. Call after KdInitThread(), on that
+// thread; it takes effect at the next collection.
+KDEXPORT void KDCALL KdSetGCMarkingHelperThreadCount(unsigned nCount);
+KDEXPORT unsigned KDCALL KdGetGCMarkingHelperThreadCount();
+// Pause times of every collection of the script heap since the last reset.
+KDEXPORT void KDCALL KdGetGCPauseStatistics(KdGCPauseStatistics* pStatistics);
+KDEXPORT void KDCALL KdResetGCPauseStatistics();
+// Time spent compiling scripts on the thread that runs them, since the last
+// reset. Compilations that stop at a syntax error are not counted.
+KDEXPORT void KDCALL KdGetScriptCompilationStatistics(KdScriptCompilationStatistics* pStatistics);
+KDEXPORT void KDCALL KdResetScriptCompilationStatistics();
+// Compiled regular expressions are cached up to a number of bytes, 2MB by
+// default, least recently used first out. A smaller capacity evicts at once;
+// 0 turns the cache off. No single pattern may take more than 1/16 of it.
+KDEXPORT void KDCALL KdSetRegExpCacheCapacity(size_t nBytes);
+KDEXPORT void KDCALL KdGetRegExpCacheStatistics(KdRegExpCacheStatistics* pStatistics);
+// Clears the counters; the cached patterns stay.
+KDEXPORT void KDCALL KdResetRegExpCacheStatistics();
+
 KDEXPORT void KDCALL KdSetBackgroundColor(KdPagePtr kdPageHandle, COLORREF c);
 
 KDEXPORT void KDCALL KdShowDebugNodeData(KdPagePtr kdPageHandle);
 
+KDEXPORT void KDCALL KdSetDirtyRegionPolicy(KdPagePtr kdPageHandle, int nMaxRects, int nTileSize);
+KDEXPORT void KDCALL KdGetPaintStatistics(KdPagePtr kdPageHandle, KdPaintStatistics* pStatistics);
+
 KDEXPORT bool KDCALL KdInvokeScript(KdPagePtr kdPageHandle, NPIdentifier methodName, const NPVariant* args, uint32_t argCount, NPVariant* result);
 
 //////////////////////////////////////////////////////////////////////////
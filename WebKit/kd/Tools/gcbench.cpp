@@ -0,0 +1,124 @@
+// gcbench: times scripts that churn through short-lived objects on top of a
+// large live heap, and reports what the collector did meanwhile.
+//
+//   gcbench [live objects] [events]
+//
+// The script first builds a tree of live objects (200,000 by default) that
+// stays reachable for the whole run, as a page's DOM wrappers and state do.
+// It then handles the given number of events (20,000 by default). Each one
+// builds and joins a few dozen strings and creates and calls closures that
+// read their arguments object; none of that survives the event.
+//
+// Every collection marks the whole heap, live tree included, so the cost of
+// the churn is mostly in how often the heap collects. Each of 3 runs prints
+// its time, the number of collections, and their total, longest and marking
+// time from the heap's pause histogram. The live tree is checked after every
+// run; a damaged tree is printed and makes the exit status non-zero.
+//
+// Build it against JavaScriptCore.
+
+#include "config.h"
+
+#include "APICast.h"
+#include "Heap.h"
+#include "JSContextRef.h"
+#include "JSGlobalData.h"
+#include "JSStringRef.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/StringExtras.h>
+
+using namespace JSC;
+
+static const char* setupScript =
+    "var live = [];\n"
+    "function build(count) {\n"
+    "    for (var i = 0; i < count; ++i)\n"
+    "        live.push({ id: i, name: 'node' + i, parent: i ? live[(i - 1) >> 1] : null, children: [] });\n"
+    "    for (var i = 1; i < count; ++i)\n"
+    "        live[i].parent.children.push(live[i]);\n"
+    "}\n"
+    "function handleEvent(e) {\n"
+    "    var parts = [];\n"
+    "    for (var i = 0; i < 40; ++i)\n"
+    "        parts.push('item-' + e + '-' + i);\n"
+    "    var text = parts.join(',');\n"
+    "    var handlers = [];\n"
+    "    for (var i = 0; i < 20; ++i)\n"
+    "        handlers.push(function(x) { return x + arguments.length; });\n"
+    "    var sum = 0;\n"
+    "    for (var i = 0; i < handlers.length; ++i)\n"
+    "        sum += handlers[i](i, e);\n"
+    "    return text.length + sum;\n"
+    "}\n"
+    "function handleEvents(count) {\n"
+    "    var total = 0;\n"
+    "    for (var e = 0; e < count; ++e)\n"
+    "        total += handleEvent(e);\n"
+    "    return total;\n"
+    "}\n"
+    "function checkLive() {\n"
+    "    for (var i = 0; i < live.length; ++i) {\n"
+    "        var node = live[i];\n"
+    "        if (node.id !== i || node.name !== 'node' + i)\n"
+    "            return false;\n"
+    "        if (i && node.parent !== live[(i - 1) >> 1])\n"
+    "            return false;\n"
+    "        for (var j = 0; j < node.children.length; ++j) {\n"
+    "            if (node.children[j].parent !== node)\n"
+    "                return false;\n"
+    "        }\n"
+    "    }\n"
+    "    return true;\n"
+    "}\n";
+
+static JSValueRef evaluate(JSGlobalContextRef context, const char* script)
+{
+    JSStringRef source = JSStringCreateWithUTF8CString(script);
+    JSValueRef exception = 0;
+    JSValueRef result = JSEvaluateScript(context, source, 0, 0, 1, &exception);
+    JSStringRelease(source);
+    if (exception) {
+        printf("exception in: %s\n", script);
+        exit(1);
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned liveObjects = argc > 1 ? strtoul(argv[1], 0, 10) : 200000;
+    unsigned events = argc > 2 ? strtoul(argv[2], 0, 10) : 20000;
+
+    JSGlobalContextRef context = JSGlobalContextCreate(0);
+    Heap& heap = toJS(context)->globalData().heap;
+
+    char script[64];
+    evaluate(context, setupScript);
+    snprintf(script, sizeof(script), "build(%u)", liveObjects);
+    evaluate(context, script);
+    snprintf(script, sizeof(script), "handleEvents(%u)", events);
+
+    printf("%u live objects, %u events\n", liveObjects, events);
+    bool damaged = false;
+    for (int run = 0; run < 3; ++run) {
+        heap.resetPauseHistogram();
+        double start = currentTime();
+        evaluate(context, script);
+        double elapsed = currentTime() - start;
+
+        const GCPauseHistogram& histogram = heap.pauseHistogram();
+        printf("run %d: %8.1fms, %4u collections, pauses %8.1fms total, %6.1fms longest, %8.1fms marking\n",
+            run, elapsed * 1000, histogram.collectionCount, histogram.totalPauseTime * 1000,
+            histogram.maxPauseTime * 1000, histogram.totalMarkTime * 1000);
+
+        if (!JSValueToBoolean(context, evaluate(context, "checkLive()"))) {
+            printf("DAMAGED: the live tree changed during run %d\n", run);
+            damaged = true;
+        }
+    }
+
+    JSGlobalContextRelease(context);
+    return damaged ? 1 : 0;
+}
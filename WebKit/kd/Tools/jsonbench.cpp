@@ -0,0 +1,451 @@
+// jsonbench: times JSON.parse and JSON.stringify over documents of different
+// shapes and checks what they build.
+//
+//   jsonbench [cases]
+//
+// Each document is parsed 5 times and the best time is printed with the
+// throughput. The documents are
+// - 20,000 records that share their keys, which the parser's shape cache
+//   turns into one Structure;
+// - 20,000 records cycling through 12 key orders, more than the shape cache
+//   holds;
+// - 20,000 records that repeat a key, which the shape cache leaves alone;
+// - one object with 50,000 distinct keys, which misses the parser's table of
+//   recent identifiers;
+// - 200,000 numbers, and 50,000 strings with and without escapes.
+//
+// Every document is checked by turning the result back into text and
+// comparing it with the text it was made from, after a collection. The
+// records are also checked to share no properties: a property added to one
+// must not show up in the next.
+//
+// The values parsed are then turned back into text, best of 5 again, and each
+// text must match the document. The records are also timed with the capacity
+// hint dropped before each run, which is what a first large call costs. The
+// hint must follow a large result, drop after a small one and stay within
+// 16MB. Objects other than plain ones (Math, an Error, a constructed object,
+// one with a prototype) and replacers that add a property to an object of
+// the same shape, or to a dictionary one, before it is written are checked against a reference
+// stringifier written in script.
+//
+// The given number of random documents (5,000 by default) are then parsed.
+// They mix nesting, repeated and non-ASCII keys, escapes and numbers of every
+// form. Each result is compared with a value built directly, in the same
+// order, from the same pieces. Each value is also stringified and compared
+// with the reference, then every object in a copy loses its first property
+// and gains another and the value is compared again, so that property names
+// remembered for the old shapes would show. Any mismatch is printed and
+// makes the exit status non-zero.
+//
+// Build it against JavaScriptCore.
+
+#include "config.h"
+
+#include "APICast.h"
+#include "JSContextRef.h"
+#include "JSGlobalData.h"
+#include "JSStringRef.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/StringExtras.h>
+
+static const char* setupScript =
+    "var seed = 7;\n"
+    "function random(limit) {\n"
+    "    seed = (seed * 1103515245 + 12345) % 2147483648;\n"
+    "    return (seed >> 8) % limit;\n"
+    "}\n"
+    "var keyNames = ['id', 'name', 'email', 'active', 'score', 'tags', 'created', 'owner', 'size', 'kind', 'parent', 'path'];\n"
+    "function record(i, keys) {\n"
+    "    var r = {};\n"
+    "    for (var k = 0; k < keys.length; ++k) {\n"
+    "        switch (keys[k]) {\n"
+    "        case 'id': r.id = i; break;\n"
+    "        case 'name': r.name = 'user' + i; break;\n"
+    "        case 'email': r.email = 'user' + i + '@example.com'; break;\n"
+    "        case 'active': r.active = !(i % 3); break;\n"
+    "        case 'score': r.score = i * 1.25; break;\n"
+    "        case 'tags': r.tags = ['a' + (i % 5), 'b' + (i % 7)]; break;\n"
+    "        case 'created': r.created = 1300000000 + i; break;\n"
+    "        case 'owner': r.owner = { id: i % 100, name: 'owner' + (i % 100) }; break;\n"
+    "        case 'size': r.size = i % 4096; break;\n"
+    "        case 'kind': r.kind = i % 2 ? 'file' : 'folder'; break;\n"
+    "        case 'parent': r.parent = i ? i - 1 : null; break;\n"
+    "        case 'path': r.path = '/home/user' + i + '/docs'; break;\n"
+    "        }\n"
+    "    }\n"
+    "    return r;\n"
+    "}\n"
+    "function rotate(keys, by) { return keys.slice(by).concat(keys.slice(0, by)); }\n"
+    "var documents = {};\n"
+    "function makeDocuments() {\n"
+    "    var records = [];\n"
+    "    for (var i = 0; i < 20000; ++i)\n"
+    "        records.push(record(i, keyNames));\n"
+    "    documents.records = JSON.stringify(records);\n"
+    "\n"
+    "    records = [];\n"
+    "    for (var i = 0; i < 20000; ++i)\n"
+    "        records.push(record(i, rotate(keyNames, i % 12)));\n"
+    "    documents.shapes = JSON.stringify(records);\n"
+    "\n"
+    "    // The repeated key keeps its first place and its last value.\n"
+    "    var parts = [];\n"
+    "    for (var i = 0; i < 20000; ++i)\n"
+    "        parts.push('{\"id\":' + i + ',\"name\":\"user' + i + '\",\"id\":' + (i + 1) + '}');\n"
+    "    documents.duplicates = '[' + parts.join(',') + ']';\n"
+    "\n"
+    "    var wide = {};\n"
+    "    for (var i = 0; i < 50000; ++i)\n"
+    "        wide['key' + i] = i;\n"
+    "    documents.wide = JSON.stringify(wide);\n"
+    "\n"
+    "    var numbers = [];\n"
+    "    for (var i = 0; i < 200000; ++i)\n"
+    "        numbers.push(i % 3 ? random(1000000000) : random(1000000) / 64 - 5000);\n"
+    "    documents.numbers = JSON.stringify(numbers);\n"
+    "\n"
+    "    var strings = [];\n"
+    "    for (var i = 0; i < 50000; ++i)\n"
+    "        strings.push('a plain string, number ' + i);\n"
+    "    documents.strings = JSON.stringify(strings);\n"
+    "\n"
+    "    strings = [];\n"
+    "    for (var i = 0; i < 50000; ++i)\n"
+    "        strings.push('line ' + i + '\\n\\t\"quoted\" \\\\ \\u00e9\\u4e2d');\n"
+    "    documents.escapes = JSON.stringify(strings);\n"
+    "}\n"
+    "function expectedText(name) {\n"
+    "    if (name != 'duplicates')\n"
+    "        return documents[name];\n"
+    "    var parts = [];\n"
+    "    for (var i = 0; i < 20000; ++i)\n"
+    "        parts.push('{\"id\":' + (i + 1) + ',\"name\":\"user' + i + '\"}');\n"
+    "    return '[' + parts.join(',') + ']';\n"
+    "}\n"
+    "var result;\n"
+    "function parseDocument(name) { result = JSON.parse(documents[name]); }\n"
+    "function checkDocument(name) { return JSON.stringify(result) === expectedText(name); }\n"
+    "var parsed = {};\n"
+    "function parseAll() {\n"
+    "    for (var name in documents)\n"
+    "        parsed[name] = JSON.parse(documents[name]);\n"
+    "}\n"
+    "var text;\n"
+    "function stringifyDocument(name) { text = JSON.stringify(parsed[name]); }\n"
+    "function checkStringified(name) { return text === expectedText(name); }\n"
+    "function stringifyLarge(copies) {\n"
+    "    var records = [];\n"
+    "    for (var i = 0; i < copies; ++i)\n"
+    "        records.push(parsed.records);\n"
+    "    return JSON.stringify(records).length;\n"
+    "}\n"
+    "function checkRecordsIndependent() {\n"
+    "    result[0].extra = 1;\n"
+    "    delete result[2].name;\n"
+    "    return result[1].extra === undefined && result[1].name === 'user1' && result[3].name === 'user3'\n"
+    "        && result[2].name === undefined && result[2].id === 2;\n"
+    "}\n"
+    "\n"
+    "// A random document as text, and the value it should parse to, built from\n"
+    "// the same pieces in the same order.\n"
+    "var caseKeys = ['a', 'b', 'ab', 'ba', 'key', 'k\\u00e9y', '\\u4e2d', '', 'a b', 'q\"t', 'x\\ny', '0', '10'];\n"
+    "var caseStrings = ['', 'plain', 'tab\\there', 'quote\"', 'back\\\\slash', '\\u00e9t\\u00e9', '\\u4e2d\\u6587', '\\u0001', '/'];\n"
+    "var caseNumbers = ['0', '-0', '7', '-12', '123456789', '1234567890', '99999999999', '0.5', '-3.25', '1e5', '2E-3', '1.5e+10', '4294967295', '4294967296'];\n"
+    "function quote(s) { return JSON.stringify(s); }\n"
+    "function randomValue(depth) {\n"
+    "    var kind = random(depth > 3 ? 5 : 7);\n"
+    "    switch (kind) {\n"
+    "    case 0: return ['null', null];\n"
+    "    case 1: return random(2) ? ['true', true] : ['false', false];\n"
+    "    case 2: var n = caseNumbers[random(caseNumbers.length)]; return [n, Number(n)];\n"
+    "    case 3: case 4: var s = caseStrings[random(caseStrings.length)]; return [quote(s), s];\n"
+    "    case 5:\n"
+    "        var count = random(6), texts = [], values = [];\n"
+    "        for (var i = 0; i < count; ++i) {\n"
+    "            var element = randomValue(depth + 1);\n"
+    "            texts.push(element[0]);\n"
+    "            values.push(element[1]);\n"
+    "        }\n"
+    "        return ['[' + texts.join(',') + ']', values];\n"
+    "    default:\n"
+    "        var count = random(12), texts = [], object = {};\n"
+    "        for (var i = 0; i < count; ++i) {\n"
+    "            var key = caseKeys[random(caseKeys.length)];\n"
+    "            var member = randomValue(depth + 1);\n"
+    "            texts.push(quote(key) + ':' + member[0]);\n"
+    "            object[key] = member[1];\n"
+    "        }\n"
+    "        return ['{' + texts.join(',') + '}', object];\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "// What JSON.stringify should produce, written out plainly.\n"
+    "function referenceQuote(string) {\n"
+    "    var out = '\"';\n"
+    "    for (var i = 0; i < string.length; ++i) {\n"
+    "        var c = string.charAt(i);\n"
+    "        var code = string.charCodeAt(i);\n"
+    "        if (c == '\"' || c == '\\\\')\n"
+    "            out += '\\\\' + c;\n"
+    "        else if (c == '\\b')\n"
+    "            out += '\\\\b';\n"
+    "        else if (c == '\\f')\n"
+    "            out += '\\\\f';\n"
+    "        else if (c == '\\n')\n"
+    "            out += '\\\\n';\n"
+    "        else if (c == '\\r')\n"
+    "            out += '\\\\r';\n"
+    "        else if (c == '\\t')\n"
+    "            out += '\\\\t';\n"
+    "        else if (code < 0x20)\n"
+    "            out += '\\\\u00' + (code < 0x10 ? '0' : '') + code.toString(16);\n"
+    "        else\n"
+    "            out += c;\n"
+    "    }\n"
+    "    return out + '\"';\n"
+    "}\n"
+    "function referenceStringify(value) {\n"
+    "    if (value === null)\n"
+    "        return 'null';\n"
+    "    switch (typeof value) {\n"
+    "    case 'boolean': return String(value);\n"
+    "    case 'number': return isFinite(value) ? String(value) : 'null';\n"
+    "    case 'string': return referenceQuote(value);\n"
+    "    }\n"
+    "    var parts = [];\n"
+    "    if (value instanceof Array) {\n"
+    "        for (var i = 0; i < value.length; ++i)\n"
+    "            parts.push(referenceStringify(value[i]));\n"
+    "        return '[' + parts.join(',') + ']';\n"
+    "    }\n"
+    "    for (var key in value) {\n"
+    "        if (value.hasOwnProperty(key))\n"
+    "            parts.push(referenceQuote(key) + ':' + referenceStringify(value[key]));\n"
+    "    }\n"
+    "    return '{' + parts.join(',') + '}';\n"
+    "}\n"
+    "// Deletes the first property of every object and adds another, so that\n"
+    "// objects stringified before with one Structure now have another.\n"
+    "function reshape(value) {\n"
+    "    if (value === null || typeof value != 'object')\n"
+    "        return;\n"
+    "    if (value instanceof Array) {\n"
+    "        for (var i = 0; i < value.length; ++i)\n"
+    "            reshape(value[i]);\n"
+    "        return;\n"
+    "    }\n"
+    "    var first;\n"
+    "    for (var key in value) {\n"
+    "        if (first === undefined)\n"
+    "            first = key;\n"
+    "        reshape(value[key]);\n"
+    "    }\n"
+    "    if (first !== undefined)\n"
+    "        delete value[first];\n"
+    "    value.late = random(2) ? 'added' : 1;\n"
+    "}\n"
+    "function Point(x, y) { this.x = x; this.y = y; }\n"
+    "// Objects that are not plain ones, and a replacer that changes an object\n"
+    "// with the same Structure as the one being written before it is reached.\n"
+    "function checkUnusualObjects() {\n"
+    "    var values = [Math, new Error('message'), new Point(1, 2), Object.create({ inherited: 1 }), new Point('a', 'b'), [1, 'two']];\n"
+    "    if (JSON.stringify(values) !== referenceStringify(values))\n"
+    "        return false;\n"
+    "    var a = { p: 1, q: 2 };\n"
+    "    var b = { p: 3, q: 4 };\n"
+    "    var replaced = JSON.stringify([a, b], function(key, value) {\n"
+    "        if (key == '0')\n"
+    "            b.extra = 5;\n"
+    "        return value;\n"
+    "    });\n"
+    "    if (replaced !== referenceStringify([a, b]))\n"
+    "        return false;\n"
+    "    // Array indices reach the replacer as numbers here, hence ==.\n"
+    "    // Deleting a property makes c's Structure a dictionary, which then\n"
+    "    // changes in place when the replacer adds to it.\n"
+    "    var c = { p: 1, q: 2, r: 3 };\n"
+    "    delete c.r;\n"
+    "    var first = JSON.stringify(c);\n"
+    "    replaced = JSON.stringify([c, c], function(key, value) {\n"
+    "        if (key == '1')\n"
+    "            c.extra = 4;\n"
+    "        return value;\n"
+    "    });\n"
+    "    return replaced === '[' + first + ',' + referenceStringify(c) + ']';\n"
+    "}\n"
+    "\n"
+    "// Returns '' when the case matches, what failed and the document otherwise.\n"
+    "function runCase() {\n"
+    "    var document = randomValue(0);\n"
+    "    // Several copies of the same document exercise the shape cache.\n"
+    "    var text = '[' + document[0] + ',' + document[0] + ',' + document[0] + ']';\n"
+    "    var expected = JSON.stringify([document[1], document[1], document[1]]);\n"
+    "    if (JSON.stringify(JSON.parse(text)) !== expected)\n"
+    "        return 'parse ' + text;\n"
+    "\n"
+    "    var value = [document[1], JSON.parse(document[0]), JSON.parse(document[0])];\n"
+    "    if (JSON.stringify(value) !== referenceStringify(value))\n"
+    "        return 'stringify ' + text;\n"
+    "    reshape(value[1]);\n"
+    "    if (JSON.stringify(value) !== referenceStringify(value))\n"
+    "        return 'stringify after a change ' + text;\n"
+    "    return '';\n"
+    "}\n";
+
+static JSGlobalContextRef context;
+static unsigned mismatches;
+
+static JSValueRef evaluate(const char* script)
+{
+    JSStringRef source = JSStringCreateWithUTF8CString(script);
+    JSValueRef exception = 0;
+    JSValueRef result = JSEvaluateScript(context, source, 0, 0, 1, &exception);
+    JSStringRelease(source);
+    if (exception) {
+        printf("exception in: %s\n", script);
+        exit(1);
+    }
+    return result;
+}
+
+static void check(bool matches, const char* what)
+{
+    if (matches)
+        return;
+    if (++mismatches <= 20)
+        printf("MISMATCH: %s\n", what);
+}
+
+struct Document {
+    const char* name;
+    const char* description;
+};
+
+static const Document documents[] = {
+    { "records", "records, one shape" },
+    { "shapes", "records, 12 shapes" },
+    { "duplicates", "records, repeated key" },
+    { "wide", "50,000 distinct keys" },
+    { "numbers", "numbers" },
+    { "strings", "strings" },
+    { "escapes", "strings with escapes" },
+};
+
+static void runBenchmark()
+{
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(documents); ++i) {
+        char script[128];
+        snprintf(script, sizeof(script), "documents.%s.length", documents[i].name);
+        double length = JSValueToNumber(context, evaluate(script), 0);
+
+        // Best of 5 runs, in milliseconds.
+        snprintf(script, sizeof(script), "parseDocument('%s')", documents[i].name);
+        double best = 0;
+        for (int run = 0; run < 5; ++run) {
+            double start = currentTime();
+            evaluate(script);
+            double elapsed = (currentTime() - start) * 1000;
+            if (!run || elapsed < best)
+                best = elapsed;
+        }
+        printf("%-24s %6.2fMB %8.1fms %7.1fMB/s\n", documents[i].description, length / (1024 * 1024), best, length / (1024 * 1024) / (best / 1000));
+
+        JSGarbageCollect(context);
+        snprintf(script, sizeof(script), "checkDocument('%s')", documents[i].name);
+        check(JSValueToBoolean(context, evaluate(script)), documents[i].description);
+        if (i < 2)
+            check(JSValueToBoolean(context, evaluate("checkRecordsIndependent()")), "records share no properties");
+    }
+}
+
+// Best of 5 runs, in milliseconds. A reset stringifies '{}' first, so that
+// every run starts without a capacity hint.
+static double timeStringify(const char* name, bool reset)
+{
+    char script[128];
+    snprintf(script, sizeof(script), "stringifyDocument('%s')", name);
+    double best = 0;
+    for (int run = 0; run < 5; ++run) {
+        if (reset)
+            evaluate("JSON.stringify({})");
+        double start = currentTime();
+        evaluate(script);
+        double elapsed = (currentTime() - start) * 1000;
+        if (!run || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static void runStringifyBenchmark()
+{
+    evaluate("parseAll()");
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(documents); ++i) {
+        char script[128];
+        snprintf(script, sizeof(script), "documents.%s.length", documents[i].name);
+        double length = JSValueToNumber(context, evaluate(script), 0);
+        double best = timeStringify(documents[i].name, false);
+        printf("%-24s %6.2fMB %8.1fms %7.1fMB/s\n", documents[i].description, length / (1024 * 1024), best, length / (1024 * 1024) / (best / 1000));
+
+        snprintf(script, sizeof(script), "checkStringified('%s')", documents[i].name);
+        check(JSValueToBoolean(context, evaluate(script)), documents[i].description);
+    }
+
+    double length = JSValueToNumber(context, evaluate("documents.records.length"), 0);
+    double best = timeStringify("records", true);
+    printf("%-24s %6.2fMB %8.1fms %7.1fMB/s\n", "records, no hint", length / (1024 * 1024), best, length / (1024 * 1024) / (best / 1000));
+    check(JSValueToBoolean(context, evaluate("checkUnusualObjects()")), "objects that are not plain ones");
+}
+
+// The hint is the length of the last large result, capped at 16MB, and
+// nothing after a small one.
+static void checkCapacityHint()
+{
+    unsigned& hint = toJS(context)->globalData().jsonStringifyCapacityHint;
+    double length = JSValueToNumber(context, evaluate("stringifyLarge(1)"), 0);
+    check(hint == length, "the capacity hint follows a large result");
+    evaluate("JSON.stringify({})");
+    check(!hint, "a small result drops the capacity hint");
+    length = JSValueToNumber(context, evaluate("stringifyLarge(4)"), 0);
+    check(length > 16 * 1024 * 1024 && hint == 16 * 1024 * 1024, "the capacity hint is capped at 16MB");
+    evaluate("stringifyLarge(1)");
+    check(hint < 16 * 1024 * 1024, "the capacity hint comes down after one smaller result");
+}
+
+static void runCases(unsigned count)
+{
+    for (unsigned testCase = 0; testCase < count; ++testCase) {
+        JSStringRef text = JSValueToStringCopy(context, evaluate("runCase()"), 0);
+        if (JSStringGetLength(text)) {
+            char document[512];
+            JSStringGetUTF8CString(text, document, sizeof(document));
+            char what[600];
+            snprintf(what, sizeof(what), "case %u: %s", testCase, document);
+            check(false, what);
+        }
+        JSStringRelease(text);
+    }
+    printf("%u cases, %u mismatches\n", count, mismatches);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned cases = argc > 1 ? strtoul(argv[1], 0, 10) : 5000;
+
+    context = JSGlobalContextCreate(0);
+    evaluate(setupScript);
+    evaluate("makeDocuments()");
+
+    printf("JSON.parse\n");
+    runBenchmark();
+    printf("JSON.stringify\n");
+    runStringifyBenchmark();
+    checkCapacityHint();
+    runCases(cases);
+
+    JSGlobalContextRelease(context);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+// kdpack: builds a .kdpk resource package from a directory tree.
+//
+//   kdpack [-0] <source directory> <output.kdpk>
+//
+// Every file under the source directory becomes one entry named by its path
+// relative to that directory, with '/' separators. Entries are zlib
+// compressed when that saves at least an eighth of their size; -0 stores
+// everything so the whole package can be served straight from the mapping.
+//
+// Link against the zlib in KdToolCore/zlib. See KResourcePackageFormat.h for
+// the layout.
+
+#include "../Api/KResourcePackageFormat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+struct SourceFile {
+    std::string name; // UTF-8, '/' separated, relative to the source directory
+    std::string path; // as passed to fopen()
+};
+
+static bool operator<(const SourceFile& a, const SourceFile& b)
+{
+    return a.name < b.name;
+}
+
+#ifdef _WIN32
+static std::string toUTF8(const wchar_t* text)
+{
+    int length = WideCharToMultiByte(CP_UTF8, 0, text, -1, 0, 0, 0, 0);
+    if (length <= 1)
+        return std::string();
+    std::string result(length - 1, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, text, -1, &result[0], length, 0, 0);
+    return result;
+}
+
+static std::wstring toWide(const std::string& text)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, 0, 0);
+    if (length <= 1)
+        return std::wstring();
+    std::wstring result(length - 1, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &result[0], length);
+    return result;
+}
+
+static void collectFiles(const std::wstring& directory, const std::string& prefix, std::vector<SourceFile>& files)
+{
+    WIN32_FIND_DATAW findData;
+    HANDLE find = FindFirstFileW((directory + L"\\*").c_str(), &findData);
+    if (INVALID_HANDLE_VALUE == find)
+        return;
+
+    do {
+        if (!wcscmp(findData.cFileName, L".") || !wcscmp(findData.cFileName, L".."))
+            continue;
+
+        std::wstring path = directory + L"\\" + findData.cFileName;
+        std::string name = prefix + toUTF8(findData.cFileName);
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            collectFiles(path, name + "/", files);
+        else {
+            SourceFile file;
+            file.name = name;
+            file.path = toUTF8(path.c_str());
+            files.push_back(file);
+        }
+    } while (FindNextFileW(find, &findData));
+
+    FindClose(find);
+}
+
+static FILE* openFile(const std::string& path, const wchar_t* mode)
+{
+    return _wfopen(toWide(path).c_str(), mode);
+}
+#else
+static void collectFiles(const std::string& directory, const std::string& prefix, std::vector<SourceFile>& files)
+{
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        return;
+
+    while (struct dirent* entry = readdir(dir)) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+
+        std::string path = directory + "/" + entry->d_name;
+        std::string name = prefix + entry->d_name;
+        struct stat fileStat;
+        if (stat(path.c_str(), &fileStat))
+            continue;
+        if (S_ISDIR(fileStat.st_mode))
+            collectFiles(path, name + "/", files);
+        else if (S_ISREG(fileStat.st_mode)) {
+            SourceFile file;
+            file.name = name;
+            file.path = path;
+            files.push_back(file);
+        }
+    }
+
+    closedir(dir);
+}
+
+static FILE* openFile(const std::string& path, const wchar_t* mode)
+{
+    return fopen(path.c_str(), wcscmp(mode, L"rb") ? "wb" : "rb");
+}
+#endif
+
+static bool readFile(const std::string& path, std::vector<unsigned char>& data)
+{
+    FILE* file = openFile(path, L"rb");
+    if (!file)
+        return false;
+
+    data.clear();
+    unsigned char buffer[64 * 1024];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + count);
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+static void writeLittleEndian(unsigned char* out, unsigned int value)
+{
+    out[0] = value & 0xff;
+    out[1] = (value >> 8) & 0xff;
+    out[2] = (value >> 16) & 0xff;
+    out[3] = (value >> 24) & 0xff;
+}
+
+static void appendHeaderOrEntry(std::vector<unsigned char>& out, const unsigned int* fields, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        unsigned char bytes[4];
+        writeLittleEndian(bytes, fields[i]);
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+}
+
+static int usage()
+{
+    fprintf(stderr, "usage: kdpack [-0] <source directory> <output.kdpk>\n");
+    return 2;
+}
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t** wargv)
+{
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i)
+        args.push_back(toUTF8(wargv[i]));
+#else
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+#endif
+    bool allowCompression = true;
+    if (!args.empty() && args[0] == "-0") {
+        allowCompression = false;
+        args.erase(args.begin());
+    }
+    if (args.size() != 2)
+        return usage();
+
+    std::vector<SourceFile> files;
+#ifdef _WIN32
+    collectFiles(toWide(args[0]), "", files);
+#else
+    collectFiles(args[0], "", files);
+#endif
+    std::sort(files.begin(), files.end());
+
+    std::vector<unsigned char> package(sizeof(KdPackHeader), 0);
+    std::vector<KdPackEntry> entries;
+    size_t originalBytes = 0;
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::vector<unsigned char> data;
+        if (!readFile(files[i].path, data)) {
+            fprintf(stderr, "kdpack: cannot read %s\n", files[i].path.c_str());
+            return 1;
+        }
+        if (data.size() > 0x7fffffff) {
+            fprintf(stderr, "kdpack: %s is too large\n", files[i].path.c_str());
+            return 1;
+        }
+
+        KdPackEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.size = static_cast<unsigned int>(data.size());
+        entry.dataOffset = static_cast<unsigned int>(package.size());
+
+        std::vector<unsigned char> compressed;
+        if (allowCompression && !data.empty()) {
+            uLongf compressedSize = compressBound(static_cast<uLong>(data.size()));
+            compressed.resize(compressedSize);
+            if (Z_OK == compress2(&compressed[0], &compressedSize, &data[0], static_cast<uLong>(data.size()), Z_BEST_COMPRESSION)
+                && compressedSize <= data.size() - data.size() / 8)
+                compressed.resize(compressedSize);
+            else
+                compressed.clear();
+        }
+
+        if (!compressed.empty()) {
+            entry.flags = KdPackEntryCompressed;
+            entry.storedSize = static_cast<unsigned int>(compressed.size());
+            package.insert(package.end(), compressed.begin(), compressed.end());
+        } else {
+            entry.storedSize = entry.size;
+            package.insert(package.end(), data.begin(), data.end());
+        }
+
+        originalBytes += data.size();
+        entries.push_back(entry);
+    }
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        entries[i].nameOffset = static_cast<unsigned int>(package.size());
+        entries[i].nameLength = static_cast<unsigned int>(files[i].name.size());
+        package.insert(package.end(), files[i].name.begin(), files[i].name.end());
+    }
+
+    // The reader uses the index in place, so keep it aligned.
+    while (package.size() % sizeof(unsigned int))
+        package.push_back(0);
+
+    unsigned int indexOffset = static_cast<unsigned int>(package.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        unsigned int fields[] = { entries[i].nameOffset, entries[i].nameLength, entries[i].dataOffset,
+            entries[i].storedSize, entries[i].size, entries[i].flags };
+        appendHeaderOrEntry(package, fields, sizeof(fields) / sizeof(fields[0]));
+    }
+
+    if (package.size() > 0xffffffffu) {
+        fprintf(stderr, "kdpack: package would exceed 4GB\n");
+        return 1;
+    }
+
+    std::vector<unsigned char> header;
+    header.insert(header.end(), KDPACK_MAGIC, KDPACK_MAGIC + 4);
+    unsigned int headerFields[] = { KDPACK_VERSION, static_cast<unsigned int>(entries.size()), indexOffset };
+    appendHeaderOrEntry(header, headerFields, sizeof(headerFields) / sizeof(headerFields[0]));
+    std::copy(header.begin(), header.end(), package.begin());
+
+    FILE* output = openFile(args[1], L"wb");
+    if (!output || fwrite(&package[0], 1, package.size(), output) != package.size()) {
+        fprintf(stderr, "kdpack: cannot write %s\n", args[1].c_str());
+        if (output)
+            fclose(output);
+        return 1;
+    }
+    fclose(output);
+
+    printf("kdpack: %u files, %lu bytes -> %lu bytes\n", static_cast<unsigned>(entries.size()),
+        static_cast<unsigned long>(originalBytes), static_cast<unsigned long>(package.size()));
+    return 0;
+}
@@ -0,0 +1,197 @@
+// markbench: times how long the collector takes to mark large arrays, by
+// what the arrays hold, and checks that it still marks what they reach.
+//
+//   markbench [arrays] [length]
+//
+// Each workload keeps the given number of arrays (200 by default) of the
+// given length (10,000 by default) live while the heap collects 10 times, and
+// prints the average pause and marking time from the heap's pause histogram.
+// The workloads are arrays of
+//   - integers and of doubles, which the collector can skip outright;
+//   - objects, which it must scan, here all references to 100 shared objects;
+//   - objects that were then overwritten with integers, which it scans once,
+//     finds no cells in and skips afterwards;
+//   - integers with one object at the end, which it scans up to the object
+//     on every collection.
+//
+// After each workload the arrays are checked. The overwritten arrays then get
+// new objects stored into them, both by index and with push(), and more
+// garbage is made and collected before those objects are checked too. An
+// array the collector wrongly skips would lose them. Any damage is printed
+// and makes the exit status non-zero.
+//
+// Build it against JavaScriptCore.
+
+#include "config.h"
+
+#include "APICast.h"
+#include "Heap.h"
+#include "JSContextRef.h"
+#include "JSGlobalData.h"
+#include "JSStringRef.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/StringExtras.h>
+
+using namespace JSC;
+
+static const char* setupScript =
+    "var shared = [];\n"
+    "for (var i = 0; i < 100; ++i)\n"
+    "    shared.push({ id: i });\n"
+    "var data;\n"
+    "function fill(count, length, value) {\n"
+    "    data = [];\n"
+    "    for (var i = 0; i < count; ++i) {\n"
+    "        var array = [];\n"
+    "        for (var j = 0; j < length; ++j)\n"
+    "            array[j] = value(i, j);\n"
+    "        data.push(array);\n"
+    "    }\n"
+    "}\n"
+    "function integer(i, j) { return i + j; }\n"
+    "function number(i, j) { return i + j + 0.5; }\n"
+    "function object(i, j) { return shared[(i + j) % 100]; }\n"
+    "function overwrite() {\n"
+    "    for (var i = 0; i < data.length; ++i) {\n"
+    "        for (var j = 0; j < data[i].length; ++j)\n"
+    "            data[i][j] = integer(i, j);\n"
+    "    }\n"
+    "}\n"
+    "function objectAtEnd() {\n"
+    "    for (var i = 0; i < data.length; ++i)\n"
+    "        data[i][data[i].length - 1] = { id: -i };\n"
+    "}\n"
+    "function check(value, length) {\n"
+    "    for (var i = 0; i < data.length; ++i) {\n"
+    "        for (var j = 0; j < length; ++j) {\n"
+    "            if (data[i][j] !== value(i, j))\n"
+    "                return false;\n"
+    "        }\n"
+    "    }\n"
+    "    return true;\n"
+    "}\n"
+    "function checkObjectAtEnd(length) {\n"
+    "    for (var i = 0; i < data.length; ++i) {\n"
+    "        if (data[i][length - 1].id !== -i)\n"
+    "            return false;\n"
+    "    }\n"
+    "    return check(integer, length - 1);\n"
+    "}\n"
+    "function storeObjects() {\n"
+    "    for (var i = 0; i < data.length; ++i) {\n"
+    "        data[i][i % data[i].length] = { id: 'stored' + i };\n"
+    "        data[i].push({ id: 'pushed' + i });\n"
+    "    }\n"
+    "}\n"
+    "function makeGarbage() {\n"
+    "    var garbage;\n"
+    "    for (var i = 0; i < 100000; ++i)\n"
+    "        garbage = { id: 'garbage' + i, next: garbage };\n"
+    "}\n"
+    "function checkStoredObjects() {\n"
+    "    for (var i = 0; i < data.length; ++i) {\n"
+    "        var array = data[i];\n"
+    "        if (array[i % (array.length - 1)].id !== 'stored' + i || array[array.length - 1].id !== 'pushed' + i)\n"
+    "            return false;\n"
+    "    }\n"
+    "    return true;\n"
+    "}\n";
+
+static JSGlobalContextRef context;
+static bool damaged;
+
+static JSValueRef evaluate(const char* script)
+{
+    JSStringRef source = JSStringCreateWithUTF8CString(script);
+    JSValueRef exception = 0;
+    JSValueRef result = JSEvaluateScript(context, source, 0, 0, 1, &exception);
+    JSStringRelease(source);
+    if (exception) {
+        printf("exception in: %s\n", script);
+        exit(1);
+    }
+    return result;
+}
+
+static void check(const char* workload, const char* script)
+{
+    if (JSValueToBoolean(context, evaluate(script)))
+        return;
+    printf("DAMAGED: %s failed after %s\n", script, workload);
+    damaged = true;
+}
+
+static void collect(const char* workload)
+{
+    Heap& heap = toJS(context)->globalData().heap;
+
+    // The first collection after the arrays were filled is the one that finds
+    // the overwritten ones hold no cells; time the ones after it.
+    JSGarbageCollect(context);
+    heap.resetPauseHistogram();
+    for (int i = 0; i < 10; ++i)
+        JSGarbageCollect(context);
+
+    const GCPauseHistogram& histogram = heap.pauseHistogram();
+    printf("%-24s %8.2fms pause, %8.2fms marking\n", workload,
+        histogram.totalPauseTime * 1000 / histogram.collectionCount, histogram.totalMarkTime * 1000 / histogram.collectionCount);
+}
+
+static void fill(unsigned arrays, unsigned length, const char* value)
+{
+    char script[64];
+    snprintf(script, sizeof(script), "fill(%u, %u, %s)", arrays, length, value);
+    evaluate(script);
+}
+
+static void checkWorkload(const char* workload, const char* function, unsigned length)
+{
+    char script[64];
+    snprintf(script, sizeof(script), function, length);
+    check(workload, script);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned arrays = argc > 1 ? strtoul(argv[1], 0, 10) : 200;
+    unsigned length = argc > 2 ? strtoul(argv[2], 0, 10) : 10000;
+    if (length < 2)
+        length = 2;
+
+    context = JSGlobalContextCreate(0);
+    evaluate(setupScript);
+
+    printf("%u arrays of %u values, average of 10 collections\n", arrays, length);
+
+    fill(arrays, length, "integer");
+    collect("integers");
+    checkWorkload("integers", "check(integer, %u)", length);
+
+    fill(arrays, length, "number");
+    collect("doubles");
+    checkWorkload("doubles", "check(number, %u)", length);
+
+    fill(arrays, length, "object");
+    collect("objects");
+    checkWorkload("objects", "check(object, %u)", length);
+
+    evaluate("overwrite()");
+    collect("objects overwritten");
+    checkWorkload("objects overwritten", "check(integer, %u)", length);
+
+    evaluate("storeObjects()");
+    for (int i = 0; i < 3; ++i) {
+        evaluate("makeGarbage()");
+        JSGarbageCollect(context);
+    }
+    check("objects stored again", "checkStoredObjects()");
+
+    fill(arrays, length, "integer");
+    evaluate("objectAtEnd()");
+    collect("integers, object at end");
+    checkWorkload("integers, object at end", "checkObjectAtEnd(%u)", length);
+
+    JSGlobalContextRelease(context);
+    return damaged ? 1 : 0;
+}
@@ -0,0 +1,507 @@
+// propcachebench: times property accesses at sites that meet more Structures
+// than their inline caches hold, and checks what those sites read and write.
+//
+//   propcachebench [cases]
+//
+// Each workload runs 5 times and the best time is printed. The workloads are
+// - two gets and a put through shared accessor functions, over objects of 24
+//   shapes;
+// - method calls through a shared prototype, and a get and a put, over
+//   components of 32 shapes;
+// - the first workload again over objects of one shape, for comparison.
+// Where the JIT has the megamorphic property cache, each prints the accesses
+// its megamorphic sites saw and how many of them fell through to a full
+// lookup. The table is direct-mapped, so a few shapes may collide and keep
+// missing, but the sites of the first two workloads must find at least 3 in
+// 4 of their accesses in it. Fewer means its JIT probes are not doing their
+// job, and the run fails.
+//
+// Accessor functions are then made megamorphic. A fixed sequence fills the
+// cache from 30 shapes and then changes what it holds: a prototype property
+// is given a double, turned into an accessor and deleted, and own properties
+// are made read-only or accessors. Every read and write after each change
+// must see it.
+//
+// The given number of random cases (300 by default) are then run at the same
+// sites. Each builds
+// 40 objects of random shapes, some with prototypes that hold the names
+// accessed, accessor properties or a read-only property, and a twin of each.
+// Shared accessor functions read and write the objects while the same reads
+// and writes go to the twins through computed names, which never use the
+// cache. The cases also read and write through primitive values, change,
+// delete and turn into accessors the properties of prototypes, delete
+// properties so objects become dictionaries, and collect garbage. After every step the object must match
+// its twin. Any mismatch is printed and makes the exit status non-zero.
+//
+// Build it against JavaScriptCore.
+
+#include "config.h"
+
+#include "APICast.h"
+#include "JSContextRef.h"
+#include "JSGlobalData.h"
+#include "JSStringRef.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/StringExtras.h>
+#include <wtf/text/CString.h>
+
+using namespace JSC;
+
+static const char* setupScript =
+    "var seed = 7;\n"
+    "function random(limit) {\n"
+    "    seed = (seed * 1103515245 + 12345) % 2147483648;\n"
+    "    return (seed >> 8) % limit;\n"
+    "}\n"
+    "\n"
+    "function getX(o) { return o.x; }\n"
+    "function getY(o) { return o.y; }\n"
+    "function setX(o, v) { o.x = v; }\n"
+    "// The same, at sites that only ever see one shape.\n"
+    "function getOneShapeX(o) { return o.x; }\n"
+    "function getOneShapeY(o) { return o.y; }\n"
+    "function setOneShapeX(o, v) { o.x = v; }\n"
+    "var shapes = [];\n"
+    "for (var k = 0; k < 24; ++k) {\n"
+    "    var o = {};\n"
+    "    o['p' + k] = k;\n"
+    "    o.x = k;\n"
+    "    o.y = k * 2;\n"
+    "    shapes.push(o);\n"
+    "}\n"
+    "function accessors(count) {\n"
+    "    var sum = 0;\n"
+    "    for (var i = 0; i < count; ++i) {\n"
+    "        var o = shapes[i % 24];\n"
+    "        sum += getX(o) + getY(o);\n"
+    "        setX(o, i & 255);\n"
+    "    }\n"
+    "    return sum;\n"
+    "}\n"
+    "var oneShape = [];\n"
+    "for (var k = 0; k < 24; ++k)\n"
+    "    oneShape.push({ x: k, y: k * 2 });\n"
+    "function oneShapeAccessors(count) {\n"
+    "    var sum = 0;\n"
+    "    for (var i = 0; i < count; ++i) {\n"
+    "        var o = oneShape[i % 24];\n"
+    "        sum += getOneShapeX(o) + getOneShapeY(o);\n"
+    "        setOneShapeX(o, i & 255);\n"
+    "    }\n"
+    "    return sum;\n"
+    "}\n"
+    "\n"
+    "function Component() {}\n"
+    "Component.prototype.area = function() { return this.width * this.height; };\n"
+    "Component.prototype.isShown = function() { return this.visible; };\n"
+    "Component.prototype.kind = 'component';\n"
+    "var components = [];\n"
+    "for (var k = 0; k < 32; ++k) {\n"
+    "    var c = new Component();\n"
+    "    c['kind' + k] = k;\n"
+    "    c.width = 10 + k;\n"
+    "    c.height = 20;\n"
+    "    c.visible = true;\n"
+    "    c.left = 0;\n"
+    "    components.push(c);\n"
+    "}\n"
+    "function methods(count) {\n"
+    "    var sum = 0;\n"
+    "    for (var i = 0; i < count; ++i) {\n"
+    "        var c = components[i & 31];\n"
+    "        if (c.isShown())\n"
+    "            sum += c.area();\n"
+    "        if (c.kind == 'component')\n"
+    "            c.left = i;\n"
+    "    }\n"
+    "    return sum;\n"
+    "}\n"
+    "\n"
+    "// One site per name and kind, so that every site meets every shape.\n"
+    "var names = ['x', 'y', 'w', 'h', 'tag'];\n"
+    "function get_x(o) { return o.x; }\n"
+    "function get_y(o) { return o.y; }\n"
+    "function get_w(o) { return o.w; }\n"
+    "function get_h(o) { return o.h; }\n"
+    "function get_tag(o) { return o.tag; }\n"
+    "function put_x(o, v) { o.x = v; }\n"
+    "function put_y(o, v) { o.y = v; }\n"
+    "function put_w(o, v) { o.w = v; }\n"
+    "function put_h(o, v) { o.h = v; }\n"
+    "function put_tag(o, v) { o.tag = v; }\n"
+    "var getters = [get_x, get_y, get_w, get_h, get_tag];\n"
+    "var putters = [put_x, put_y, put_w, put_h, put_tag];\n"
+    "// A site that meets anything its inline caches cannot hold, such as a\n"
+    "// primitive or a dictionary, gives up on caching for good. Only a site\n"
+    "// that first fills its caches with plain objects turns to the megamorphic\n"
+    "// cache, and from then on it uses the cache for everything.\n"
+    "function makeSitesMegamorphic() {\n"
+    "    for (var k = 0; k < 10; ++k) {\n"
+    "        var o = {};\n"
+    "        o['warm' + k] = k;\n"
+    "        for (var i = 0; i < names.length; ++i)\n"
+    "            o[names[i]] = i;\n"
+    "        for (var i = 0; i < names.length; ++i) {\n"
+    "            getters[i](o);\n"
+    "            putters[i](o, k);\n"
+    "            putters[i](o, k);\n"
+    "        }\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "// Every kind of value, so that both halves of a stored value are checked.\n"
+    "var sampleValues = [0, 1, -7, 2147483647, -2147483648, 4294967296, 0.5, -1e300, NaN, Infinity, 'text', '', null, undefined, true, false];\n"
+    "function randomValue() {\n"
+    "    var i = random(sampleValues.length + 2);\n"
+    "    if (i < sampleValues.length)\n"
+    "        return sampleValues[i];\n"
+    "    return i == sampleValues.length ? {} : [i];\n"
+    "}\n"
+    "function same(a, b) { return a === b || (a !== a && b !== b); }\n"
+    "var hasOwn = Object.prototype.hasOwnProperty;\n"
+    "\n"
+    "// Fresh prototypes for each case: one with data properties, one with\n"
+    "// accessors, and one two levels up.\n"
+    "function accessorGetter() { return 'from a getter'; }\n"
+    "function accessorSetter(v) { this.seen = v; }\n"
+    "var A, B, C;\n"
+    "function makeConstructors() {\n"
+    "    A = function() {};\n"
+    "    A.prototype.x = 'A.x';\n"
+    "    A.prototype.w = 1.5;\n"
+    "    B = function() {};\n"
+    "    B.prototype.y = 'B.y';\n"
+    "    Object.defineProperty(B.prototype, 'w', { get: function() { return 'B.w'; }, set: function(v) { this.seen = v; }, configurable: true });\n"
+    "    Object.defineProperty(B.prototype, 'h', { set: function(v) { this.seen = v; }, configurable: true });\n"
+    "    C = function() {};\n"
+    "    C.prototype = new A();\n"
+    "    C.prototype.tag = 'C.tag';\n"
+    "}\n"
+    "function randomRecipe() {\n"
+    "    var recipe = { kind: random(5), extra: random(13), names: [], values: [], readOnly: null };\n"
+    "    for (var i = 0; i < names.length; ++i) {\n"
+    "        if (random(2)) {\n"
+    "            recipe.names.push(names[(i + recipe.extra) % names.length]);\n"
+    "            recipe.values.push(randomValue());\n"
+    "        }\n"
+    "    }\n"
+    "    if (!random(6))\n"
+    "        recipe.readOnly = names[random(names.length)];\n"
+    "    return recipe;\n"
+    "}\n"
+    "function build(recipe) {\n"
+    "    var o;\n"
+    "    switch (recipe.kind) {\n"
+    "    case 0: o = {}; break;\n"
+    "    case 1: o = new A(); break;\n"
+    "    case 2: o = new B(); break;\n"
+    "    case 3: o = new C(); break;\n"
+    "    default: o = Object.create(null);\n"
+    "    }\n"
+    "    o['extra' + recipe.extra] = recipe.extra;\n"
+    "    for (var i = 0; i < recipe.names.length; ++i)\n"
+    "        o[recipe.names[i]] = recipe.values[i];\n"
+    "    if (recipe.readOnly)\n"
+    "        Object.defineProperty(o, recipe.readOnly, { value: 'read only', writable: false, enumerable: true, configurable: true });\n"
+    "    return o;\n"
+    "}\n"
+    "function sameState(a, b) {\n"
+    "    for (var i = 0; i < names.length; ++i) {\n"
+    "        var name = names[i];\n"
+    "        if (!same(a[name], b[name]) || hasOwn.call(a, name) !== hasOwn.call(b, name))\n"
+    "            return false;\n"
+    "    }\n"
+    "    return same(a.seen, b.seen);\n"
+    "}\n"
+    "\n"
+    "// Fills the cache from objects of 30 shapes, then changes what it holds\n"
+    "// behind its back. Returns '' when every read and write matches, what did\n"
+    "// not otherwise.\n"
+    "function checkChanges() {\n"
+    "    makeConstructors();\n"
+    "    var fromPrototype = [];\n"
+    "    var own = [];\n"
+    "    for (var k = 0; k < 30; ++k) {\n"
+    "        var o = new A();\n"
+    "        o['shape' + k] = k;\n"
+    "        fromPrototype.push(o);\n"
+    "        o = { y: k };\n"
+    "        o['shape' + k] = k;\n"
+    "        own.push(o);\n"
+    "    }\n"
+    "    function readAll(expected) {\n"
+    "        for (var pass = 0; pass < 2; ++pass) {\n"
+    "            for (var k = 0; k < 30; ++k) {\n"
+    "                if (!same(get_x(fromPrototype[k]), expected))\n"
+    "                    return false;\n"
+    "            }\n"
+    "        }\n"
+    "        return true;\n"
+    "    }\n"
+    "    if (!readAll('A.x'))\n"
+    "        return 'a prototype property';\n"
+    "    A.prototype.x = 2.5;\n"
+    "    if (!readAll(2.5))\n"
+    "        return 'a prototype property given a double';\n"
+    "    Object.defineProperty(A.prototype, 'x', { get: accessorGetter, set: accessorSetter, configurable: true });\n"
+    "    if (!readAll('from a getter'))\n"
+    "        return 'a prototype property turned into an accessor';\n"
+    "    delete A.prototype.x;\n"
+    "    A.prototype.other = 'other';\n"
+    "    if (!readAll(undefined))\n"
+    "        return 'a deleted prototype property';\n"
+    "    fromPrototype[7].x = 'own';\n"
+    "    if (get_x(fromPrototype[7]) !== 'own')\n"
+    "        return 'a property that shadows the prototype';\n"
+    "\n"
+    "    for (var pass = 0; pass < 2; ++pass) {\n"
+    "        for (var k = 0; k < 30; ++k)\n"
+    "            put_y(own[k], pass ? 'string' : k + 0.5);\n"
+    "    }\n"
+    "    for (var k = 0; k < 30; ++k) {\n"
+    "        if (own[k].y !== 'string')\n"
+    "            return 'an own property';\n"
+    "    }\n"
+    "    Object.defineProperty(own[3], 'y', { writable: false });\n"
+    "    Object.defineProperty(own[4], 'y', { get: accessorGetter, set: accessorSetter, configurable: true });\n"
+    "    for (var k = 0; k < 30; ++k)\n"
+    "        put_y(own[k], k);\n"
+    "    if (own[3].y !== 'string')\n"
+    "        return 'a property made read-only';\n"
+    "    if (own[4].seen !== 4 || own[4].y !== 'from a getter')\n"
+    "        return 'a property turned into an accessor';\n"
+    "    for (var k = 5; k < 30; ++k) {\n"
+    "        if (own[k].y !== k)\n"
+    "            return 'an own property after others changed';\n"
+    "    }\n"
+    "    return '';\n"
+    "}\n"
+    "\n"
+    "var objects, twins;\n"
+    "function startCase() {\n"
+    "    makeConstructors();\n"
+    "    objects = [];\n"
+    "    twins = [];\n"
+    "    for (var i = 0; i < 40; ++i) {\n"
+    "        var recipe = randomRecipe();\n"
+    "        objects.push(build(recipe));\n"
+    "        twins.push(build(recipe));\n"
+    "    }\n"
+    "}\n"
+    "// Returns '' when every step matches, the step that did not otherwise.\n"
+    "function runSteps(count) {\n"
+    "    var prototypes = [A.prototype, B.prototype, C.prototype];\n"
+    "    for (var step = 0; step < count; ++step) {\n"
+    "        var i = random(objects.length);\n"
+    "        var o = objects[i];\n"
+    "        var twin = twins[i];\n"
+    "        var n = random(names.length);\n"
+    "        var name = names[n];\n"
+    "        var what;\n"
+    "        switch (random(12)) {\n"
+    "        case 0: case 1: case 2: case 3:\n"
+    "            what = 'get ' + name;\n"
+    "            if (!same(getters[n](o), twin[name]))\n"
+    "                return what;\n"
+    "            break;\n"
+    "        case 4: case 5: case 6: case 7:\n"
+    "            what = 'put ' + name;\n"
+    "            var value = randomValue();\n"
+    "            putters[n](o, value);\n"
+    "            twin[name] = value;\n"
+    "            break;\n"
+    "        case 8:\n"
+    "            what = 'get and put ' + name + ' on primitives';\n"
+    "            var primitive = [5, 0.5, 'text', true][random(4)];\n"
+    "            if (!same(getters[n](primitive), primitive[name]))\n"
+    "                return what;\n"
+    "            putters[n](primitive, 1);\n"
+    "            break;\n"
+    "        case 9:\n"
+    "            what = 'change prototype property ' + name;\n"
+    "            var prototype = prototypes[random(prototypes.length)];\n"
+    "            switch (random(4)) {\n"
+    "            case 0:\n"
+    "                delete prototype[name];\n"
+    "                break;\n"
+    "            case 1:\n"
+    "                // Same place, but no longer a plain value.\n"
+    "                Object.defineProperty(prototype, name, { get: accessorGetter, set: accessorSetter, configurable: true });\n"
+    "                break;\n"
+    "            default:\n"
+    "                prototype[name] = randomValue();\n"
+    "            }\n"
+    "            break;\n"
+    "        case 10:\n"
+    "            what = 'delete ' + name;\n"
+    "            delete o[name];\n"
+    "            delete twin[name];\n"
+    "            break;\n"
+    "        default:\n"
+    "            what = 'add ' + name + ' to another object';\n"
+    "            var other = random(objects.length);\n"
+    "            putters[n](objects[other], step);\n"
+    "            twins[other][name] = step;\n"
+    "            if (!sameState(objects[other], twins[other]))\n"
+    "                return what;\n"
+    "        }\n"
+    "        if (!sameState(o, twin))\n"
+    "            return what;\n"
+    "    }\n"
+    "    return '';\n"
+    "}\n";
+
+static JSGlobalContextRef context;
+static unsigned mismatches;
+
+static JSValueRef evaluate(const char* script)
+{
+    JSStringRef source = JSStringCreateWithUTF8CString(script);
+    JSValueRef exception = 0;
+    JSValueRef result = JSEvaluateScript(context, source, 0, 0, 1, &exception);
+    JSStringRelease(source);
+    if (exception) {
+        printf("exception in: %s\n", script);
+        exit(1);
+    }
+    return result;
+}
+
+static void check(bool matches, const char* what)
+{
+    if (matches)
+        return;
+    if (++mismatches <= 20)
+        printf("MISMATCH: %s\n", what);
+}
+
+struct Workload {
+    const char* name;
+    const char* script;
+    bool megamorphic;
+};
+
+static const Workload workloads[] = {
+    { "24 shapes, 2 gets 1 put", "accessors(1000000)", true },
+    { "32 shapes, methods", "methods(1000000)", true },
+    { "1 shape, 2 gets 1 put", "oneShapeAccessors(1000000)", false },
+};
+
+#if ENABLE(MEGAMORPHIC_CACHE)
+// Sums the counts of every site from the cache's statistics, whose lines end
+// in "accesses misses".
+static void siteCounts(double& accesses, double& misses)
+{
+    CString statistics = toJS(context)->globalData().megamorphicCache.siteStatistics().utf8();
+    accesses = 0;
+    misses = 0;
+    for (const char* line = statistics.data(); *line; ) {
+        const char* end = strchr(line, '\n');
+        const char* last = end - 1;
+        while (*last != ' ')
+            --last;
+        const char* previous = last - 1;
+        while (*previous != ' ')
+            --previous;
+        accesses += strtod(previous + 1, 0);
+        misses += strtod(last + 1, 0);
+        line = end + 1;
+    }
+}
+#endif
+
+static void runBenchmark()
+{
+    // Warm up, so that the sites have given up on their inline caches.
+    evaluate("accessors(1000); methods(1000); oneShapeAccessors(1000)");
+
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(workloads); ++i) {
+#if ENABLE(MEGAMORPHIC_CACHE)
+        toJS(context)->globalData().megamorphicCache.resetSiteCounts();
+#endif
+        // Best of 5 runs, in milliseconds.
+        double best = 0;
+        for (int run = 0; run < 5; ++run) {
+            double start = currentTime();
+            evaluate(workloads[i].script);
+            double elapsed = (currentTime() - start) * 1000;
+            if (!run || elapsed < best)
+                best = elapsed;
+        }
+
+#if ENABLE(MEGAMORPHIC_CACHE)
+        double accesses;
+        double misses;
+        siteCounts(accesses, misses);
+        printf("%-26s %8.1fms %10.0f megamorphic accesses %8.0f full lookups\n", workloads[i].name, best, accesses, misses);
+        if (workloads[i].megamorphic)
+            check(accesses >= 5000000 && misses * 4 < accesses, "the cache answers the megamorphic sites");
+#else
+        printf("%-26s %8.1fms\n", workloads[i].name, best);
+#endif
+    }
+}
+
+static void runCases(unsigned count)
+{
+    evaluate("makeSitesMegamorphic()");
+#if ENABLE(MEGAMORPHIC_CACHE)
+    toJS(context)->globalData().megamorphicCache.resetSiteCounts();
+#endif
+
+    JSStringRef change = JSValueToStringCopy(context, evaluate("checkChanges()"), 0);
+    if (JSStringGetLength(change)) {
+        char what[128];
+        JSStringGetUTF8CString(change, what, sizeof(what));
+        char description[192];
+        snprintf(description, sizeof(description), "changes: %s", what);
+        check(false, description);
+    }
+    JSStringRelease(change);
+
+    for (unsigned testCase = 0; testCase < count; ++testCase) {
+        evaluate("startCase()");
+        // Collect between the halves, so entries made before it are gone and
+        // must be made again.
+        for (int half = 0; half < 2; ++half) {
+            JSStringRef step = JSValueToStringCopy(context, evaluate("runSteps(200)"), 0);
+            if (JSStringGetLength(step)) {
+                char what[128];
+                JSStringGetUTF8CString(step, what, sizeof(what));
+                char description[192];
+                snprintf(description, sizeof(description), "case %u: %s", testCase, what);
+                check(false, description);
+            }
+            JSStringRelease(step);
+            if (!half)
+                JSGarbageCollect(context);
+        }
+    }
+
+#if ENABLE(MEGAMORPHIC_CACHE)
+    double accesses;
+    double misses;
+    siteCounts(accesses, misses);
+    printf("%.0f megamorphic accesses, %.0f full lookups\n", accesses, misses);
+    check(!count || accesses > misses, "the cases go through the cache");
+#endif
+    printf("%u cases, %u mismatches\n", count, mismatches);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned cases = argc > 1 ? strtoul(argv[1], 0, 10) : 300;
+
+    context = JSGlobalContextCreate(0);
+    evaluate(setupScript);
+
+    runBenchmark();
+    runCases(cases);
+
+    JSGlobalContextRelease(context);
+    return mismatches ? 1 : 0;
+}
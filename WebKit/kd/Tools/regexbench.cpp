@@ -0,0 +1,413 @@
+// regexbench: times the YARR JIT and interpreter and checks their matches.
+//
+//   regexbench [-v]
+//
+// The benchmark runs each pattern globally over a 20,000-line log buffer,
+// 20 passes, and prints the best of 5 runs for the JIT and for the bytecode
+// interpreter. The literal and leading-class patterns exercise the JIT's
+// required-prefix scan; /q/ and /\w+ous/ have no usable prefix and show the
+// cost of the plain retry loop.
+//
+// The correctness corpus runs every pattern globally over every subject
+// through both engines and compares the result and every capture. Patterns
+// the JIT hands back to the interpreter are counted and skipped. Any
+// mismatch is printed and makes the exit status non-zero.
+//
+// The nested-group benchmark times the interpreter on the repeated groups,
+// backreferences and lookaheads the JIT leaves to it, best of 5 runs. The
+// nested-group cases then run 11 such patterns over 13 subjects; their
+// results are checked against the JIT where it compiles the pattern, and
+// summed up in a digest so that builds with different interpreters can be
+// compared. -v prints every case instead.
+//
+// Build it against JavaScriptCore with the YARR JIT enabled.
+
+#include "config.h"
+
+#include "InitializeThreading.h"
+#include "JSGlobalData.h"
+#include "JSLock.h"
+#include "UString.h"
+#include "UStringConcatenate.h"
+#include "Yarr.h"
+#include "YarrJIT.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/StringExtras.h>
+#include <wtf/Vector.h>
+
+using namespace JSC;
+using namespace JSC::Yarr;
+
+struct PatternSource {
+    const char* source;
+    bool ignoreCase;
+    bool multiline;
+};
+
+// Subjects are Latin-1, except that "\\uXXXX" stands for any UTF-16 unit.
+static UString decode(const char* text)
+{
+    Vector<UChar> characters;
+    for (const char* p = text; *p; ++p) {
+        if (p[0] == '\\' && p[1] == 'u') {
+            char hex[5] = { p[2], p[3], p[4], p[5], 0 };
+            characters.append(static_cast<UChar>(strtol(hex, 0, 16)));
+            p += 5;
+        } else
+            characters.append(static_cast<unsigned char>(*p));
+    }
+    return UString(characters.data(), characters.size());
+}
+
+class CompiledPattern {
+public:
+    CompiledPattern(JSGlobalData* globalData, const PatternSource& source)
+        : m_numSubpatterns(0)
+        , m_hasJIT(false)
+    {
+        const char* error = 0;
+        YarrPattern pattern(decode(source.source), source.ignoreCase, source.multiline, &error);
+        if (error) {
+            fprintf(stderr, "regexbench: /%s/ does not compile: %s\n", source.source, error);
+            exit(1);
+        }
+        m_numSubpatterns = pattern.m_numSubpatterns;
+        if (!pattern.m_containsBackreferences) {
+            jitCompile(pattern, globalData, m_jit);
+            m_hasJIT = !m_jit.isFallBack();
+        }
+        m_bytecode = byteCompile(pattern, &globalData->m_regExpAllocator);
+    }
+
+    bool hasJIT() const { return m_hasJIT; }
+    unsigned outputSize() const { return (m_numSubpatterns + 1) * 2; }
+
+    int match(bool useJIT, const UString& subject, unsigned start, int* output)
+    {
+        for (unsigned i = 0; i < outputSize(); i += 2)
+            output[i] = -1;
+        if (useJIT)
+            return execute(m_jit, subject.characters(), start, subject.length(), output);
+        return interpret(m_bytecode.get(), subject.characters(), start, subject.length(), output);
+    }
+
+    // Runs the pattern the way a global exec loop does, and returns the
+    // number of matches.
+    unsigned matchAll(bool useJIT, const UString& subject)
+    {
+        Vector<int, 32> output(outputSize());
+        unsigned matches = 0;
+        unsigned start = 0;
+        while (start <= subject.length() && match(useJIT, subject, start, output.data()) >= 0) {
+            ++matches;
+            start = output[1] > output[0] ? output[1] : output[1] + 1;
+        }
+        return matches;
+    }
+
+private:
+    unsigned m_numSubpatterns;
+    bool m_hasJIT;
+    YarrCodeBlock m_jit;
+    OwnPtr<BytecodePattern> m_bytecode;
+};
+
+static UString makeLogBuffer()
+{
+    static const char* const words[] = { "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "INFO", "request", "served", "in", "ms", "user", "session", "cache" };
+    static const unsigned wordCount = sizeof(words) / sizeof(words[0]);
+
+    Vector<char> text;
+    for (unsigned i = 0; i < 20000; ++i) {
+        char line[256];
+        int length = snprintf(line, sizeof(line), "2026-10-17 12:00:%u ", i % 60);
+        text.append(line, length);
+        for (unsigned j = 0; j < 10; ++j) {
+            const char* word = words[(i * 7 + j * 13) % wordCount];
+            text.append(word, strlen(word));
+            text.append(' ');
+        }
+        if (!(i % 997)) {
+            static const char error[] = "ERROR: connection reset by peer";
+            text.append(error, sizeof(error) - 1);
+        }
+        text.append('\n');
+    }
+    return UString(text.data(), text.size());
+}
+
+// Best of several runs, in milliseconds.
+static double timeMatchAll(CompiledPattern& pattern, bool useJIT, const UString& subject, unsigned passes, unsigned& matches)
+{
+    double best = 0;
+    for (int run = 0; run < 5; ++run) {
+        matches = 0;
+        double start = currentTime();
+        for (unsigned pass = 0; pass < passes; ++pass)
+            matches += pattern.matchAll(useJIT, subject);
+        double elapsed = (currentTime() - start) * 1000;
+        if (!run || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static void runPrefixBenchmark(JSGlobalData* globalData)
+{
+    static const PatternSource patterns[] = {
+        { "connection reset", false, false },
+        { "ERROR: \\w+", false, false },
+        { "timeout", true, false },
+        { "[#$%]", false, false },
+        { "\\d+ms\\b", false, false },
+        { "q", false, false },
+        { "\\w+ous", false, false },
+    };
+
+    UString text = makeLogBuffer();
+    text.characters(); // Widen once, outside the timing.
+
+    printf("log buffer, %u characters, 20 passes, best of 5:\n", text.length());
+    for (size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i) {
+        CompiledPattern pattern(globalData, patterns[i]);
+        unsigned matches;
+        double interpreterTime = timeMatchAll(pattern, false, text, 20, matches);
+        if (pattern.hasJIT()) {
+            double jitTime = timeMatchAll(pattern, true, text, 20, matches);
+            printf("  /%s/%s: JIT %.1f ms, interpreter %.1f ms, %u matches\n", patterns[i].source, patterns[i].ignoreCase ? "i" : "", jitTime, interpreterTime, matches);
+        } else
+            printf("  /%s/%s: interpreter %.1f ms, %u matches\n", patterns[i].source, patterns[i].ignoreCase ? "i" : "", interpreterTime, matches);
+    }
+}
+
+static const PatternSource corpusPatterns[] = {
+    { "abc", false, false }, { "abcabd", false, false }, { "abcabd", true, false }, { "hello world", false, false },
+    { "HELLO", true, false }, { "a@b", true, false }, { "`x", true, false }, { "@x", true, false },
+    { "aaaa", false, false }, { "aab", false, false }, { "ab+c", false, false }, { "ab*c", false, false },
+    { "abc|abd", false, false }, { "x(y)z", false, false }, { "(?:ab)c", false, false }, { "a{3}b", false, false },
+    { "a{0}b", false, false }, { "[0-9]+x", false, false }, { "[^a-z]b", false, false }, { "\\d\\d:\\d\\d", false, false },
+    { "\\w+@\\w+", false, false }, { "[a-c]", true, false }, { "[^ ]+ing", false, false }, { "ERROR: .*$", false, true },
+    { "^foo", false, false }, { "^foo", false, true }, { "foo$", false, false }, { "x\\by", false, false },
+    { "\\bword\\b", false, false }, { "ab(?=c)", false, false }, { "abc?d", false, false }, { "abcdefghijklmnopqrstuvwxyz", false, false },
+    { "mississippi", false, false }, { "issip", false, false }, { "\\u00fc", true, false }, { "\\u00e9t\\u00e9", false, false },
+    { ".abc", false, false }, { "[xyz]abc", false, false }, { "a.c", false, false }, { "(a)\\1", false, false },
+    { "[\\s\\S]q", false, false }, { "zz*", false, false }, { "\\u0100\\u0101", false, false },
+};
+
+static const char* const corpusSubjects[] = {
+    "", "a", "abc", "xxabcxx", "abcabcabd", "ABCABD abcabd", "say hello world!", "oh HeLlO", "A@B a@b", "@X `x",
+    "aaaaaaab", "aaab", "abbbbc ac", "abd", "xyz", "abc", "aaab", "b", "123x", "Bb", "12:34", "me@host", "C", "running",
+    "line\nERROR: bad\nnext", "foo", "bar\nfoo", "xfoo", "x y", "a word here", "abc", "abd abcd",
+    "xxabcdefghijklmnopqrstuvwxyzxx", "mississippi", "mississippi issip", "\xdc" "BER", "\xe9t\xe9", "xabc", "zabc",
+    "abc axc", "aa", " q", "zzz", "\\u0100\\u0101",
+};
+
+static UString repeat(const char* text, unsigned count)
+{
+    size_t length = strlen(text);
+    Vector<char> characters;
+    for (unsigned i = 0; i < count; ++i)
+        characters.append(text, length);
+    return UString(characters.data(), characters.size());
+}
+
+static bool sameMatch(int result, const int* a, const int* b, unsigned outputSize)
+{
+    if (result < 0)
+        return true;
+    for (unsigned i = 0; i < outputSize; i += 2) {
+        if (a[i] != b[i] || (a[i] >= 0 && a[i + 1] != b[i + 1]))
+            return false;
+    }
+    return true;
+}
+
+// Returns the number of mismatches.
+static unsigned runCorpus(JSGlobalData* globalData)
+{
+    static const size_t subjectCount = sizeof(corpusSubjects) / sizeof(corpusSubjects[0]);
+    Vector<UString> subjects;
+    for (size_t i = 0; i < subjectCount; ++i)
+        subjects.append(decode(corpusSubjects[i]));
+
+    // One long subject mixes every other one, so matches are found far
+    // from the start and after many failed prefix candidates.
+    Vector<UChar> mixed;
+    for (unsigned i = 0; i < 200; ++i) {
+        const UString& subject = subjects[i % subjectCount];
+        mixed.append(subject.characters(), subject.length());
+        mixed.append('|');
+        mixed.append(static_cast<UChar>('A' + i % 58));
+    }
+    subjects.append(UString(mixed.data(), mixed.size()));
+
+    unsigned cases = 0;
+    unsigned matches = 0;
+    unsigned interpreterOnly = 0;
+    unsigned mismatches = 0;
+    for (size_t p = 0; p < sizeof(corpusPatterns) / sizeof(corpusPatterns[0]); ++p) {
+        CompiledPattern pattern(globalData, corpusPatterns[p]);
+        if (!pattern.hasJIT()) {
+            ++interpreterOnly;
+            continue;
+        }
+
+        Vector<int, 32> jitOutput(pattern.outputSize());
+        Vector<int, 32> interpreterOutput(pattern.outputSize());
+        for (size_t s = 0; s < subjects.size(); ++s) {
+            const UString& subject = subjects[s];
+            ++cases;
+            unsigned start = 0;
+            while (start <= subject.length()) {
+                int jitResult = pattern.match(true, subject, start, jitOutput.data());
+                int interpreterResult = pattern.match(false, subject, start, interpreterOutput.data());
+                if (jitResult != interpreterResult || !sameMatch(jitResult, jitOutput.data(), interpreterOutput.data(), pattern.outputSize())) {
+                    printf("  MISMATCH /%s/ on subject %u from %u: JIT %d, interpreter %d\n", corpusPatterns[p].source, static_cast<unsigned>(s), start, jitResult, interpreterResult);
+                    ++mismatches;
+                    break;
+                }
+                if (jitResult < 0)
+                    break;
+                ++matches;
+                start = jitOutput[1] > jitOutput[0] ? jitOutput[1] : jitOutput[1] + 1;
+            }
+        }
+    }
+
+    printf("corpus: %u pattern/subject cases, %u matches, %u mismatches; %u patterns left to the interpreter\n", cases, matches, mismatches, interpreterOnly);
+    return mismatches;
+}
+
+static void runNestedBenchmark(JSGlobalData* globalData)
+{
+    struct NestedCase {
+        PatternSource pattern;
+        UString subject;
+        unsigned iterations;
+    };
+
+    Vector<char> pairs;
+    for (unsigned i = 0; i < 60; ++i) {
+        char pair[32];
+        pairs.append(pair, snprintf(pair, sizeof(pair), "key%u=val%u; ", i, i * 7));
+    }
+    Vector<char> tags;
+    for (unsigned i = 0; i < 200; ++i) {
+        char tag[32];
+        tags.append(tag, snprintf(tag, sizeof(tag), "<b>w%u</b> <i>x</i> ", i));
+    }
+
+    const NestedCase cases[] = {
+        { { "(?:(\\w+)=(\\w+); )+x", false, false }, UString(pairs.data(), pairs.size()), 100 },
+        { { "((a|b)(b|a))+c", false, false }, repeat("ab", 60), 100 },
+        { { "(?:(?:ab)+\\s?)+$", false, false }, makeUString(repeat("ab", 10), "!"), 600 },
+        { { "(\\d+(?:\\.\\d+)?\\s*)+;", false, false }, "1.5 2 3.25 4 5.0 6 7 8 9 x", 2000 },
+        { { "(?:<(\\w+)>[^<]*<\\/\\1>\\s*)+", false, false }, UString(tags.data(), tags.size()), 400 },
+        { { "((?:a|b)*?c)+d", false, false }, makeUString(repeat("ab", 50), "c", repeat("ab", 50), "ce"), 10000 },
+    };
+
+    printf("nested groups, interpreter, best of 5:\n");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        CompiledPattern pattern(globalData, cases[i].pattern);
+        const UString& subject = cases[i].subject;
+        subject.characters();
+        Vector<int, 32> output(pattern.outputSize());
+
+        double best = 0;
+        for (int run = 0; run < 5; ++run) {
+            double start = currentTime();
+            for (unsigned iteration = 0; iteration < cases[i].iterations; ++iteration)
+                pattern.match(false, subject, 0, output.data());
+            double elapsed = (currentTime() - start) * 1000;
+            if (!run || elapsed < best)
+                best = elapsed;
+        }
+        printf("  /%s/ x %u: %.1f ms\n", cases[i].pattern.source, cases[i].iterations, best);
+    }
+}
+
+static unsigned hashInt(unsigned hash, int value)
+{
+    // FNV-1a over the value's four bytes.
+    for (int shift = 0; shift < 32; shift += 8)
+        hash = (hash ^ ((static_cast<unsigned>(value) >> shift) & 0xff)) * 16777619U;
+    return hash;
+}
+
+// Returns the number of mismatches with the JIT.
+static unsigned runNestedCases(JSGlobalData* globalData, bool verbose)
+{
+    static const PatternSource patterns[] = {
+        { "((a|b)(b|a))+c?", false, false }, { "(?:(\\w+)=(\\w+); )+", false, false }, { "(?:<(\\w+)>[^<]*<\\/\\1>\\s*)+", false, false },
+        { "((?:a|b)*?c)+d?", false, false }, { "((ab){2})+", false, false }, { "((a)|(b))+?b", false, false },
+        { "(\\d+(?:\\.(\\d+))?\\s*){3}", false, false }, { "(x(y(z)+)+)+", false, false }, { "((\\w)\\2)+", false, false },
+        { "(a(?=b)|b(?!c))+", false, false }, { "(?:(a)|b)*\\1", false, false },
+    };
+    const UString subjects[] = {
+        "", "ab", "abba", "abababc", "key=val; k2=v2; x", "<b>x</b> <i>y</i><b>z</c>",
+        makeUString(repeat("ab", 500), "c", repeat("ab", 200)), "1.5 2 3.25 4", "xyzzyzxyz", "aabbcc", "abababac",
+        repeat("xyz", 2000), repeat("<b>w</b> ", 3000),
+    };
+    static const size_t subjectCount = sizeof(subjects) / sizeof(subjects[0]);
+
+    unsigned cases = 0;
+    unsigned matches = 0;
+    unsigned checkedWithJIT = 0;
+    unsigned mismatches = 0;
+    unsigned digest = 2166136261U;
+    for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p) {
+        CompiledPattern pattern(globalData, patterns[p]);
+        Vector<int, 32> output(pattern.outputSize());
+        Vector<int, 32> jitOutput(pattern.outputSize());
+        for (size_t s = 0; s < subjectCount; ++s) {
+            ++cases;
+            int result = pattern.match(false, subjects[s], 0, output.data());
+            if (result >= 0)
+                ++matches;
+
+            if (pattern.hasJIT()) {
+                ++checkedWithJIT;
+                int jitResult = pattern.match(true, subjects[s], 0, jitOutput.data());
+                if (jitResult != result || !sameMatch(result, output.data(), jitOutput.data(), pattern.outputSize())) {
+                    printf("  MISMATCH /%s/ on subject %u: interpreter %d, JIT %d\n", patterns[p].source, static_cast<unsigned>(s), result, jitResult);
+                    ++mismatches;
+                }
+            }
+
+            digest = hashInt(digest, result);
+            if (verbose)
+                printf("  %u/%u = %d", static_cast<unsigned>(p), static_cast<unsigned>(s), result);
+            for (unsigned i = 0; result >= 0 && i < pattern.outputSize(); i += 2) {
+                digest = hashInt(hashInt(digest, output[i]), output[i] >= 0 ? output[i + 1] : -1);
+                if (verbose)
+                    printf(" %d,%d", output[i], output[i] >= 0 ? output[i + 1] : -1);
+            }
+            if (verbose)
+                printf("\n");
+        }
+    }
+
+    printf("nested-group cases: %u, %u matches, %u checked against the JIT, %u mismatches, results digest %08x\n", cases, matches, checkedWithJIT, mismatches, digest);
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = argc > 1 && !strcmp(argv[1], "-v");
+
+    initializeThreading();
+    JSLock lock(SilenceAssertionsOnly);
+    RefPtr<JSGlobalData> globalData = JSGlobalData::create(ThreadStackTypeLarge);
+
+    if (!verbose) {
+        runPrefixBenchmark(globalData.get());
+        runNestedBenchmark(globalData.get());
+    }
+    unsigned mismatches = runCorpus(globalData.get());
+    mismatches += runNestedCases(globalData.get(), verbose);
+    return mismatches ? 1 : 0;
+}
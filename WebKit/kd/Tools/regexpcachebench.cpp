@@ -0,0 +1,215 @@
+// regexpcachebench: times scripts that keep building the same regular
+// expressions under different RegExpCache capacities, and checks the cache's
+// least-recently-used eviction.
+//
+//   regexpcachebench
+//
+// A script cycles 20 times through a working set of distinct patterns,
+// building each with new RegExp() and testing a string with it, as a page
+// that validates input fields does. Each working set (100 to 3,000 patterns)
+// runs against a cache of 0 bytes (no cache), 256KB, the 2MB default and 8MB.
+// Each prints the best time of 3 runs and what the cache did: hits, misses,
+// evictions, the time spent compiling and the bytes held at the end.
+//
+// The checks then drive RegExpCache::lookupOrCreate() directly. They fill a
+// cache sized for exactly 20 patterns, and check that:
+// - a hit returns the cached RegExp;
+// - a new pattern evicts the least recently used one and nothing else;
+// - a pattern over 1/16 of the capacity is compiled but never cached;
+// - the same pattern with other flags is another entry;
+// - lowering the capacity evicts at once.
+// Each check prints PASS or FAIL. Any failure makes the exit status non-zero.
+//
+// Build it against JavaScriptCore.
+
+#include "config.h"
+
+#include "APICast.h"
+#include "JSContextRef.h"
+#include "JSGlobalData.h"
+#include "JSLock.h"
+#include "JSStringRef.h"
+#include "RegExpCache.h"
+#include "UString.h"
+#include "UStringConcatenate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/StringExtras.h>
+
+using namespace JSC;
+
+static const char* setupScript =
+    "var patterns;\n"
+    "var subjects;\n"
+    "function makeWorkingSet(count) {\n"
+    "    patterns = [];\n"
+    "    subjects = [];\n"
+    "    for (var i = 0; i < count; ++i) {\n"
+    "        patterns.push('^field' + i + '-(\\\\d{2,6})(?:[,;][a-z]+\\\\d*)*$');\n"
+    "        subjects.push('field' + i + '-' + (1000 + i) + ',abc' + i + ';de');\n"
+    "    }\n"
+    "}\n"
+    "function validate(passes) {\n"
+    "    var matched = 0;\n"
+    "    for (var pass = 0; pass < passes; ++pass) {\n"
+    "        for (var i = 0; i < patterns.length; ++i) {\n"
+    "            if (new RegExp(patterns[i]).test(subjects[i]))\n"
+    "                ++matched;\n"
+    "        }\n"
+    "    }\n"
+    "    return matched;\n"
+    "}\n";
+
+static JSGlobalContextRef context;
+static JSGlobalData* globalData;
+static int failures;
+
+static JSValueRef evaluate(const char* script)
+{
+    JSStringRef source = JSStringCreateWithUTF8CString(script);
+    JSValueRef exception = 0;
+    JSValueRef result = JSEvaluateScript(context, source, 0, 0, 1, &exception);
+    JSStringRelease(source);
+    if (exception) {
+        printf("exception in: %s\n", script);
+        exit(1);
+    }
+    return result;
+}
+
+static void resetCache(size_t capacity)
+{
+    JSLock lock(SilenceAssertionsOnly);
+    RegExpCache* cache = globalData->regExpCache();
+    cache->setCapacity(0);
+    cache->setCapacity(capacity);
+    globalData->regExpCacheStatistics = RegExpCacheStatistics();
+}
+
+static const unsigned workingSets[] = { 100, 300, 1000, 3000 };
+static const size_t capacities[] = { 0, 256 * 1024, RegExpCache::defaultCapacity, 8 * 1024 * 1024 };
+
+static void runBenchmark()
+{
+    static const unsigned passes = 20;
+    printf("%8s %9s %9s %8s %8s %9s %10s %10s\n", "patterns", "capacity", "time", "hits", "misses", "evictions", "compiling", "cached");
+
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(workingSets); ++i) {
+        char script[64];
+        snprintf(script, sizeof(script), "makeWorkingSet(%u)", workingSets[i]);
+        evaluate(script);
+        snprintf(script, sizeof(script), "validate(%u)", passes);
+
+        for (size_t j = 0; j < WTF_ARRAY_LENGTH(capacities); ++j) {
+            // Best of 3 runs, each from an empty cache; the counts are the
+            // same every time.
+            double best = 0;
+            for (int run = 0; run < 3; ++run) {
+                resetCache(capacities[j]);
+                double start = currentTime();
+                double matched = JSValueToNumber(context, evaluate(script), 0);
+                double elapsed = currentTime() - start;
+                if (!run || elapsed < best)
+                    best = elapsed;
+                if (matched != workingSets[i] * passes) {
+                    printf("FAIL: %u of %u subjects matched\n", static_cast<unsigned>(matched), workingSets[i] * passes);
+                    ++failures;
+                }
+            }
+
+            const RegExpCacheStatistics& statistics = globalData->regExpCacheStatistics;
+            printf("%8u %8uK %7.1fms %8u %8u %9u %8.1fms %9uK\n", workingSets[i], static_cast<unsigned>(capacities[j] / 1024),
+                best * 1000, statistics.hits, statistics.misses, statistics.evictions,
+                statistics.compileTime * 1000, static_cast<unsigned>(statistics.cachedBytes / 1024));
+        }
+    }
+}
+
+static void check(bool condition, const char* description)
+{
+    printf("%s: %s\n", condition ? "PASS" : "FAIL", description);
+    if (!condition)
+        ++failures;
+}
+
+// Patterns of the same length and shape, so every entry costs the same.
+static UString pattern(unsigned index)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "^entry%04u-(\\d+)-[a-f]+$", index);
+    return UString(text);
+}
+
+static void runChecks()
+{
+    JSLock lock(SilenceAssertionsOnly);
+    RegExpCache* cache = globalData->regExpCache();
+    const RegExpCacheStatistics& statistics = globalData->regExpCacheStatistics;
+
+    resetCache(RegExpCache::defaultCapacity);
+    cache->lookupOrCreate(pattern(0), NoFlags);
+    size_t entrySize = statistics.cachedBytes;
+    cache->lookupOrCreate(pattern(1), NoFlags);
+    check(entrySize && statistics.cachedBytes == 2 * entrySize, "patterns of the same shape cost the same");
+
+    static const unsigned capacityInEntries = 20;
+    resetCache(capacityInEntries * entrySize);
+    Vector<RefPtr<RegExp> > regExps;
+    for (unsigned i = 0; i < capacityInEntries; ++i)
+        regExps.append(cache->lookupOrCreate(pattern(i), NoFlags));
+    check(statistics.misses == capacityInEntries && statistics.entries == capacityInEntries && !statistics.evictions,
+        "a cache sized for 20 patterns holds 20");
+    check(cache->lookupOrCreate(pattern(0), NoFlags) == regExps[0] && statistics.hits == 1, "a hit returns the cached RegExp");
+
+    // pattern(0) was just used, so pattern(1) is now the least recently used.
+    cache->lookupOrCreate(pattern(capacityInEntries), NoFlags);
+    check(statistics.evictions == 1 && statistics.entries == capacityInEntries, "a new pattern evicts one entry");
+    unsigned hits = statistics.hits;
+    cache->lookupOrCreate(pattern(0), NoFlags);
+    cache->lookupOrCreate(pattern(2), NoFlags);
+    check(statistics.hits == hits + 2, "the recently used entries stay");
+    unsigned misses = statistics.misses;
+    check(cache->lookupOrCreate(pattern(1), NoFlags) != regExps[1] && statistics.misses == misses + 1,
+        "the least recently used entry was the one evicted");
+    check(statistics.cachedBytes <= cache->capacity(), "the cache stays within its capacity");
+
+    misses = statistics.misses;
+    unsigned entries = statistics.entries;
+    UString large = pattern(0);
+    while (large.length() * sizeof(UChar) <= cache->capacity() / 16)
+        large = makeUString(large, "|", pattern(0));
+    RefPtr<RegExp> uncached = cache->lookupOrCreate(large, NoFlags);
+    check(uncached && cache->lookupOrCreate(large, NoFlags) != uncached && statistics.misses == misses + 2 && statistics.entries == entries,
+        "a pattern over 1/16 of the capacity is not cached");
+
+    hits = statistics.hits;
+    RefPtr<RegExp> global = cache->lookupOrCreate(pattern(0), FlagGlobal);
+    check(global != regExps[0] && statistics.hits == hits, "other flags make another entry");
+
+    cache->setCapacity(capacityInEntries * entrySize / 2);
+    check(statistics.entries == capacityInEntries / 2 && statistics.cachedBytes <= cache->capacity(), "lowering the capacity evicts at once");
+    cache->setCapacity(0);
+    check(!statistics.entries && !statistics.cachedBytes, "a capacity of 0 empties the cache");
+    misses = statistics.misses;
+    cache->lookupOrCreate(pattern(0), NoFlags);
+    cache->lookupOrCreate(pattern(0), NoFlags);
+    check(statistics.misses == misses + 2 && !statistics.entries, "a capacity of 0 caches nothing");
+
+    cache->setCapacity(RegExpCache::defaultCapacity);
+}
+
+int main()
+{
+    context = JSGlobalContextCreate(0);
+    globalData = &toJS(context)->globalData();
+    evaluate(setupScript);
+
+    runBenchmark();
+    runChecks();
+
+    JSGlobalContextRelease(context);
+    printf("%s\n", failures ? "SOME CHECKS FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
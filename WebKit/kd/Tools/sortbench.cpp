@@ -0,0 +1,236 @@
+// sortbench: times Array.prototype.sort and checks the order it leaves
+// arrays in.
+//
+//   sortbench [cases]
+//
+// Each sort runs 5 times on a fresh copy of its input, and the best time is
+// printed with the number of times the comparator was called. The inputs are
+// 100,000 objects sorted by a key through a script comparator, in random,
+// ascending and descending order; 200,000 numbers with a NaN and an undefined
+// value sorted with function(a, b) { return a - b; }, which takes the numeric
+// path; and 100,000 strings sorted without a comparator.
+//
+// The given number of random arrays (20,000 by default) are then sorted and
+// checked against a plain insertion sort. They mix values with undefined
+// values, holes and NaN. The defined values must come first, in order and,
+// for a comparator, stable; then the undefined values; then the holes. NaN
+// sorts after every number. A last set of cases uses a comparator that
+// empties the array while it sorts, which must still leave the values in
+// order. Any mismatch is printed and makes the exit status non-zero.
+//
+// Build it against JavaScriptCore.
+
+#include "config.h"
+
+#include "JSContextRef.h"
+#include "JSStringRef.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/StringExtras.h>
+
+static const char* setupScript =
+    "var seed = 7;\n"
+    "function random(limit) {\n"
+    "    seed = (seed * 1103515245 + 12345) % 2147483648;\n"
+    "    return (seed >> 8) % limit;\n"
+    "}\n"
+    "var calls = 0;\n"
+    "function byKey(a, b) { ++calls; return a.k - b.k; }\n"
+    "function numeric(a, b) { return a - b; }\n"
+    "var inputs = {};\n"
+    "function makeInputs() {\n"
+    "    var rows = [];\n"
+    "    for (var i = 0; i < 100000; ++i)\n"
+    "        rows.push({ k: random(1000000), i: i });\n"
+    "    inputs.random = rows;\n"
+    "    inputs.ascending = rows.slice().sort(byKey);\n"
+    "    inputs.descending = inputs.ascending.slice().reverse();\n"
+    "    var numbers = [];\n"
+    "    for (var i = 0; i < 200000; ++i)\n"
+    "        numbers.push(random(1000000) / 7);\n"
+    "    numbers[100000] = NaN;\n"
+    "    numbers.push(undefined);\n"
+    "    inputs.numbers = numbers;\n"
+    "    var strings = [];\n"
+    "    for (var i = 0; i < 100000; ++i)\n"
+    "        strings.push('row' + random(1000000));\n"
+    "    inputs.strings = strings;\n"
+    "}\n"
+    "var input;\n"
+    "function prepare(name) { input = inputs[name].slice(); calls = 0; }\n"
+    "\n"
+    "// The reference: a stable insertion sort of the defined values, then the\n"
+    "// undefined values, then the holes.\n"
+    "function expected(array, less) {\n"
+    "    var values = [];\n"
+    "    var undefinedCount = 0;\n"
+    "    for (var i = 0; i < array.length; ++i) {\n"
+    "        if (!(i in array))\n"
+    "            continue;\n"
+    "        if (array[i] === undefined) {\n"
+    "            ++undefinedCount;\n"
+    "            continue;\n"
+    "        }\n"
+    "        var j = values.length;\n"
+    "        while (j && less(array[i], values[j - 1]))\n"
+    "            --j;\n"
+    "        values.splice(j, 0, array[i]);\n"
+    "    }\n"
+    "    return { values: values, undefinedCount: undefinedCount };\n"
+    "}\n"
+    "function same(a, b) { return a === b || (a !== a && b !== b); }\n"
+    "function matches(array, expect, length) {\n"
+    "    if (array.length !== length)\n"
+    "        return false;\n"
+    "    var values = expect.values;\n"
+    "    for (var i = 0; i < values.length; ++i) {\n"
+    "        if (!same(array[i], values[i]))\n"
+    "            return false;\n"
+    "    }\n"
+    "    var end = values.length + expect.undefinedCount;\n"
+    "    for (var i = values.length; i < end; ++i) {\n"
+    "        if (!(i in array) || array[i] !== undefined)\n"
+    "            return false;\n"
+    "    }\n"
+    "    for (var i = end; i < length; ++i) {\n"
+    "        if (i in array)\n"
+    "            return false;\n"
+    "    }\n"
+    "    return true;\n"
+    "}\n"
+    "function numberLess(a, b) { return a < b || (b !== b && a === a); }\n"
+    "function stringLess(a, b) { return String(a) < String(b); }\n"
+    "function keyLess(a, b) { return a.k < b.k; }\n"
+    "function randomArray(value) {\n"
+    "    var length = random(40);\n"
+    "    var array = new Array(length);\n"
+    "    for (var i = 0; i < length; ++i) {\n"
+    "        var kind = random(10);\n"
+    "        if (kind < 2)\n"
+    "            continue;\n"
+    "        array[i] = kind < 3 ? undefined : value(i);\n"
+    "    }\n"
+    "    return array;\n"
+    "}\n"
+    "function randomNumber() { return random(10) ? random(10) - 3 : NaN; }\n"
+    "function randomRow(i) { return { k: random(5), i: i }; }\n"
+    "function randomString() { return random(3) ? 'abc'.charAt(random(3)) + random(10) : random(20); }\n"
+    "\n"
+    "// Returns the kind of the first case that came out wrong, or ''.\n"
+    "function runCase() {\n"
+    "    var array = randomArray(randomRow);\n"
+    "    var expect = expected(array, keyLess);\n"
+    "    var length = array.length;\n"
+    "    array.sort(byKey);\n"
+    "    if (!matches(array, expect, length))\n"
+    "        return 'comparator';\n"
+    "\n"
+    "    array = randomArray(randomNumber);\n"
+    "    expect = expected(array, numberLess);\n"
+    "    length = array.length;\n"
+    "    array.sort(numeric);\n"
+    "    if (!matches(array, expect, length))\n"
+    "        return 'numeric';\n"
+    "\n"
+    "    array = randomArray(randomString);\n"
+    "    expect = expected(array, stringLess);\n"
+    "    length = array.length;\n"
+    "    array.sort();\n"
+    "    if (!matches(array, expect, length))\n"
+    "        return 'default';\n"
+    "\n"
+    "    // Emptying the array drops the holes; the values and the undefined\n"
+    "    // values must still come back in order.\n"
+    "    array = randomArray(randomRow);\n"
+    "    expect = expected(array, keyLess);\n"
+    "    array.sort(function(a, b) { array.length = 0; return a.k - b.k; });\n"
+    "    if (!matches(array, expect, expect.values.length + expect.undefinedCount))\n"
+    "        return 'emptying comparator';\n"
+    "    return '';\n"
+    "}\n";
+
+static JSGlobalContextRef context;
+
+static JSValueRef evaluate(const char* script)
+{
+    JSStringRef source = JSStringCreateWithUTF8CString(script);
+    JSValueRef exception = 0;
+    JSValueRef result = JSEvaluateScript(context, source, 0, 0, 1, &exception);
+    JSStringRelease(source);
+    if (exception) {
+        printf("exception in: %s\n", script);
+        exit(1);
+    }
+    return result;
+}
+
+struct Benchmark {
+    const char* name;
+    const char* input;
+    const char* sort;
+};
+
+static const Benchmark benchmarks[] = {
+    { "random, comparator", "random", "input.sort(byKey)" },
+    { "ascending, comparator", "ascending", "input.sort(byKey)" },
+    { "descending, comparator", "descending", "input.sort(byKey)" },
+    { "numbers, a - b", "numbers", "input.sort(numeric)" },
+    { "strings, default", "strings", "input.sort()" },
+};
+
+// Best of 5 runs, in milliseconds.
+static double timeSort(const Benchmark& benchmark)
+{
+    char prepare[64];
+    snprintf(prepare, sizeof(prepare), "prepare('%s')", benchmark.input);
+
+    double best = 0;
+    for (int run = 0; run < 5; ++run) {
+        evaluate(prepare);
+        double start = currentTime();
+        evaluate(benchmark.sort);
+        double elapsed = (currentTime() - start) * 1000;
+        if (!run || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static unsigned runCases(unsigned count)
+{
+    unsigned mismatches = 0;
+    for (unsigned testCase = 0; testCase < count; ++testCase) {
+        JSStringRef kind = JSValueToStringCopy(context, evaluate("runCase()"), 0);
+        size_t length = JSStringGetLength(kind);
+        if (length) {
+            char name[64];
+            JSStringGetUTF8CString(kind, name, sizeof(name));
+            if (++mismatches <= 20)
+                printf("MISMATCH: %s sort, case %u\n", name, testCase);
+        }
+        JSStringRelease(kind);
+    }
+    printf("%u cases, %u mismatches\n", count, mismatches);
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned cases = argc > 1 ? strtoul(argv[1], 0, 10) : 20000;
+
+    context = JSGlobalContextCreate(0);
+    evaluate(setupScript);
+    evaluate("makeInputs()");
+
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(benchmarks); ++i) {
+        double elapsed = timeSort(benchmarks[i]);
+        printf("%-24s %8.1fms %9.0f comparator calls\n", benchmarks[i].name, elapsed,
+            JSValueToNumber(context, evaluate("calls"), 0));
+    }
+
+    unsigned mismatches = runCases(cases);
+    JSGlobalContextRelease(context);
+    return mismatches ? 1 : 0;
+}
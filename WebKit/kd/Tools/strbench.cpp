@@ -0,0 +1,318 @@
+// strbench: times StringImpl's search and comparison kernels and checks them.
+//
+//   strbench [cases]
+//
+// Each operation runs over a short (24 character), a medium (1K) and a large
+// (4M) 16-bit haystack, and the best of 5 runs is printed. Searches look for
+// something that only occurs at the far end, and comparisons are between
+// strings that are equal, or equal but for case, all the way through, so
+// every run covers the whole haystack. The first line says whether the SSE2
+// kernels are in use; on 32-bit x86 that is decided by the CPU at run time.
+//
+// The kernels are then checked: the given number of random cases (200,000
+// by default) run every operation on short strings of a few letters, some of
+// them non-ASCII, against plain loops over the characters. Any mismatch is
+// printed and makes the exit status non-zero.
+//
+// Build it against JavaScriptCore's wtf.
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wtf/CPUFeatures.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringImpl.h>
+#include <wtf/unicode/Unicode.h>
+
+using namespace WTF;
+
+static unsigned randomState = 7;
+
+// Deterministic, so that every build checks the same cases.
+static unsigned randomNumber(unsigned limit)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return (randomState >> 8) % limit;
+}
+
+enum Operation {
+    FindCharacter,
+    FindString,
+    ReverseFindCharacter,
+    ReverseFindString,
+    Equal,
+    EqualIgnoringCase,
+    CodePointCompare,
+    numberOfOperations
+};
+
+static const char* const operationNames[numberOfOperations] = {
+    "find(UChar)",
+    "find(StringImpl*)",
+    "reverseFind(UChar)",
+    "reverseFind(StringImpl*)",
+    "equal",
+    "equalIgnoringCase",
+    "codePointCompare",
+};
+
+struct Haystack {
+    RefPtr<StringImpl> text;
+    RefPtr<StringImpl> copy; // Equal to text, but another string.
+    RefPtr<StringImpl> upper; // Equal to text but for case.
+    RefPtr<StringImpl> needle; // Not in text.
+};
+
+// Lower case letters, then U+0100, which is what find(UChar) looks for.
+static Haystack makeHaystack(unsigned length)
+{
+    Vector<UChar> characters(length);
+    for (unsigned i = 0; i < length - 1; ++i)
+        characters[i] = 'a' + randomNumber(20);
+    characters[length - 1] = 0x100;
+
+    Vector<UChar> upper(characters);
+    for (unsigned i = 0; i < length - 1; ++i)
+        upper[i] -= 'a' - 'A';
+
+    static const UChar needle[] = { 'x', 'y', 'z', 0x101, 'q' };
+
+    Haystack haystack;
+    haystack.text = StringImpl::create(characters.data(), length);
+    haystack.copy = StringImpl::create(characters.data(), length);
+    haystack.upper = StringImpl::create(upper.data(), length);
+    haystack.needle = StringImpl::create(needle, WTF_ARRAY_LENGTH(needle));
+    return haystack;
+}
+
+static NEVER_INLINE size_t runOperation(Operation operation, const Haystack& haystack, unsigned repetitions)
+{
+    StringImpl* text = haystack.text.get();
+    size_t sum = 0;
+    for (unsigned i = 0; i < repetitions; ++i) {
+        switch (operation) {
+        case FindCharacter:
+            sum += text->find(static_cast<UChar>(0x100), i & 1);
+            break;
+        case FindString:
+            sum += text->find(haystack.needle.get(), i & 1);
+            break;
+        case ReverseFindCharacter:
+            sum += text->reverseFind(static_cast<UChar>('{'), UINT_MAX - (i & 1));
+            break;
+        case ReverseFindString:
+            sum += text->reverseFind(haystack.needle.get());
+            break;
+        case Equal:
+            sum += equal(text, haystack.copy.get());
+            break;
+        case EqualIgnoringCase:
+            sum += equalIgnoringCase(text, haystack.upper.get());
+            break;
+        case CodePointCompare:
+            sum += codePointCompare(text, haystack.copy.get());
+            break;
+        case numberOfOperations:
+            ASSERT_NOT_REACHED();
+        }
+    }
+    return sum;
+}
+
+static size_t benchmarkSum;
+
+// Best of 5 runs, in milliseconds.
+static double timeOperation(Operation operation, const Haystack& haystack, unsigned repetitions)
+{
+    double best = 0;
+    for (int run = 0; run < 5; ++run) {
+        double start = currentTime();
+        benchmarkSum += runOperation(operation, haystack, repetitions);
+        double elapsed = (currentTime() - start) * 1000;
+        if (!run || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+struct HaystackSize {
+    const char* name;
+    unsigned length;
+    unsigned repetitions;
+};
+
+static const HaystackSize sizes[] = {
+    { "short", 24, 2000000 },
+    { "medium", 1024, 100000 },
+    { "large", 4 << 20, 20 },
+};
+
+static void runBenchmark()
+{
+    printf("SSE2 kernels: %s\n", isSSE2Present() ? "yes" : "no");
+    printf("%-26s", "");
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(sizes); ++i)
+        printf("%8s x%-8u", sizes[i].name, sizes[i].repetitions);
+    printf("\n");
+
+    Haystack haystacks[WTF_ARRAY_LENGTH(sizes)];
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(sizes); ++i)
+        haystacks[i] = makeHaystack(sizes[i].length);
+
+    for (unsigned operation = 0; operation < numberOfOperations; ++operation) {
+        printf("%-26s", operationNames[operation]);
+        for (size_t i = 0; i < WTF_ARRAY_LENGTH(sizes); ++i)
+            printf("%15.1fms ", timeOperation(static_cast<Operation>(operation), haystacks[i], sizes[i].repetitions));
+        printf("\n");
+    }
+}
+
+// Letters with case pairs inside and outside ASCII, including the Kelvin
+// sign, which folds to ASCII 'k'.
+static const UChar letters[] = { 'a', 'b', 'A', 'B', 'z', 'Z', 0xE9, 0xC9, 0x212A, 'k', 'K', 0x4E2D };
+
+static PassRefPtr<StringImpl> makeRandomString(unsigned length, unsigned letterCount)
+{
+    Vector<UChar> characters(length);
+    for (unsigned i = 0; i < length; ++i)
+        characters[i] = letters[randomNumber(letterCount)];
+    return StringImpl::create(characters.data(), length);
+}
+
+static bool matchesAt(StringImpl* text, StringImpl* match, unsigned index)
+{
+    for (unsigned j = 0; j < match->length(); ++j) {
+        if (text->characters()[index + j] != match->characters()[j])
+            return false;
+    }
+    return true;
+}
+
+static size_t plainFind(StringImpl* text, StringImpl* match, unsigned index)
+{
+    if (!match->length())
+        return std::min(index, text->length());
+    for (unsigned i = index; i + match->length() <= text->length(); ++i) {
+        if (matchesAt(text, match, i))
+            return i;
+    }
+    return notFound;
+}
+
+static size_t plainReverseFind(StringImpl* text, StringImpl* match, unsigned index)
+{
+    if (!match->length())
+        return std::min(index, text->length());
+    if (match->length() > text->length())
+        return notFound;
+    for (unsigned i = std::min(index, text->length() - match->length()); ; --i) {
+        if (matchesAt(text, match, i))
+            return i;
+        if (!i)
+            return notFound;
+    }
+}
+
+static size_t plainFindCharacter(StringImpl* text, UChar character, unsigned index)
+{
+    for (unsigned i = index; i < text->length(); ++i) {
+        if (text->characters()[i] == character)
+            return i;
+    }
+    return notFound;
+}
+
+static size_t plainReverseFindCharacter(StringImpl* text, UChar character, unsigned index)
+{
+    if (!text->length())
+        return notFound;
+    for (unsigned i = std::min(index, text->length() - 1); ; --i) {
+        if (text->characters()[i] == character)
+            return i;
+        if (!i)
+            return notFound;
+    }
+}
+
+static int plainCodePointCompare(StringImpl* a, StringImpl* b)
+{
+    unsigned length = std::min(a->length(), b->length());
+    for (unsigned i = 0; i < length; ++i) {
+        if (a->characters()[i] != b->characters()[i])
+            return a->characters()[i] > b->characters()[i] ? 1 : -1;
+    }
+    if (a->length() == b->length())
+        return 0;
+    return a->length() > b->length() ? 1 : -1;
+}
+
+static unsigned mismatches;
+
+static void check(bool matches, Operation operation, unsigned testCase)
+{
+    if (matches)
+        return;
+    if (++mismatches <= 20)
+        printf("MISMATCH: %s, case %u\n", operationNames[operation], testCase);
+}
+
+// A second string for the comparisons: the same characters, or random ones,
+// sometimes with one character changed or its case flipped.
+static PassRefPtr<StringImpl> makeComparand(StringImpl* text, unsigned letterCount)
+{
+    RefPtr<StringImpl> other = randomNumber(2) ? text->substring(0, text->length()) : makeRandomString(text->length(), letterCount);
+    if (!other->length() || !randomNumber(2))
+        return other.release();
+
+    Vector<UChar> characters;
+    characters.append(other->characters(), other->length());
+    unsigned index = randomNumber(characters.size());
+    characters[index] = randomNumber(2) ? Unicode::toUpper(characters[index]) : letters[randomNumber(letterCount)];
+    return StringImpl::create(characters.data(), characters.size());
+}
+
+static void runCases(unsigned count)
+{
+    for (unsigned testCase = 0; testCase < count; ++testCase) {
+        unsigned letterCount = 2 + randomNumber(WTF_ARRAY_LENGTH(letters) - 2);
+        RefPtr<StringImpl> text = makeRandomString(randomNumber(120), letterCount);
+
+        unsigned matchLength = randomNumber(3) ? 1 + randomNumber(24) : randomNumber(3);
+        RefPtr<StringImpl> match;
+        if (randomNumber(2) && text->length() >= matchLength)
+            match = text->substring(randomNumber(text->length() - matchLength + 1), matchLength);
+        else
+            match = makeRandomString(matchLength, letterCount);
+        unsigned index = randomNumber(text->length() + 4);
+
+        check(text->find(match.get(), index) == plainFind(text.get(), match.get(), index), FindString, testCase);
+        check(text->reverseFind(match.get(), index) == plainReverseFind(text.get(), match.get(), index), ReverseFindString, testCase);
+        check(text->reverseFind(match.get()) == plainReverseFind(text.get(), match.get(), UINT_MAX), ReverseFindString, testCase);
+        if (matchLength) {
+            UChar character = match->characters()[0];
+            check(text->find(character, index) == plainFindCharacter(text.get(), character, index), FindCharacter, testCase);
+            check(text->reverseFind(character, index) == plainReverseFindCharacter(text.get(), character, index), ReverseFindCharacter, testCase);
+        }
+
+        RefPtr<StringImpl> other = makeComparand(text.get(), letterCount);
+        bool sameLength = text->length() == other->length();
+        check(equal(text.get(), other.get()) == (sameLength && !memcmp(text->characters(), other->characters(), text->length() * sizeof(UChar))), Equal, testCase);
+        check(equalIgnoringCase(text.get(), other.get()) == (sameLength && !Unicode::umemcasecmp(text->characters(), other->characters(), text->length())), EqualIgnoringCase, testCase);
+        check(codePointCompare(text.get(), other.get()) == plainCodePointCompare(text.get(), other.get()), CodePointCompare, testCase);
+    }
+    printf("%u cases, %u mismatches\n", count, mismatches);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned cases = argc > 1 ? strtoul(argv[1], 0, 10) : 200000;
+
+    initializeThreading();
+    runBenchmark();
+    runCases(cases);
+    return mismatches ? 1 : 0;
+}
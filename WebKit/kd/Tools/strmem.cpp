@@ -0,0 +1,185 @@
+// strmem: measures the memory 8-bit strings save and the cost of reading them.
+//
+//   strmem [megabytes]
+//
+// Decodes a generated Latin-1 page of the given size (16 by default) and
+// reports the memory the text takes and how long SegmentedString takes to
+// scan it, with and without line counting, as the HTML tokenizer does.
+//
+// It then runs a script that parses a large JSON document, keeps every
+// string it produced, and calls the String methods pages use most on them.
+// The memory still held after those calls, beyond what the parse took, is
+// the widened copies left behind by code that read 8-bit strings as UChars.
+//
+// Build it against JavaScriptCore and WebCore/platform/text. Memory is the
+// process's private bytes on Windows and resident size elsewhere.
+
+#include "config.h"
+
+#include <JavaScriptCore/JavaScript.h>
+#include "SegmentedString.h"
+#include "TextCodecLatin1.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/Threading.h>
+
+#if OS(WINDOWS)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+using namespace WebCore;
+
+static double processMegabytes()
+{
+#if OS(WINDOWS)
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)))
+        return 0;
+    return counters.PrivateUsage / (1024.0 * 1024.0);
+#else
+    long pages = 0;
+    long residentPages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+    if (fscanf(statm, "%ld %ld", &pages, &residentPages) != 2)
+        residentPages = 0;
+    fclose(statm);
+    return residentPages * 4096 / (1024.0 * 1024.0);
+#endif
+}
+
+static NEVER_INLINE unsigned scan(SegmentedString& source)
+{
+    unsigned tags = 0;
+    while (!source.isEmpty()) {
+        if (*source == '<')
+            ++tags;
+        source.advance();
+    }
+    return tags;
+}
+
+static NEVER_INLINE unsigned scanCountingLines(SegmentedString& source, int& lineNumber)
+{
+    unsigned tags = 0;
+    while (!source.isEmpty()) {
+        if (*source == '<')
+            ++tags;
+        source.advance(lineNumber);
+    }
+    return tags;
+}
+
+// Best of several runs, in milliseconds.
+static double timeScan(const String& text, bool countLines)
+{
+    double best = 0;
+    for (int run = 0; run < 10; ++run) {
+        SegmentedString source(text);
+        int lineNumber = 0;
+        double start = currentTime();
+        if (countLines)
+            scanCountingLines(source, lineNumber);
+        else
+            scan(source);
+        double elapsed = (currentTime() - start) * 1000;
+        if (!run || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static void measureDocument(size_t size)
+{
+    static const char chunk[] = "<div class=\"item\"><a href=\"/path/to/page.html\">Caf\xe9 link text</a> some paragraph text here.</div>\n";
+    Vector<char> bytes;
+    bytes.reserveCapacity(size + sizeof(chunk));
+    while (bytes.size() < size)
+        bytes.append(chunk, sizeof(chunk) - 1);
+
+    TextCodecLatin1 codec;
+    bool sawError = false;
+    double before = processMegabytes();
+    String text = codec.decode(bytes.data(), bytes.size(), true, false, sawError);
+    double after = processMegabytes();
+
+    printf("document: %u characters, %s, %.1f MB\n", text.length(), text.is8Bit() ? "8-bit" : "16-bit", after - before);
+    printf("  scan: %.1f ms, counting lines: %.1f ms\n", timeScan(text, false), timeScan(text, true));
+}
+
+// The document is parsed a thousand records at a time so that little of the
+// memory measured afterwards is garbage the allocator is still holding on to.
+static const char script[] =
+    "var kept = [];\n"
+    "for (var chunk = 0; chunk < 200; ++chunk) {\n"
+    "    var records = [];\n"
+    "    for (var i = chunk * 1000; i < (chunk + 1) * 1000; ++i)\n"
+    "        records.push('{\"name\":\"item number ' + i + '\",\"tags\":\"red,green,blue\",\"price\":\"' + (i % 997) + '.50\",\"url\":\"/shop/item?id=' + i + '&ref=list\"}');\n"
+    "    var parsed = JSON.parse('[' + records.join(',') + ']');\n"
+    "    for (var i = 0; i < parsed.length; ++i) {\n"
+    "        var p = parsed[i];\n"
+    "        kept.push(p.name, p.tags, p.price, p.url);\n"
+    "    }\n"
+    "}\n"
+    "records = parsed = null;\n"
+    "function useStrings() {\n"
+    "    var total = 0;\n"
+    "    for (var i = 0; i < kept.length; i += 4) {\n"
+    "        var name = kept[i], tags = kept[i + 1], price = kept[i + 2], url = kept[i + 3];\n"
+    "        total += url.indexOf('?') + url.lastIndexOf('/') + tags.split(',').length;\n"
+    "        total += parseFloat(price) + Number(price) + parseInt(price, 10);\n"
+    "        total += name.toUpperCase().length + name.toLowerCase().length;\n"
+    "        total += (name < url) + (name + ' ' + tags).length;\n"
+    "    }\n"
+    "    return total;\n"
+    "}\n";
+
+static void evaluate(JSGlobalContextRef context, const char* source)
+{
+    JSStringRef string = JSStringCreateWithUTF8CString(source);
+    JSValueRef exception = 0;
+    JSEvaluateScript(context, string, 0, 0, 1, &exception);
+    JSStringRelease(string);
+    if (exception)
+        fprintf(stderr, "strmem: the script threw an exception\n");
+}
+
+static void measureScriptStrings()
+{
+    JSGlobalContextRef context = JSGlobalContextCreate(0);
+
+    double before = processMegabytes();
+    evaluate(context, script);
+    JSGarbageCollect(context);
+    double parsed = processMegabytes();
+
+    double start = currentTime();
+    evaluate(context, "useStrings();");
+    double elapsed = (currentTime() - start) * 1000;
+    JSGarbageCollect(context);
+    double used = processMegabytes();
+
+    printf("script strings: %.1f MB after parsing, %.1f MB more after use, use took %.1f ms\n", parsed - before, used - parsed, elapsed);
+
+    JSGlobalContextRelease(context);
+}
+
+int main(int argc, char** argv)
+{
+    WTF::initializeThreading();
+
+    size_t megabytes = argc > 1 ? atoi(argv[1]) : 16;
+    if (!megabytes) {
+        fprintf(stderr, "usage: strmem [megabytes]\n");
+        return 1;
+    }
+
+    measureDocument(megabytes * 1024 * 1024);
+    measureScriptStrings();
+    return 0;
+}
@@ -22,6 +22,9 @@
 
 #include "KWebPage.h"
 #include "FrameNetworkingContext.h"
+#include "KResourceLoadPool.h"
+#include "ResourceLoadTiming.h"
+#include "SharedBuffer.h"
 #include <list>
 
 namespace WebCore {
@@ -37,7 +40,22 @@ public:
         , m_resHandle(resHandle)
         , m_url(m_url)
         , m_deferred(false)
+        , m_started(false)
+        , m_responseSent(false)
+        , m_ignoringCacheData(false)
+        , m_loadJob(0)
+        , m_dataOffset(0)
+        , m_delivering(false)
+        , m_cancelled(false)
     {}
+
+    ~KNetworkReplyHandler()
+    {
+        if (m_loadJob) {
+            m_loadJob->cancel();
+            m_loadJob->deref();
+        }
+    }
 //     void setClient(ResourceHandleClient* client) {m_client = client;}
      ResourceHandleClient* client() {return m_client;}
 // 
@@ -51,11 +69,33 @@ public:
 
      void setLoadingDeferred(bool deferred) { m_deferred = deferred; }
 
+     // Called by ResourceHandle::cancel(). Nothing may reach the client or
+     // the handle afterwards.
+     void detach() { m_client = 0; m_resHandle = 0; m_cancelled = true; }
+     bool isCancelled() const { return m_cancelled; }
+
+     // Loading state owned by KWebPage::scheduleResourceLoader. A load is
+     // started once; its bytes then arrive either at once (buffers posted by
+     // the embedder) or from a KResourceLoadJob, and are delivered in chunks.
+     bool m_started;
+     bool m_responseSent;
+     bool m_ignoringCacheData;
+     KResourceLoadJob* m_loadJob;
+     RefPtr<SharedBuffer> m_data;
+     unsigned m_dataOffset;
+     RefPtr<ResourceLoadTiming> m_timing;
+
+     // The ResourceHandle owns its handler and deletes it on cancel(),
+     // unless a client callback cancels the load while KWebPage is
+     // delivering to it; KWebPage deletes the handler once that returns.
+     bool m_delivering;
+
 protected:
     ResourceHandleClient* m_client;
     ResourceHandle* m_resHandle;
     KURL m_url;
     bool m_deferred;
+    bool m_cancelled;
 };
 
 class KFrameNetworkingContext : public FrameNetworkingContext {
@@ -0,0 +1,280 @@
+#include "config.h"
+#include "KResourceLoadPool.h"
+
+#include <wtf/Atomics.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/text/CString.h>
+
+#if OS(WINDOWS)
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace WebCore {
+
+KResourceLoadJob::KResourceLoadJob(const String& path, ResourceLoadPriority priority)
+    : m_refCount(1)
+    , m_state(Queued)
+    , m_priority(priority)
+    , m_succeeded(false)
+    , m_queueTime(currentTime())
+    , m_startTime(0)
+    , m_finishTime(0)
+{
+    if (m_priority < ResourceLoadPriorityLowest || m_priority > ResourceLoadPriorityHighest)
+        m_priority = ResourceLoadPriorityLow;
+
+    // Copy the path out of the String now; StringImpl refcounts are not
+    // safe to touch from the worker.
+#if OS(WINDOWS)
+    m_path.append(path.characters(), path.length());
+    m_path.append(0);
+#else
+    CString utf8 = path.utf8();
+    m_path.reserveCapacity(utf8.length() + 1);
+    for (size_t i = 0; i < utf8.length(); ++i)
+        m_path.append(static_cast<unsigned char>(utf8.data()[i]));
+    m_path.append(0);
+#endif
+}
+
+void KResourceLoadJob::ref()
+{
+    atomicIncrement(&m_refCount);
+}
+
+void KResourceLoadJob::deref()
+{
+    if (!atomicDecrement(&m_refCount))
+        delete this;
+}
+
+bool KResourceLoadJob::isFinished() const
+{
+    return *const_cast<volatile int*>(&m_state) == Finished;
+}
+
+void KResourceLoadJob::cancel()
+{
+#if OS(WINDOWS)
+    InterlockedCompareExchange(reinterpret_cast<volatile LONG*>(&m_state), Cancelled, Queued);
+#else
+    __sync_bool_compare_and_swap(&m_state, Queued, Cancelled);
+#endif
+}
+
+void KResourceLoadJob::run()
+{
+#if OS(WINDOWS)
+    if (InterlockedCompareExchange(reinterpret_cast<volatile LONG*>(&m_state), Running, Queued) != Queued)
+        return;
+#else
+    if (!__sync_bool_compare_and_swap(&m_state, Queued, Running))
+        return;
+#endif
+
+    m_startTime = currentTime();
+    m_succeeded = readFile();
+    m_finishTime = currentTime();
+
+    // Publish m_data and the timings before the state flips.
+#if OS(WINDOWS)
+    InterlockedExchange(reinterpret_cast<volatile LONG*>(&m_state), Finished);
+#else
+    __sync_synchronize();
+    m_state = Finished;
+#endif
+}
+
+bool KResourceLoadJob::readFile()
+{
+#if OS(WINDOWS)
+    HANDLE hFile = CreateFileW((LPCWSTR)m_path.data(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
+    if (!hFile || INVALID_HANDLE_VALUE == hFile)
+        return false;
+
+    // An empty file is a successful read of nothing; only a file that
+    // cannot be opened or read counts as a failure.
+    bool bRet = false;
+    LARGE_INTEGER fileSize = {0};
+    DWORD bytesRead = 0;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.HighPart)
+        goto Exit0;
+
+    m_data.resize(fileSize.LowPart);
+    if (fileSize.LowPart && !::ReadFile(hFile, m_data.data(), fileSize.LowPart, &bytesRead, NULL))
+        goto Exit0;
+
+    m_data.shrink(bytesRead);
+    bRet = true;
+
+Exit0:
+    ::CloseHandle(hFile);
+    return bRet;
+#else
+    Vector<char> path;
+    for (size_t i = 0; i < m_path.size(); ++i)
+        path.append(static_cast<char>(m_path[i]));
+
+    int fd = open(path.data(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    bool result = false;
+    struct stat fileStat;
+    if (!fstat(fd, &fileStat)) {
+        m_data.resize(fileStat.st_size);
+        size_t offset = 0;
+        while (offset < m_data.size()) {
+            ssize_t count = read(fd, m_data.data() + offset, m_data.size() - offset);
+            if (count <= 0)
+                break;
+            offset += count;
+        }
+        result = offset == m_data.size();
+        m_data.shrink(offset);
+    }
+    close(fd);
+    return result;
+#endif
+}
+
+KResourceLoadPool* KResourceLoadPool::shared()
+{
+    static KResourceLoadPool* pool = new KResourceLoadPool;
+    return pool;
+}
+
+KResourceLoadPool::KResourceLoadPool()
+    : m_threadCount(0)
+    , m_jobFinishedFunction(0)
+{
+#if OS(WINDOWS)
+    InitializeCriticalSection(&m_lock);
+    m_jobsAvailable = CreateSemaphoreW(NULL, 0, LONG_MAX, NULL);
+#else
+    pthread_mutex_init(&m_lock, 0);
+    pthread_cond_init(&m_jobsAvailable, 0);
+#endif
+}
+
+void KResourceLoadPool::lock()
+{
+#if OS(WINDOWS)
+    EnterCriticalSection(&m_lock);
+#else
+    pthread_mutex_lock(&m_lock);
+#endif
+}
+
+void KResourceLoadPool::unlock()
+{
+#if OS(WINDOWS)
+    LeaveCriticalSection(&m_lock);
+#else
+    pthread_mutex_unlock(&m_lock);
+#endif
+}
+
+void KResourceLoadPool::startThreadsIfNeeded()
+{
+    if (m_threadCount)
+        return;
+
+#if OS(WINDOWS)
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    unsigned processorCount = systemInfo.dwNumberOfProcessors;
+#else
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned processorCount = processors > 0 ? processors : 1;
+#endif
+    unsigned maxThreads = maxThreadCount;
+    m_threadCount = std::max(1u, std::min(maxThreads, processorCount));
+
+    for (unsigned i = 0; i < m_threadCount; ++i) {
+#if OS(WINDOWS)
+        HANDLE thread = (HANDLE)_beginthreadex(0, 0, workerThreadEntry, this, 0, 0);
+        if (thread)
+            CloseHandle(thread);
+#else
+        pthread_t thread;
+        if (!pthread_create(&thread, 0, workerThreadEntry, this))
+            pthread_detach(thread);
+#endif
+    }
+}
+
+void KResourceLoadPool::post(KResourceLoadJob* job)
+{
+    job->ref();
+
+    lock();
+    startThreadsIfNeeded();
+    m_queues[job->priority()].append(job);
+#if OS(WINDOWS)
+    unlock();
+    ReleaseSemaphore(m_jobsAvailable, 1, 0);
+#else
+    pthread_cond_signal(&m_jobsAvailable);
+    unlock();
+#endif
+}
+
+KResourceLoadJob* KResourceLoadPool::takeJob()
+{
+#if OS(WINDOWS)
+    WaitForSingleObject(m_jobsAvailable, INFINITE);
+    lock();
+#else
+    lock();
+    while (true) {
+        bool empty = true;
+        for (int priority = ResourceLoadPriorityHighest; priority >= ResourceLoadPriorityLowest && empty; --priority)
+            empty = m_queues[priority].isEmpty();
+        if (!empty)
+            break;
+        pthread_cond_wait(&m_jobsAvailable, &m_lock);
+    }
+#endif
+
+    KResourceLoadJob* job = 0;
+    for (int priority = ResourceLoadPriorityHighest; priority >= ResourceLoadPriorityLowest && !job; --priority) {
+        if (!m_queues[priority].isEmpty())
+            job = m_queues[priority].takeFirst();
+    }
+    unlock();
+    return job;
+}
+
+void KResourceLoadPool::workerLoop()
+{
+    while (true) {
+        KResourceLoadJob* job = takeJob();
+        if (!job)
+            continue;
+        job->run();
+        job->deref();
+        if (m_jobFinishedFunction)
+            m_jobFinishedFunction();
+    }
+}
+
+#if OS(WINDOWS)
+unsigned __stdcall KResourceLoadPool::workerThreadEntry(void* context)
+{
+    static_cast<KResourceLoadPool*>(context)->workerLoop();
+    return 0;
+}
+#else
+void* KResourceLoadPool::workerThreadEntry(void* context)
+{
+    static_cast<KResourceLoadPool*>(context)->workerLoop();
+    return 0;
+}
+#endif
+
+} // namespace WebCore
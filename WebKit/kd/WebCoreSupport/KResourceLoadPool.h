@@ -0,0 +1,112 @@
+#ifndef KResourceLoadPool_h
+#define KResourceLoadPool_h
+
+#include "ResourceLoadPriority.h"
+#include "PlatformString.h"
+#include <wtf/Deque.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+#if OS(WINDOWS)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace WebCore {
+
+// One local file read, shared between the UI thread and a pool worker.
+//
+// The kd build compiles WTF with ENABLE_SINGLE_THREADED, so WTF::Mutex and
+// RefCounted are not thread safe here; the job counts references with
+// atomicIncrement/atomicDecrement and publishes its result through m_state.
+class KResourceLoadJob {
+    WTF_MAKE_NONCOPYABLE(KResourceLoadJob); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static KResourceLoadJob* create(const String& path, ResourceLoadPriority priority)
+    { return new KResourceLoadJob(path, priority); }
+
+    void ref();
+    void deref();
+
+    ResourceLoadPriority priority() const { return m_priority; }
+
+    // The UI thread may read the fields below once isFinished() is true.
+    bool isFinished() const;
+    bool succeeded() const { return m_succeeded; }
+    Vector<char>& data() { return m_data; }
+
+    // Seconds, as returned by WTF::currentTime().
+    double queueTime() const { return m_queueTime; }
+    double startTime() const { return m_startTime; }
+    double finishTime() const { return m_finishTime; }
+
+    // A cancelled job that has not started yet is skipped by the workers.
+    void cancel();
+
+private:
+    friend class KResourceLoadPool;
+
+    KResourceLoadJob(const String& path, ResourceLoadPriority);
+
+    void run();
+    bool readFile();
+
+    enum State { Queued, Running, Finished, Cancelled };
+
+    int m_refCount;
+    int m_state;
+    ResourceLoadPriority m_priority;
+    Vector<UChar> m_path;
+    Vector<char> m_data;
+    bool m_succeeded;
+    double m_queueTime;
+    double m_startTime;
+    double m_finishTime;
+};
+
+// Fixed set of worker threads that read KResourceLoadJobs, highest
+// ResourceLoadPriority first and FIFO within a priority.
+class KResourceLoadPool {
+    WTF_MAKE_NONCOPYABLE(KResourceLoadPool);
+public:
+    static KResourceLoadPool* shared();
+
+    // Takes a reference to the job until a worker is done with it.
+    void post(KResourceLoadJob*);
+
+    // Called on the worker thread after each job finishes, so a host that
+    // sleeps between events can wake its UI thread.
+    typedef void JobFinishedFunction();
+    void setJobFinishedFunction(JobFinishedFunction* function) { m_jobFinishedFunction = function; }
+
+    static const unsigned maxThreadCount = 4;
+
+private:
+    KResourceLoadPool();
+
+    void startThreadsIfNeeded();
+    KResourceLoadJob* takeJob();
+    void workerLoop();
+
+#if OS(WINDOWS)
+    static unsigned __stdcall workerThreadEntry(void*);
+    CRITICAL_SECTION m_lock;
+    HANDLE m_jobsAvailable;
+#else
+    static void* workerThreadEntry(void*);
+    pthread_mutex_t m_lock;
+    pthread_cond_t m_jobsAvailable;
+#endif
+
+    void lock();
+    void unlock();
+
+    unsigned m_threadCount;
+    JobFinishedFunction* m_jobFinishedFunction;
+    Deque<KResourceLoadJob*> m_queues[ResourceLoadPriorityHighest + 1];
+};
+
+} // namespace WebCore
+
+#endif // KResourceLoadPool_h